@@ -0,0 +1,277 @@
+#include "bulk_kernels.h"
+#include "helper.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace algorithms {
+namespace bulk_kernels {
+
+// copy_demo(), move_demo(), transform_and_combine_demo(), assign_new_values_demo() and replace_demo() of modifying.cpp
+void same_as_std_demo()
+{
+    // strings are not trivially copyable: std::copy / std::move
+    vector<string> coll1 = { "Hello", "this", "is", "an", "example" };
+    list<string> coll2;
+    bulk_kernels::copy(coll1.cbegin(), coll1.cend(), back_inserter(coll2));
+    helper::PRINT_ELEMENT(coll2, "coll2: ");
+    vector<string> coll4 = {"1", "2", "3", "4", "5"};
+    bulk_kernels::move_backward(coll1.begin(), coll1.end(), coll4.end());
+    helper::PRINT_ELEMENT(coll4, "coll4 (moved): ");
+
+    // --- 单个容器中的copy，区间重叠时就是 memmove ---
+    vector<char> chars(10, '.');
+    for (int c = 'a'; c < 'g'; c++)
+        chars.push_back(c);
+    chars.insert(chars.end(), 10, '.');
+    helper::PRINT_ELEMENT(chars, "chars: ");
+    vector<char> c1(chars.cbegin(), chars.cend());
+    bulk_kernels::copy(c1.begin() + 10, c1.begin() + 16, c1.begin() + 7);
+    helper::PRINT_ELEMENT(c1, "c1   : ");
+    vector<char> c2(chars.cbegin(), chars.cend());
+    bulk_kernels::copy_backward(c2.begin() + 10, c2.begin() + 16, c2.begin() + 19);
+    helper::PRINT_ELEMENT(c2, "c2   : ");
+
+    bulk_kernels::fill_n(ostream_iterator<double>(cout, " "), 10, 8.8);
+    cout << endl;
+    array<int, 10> arr;
+    bulk_kernels::iota(arr.begin(), arr.end(), 42);
+    helper::PRINT_ELEMENT(arr, "arr: ");
+    bulk_kernels::fill(arr.begin() + 5, arr.end(), -1);
+    helper::PRINT_ELEMENT(arr, "arr filled: ");
+
+    vector<int> coll;
+    helper::INSERT_ELEMENTS(coll, 1, 7);
+    helper::INSERT_ELEMENTS(coll, 3, 9);
+    helper::PRINT_ELEMENT(coll, "coll: ");
+    bulk_kernels::replace(coll.begin(), coll.end(), 6, 42);
+    helper::PRINT_ELEMENT(coll, "coll replace 6 with 42: ");
+    bulk_kernels::replace_if(coll.begin(), coll.end(), [] (int elem) { return elem < 5; }, 0);
+    helper::PRINT_ELEMENT(coll, "coll replace_if: ");
+    bulk_kernels::replace_if(coll.begin(), coll.end(), simd::greater_than(9), 9);
+    helper::PRINT_ELEMENT(coll, "coll replace_if > 9: ");
+
+    // transform_and_combine_demo(): negate, then multiply two ranges
+    bulk_kernels::transform(coll.begin(), coll.end(), coll.begin(), negate<int>());
+    helper::PRINT_ELEMENT(coll, "negated: ");
+    vector<double> scaled(coll.size());
+    bulk_kernels::transform(coll.begin(), coll.end(), scaled.begin(), [] (int x) { return x * 0.5; });
+    helper::PRINT_ELEMENT(scaled, "scaled: ");
+    bulk_kernels::transform(coll.begin(), coll.end(), coll.begin(), coll.begin(), multiplies<int>());
+    helper::PRINT_ELEMENT(coll, "squared: ");
+}
+
+template <typename T>
+bool check_type(mt19937& gen)
+{
+    bool ok = true;
+    for (size_t n : {0, 1, 15, 16, 17, 63, 64, 65, 200, 1000, 4097}) {
+        vector<T> data(n + 8);
+        for (auto& x : data) {
+            x = static_cast<T>(gen() % 16);
+        }
+
+        // overlapping copies in both directions
+        for (size_t shift : {1, 3, 8}) {
+            vector<T> a(data), b(data);
+            bulk_kernels::copy(a.begin() + shift, a.begin() + shift + n, a.begin());
+            std::copy(b.begin() + shift, b.begin() + shift + n, b.begin());
+            ok = ok && a == b;
+            a = data;
+            b = data;
+            bulk_kernels::copy_backward(a.begin(), a.begin() + n, a.begin() + n + shift);
+            std::copy_backward(b.begin(), b.begin() + n, b.begin() + n + shift);
+            ok = ok && a == b;
+        }
+
+        vector<T> a(data), b(data);
+        bulk_kernels::fill(a.begin() + 1, a.begin() + 1 + n, static_cast<T>(7));
+        std::fill(b.begin() + 1, b.begin() + 1 + n, static_cast<T>(7));
+        ok = ok && a == b;
+        // the streaming path on a misaligned destination
+        a = data;
+        detail::fill_lanes(reinterpret_cast<typename simd::uint_of<sizeof(T)>::type*>(&a[1]), n,
+                           static_cast<typename simd::uint_of<sizeof(T)>::type>(0), true);
+        std::fill(b.begin() + 1, b.begin() + 1 + n, static_cast<T>(0));
+        ok = ok && a == b;
+        vector<T> c(n + 8);
+        detail::stream_copy(reinterpret_cast<unsigned char*>(&c[1]), reinterpret_cast<const unsigned char*>(&data[0]),
+                            n * sizeof(T));
+        ok = ok && std::equal(data.begin(), data.begin() + n, c.begin() + 1);
+
+        a = data;
+        b = data;
+        bulk_kernels::replace(a.begin(), a.end(), static_cast<T>(3), static_cast<T>(9));
+        std::replace(b.begin(), b.end(), static_cast<T>(3), static_cast<T>(9));
+        ok = ok && a == b;
+        // an old value the element type can not hold matches nothing: 65536 + 9 is not 9 in a range of int8_t
+        bulk_kernels::replace(a.begin(), a.end(), (1ll << 16) + 9, 4ll);
+        bulk_kernels::replace(a.begin(), a.end(), 9.5, 4.0);
+        ok = ok && a == b;
+        bulk_kernels::replace_if(a.begin(), a.end(), simd::less_than(static_cast<T>(5)), static_cast<T>(1));
+        std::replace_if(b.begin(), b.end(), [] (T x) { return x < static_cast<T>(5); }, static_cast<T>(1));
+        ok = ok && a == b;
+        bulk_kernels::replace_if(a.begin(), a.end(), [] (T x) { return x > static_cast<T>(10); }, static_cast<T>(2));
+        std::replace_if(b.begin(), b.end(), [] (T x) { return x > static_cast<T>(10); }, static_cast<T>(2));
+        ok = ok && a == b;
+
+        auto f = [] (T x) { return static_cast<T>(x * 3 + 1); };
+        bulk_kernels::transform(a.begin(), a.end(), a.begin(), f);
+        std::transform(b.begin(), b.end(), b.begin(), f);
+        ok = ok && a == b;
+        vector<double> da(a.size()), db(a.size());
+        bulk_kernels::transform(a.begin(), a.end(), data.begin(), da.begin(), [] (T x, T y) { return double(x) - y; });
+        std::transform(a.begin(), a.end(), data.begin(), db.begin(), [] (T x, T y) { return double(x) - y; });
+        ok = ok && da == db;
+        // in place over either input, the blocked kernels
+        auto g = [] (T x, T y) { return static_cast<T>(x * 2 - y); };
+        vector<T> got(a), expected(b);
+        bulk_kernels::transform(got.begin(), got.end(), data.begin(), got.begin(), g);
+        std::transform(expected.begin(), expected.end(), data.begin(), expected.begin(), g);
+        ok = ok && got == expected;
+        bulk_kernels::transform(data.begin(), data.end(), got.begin(), got.begin(), g);
+        std::transform(data.begin(), data.end(), expected.begin(), expected.begin(), g);
+        ok = ok && got == expected;
+        bulk_kernels::transform(got.begin(), got.end(), got.begin(), got.begin(), g);
+        std::transform(expected.begin(), expected.end(), expected.begin(), expected.begin(), g);
+        ok = ok && got == expected;
+    }
+    return ok;
+}
+
+template <typename T>
+bool check_iota()
+{
+    bool ok = true;
+    for (size_t n : {0, 1, 31, 33, 1000}) {
+        vector<T> a(n), b(n);
+        bulk_kernels::iota(a.begin(), a.end(), static_cast<T>(100));
+        std::iota(b.begin(), b.end(), static_cast<T>(100));
+        ok = ok && a == b;
+    }
+    return ok;
+}
+
+struct rgb {
+    uint8_t r, g, b, a;
+};
+
+bool cross_check()
+{
+    mt19937 gen(11);
+    bool ok = check_type<int8_t>(gen) && check_type<uint16_t>(gen) && check_type<int32_t>(gen) &&
+              check_type<float>(gen) && check_type<int64_t>(gen) && check_type<double>(gen) &&
+              check_iota<uint8_t>() && check_iota<int16_t>() && check_iota<uint32_t>() && check_iota<int64_t>();
+
+    // a 4 byte struct is filled through uint32_t
+    vector<rgb> pixels(1001);
+    bulk_kernels::fill(pixels.begin(), pixels.end(), rgb{1, 2, 3, 255});
+    for (const rgb& p : pixels) {
+        ok = ok && p.r == 1 && p.g == 2 && p.b == 3 && p.a == 255;
+    }
+    // streaming into a range that is not aligned to its element size (a packed struct in a byte buffer)
+    alignas(64) unsigned char bytes[4 * 1000 + 1] = {};
+    detail::fill_lanes(reinterpret_cast<uint32_t*>(bytes + 1), 1000, uint32_t(0x01020304), true);
+    for (size_t i = 0; i < 1000; ++i) {
+        uint32_t x;
+        memcpy(&x, bytes + 1 + 4 * i, sizeof(x));
+        ok = ok && x == 0x01020304;
+    }
+    ok = ok && bytes[0] == 0;
+
+    // the parallel versions (STL_DEMO_THREADS=8 runs more chunks)
+    vector<int32_t> src(3000007), dst(src.size());
+    for (auto& x : src) {
+        x = static_cast<int32_t>(gen());
+    }
+    bulk_kernels::parallel::copy(src.begin(), src.end(), dst.begin());
+    ok = ok && src == dst;
+    bulk_kernels::parallel::fill(dst.begin() + 1, dst.end(), 5);
+    ok = ok && dst[0] == src[0] && std::count(dst.begin(), dst.end(), 5) == static_cast<long>(dst.size() - 1);
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+void benchmark()
+{
+    // 512 MB: far beyond any last level cache
+    const size_t kValues = 128 << 20;
+    vector<int32_t> src(kValues), dst(kValues);
+    std::iota(src.begin(), src.end(), 0);
+    std::fill(dst.begin(), dst.end(), 0);
+    cout << "last level cache: " << (detail::llc_bytes() >> 20) << " MB" << endl;
+
+    long long t = time_ms([&] { std::copy(src.begin(), src.end(), dst.begin()); });
+    cout << "std::copy 512 MB: " << t << " ms" << endl;
+    t = time_ms([&] { bulk_kernels::copy(src.begin(), src.end(), dst.begin()); });
+    cout << "copy 512 MB (streaming): " << t << " ms" << endl;
+    t = time_ms([&] { bulk_kernels::parallel::copy(src.begin(), src.end(), dst.begin()); });
+    cout << "parallel::copy 512 MB: " << t << " ms (" << algorithms::parallel::thread_count() << " threads)" << endl;
+
+    t = time_ms([&] { std::fill(dst.begin(), dst.end(), 7); });
+    cout << "std::fill 512 MB: " << t << " ms" << endl;
+    t = time_ms([&] { bulk_kernels::fill(dst.begin(), dst.end(), 7); });
+    cout << "fill 512 MB (streaming): " << t << " ms" << endl;
+
+    t = time_ms([&] { std::iota(dst.begin(), dst.end(), 1); });
+    cout << "std::iota: " << t << " ms" << endl;
+    t = time_ms([&] { bulk_kernels::iota(dst.begin(), dst.end(), 1); });
+    cout << "iota: " << t << " ms" << endl;
+
+    // every 1000th value matches
+    for (auto& x : dst) {
+        x %= 1000;
+    }
+    t = time_ms([&] { std::replace(dst.begin(), dst.end(), 999, -1); });
+    cout << "std::replace: " << t << " ms" << endl;
+    t = time_ms([&] { bulk_kernels::replace(dst.begin(), dst.end(), 998, -1); });
+    cout << "replace: " << t << " ms" << endl;
+    t = time_ms([&] { std::replace_if(dst.begin(), dst.end(), [] (int32_t x) { return x < 500; }, 0); });
+    cout << "std::replace_if (x < 500): " << t << " ms" << endl;
+    t = time_ms([&] { bulk_kernels::replace_if(dst.begin(), dst.end(), [] (int32_t x) { return x < 600; }, 0); });
+    cout << "replace_if (x < 600, lambda): " << t << " ms" << endl;
+
+    // in cache, so the arithmetic counts: 16K floats, 20000 times
+    vector<float> in(1 << 14), out(1 << 14);
+    std::iota(in.begin(), in.end(), 0.0f);
+    auto axpb = [] (float x) { return x * 0.5f + 2.0f; };
+    t = time_ms([&] {
+        for (int r = 0; r < 20000; ++r) {
+            std::transform(in.begin(), in.end(), out.begin(), axpb);
+        }
+    });
+    cout << "std::transform x * 0.5 + 2: " << t << " ms" << endl;
+    t = time_ms([&] {
+        for (int r = 0; r < 20000; ++r) {
+            bulk_kernels::transform(in.begin(), in.end(), out.begin(), axpb);
+        }
+    });
+    cout << "transform x * 0.5 + 2: " << t << " ms (out[3] = " << out[3] << ")" << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
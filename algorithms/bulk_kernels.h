@@ -0,0 +1,674 @@
+#ifndef STL_DEMO_ALGORITHMS_BULK_KERNELS_H
+#define STL_DEMO_ALGORITHMS_BULK_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+
+#include "parallel.h"
+#include "simd.h"
+
+namespace algorithms {
+namespace bulk_kernels {
+
+/*
+ * Bulk data movement for copy_demo(), move_demo(), transform_and_combine_demo(), assign_new_values_demo()
+ * and replace_demo() of modifying.cpp.
+ *
+ *     copy / copy_n / move       trivially copyable contiguous ranges become one memmove; a copy whose source
+ *     copy_backward / ...        and destination do not fit into the last level cache uses non-temporal
+ *                                (streaming) stores instead, which skip the cache and the read-for-ownership
+ *     fill / fill_n / iota       broadcast register stores, streaming for huge ranges
+ *     replace / replace_if       compare + select per register, simd:: predicates or any other predicate
+ *     transform                  arithmetic element types: the lambda runs on fixed blocks of kBlock elements
+ *     parallel::copy / fill      one chunk per thread; a single core can not saturate the memory bandwidth
+ *
+ * 关于 transform: -O2 下 GCC 只在 "循环次数固定且是向量宽度的倍数" 时才向量化 (very-cheap cost model)，
+ * std::transform 那样次数不定、输入输出可能重叠的循环不会被向量化。所以这里把区间切成固定 kBlock 个元素的块，
+ * 先写到栈上的临时数组再 memcpy 出去，编译器就能把 lambda 本身 (x * 3 + 1 之类) 向量化。
+ * 其它情况 (list, string 之类) 直接转给 std:: 版本。
+ */
+
+namespace detail {
+
+using simd::value_of;
+using simd::is_bitwise;
+using simd::is_bitwise_pair;
+using simd::is_lane_size;
+
+// size of the last level cache, 8 MB if the system does not tell
+inline std::size_t llc_bytes()
+{
+    static const std::size_t bytes = [] {
+        long l3 = 0;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+        l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+        return l3 > 0 ? static_cast<std::size_t>(l3) : std::size_t(8) << 20;
+    }();
+    return bytes;
+}
+
+// source and destination of a copy together do not fit into the last level cache
+inline bool use_stream(std::size_t bytes)
+{
+    return 2 * bytes > llc_bytes();
+}
+
+inline bool overlap(const void* a, const void* b, std::size_t bytes)
+{
+    const unsigned char* x = static_cast<const unsigned char*>(a);
+    const unsigned char* y = static_cast<const unsigned char*>(b);
+    return x < y + bytes && y < x + bytes;
+}
+
+// bytes until p is aligned to a register, at most n
+inline std::size_t head_bytes(const void* p, std::size_t n)
+{
+#if defined(STL_DEMO_SIMD)
+    const std::size_t misalign = reinterpret_cast<std::uintptr_t>(p) % simd::kBytes;
+    return std::min(n, misalign == 0 ? 0 : simd::kBytes - misalign);
+#else
+    (void) p;
+    return n;
+#endif
+}
+
+// non-overlapping ranges, loads are unaligned, the streaming stores aligned
+inline void stream_copy(unsigned char* dst, const unsigned char* src, std::size_t n)
+{
+    std::size_t i = head_bytes(dst, n);
+    std::memcpy(dst, src, i);
+#if defined(STL_DEMO_SIMD)
+    const std::size_t B = simd::kBytes;
+    for (; i + 4 * B <= n; i += 4 * B) {
+        const simd::reg a = simd::loadu(src + i), b = simd::loadu(src + i + B);
+        const simd::reg c = simd::loadu(src + i + 2 * B), d = simd::loadu(src + i + 3 * B);
+        simd::stream(dst + i, a);
+        simd::stream(dst + i + B, b);
+        simd::stream(dst + i + 2 * B, c);
+        simd::stream(dst + i + 3 * B, d);
+    }
+    for (; i + B <= n; i += B) {
+        simd::stream(dst + i, simd::loadu(src + i));
+    }
+    simd::sfence();
+#endif
+    std::memcpy(dst + i, src + i, n - i);
+}
+
+inline void copy_bytes(void* dst, const void* src, std::size_t n, bool stream)
+{
+    if (n == 0)
+        return;
+    if (stream && !overlap(dst, src, n))
+        stream_copy(static_cast<unsigned char*>(dst), static_cast<const unsigned char*>(src), n);
+    else
+        std::memmove(dst, src, n);
+}
+
+// n elements of U (an unsigned integer of 1, 2, 4 or 8 bytes), all set to v
+template <typename U>
+void fill_lanes(U* p, std::size_t n, U v, bool stream)
+{
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    const std::size_t W = simd::lane<U>::width;
+    const simd::reg r = simd::lane<U>::set1(v);
+    // p is not always aligned to sizeof(U) (a packed struct, a char buffer): its head would never end on a
+    // register boundary, so such a range takes the storeu loop (parallel::fill shares this kernel)
+    if (stream && reinterpret_cast<std::uintptr_t>(p) % sizeof(U) == 0) {
+        // sizeof(U) divides the alignment of p, so the head ends on a register boundary
+        for (const std::size_t head = head_bytes(p, n * sizeof(U)) / sizeof(U); i < head; ++i) {
+            p[i] = v;
+        }
+        for (; i + W <= n; i += W) {
+            simd::stream(p + i, r);
+        }
+        simd::sfence();
+    } else {
+        for (; i + 4 * W <= n; i += 4 * W) {
+            simd::storeu(p + i, r);
+            simd::storeu(p + i + W, r);
+            simd::storeu(p + i + 2 * W, r);
+            simd::storeu(p + i + 3 * W, r);
+        }
+        for (; i + W <= n; i += W) {
+            simd::storeu(p + i, r);
+        }
+    }
+#else
+    (void) stream;
+#endif
+    for (; i < n; ++i) {
+        p[i] = v;
+    }
+}
+
+// value, value + 1, ... with the wrap around of unsigned arithmetic
+template <typename T>
+void iota_lanes(T* p, std::size_t n, T value)
+{
+    typedef typename std::make_unsigned<T>::type U;
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    const std::size_t W = simd::lane<T>::width;
+    T start[simd::kBytes / sizeof(T)];
+    for (std::size_t k = 0; k < W; ++k) {
+        start[k] = static_cast<T>(static_cast<U>(value) + static_cast<U>(k));
+    }
+    simd::reg v = simd::loadu(start);
+    const simd::reg step = simd::lane<T>::set1(static_cast<T>(W));
+    for (; i + W <= n; i += W) {
+        simd::storeu(p + i, v);
+        v = simd::lane<T>::add(v, step);
+    }
+#endif
+    for (; i < n; ++i) {
+        p[i] = static_cast<T>(static_cast<U>(value) + static_cast<U>(i));
+    }
+}
+
+// registers without a match are not written back
+template <typename T, typename Pred>
+void replace_lanes(T* p, std::size_t n, Pred pred, T new_value)
+{
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    const std::size_t W = simd::lane<T>::width;
+    const simd::reg v = simd::lane<T>::set1(pred.value);
+    const simd::reg r = simd::lane<T>::set1(new_value);
+    for (; i + W <= n; i += W) {
+        const simd::reg x = simd::loadu(p + i);
+        const simd::reg m = pred.mask(x, v);
+        if (simd::bytemask(m) != 0)
+            simd::storeu(p + i, simd::select(m, r, x));
+    }
+#endif
+    for (; i < n; ++i) {
+        if (pred(p[i]))
+            p[i] = new_value;
+    }
+}
+
+// elements per block of the transform kernels: a constant trip count the compiler vectorizes
+static const std::size_t kBlock = 64;
+
+template <typename T, typename Pred>
+void replace_blocks(T* p, std::size_t n, Pred& pred, T new_value)
+{
+    std::size_t i = 0;
+    for (; i + kBlock <= n; i += kBlock) {
+        T* q = p + i;
+        for (std::size_t k = 0; k < kBlock; ++k) {
+            q[k] = pred(q[k]) ? new_value : q[k];
+        }
+    }
+    for (; i < n; ++i) {
+        if (pred(p[i]))
+            p[i] = new_value;
+    }
+}
+
+// one block each: restrict tells the compiler that out does not alias the input
+template <typename In, typename Out, typename F>
+void transform_block(const In* __restrict in, Out* __restrict out, F& f)
+{
+    for (std::size_t k = 0; k < kBlock; ++k) {
+        out[k] = f(in[k]);
+    }
+}
+
+template <typename T, typename F>
+void transform_block(T* p, F& f)
+{
+    for (std::size_t k = 0; k < kBlock; ++k) {
+        p[k] = f(p[k]);
+    }
+}
+
+template <typename In1, typename In2, typename Out, typename F>
+void transform_block(const In1* a, const In2* b, Out* __restrict out, F& f)
+{
+    for (std::size_t k = 0; k < kBlock; ++k) {
+        out[k] = f(a[k], b[k]);
+    }
+}
+
+// the output is the first input: element k is read before it is written
+template <typename T, typename In2, typename F>
+void transform_block_first(T* p, const In2* b, F& f)
+{
+    for (std::size_t k = 0; k < kBlock; ++k) {
+        p[k] = f(p[k], b[k]);
+    }
+}
+
+template <typename In1, typename T, typename F>
+void transform_block_second(const In1* a, T* p, F& f)
+{
+    for (std::size_t k = 0; k < kBlock; ++k) {
+        p[k] = f(a[k], p[k]);
+    }
+}
+
+// out == in works like std::transform; other overlaps run the scalar loop
+template <typename In, typename Out, typename F>
+void transform_blocks(const In* in, std::size_t n, Out* out, F& f)
+{
+    std::size_t i = 0;
+    if (static_cast<const void*>(in) == static_cast<const void*>(out) && std::is_same<In, Out>::value) {
+        Out* p = reinterpret_cast<Out*>(const_cast<In*>(in));
+        for (; i + kBlock <= n; i += kBlock) {
+            transform_block(p + i, f);
+        }
+    } else if (!overlap(in, out, n * std::max(sizeof(In), sizeof(Out)))) {
+        for (; i + kBlock <= n; i += kBlock) {
+            transform_block(in + i, out + i, f);
+        }
+    }
+    for (; i < n; ++i) {
+        out[i] = f(in[i]);
+    }
+}
+
+// out == in1 or out == in2 (in place, like std::transform) keeps the blocks; a partial overlap runs the scalar loop
+template <typename In1, typename In2, typename Out, typename F>
+void transform_blocks(const In1* in1, const In2* in2, std::size_t n, Out* out, F& f)
+{
+    std::size_t i = 0;
+    const std::size_t bytes = n * std::max(sizeof(In1), std::max(sizeof(In2), sizeof(Out)));
+    const bool first = static_cast<const void*>(in1) == static_cast<const void*>(out) && std::is_same<In1, Out>::value;
+    const bool second = static_cast<const void*>(in2) == static_cast<const void*>(out) && std::is_same<In2, Out>::value;
+    const bool blocks = (first || !overlap(in1, out, bytes)) && (second || !overlap(in2, out, bytes));
+    if (blocks && first) {
+        for (; i + kBlock <= n; i += kBlock) {
+            transform_block_first(out + i, in2 + i, f);
+        }
+    } else if (blocks && second) {
+        for (; i + kBlock <= n; i += kBlock) {
+            transform_block_second(in1 + i, out + i, f);
+        }
+    } else if (blocks) {
+        for (; i + kBlock <= n; i += kBlock) {
+            transform_block(in1 + i, in2 + i, out + i, f);
+        }
+    }
+    for (; i < n; ++i) {
+        out[i] = f(in1[i], in2[i]);
+    }
+}
+
+// -- iterator wrappers --
+
+template <typename It, typename Out>
+Out copy(It first, It last, Out out, std::true_type)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t bytes = n * sizeof(typename value_of<It>::type);
+    if (n > 0)
+        copy_bytes(&*out, &*first, bytes, use_stream(bytes));
+    return out + n;
+}
+
+template <typename It, typename Out>
+Out copy(It first, It last, Out out, std::false_type)
+{
+    return std::copy(first, last, out);
+}
+
+template <typename It, typename Size, typename Out>
+Out copy_n(It first, Size count, Out out, std::true_type)
+{
+    return count <= 0 ? out : detail::copy(first, first + count, out, std::true_type());
+}
+
+template <typename It, typename Size, typename Out>
+Out copy_n(It first, Size count, Out out, std::false_type)
+{
+    return std::copy_n(first, count, out);
+}
+
+// moving a trivially copyable element is copying it
+template <typename It, typename Out>
+Out move(It first, It last, Out out, std::true_type)
+{
+    return detail::copy(first, last, out, std::true_type());
+}
+
+template <typename It, typename Out>
+Out move(It first, It last, Out out, std::false_type)
+{
+    return std::move(first, last, out);
+}
+
+template <typename It, typename Out>
+Out copy_backward(It first, It last, Out d_last, std::true_type)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t bytes = n * sizeof(typename value_of<It>::type);
+    if (n > 0)
+        copy_bytes(&*(d_last - n), &*first, bytes, use_stream(bytes));
+    return d_last - n;
+}
+
+template <typename It, typename Out>
+Out copy_backward(It first, It last, Out d_last, std::false_type)
+{
+    return std::copy_backward(first, last, d_last);
+}
+
+template <typename It, typename Out>
+Out move_backward(It first, It last, Out d_last, std::true_type)
+{
+    return detail::copy_backward(first, last, d_last, std::true_type());
+}
+
+template <typename It, typename Out>
+Out move_backward(It first, It last, Out d_last, std::false_type)
+{
+    return std::move_backward(first, last, d_last);
+}
+
+// output iterators have the value type void, so sizeof is only taken for bitwise ranges
+template <typename It, bool = is_bitwise<It>::value>
+struct use_fill : std::false_type {};
+
+template <typename It>
+struct use_fill<It, true> : is_lane_size<sizeof(typename value_of<It>::type)> {};
+
+template <typename It, typename T>
+void fill(It first, It last, const T& value, std::true_type)
+{
+    typedef typename value_of<It>::type V;
+    typedef typename simd::uint_of<sizeof(V)>::type U;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (n == 0)
+        return;
+    const V v = value;
+    U bits;
+    std::memcpy(&bits, &v, sizeof(V));
+    fill_lanes(reinterpret_cast<U*>(&*first), n, bits, use_stream(n * sizeof(V)));
+}
+
+template <typename It, typename T>
+void fill(It first, It last, const T& value, std::false_type)
+{
+    std::fill(first, last, value);
+}
+
+template <typename It, typename Size, typename T>
+It fill_n(It first, Size count, const T& value, std::true_type)
+{
+    if (count <= 0)
+        return first;
+    detail::fill(first, first + count, value, std::true_type());
+    return first + count;
+}
+
+template <typename It, typename Size, typename T>
+It fill_n(It first, Size count, const T& value, std::false_type)
+{
+    return std::fill_n(first, count, value);
+}
+
+template <typename It, typename T>
+void iota(It first, It last, T value, std::true_type)
+{
+    typedef typename value_of<It>::type V;
+    if (first != last)
+        iota_lanes(&*first, static_cast<std::size_t>(last - first), static_cast<V>(value));
+}
+
+template <typename It, typename T>
+void iota(It first, It last, T value, std::false_type)
+{
+    std::iota(first, last, value);
+}
+
+template <typename It, typename T>
+void replace(It first, It last, const T& old_value, const T& new_value, std::true_type)
+{
+    typedef typename value_of<It>::type V;
+    // new_value converts on assignment either way, old_value has to compare the std::replace way
+    if (!simd::representable<V>(old_value))
+        std::replace(first, last, old_value, new_value);
+    else if (first != last)
+        replace_lanes(&*first, static_cast<std::size_t>(last - first), simd::equal_to(static_cast<V>(old_value)),
+                      static_cast<V>(new_value));
+}
+
+template <typename It, typename T>
+void replace(It first, It last, const T& old_value, const T& new_value, std::false_type)
+{
+    std::replace(first, last, old_value, new_value);
+}
+
+// 2: simd:: predicate, 1: any predicate on a contiguous arithmetic range, 0: std::replace_if
+template <typename It, typename Pred, typename T>
+void replace_if(It first, It last, Pred pred, const T& new_value, std::integral_constant<int, 2>)
+{
+    typedef typename value_of<It>::type V;
+    if (first != last)
+        replace_lanes(&*first, static_cast<std::size_t>(last - first), pred, static_cast<V>(new_value));
+}
+
+template <typename It, typename Pred, typename T>
+void replace_if(It first, It last, Pred pred, const T& new_value, std::integral_constant<int, 1>)
+{
+    typedef typename value_of<It>::type V;
+    if (first != last)
+        replace_blocks(&*first, static_cast<std::size_t>(last - first), pred, static_cast<V>(new_value));
+}
+
+template <typename It, typename Pred, typename T>
+void replace_if(It first, It last, Pred pred, const T& new_value, std::integral_constant<int, 0>)
+{
+    std::replace_if(first, last, pred, new_value);
+}
+
+template <typename It, typename Out, typename F>
+Out transform(It first, It last, Out out, F f, std::true_type)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (n > 0)
+        transform_blocks(&*first, n, &*out, f);
+    return out + n;
+}
+
+template <typename It, typename Out, typename F>
+Out transform(It first, It last, Out out, F f, std::false_type)
+{
+    return std::transform(first, last, out, f);
+}
+
+template <typename It1, typename It2, typename Out, typename F>
+Out transform(It1 first1, It1 last1, It2 first2, Out out, F f, std::true_type)
+{
+    const std::size_t n = static_cast<std::size_t>(last1 - first1);
+    if (n > 0)
+        transform_blocks(&*first1, &*first2, n, &*out, f);
+    return out + n;
+}
+
+template <typename It1, typename It2, typename Out, typename F>
+Out transform(It1 first1, It1 last1, It2 first2, Out out, F f, std::false_type)
+{
+    return std::transform(first1, last1, first2, out, f);
+}
+
+} // namespace detail
+
+// copy() may overlap like std::copy (out before first); huge non-overlapping copies bypass the cache
+template <typename It, typename Out>
+Out copy(It first, It last, Out out)
+{
+    return detail::copy(first, last, out, detail::is_bitwise_pair<It, Out>());
+}
+
+template <typename It, typename Size, typename Out>
+Out copy_n(It first, Size count, Out out)
+{
+    return detail::copy_n(first, count, out, detail::is_bitwise_pair<It, Out>());
+}
+
+template <typename It, typename Out>
+Out copy_backward(It first, It last, Out d_last)
+{
+    return detail::copy_backward(first, last, d_last, detail::is_bitwise_pair<It, Out>());
+}
+
+template <typename It, typename Out>
+Out move(It first, It last, Out out)
+{
+    return detail::move(first, last, out, detail::is_bitwise_pair<It, Out>());
+}
+
+template <typename It, typename Out>
+Out move_backward(It first, It last, Out d_last)
+{
+    return detail::move_backward(first, last, d_last, detail::is_bitwise_pair<It, Out>());
+}
+
+template <typename It, typename T>
+void fill(It first, It last, const T& value)
+{
+    detail::fill(first, last, value, detail::use_fill<It>());
+}
+
+template <typename It, typename Size, typename T>
+It fill_n(It first, Size count, const T& value)
+{
+    return detail::fill_n(first, count, value, detail::use_fill<It>());
+}
+
+template <typename It, typename T>
+void iota(It first, It last, T value)
+{
+    typedef typename detail::value_of<It>::type V;
+    detail::iota(first, last, value, std::integral_constant<bool, simd::use_simd<It>::value && std::is_integral<V>::value>());
+}
+
+// registers with a match are written back as a whole
+template <typename It, typename T>
+void replace(It first, It last, const T& old_value, const T& new_value)
+{
+    detail::replace(first, last, old_value, new_value, simd::use_simd<It>());
+}
+
+template <typename It, typename Pred, typename T>
+void replace_if(It first, It last, Pred pred, const T& new_value)
+{
+    typedef typename detail::value_of<It>::type V;
+    detail::replace_if(first, last, pred, new_value,
+                       std::integral_constant<int, simd::is_simd_predicate_for<Pred, V>::value && simd::use_simd<It>::value ? 2
+                                                 : simd::use_simd<It>::value ? 1 : 0>());
+}
+
+// out may be equal to first, other overlaps are not allowed
+template <typename It, typename Out, typename F>
+Out transform(It first, It last, Out out, F f)
+{
+    return detail::transform(first, last, out, f,
+                             std::integral_constant<bool, simd::use_simd<It>::value && simd::use_simd<Out>::value>());
+}
+
+template <typename It1, typename It2, typename Out, typename F>
+Out transform(It1 first1, It1 last1, It2 first2, Out out, F f)
+{
+    return detail::transform(first1, last1, first2, out, f,
+                             std::integral_constant<bool, simd::use_simd<It1>::value && simd::use_simd<It2>::value &&
+                                                              simd::use_simd<Out>::value>());
+}
+
+namespace parallel {
+
+// less than this many bytes per thread are not worth a thread
+static const std::size_t kMinBytesPerThread = 1 << 20;
+
+namespace detail {
+
+template <typename It, typename Out>
+Out copy(It first, It last, Out out, std::true_type)
+{
+    typedef typename bulk_kernels::detail::value_of<It>::type V;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t bytes = n * sizeof(V);
+    if (n == 0)
+        return out;
+    V* dst = &*out;
+    const V* src = &*first;
+    if (bulk_kernels::detail::overlap(dst, src, bytes)) {
+        std::memmove(dst, src, bytes);
+        return out + n;
+    }
+    const bool stream = bulk_kernels::detail::use_stream(bytes);
+    algorithms::parallel::for_each_chunk(n, algorithms::parallel::chunk_count(bytes, kMinBytesPerThread),
+                                         [=] (std::size_t, std::size_t b, std::size_t e) {
+        bulk_kernels::detail::copy_bytes(dst + b, src + b, (e - b) * sizeof(V), stream);
+    });
+    return out + n;
+}
+
+template <typename It, typename Out>
+Out copy(It first, It last, Out out, std::false_type)
+{
+    return std::copy(first, last, out);
+}
+
+template <typename It, typename T>
+void fill(It first, It last, const T& value, std::true_type)
+{
+    typedef typename bulk_kernels::detail::value_of<It>::type V;
+    typedef typename simd::uint_of<sizeof(V)>::type U;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (n == 0)
+        return;
+    const V v = value;
+    U bits;
+    std::memcpy(&bits, &v, sizeof(V));
+    U* p = reinterpret_cast<U*>(&*first);
+    const bool stream = bulk_kernels::detail::use_stream(n * sizeof(V));
+    algorithms::parallel::for_each_chunk(n, algorithms::parallel::chunk_count(n * sizeof(V), kMinBytesPerThread),
+                                         [=] (std::size_t, std::size_t b, std::size_t e) {
+        bulk_kernels::detail::fill_lanes(p + b, e - b, bits, stream);
+    });
+}
+
+template <typename It, typename T>
+void fill(It first, It last, const T& value, std::false_type)
+{
+    std::fill(first, last, value);
+}
+
+}
+
+// source and destination must not overlap for the threads to run; an overlapping copy is one memmove
+template <typename It, typename Out>
+Out copy(It first, It last, Out out)
+{
+    return detail::copy(first, last, out, bulk_kernels::detail::is_bitwise_pair<It, Out>());
+}
+
+template <typename It, typename T>
+void fill(It first, It last, const T& value)
+{
+    detail::fill(first, last, value, bulk_kernels::detail::use_fill<It>());
+}
+
+}
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_BULK_KERNELS_H
@@ -0,0 +1,607 @@
+#include "codec_kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+using namespace std;
+
+namespace algorithms {
+namespace codec_kernels {
+
+// -- bp128 --
+
+bp128::bp128(const uint32_t* in, size_t n, transform mode) : mode_(mode), size_(n)
+{
+    const size_t blocks = (n + kBlock - 1) / kBlock;
+    offsets_.reserve(blocks);
+    bases_.reserve(blocks);
+    bits_.reserve(blocks);
+    uint32_t values[kBlock], coded[kBlock];
+    uint32_t before = 0;
+    for (size_t block = 0; block < blocks; ++block) {
+        const size_t begin = block * kBlock, m = min(kBlock, n - begin);
+        memcpy(values, in + begin, m * sizeof(uint32_t));
+        // the padding of the last block must not widen it: D4 repeats the value four positions before
+        // (a delta of 0), the other modes the last value
+        const bool d4 = mode == transform::delta || mode == transform::zigzag_delta;
+        for (size_t i = m; i < kBlock; ++i) {
+            values[i] = !d4 ? values[m - 1] : i >= 4 ? values[i - 4] : before;
+        }
+        uint32_t base = 0;
+        switch (mode) {
+        case transform::none:
+            memcpy(coded, values, sizeof(values));
+            break;
+        case transform::frame:
+            base = *min_element(values, values + kBlock);
+            for (size_t i = 0; i < kBlock; ++i) {
+                coded[i] = values[i] - base;
+            }
+            break;
+        case transform::delta:
+        case transform::zigzag_delta:
+            // D4: the value four positions before, the value before the block for the first four
+            base = before;
+            for (size_t i = 0; i < kBlock; ++i) {
+                coded[i] = values[i] - (i >= 4 ? values[i - 4] : base);
+            }
+            if (mode == transform::zigzag_delta) {
+                for (size_t i = 0; i < kBlock; ++i) {
+                    coded[i] = zigzag_encode(static_cast<int32_t>(coded[i]));
+                }
+            }
+            break;
+        }
+        before = values[m - 1];
+
+        const unsigned b = bit_width(coded, kBlock);
+        offsets_.push_back(words_.size());
+        bases_.push_back(base);
+        bits_.push_back(static_cast<uint8_t>(b));
+        words_.resize(words_.size() + 4 * b);
+        pack128(coded, words_.data() + offsets_.back(), b);
+    }
+}
+
+size_t bp128::bytes() const
+{
+    return words_.size() * sizeof(uint32_t) + offsets_.size() * sizeof(uint64_t) + bases_.size() * sizeof(uint32_t) +
+           bits_.size();
+}
+
+void bp128::unpack_block(size_t block, uint32_t* out) const
+{
+    const uint32_t* in = words_.data() + offsets_[block];
+    const unsigned b = bits_[block];
+    const uint32_t base = bases_[block];
+#if defined(STL_DEMO_SIMD)
+    const __m128i base4 = _mm_set1_epi32(static_cast<int>(base));
+    switch (mode_) {
+    case transform::none: {
+        detail::plain f;
+        detail::unpack(in, out, b, f);
+        break;
+    }
+    case transform::frame: {
+        detail::add_base f = {base4};
+        detail::unpack(in, out, b, f);
+        break;
+    }
+    case transform::delta: {
+        detail::add_previous f = {base4};
+        detail::unpack(in, out, b, f);
+        break;
+    }
+    case transform::zigzag_delta: {
+        detail::zigzag_add_previous f = {base4};
+        detail::unpack(in, out, b, f);
+        break;
+    }
+    }
+#else
+    unpack128(in, out, b);
+    for (size_t i = 0; i < kBlock; ++i) {
+        switch (mode_) {
+        case transform::none: break;
+        case transform::frame: out[i] += base; break;
+        case transform::delta: out[i] += i >= 4 ? out[i - 4] : base; break;
+        case transform::zigzag_delta:
+            out[i] = static_cast<uint32_t>(zigzag_decode(out[i])) + (i >= 4 ? out[i - 4] : base);
+            break;
+        }
+    }
+#endif
+}
+
+void bp128::decode_block(size_t block, uint32_t* out) const
+{
+    const size_t m = min(kBlock, size_ - block * kBlock);
+    if (m == kBlock) {
+        unpack_block(block, out);
+        return;
+    }
+    uint32_t tmp[kBlock];
+    unpack_block(block, tmp);
+    memcpy(out, tmp, m * sizeof(uint32_t));
+}
+
+void bp128::decode(uint32_t* out) const
+{
+    for (size_t block = 0; block < blocks(); ++block) {
+        decode_block(block, out + block * kBlock);
+    }
+}
+
+vector<uint32_t> bp128::decode() const
+{
+    vector<uint32_t> out(size_);
+    decode(out.data());
+    return out;
+}
+
+uint32_t bp128::operator[](size_t i) const
+{
+    const size_t block = i / kBlock, j = i % kBlock, lane = j % 4, k = j / 4;
+    const uint32_t* in = words_.data() + offsets_[block];
+    const unsigned b = bits_[block];
+    uint32_t v = mode_ == transform::none ? 0 : bases_[block];
+    switch (mode_) {
+    case transform::none:
+    case transform::frame:
+        return v + detail::extract(in, b, lane, k);
+    case transform::delta:
+        for (size_t t = 0; t <= k; ++t) {
+            v += detail::extract(in, b, lane, t);
+        }
+        return v;
+    case transform::zigzag_delta:
+        for (size_t t = 0; t <= k; ++t) {
+            v += static_cast<uint32_t>(zigzag_decode(detail::extract(in, b, lane, t)));
+        }
+        return v;
+    }
+    return v;
+}
+
+// -- stream_vbyte --
+
+namespace {
+
+// bytes of a value: 0 -> 1, ..., 3 -> 4
+unsigned length_code(uint32_t v)
+{
+    return v < (1u << 8) ? 0 : v < (1u << 16) ? 1 : v < (1u << 24) ? 2 : 3;
+}
+
+// the value of code + 1 bytes at p; the data has 16 bytes of padding, so a 4 byte load is always safe
+uint32_t read_varint(const uint8_t* p, unsigned code)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v & (~0u >> (8 * (3 - code)));
+#else
+    uint32_t v = 0;
+    for (unsigned byte = 0; byte <= code; ++byte) {
+        v |= static_cast<uint32_t>(p[byte]) << (8 * byte);
+    }
+    return v;
+#endif
+}
+
+// the data bytes of the four values of a control byte
+unsigned group_length(uint8_t c)
+{
+    return 4 + (c & 3) + ((c >> 2) & 3) + ((c >> 4) & 3) + (c >> 6);
+}
+
+#if defined(__SSSE3__)
+// for every control byte: the pshufb control that spreads 4 to 16 data bytes over four lanes, and their length
+struct shuffle_table {
+    __m128i shuffle[256];
+    uint8_t length[256];
+
+    shuffle_table()
+    {
+        for (unsigned c = 0; c < 256; ++c) {
+            alignas(16) uint8_t bytes[16];
+            unsigned offset = 0;
+            for (unsigned k = 0; k < 4; ++k) {
+                const unsigned len = ((c >> (2 * k)) & 3) + 1;
+                for (unsigned j = 0; j < 4; ++j) {
+                    bytes[4 * k + j] = static_cast<uint8_t>(j < len ? offset + j : 0x80); // 0x80: pshufb writes 0
+                }
+                offset += len;
+            }
+            shuffle[c] = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+            length[c] = static_cast<uint8_t>(offset);
+        }
+    }
+};
+#endif
+
+}
+
+stream_vbyte::stream_vbyte(const uint32_t* in, size_t n, transform mode) : mode_(mode), size_(n)
+{
+    const size_t blocks = (n + kBlock - 1) / kBlock;
+    control_.assign(blocks * (kBlock / 4), 0);
+    data_.reserve(n * 2 + 16);
+    data_offsets_.reserve(blocks);
+    bases_.reserve(blocks);
+    uint32_t coded[kBlock];
+    uint32_t before = 0;
+    for (size_t block = 0; block < blocks; ++block) {
+        const size_t begin = block * kBlock, m = min(kBlock, n - begin);
+        const uint32_t* values = in + begin;
+        uint32_t base = 0;
+        switch (mode) {
+        case transform::none:
+            memcpy(coded, values, m * sizeof(uint32_t));
+            break;
+        case transform::frame:
+            base = *min_element(values, values + m);
+            for (size_t i = 0; i < m; ++i) {
+                coded[i] = values[i] - base;
+            }
+            break;
+        case transform::delta:
+        case transform::zigzag_delta:
+            // D1, plain adjacent differences: the smallest values for the varints
+            base = before;
+            delta_encode(values, m, coded, base);
+            if (mode == transform::zigzag_delta) {
+                for (size_t i = 0; i < m; ++i) {
+                    coded[i] = zigzag_encode(static_cast<int32_t>(coded[i]));
+                }
+            }
+            break;
+        }
+        before = values[m - 1];
+
+        data_offsets_.push_back(data_.size());
+        bases_.push_back(base);
+        uint8_t* control = control_.data() + block * (kBlock / 4);
+        for (size_t i = 0; i < m; ++i) {
+            const uint32_t v = coded[i];
+            const unsigned code = length_code(v);
+            control[i / 4] = static_cast<uint8_t>(control[i / 4] | (code << (2 * (i % 4))));
+            for (unsigned byte = 0; byte <= code; ++byte) {
+                data_.push_back(static_cast<uint8_t>(v >> (8 * byte)));
+            }
+        }
+    }
+    data_.resize(data_.size() + 16);
+}
+
+size_t stream_vbyte::bytes() const
+{
+    return control_.size() + data_.size() - 16 + data_offsets_.size() * sizeof(uint64_t) +
+           bases_.size() * sizeof(uint32_t);
+}
+
+void stream_vbyte::decode_block(size_t block, uint32_t* out) const
+{
+    const size_t m = min(kBlock, size_ - block * kBlock);
+    const uint8_t* control = control_.data() + block * (kBlock / 4);
+    const uint8_t* data = data_.data() + data_offsets_[block];
+    size_t i = 0;
+#if defined(__SSSE3__)
+    static const shuffle_table table;
+    for (; i + 4 <= m; i += 4) {
+        const uint8_t c = control[i / 4];
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_shuffle_epi8(bytes, table.shuffle[c]));
+        data += table.length[c];
+    }
+#endif
+    for (; i < m; ++i) {
+        const unsigned code = (control[i / 4] >> (2 * (i % 4))) & 3;
+        out[i] = read_varint(data, code);
+        data += code + 1;
+    }
+
+    const uint32_t base = bases_[block];
+    switch (mode_) {
+    case transform::none:
+        break;
+    case transform::frame:
+        for (size_t k = 0; k < m; ++k) {
+            out[k] += base;
+        }
+        break;
+    case transform::zigzag_delta:
+        for (size_t k = 0; k < m; ++k) {
+            out[k] = static_cast<uint32_t>(zigzag_decode(out[k]));
+        }
+        delta_decode(out, m, out, base);
+        break;
+    case transform::delta:
+        delta_decode(out, m, out, base);
+        break;
+    }
+}
+
+void stream_vbyte::decode(uint32_t* out) const
+{
+    for (size_t block = 0; block < blocks(); ++block) {
+        decode_block(block, out + block * kBlock);
+    }
+}
+
+vector<uint32_t> stream_vbyte::decode() const
+{
+    vector<uint32_t> out(size_);
+    decode(out.data());
+    return out;
+}
+
+// none / frame: skip to the value; delta: the running sum up to it
+uint32_t stream_vbyte::operator[](size_t i) const
+{
+    const size_t block = i / kBlock, j = i % kBlock;
+    const uint8_t* control = control_.data() + block * (kBlock / 4);
+    const uint8_t* data = data_.data() + data_offsets_[block];
+    const uint32_t base = bases_[block];
+    if (mode_ == transform::none || mode_ == transform::frame) {
+        for (size_t g = 0; g < j / 4; ++g) {
+            data += group_length(control[g]);
+        }
+        for (size_t k = j & ~size_t(3); k < j; ++k) {
+            data += ((control[k / 4] >> (2 * (k % 4))) & 3) + 1;
+        }
+        return (mode_ == transform::none ? 0 : base) + read_varint(data, (control[j / 4] >> (2 * (j % 4))) & 3);
+    }
+    uint32_t v = base;
+    for (size_t k = 0; k <= j; ++k) {
+        const unsigned code = (control[k / 4] >> (2 * (k % 4))) & 3;
+        const uint32_t d = read_varint(data, code);
+        v += mode_ == transform::delta ? d : static_cast<uint32_t>(zigzag_decode(d));
+        data += code + 1;
+    }
+    return v;
+}
+
+// -- demo, cross check, benchmark --
+
+void print(const string& title, const vector<uint32_t>& v)
+{
+    cout << title;
+    copy(v.begin(), v.end(), ostream_iterator<uint32_t>(cout, " "));
+    cout << endl;
+}
+
+// adjacent_difference_demo() and partial_sum_demo() of numerics.cpp, on link ids
+void same_as_std_demo()
+{
+    const vector<uint32_t> ids = {9000, 9002, 9003, 9007, 9008, 9012, 9013};
+    print("link ids:            ", ids);
+    vector<uint32_t> diff(ids.size()), back(ids.size());
+    adjacent_difference(ids.begin(), ids.end(), diff.begin());
+    print("adjacent_difference: ", diff);
+    delta_encode(ids.data(), ids.size(), diff.data(), 9000);
+    print("delta_encode(9000):  ", diff);
+    delta_decode(diff.data(), diff.size(), back.data(), 9000);
+    print("delta_decode(9000):  ", back);
+
+    // 100000 sorted link ids with gaps of 1..8
+    mt19937 gen(73);
+    vector<uint32_t> links(100000);
+    uint32_t id = 9000;
+    for (auto& l : links) {
+        l = id += 1 + gen() % 8;
+    }
+    const bp128 packed(links, transform::delta);
+    const stream_vbyte varints(links, transform::delta);
+    const bp128 frame(links, transform::frame);
+    const size_t raw = links.size() * sizeof(uint32_t);
+    cout << "100000 sorted link ids, " << raw << " bytes:" << endl;
+    cout << "  bp128 delta:        " << packed.bytes() << " bytes (" << raw / packed.bytes() << "x), links[54321] = "
+         << packed[54321] << " / " << links[54321] << endl;
+    cout << "  stream_vbyte delta: " << varints.bytes() << " bytes (" << raw / varints.bytes() << "x), links[54321] = "
+         << varints[54321] << endl;
+    cout << "  bp128 frame:        " << frame.bytes() << " bytes (" << raw / frame.bytes() << "x)" << endl;
+    cout << "  decoded == links: " << boolalpha << (packed.decode() == links && varints.decode() == links &&
+                                                   frame.decode() == links) << endl;
+}
+
+// bit i of the packed lane stream, one bit at a time
+vector<uint32_t> reference_pack(const uint32_t* in, unsigned b)
+{
+    vector<uint32_t> words(4 * b, 0);
+    for (size_t i = 0; i < kBlock; ++i) {
+        const size_t lane = i % 4, k = i / 4;
+        for (unsigned t = 0; t < b; ++t) {
+            if ((in[i] >> t) & 1) {
+                const size_t bit = k * b + t;
+                words[4 * (bit / 32) + lane] |= 1u << (bit % 32);
+            }
+        }
+    }
+    return words;
+}
+
+template <typename Codec>
+bool round_trip(const vector<uint32_t>& v, transform mode, mt19937& gen)
+{
+    const Codec c(v, mode);
+    bool ok = c.size() == v.size() && c.blocks() == (v.size() + kBlock - 1) / kBlock && c.decode() == v;
+    for (int probe = 0; probe < 20 && !v.empty() && ok; ++probe) {
+        const size_t i = gen() % v.size();
+        ok = c[i] == v[i];
+        uint32_t block[kBlock];
+        const size_t b = i / kBlock;
+        c.decode_block(b, block);
+        ok = ok && equal(v.begin() + b * kBlock, v.begin() + min(v.size(), (b + 1) * kBlock), block);
+    }
+    return ok;
+}
+
+bool cross_check()
+{
+    mt19937 gen(79);
+    bool ok = true;
+
+    // every bit width, against the bit by bit layout
+    for (unsigned b = 0; b <= 32 && ok; ++b) {
+        for (int round = 0; round < 20; ++round) {
+            uint32_t in[kBlock], out[kBlock];
+            for (auto& x : in) {
+                x = gen() & detail::low_bits(b);
+            }
+            vector<uint32_t> words(4 * b + 1, 0xDEADBEEF);
+            pack128(in, words.data(), b);
+            unpack128(words.data(), out, b);
+            ok = ok && words.back() == 0xDEADBEEF && equal(in, in + kBlock, out) &&
+                 equal(words.begin(), words.end() - 1, reference_pack(in, b).begin()) &&
+                 bit_width(in, kBlock) <= b;
+        }
+    }
+
+    // zigzag and the deltas against adjacent_difference / partial_sum
+    for (int32_t x : {0, -1, 1, -2, 2, 1 << 30, -(1 << 30), numeric_limits<int32_t>::max(), numeric_limits<int32_t>::min()}) {
+        ok = ok && zigzag_decode(zigzag_encode(x)) == x;
+    }
+    ok = ok && zigzag_encode(-1) == 1 && zigzag_encode(1) == 2 && zigzag_encode(numeric_limits<int32_t>::min()) == ~0u;
+    for (int round = 0; round < 200; ++round) {
+        vector<uint32_t> v(gen() % 100), d(v.size()), expected(v.size()), back(v.size());
+        for (auto& x : v) {
+            x = gen();
+        }
+        const uint32_t prev = gen();
+        delta_encode(v.data(), v.size(), d.data(), prev);
+        if (!v.empty()) {
+            adjacent_difference(v.begin(), v.end(), expected.begin());
+            expected[0] = v[0] - prev;
+        }
+        delta_decode(d.data(), d.size(), back.data(), prev);
+        vector<uint32_t> in_place = v;
+        delta_encode(in_place.data(), in_place.size(), in_place.data(), prev);
+        ok = ok && d == expected && back == v && in_place == d;
+    }
+
+    // all codecs, all transforms, on columns of every shape and of lengths around the block size
+    const transform modes[] = {transform::none, transform::delta, transform::zigzag_delta, transform::frame};
+    for (int round = 0; round < 600 && ok; ++round) {
+        static const size_t kSizes[] = {0, 1, 3, 4, 5, 127, 128, 129, 255, 256, 257, 1000};
+        const size_t n = round % 2 ? kSizes[gen() % 12] : gen() % 5000;
+        vector<uint32_t> v(n);
+        const unsigned width = gen() % 33;
+        uint32_t x = gen();
+        for (auto& e : v) {
+            switch (round % 4) {
+            case 0: e = gen() & detail::low_bits(width); break;           // random of some width
+            case 1: e = x += gen() & detail::low_bits(width % 12); break;  // sorted, wrapping around now and then
+            case 2: e = x += (gen() % 64) - 16; break;                      // nearly sorted
+            default: e = gen() % 4 ? 1000000 + gen() % 256 : gen(); break; // a frame with outliers
+            }
+        }
+        for (transform mode : modes) {
+            ok = ok && round_trip<bp128>(v, mode, gen) && round_trip<stream_vbyte>(v, mode, gen);
+        }
+    }
+
+    // a short last block packs like the same block completed with D4 deltas of 0: the padding is free
+    vector<uint32_t> partial(128 + 8, 5000);
+    partial[128 + 4] = 6000;
+    vector<uint32_t> completed(partial);
+    for (size_t i = partial.size(); i < 256; ++i) {
+        completed.push_back(completed[i - 4]);
+    }
+    for (transform mode : {transform::delta, transform::zigzag_delta}) {
+        ok = ok && bp128(partial, mode).bytes() == bp128(completed, mode).bytes() && round_trip<bp128>(partial, mode, gen);
+    }
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+template <typename Codec>
+void measure(const char* name, const vector<uint32_t>& v, transform mode, const vector<size_t>& probes)
+{
+    Codec c;
+    const long long encode = time_ms([&] { c = Codec(v, mode); });
+    vector<uint32_t> out(v.size());
+    const long long decode = time_ms([&] { c.decode(out.data()); });
+    uint32_t sum = 0;
+    const long long access = time_ms([&] {
+        for (size_t i : probes) {
+            sum += c[i];
+        }
+    });
+    cout << "  " << name << ": " << static_cast<double>(v.size() * sizeof(uint32_t)) / c.bytes() << "x ("
+         << 8.0 * c.bytes() / v.size() << " bits/value), encode " << encode << " ms, decode " << decode << " ms ("
+         << v.size() / 1000 / max<long long>(decode, 1) << " M/s), " << probes.size() << " random reads " << access
+         << " ms (" << sum << "), same: " << (out == v) << endl;
+}
+
+// 16M values per column: link ids in order, junction ids along the links, ids from a range of 1M in any order
+void benchmark()
+{
+    const size_t n = 16 << 20;
+    mt19937 gen(83);
+    vector<uint32_t> sorted(n), nearly(n), ranged(n);
+    uint32_t id = 9000;
+    for (size_t i = 0; i < n; ++i) {
+        sorted[i] = id += 1 + gen() % 16;
+        nearly[i] = static_cast<uint32_t>(3 * i + gen() % 100);
+        ranged[i] = 5000000 + gen() % 1000000;
+    }
+    vector<size_t> probes(1000000);
+    for (auto& p : probes) {
+        p = gen() % n;
+    }
+
+    const struct {
+        const char* name;
+        const vector<uint32_t>* values;
+    } columns[] = {{"sorted link ids", &sorted}, {"junction ids along the links", &nearly}, {"ids in [5M, 6M)", &ranged}};
+    cout << boolalpha;
+    for (const auto& column : columns) {
+        const vector<uint32_t>& v = *column.values;
+        cout << column.name << ", " << n * sizeof(uint32_t) / (1 << 20) << " MB:" << endl;
+        vector<uint32_t> d(n), back(n);
+        long long t = time_ms([&] { adjacent_difference(v.begin(), v.end(), d.begin()); });
+        cout << "  std::adjacent_difference: " << t << " ms";
+        t = time_ms([&] { partial_sum(d.begin(), d.end(), back.begin()); });
+        cout << ", std::partial_sum: " << t << " ms (no compression)" << endl;
+
+        measure<bp128>("bp128 none        ", v, transform::none, probes);
+        measure<bp128>("bp128 delta       ", v, transform::delta, probes);
+        measure<bp128>("bp128 zigzag_delta", v, transform::zigzag_delta, probes);
+        measure<bp128>("bp128 frame       ", v, transform::frame, probes);
+        measure<stream_vbyte>("svb none          ", v, transform::none, probes);
+        measure<stream_vbyte>("svb delta         ", v, transform::delta, probes);
+        measure<stream_vbyte>("svb zigzag_delta  ", v, transform::zigzag_delta, probes);
+        measure<stream_vbyte>("svb frame         ", v, transform::frame, probes);
+    }
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
@@ -0,0 +1,321 @@
+#ifndef STL_DEMO_ALGORITHMS_CODEC_KERNELS_H
+#define STL_DEMO_ALGORITHMS_CODEC_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "integer_sequence.h"
+#include "scan_kernels.h"
+#include "simd.h"
+
+namespace algorithms {
+namespace codec_kernels {
+
+/*
+ * Compressed integer columns: adjacent_difference_demo() and partial_sum_demo() of numerics.cpp used for storage
+ *
+ *     delta_encode / delta_decode    out[i] = in[i] - in[i - 1] / the running sum, adjacent_difference() and
+ *                                    partial_sum() of std::uint32_t (SIMD through scan_kernels)
+ *     zigzag_encode / zigzag_decode  0, -1, 1, -2, ... <-> 0, 1, 2, 3, ...: small negative deltas stay small
+ *     pack128 / unpack128            128 values of b bits in 4 * b words
+ *
+ *     bp128         blocks of 128 values, every block packed with the bit width of its largest value
+ *                   (FastPFor 的 SIMD-BP128, 没有 exception: 一个很大的值会让整块变宽)
+ *     stream_vbyte  1 to 4 bytes per value, the lengths of four values in one control byte (Lemire's StreamVByte);
+ *                   decoding four values is one pshufb with a table indexed by the control byte
+ *
+ * Both take a transform, applied per block of 128 so that every block decodes on its own (random access):
+ *
+ *     transform::none          the values as they are
+ *     transform::delta         differences to the value before (sorted ids: a few bits each)
+ *     transform::zigzag_delta  the same, zigzag coded: nearly sorted columns, differences of either sign
+ *     transform::frame         frame of reference: the difference to the minimum of the block
+ *
+ * bp128 的位布局是 "vertical" 的: 第 i 个值属于 lane i % 4，每个 lane 在自己的 32 位字序列里连续存放，
+ * 所以一个 128 位寄存器同时解出 4 个值，移位量在编译期就确定 (每个 bit width 一个展开的函数，查表分派)。
+ * bp128 的 delta 是和 4 个位置之前的值相减 (FastPFor 的 D4)，解码时的前缀和就变成了寄存器之间的加法，
+ * 和解包融合在一起；stream_vbyte 的 delta 是普通的相邻差 (D1)，解码后用 scan_kernels 做前缀和。
+ *
+ * 最后一个不满 128 个值的块: bp128 补齐到 128 个值 (delta 模式重复四个位置之前的值，D4 的 delta 为 0；
+ * 其它模式重复最后一个值)，都不增加位宽；stream_vbyte 只存实际的值。
+ * stream_vbyte 的 SIMD 解码需要 SSSE3 (pshufb)，只有 SSE2 时逐字节解码。
+ */
+
+const std::size_t kBlock = 128;
+
+enum class transform { none, delta, zigzag_delta, frame };
+
+inline std::uint32_t zigzag_encode(std::int32_t v)
+{
+    return (static_cast<std::uint32_t>(v) << 1) ^ static_cast<std::uint32_t>(v >> 31);
+}
+
+inline std::int32_t zigzag_decode(std::uint32_t v)
+{
+    return static_cast<std::int32_t>((v >> 1) ^ (0u - (v & 1)));
+}
+
+// out[i] = in[i] - in[i - 1] with in[-1] = prev, modulo 2^32; out may be in
+inline void delta_encode(const std::uint32_t* in, std::size_t n, std::uint32_t* out, std::uint32_t prev = 0)
+{
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    // x - (x one lane up, the last lane of the register before coming in at lane 0)
+    __m128i before = _mm_cvtsi32_si128(static_cast<int>(prev));
+    for (; i + 4 <= n; i += 4) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i shifted = _mm_or_si128(_mm_slli_si128(x, 4), before);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi32(x, shifted));
+        before = _mm_srli_si128(x, 12);
+    }
+    if (i > 0)
+        prev = static_cast<std::uint32_t>(_mm_cvtsi128_si32(before));
+#endif
+    for (; i < n; ++i) {
+        const std::uint32_t x = in[i];
+        out[i] = x - prev;
+        prev = x;
+    }
+}
+
+// the inverse: out[i] = prev + in[0] + ... + in[i]
+inline void delta_decode(const std::uint32_t* in, std::size_t n, std::uint32_t* out, std::uint32_t prev = 0)
+{
+    scan_kernels::inclusive_scan(in, in + n, out, std::plus<std::uint32_t>(), prev);
+}
+
+// the bits of the largest value, 0 when all of them are 0
+inline unsigned bit_width(const std::uint32_t* in, std::size_t n)
+{
+    std::uint32_t all = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        all |= in[i];
+    }
+    return all == 0 ? 0 : 32 - static_cast<unsigned>(__builtin_clz(all));
+}
+
+namespace detail {
+
+inline std::uint32_t low_bits(unsigned b) { return b >= 32 ? ~0u : (1u << b) - 1; }
+
+// value k of a lane of a packed block: bits [k * b, k * b + b) of the words in[lane], in[lane + 4], ...
+inline std::uint32_t extract(const std::uint32_t* in, unsigned b, std::size_t lane, std::size_t k)
+{
+    if (b == 0)
+        return 0;
+    const std::size_t bit = k * b, word = bit / 32;
+    const unsigned shift = static_cast<unsigned>(bit % 32);
+    std::uint32_t v = in[4 * word + lane] >> shift;
+    if (shift + b > 32)
+        v |= in[4 * (word + 1) + lane] << (32 - shift);
+    return v & low_bits(b);
+}
+
+#if defined(STL_DEMO_SIMD)
+
+// what unpacking does with the four values of each register before storing them
+struct plain {
+    __m128i operator()(__m128i v) { return v; }
+};
+
+struct add_base {
+    __m128i base;
+    __m128i operator()(__m128i v) { return _mm_add_epi32(v, base); }
+};
+
+// D4: every lane continues its running sum
+struct add_previous {
+    __m128i previous;
+    __m128i operator()(__m128i v) { return previous = _mm_add_epi32(previous, v); }
+};
+
+struct zigzag_add_previous {
+    __m128i previous;
+    __m128i operator()(__m128i v)
+    {
+        const __m128i sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(v, _mm_set1_epi32(1)));
+        return previous = _mm_add_epi32(previous, _mm_xor_si128(_mm_srli_epi32(v, 1), sign));
+    }
+};
+
+// the K-th register of a block of B bits, then the next one: the shifts are constants
+template <unsigned B, unsigned K>
+struct unpack_step {
+    static const unsigned word = K * B / 32;
+    static const unsigned shift = K * B % 32;
+
+    template <typename F>
+    static void run(const __m128i* in, __m128i* out, F& finish)
+    {
+        __m128i v = _mm_setzero_si128(); // 0 bits: there are no words to load
+        if (B > 0)
+            v = _mm_srli_epi32(_mm_loadu_si128(in + word), static_cast<int>(shift));
+        if (shift + B > 32)
+            v = _mm_or_si128(v, _mm_slli_epi32(_mm_loadu_si128(in + word + 1), static_cast<int>(32 - shift)));
+        if (B > 0 && B < 32)
+            v = _mm_and_si128(v, _mm_set1_epi32(static_cast<int>(low_bits(B))));
+        _mm_storeu_si128(out + K, finish(v));
+        unpack_step<B, K + 1>::run(in, out, finish);
+    }
+};
+
+template <unsigned B>
+struct unpack_step<B, 32> {
+    template <typename F>
+    static void run(const __m128i*, __m128i*, F&) {}
+};
+
+template <unsigned B, typename F>
+void unpack_bits(const std::uint32_t* in, std::uint32_t* out, F& finish)
+{
+    unpack_step<B, 0>::run(reinterpret_cast<const __m128i*>(in), reinterpret_cast<__m128i*>(out), finish);
+}
+
+template <typename F>
+struct unpackers {
+    typedef void (*function)(const std::uint32_t*, std::uint32_t*, F&);
+
+    template <std::size_t... Bs>
+    static const function* make(helper::index_sequence<Bs...>)
+    {
+        static const function table[] = {&unpack_bits<static_cast<unsigned>(Bs), F>...};
+        return table;
+    }
+
+    // one function per bit width 0..32
+    static const function* table()
+    {
+        static const function* t = make(helper::make_index_sequence<33>());
+        return t;
+    }
+};
+
+template <typename F>
+inline void unpack(const std::uint32_t* in, std::uint32_t* out, unsigned b, F& finish)
+{
+    unpackers<F>::table()[b](in, out, finish);
+}
+
+#endif // STL_DEMO_SIMD
+
+}
+
+// 128 values of at most b bits into 4 * b words; the bits above b are ignored
+inline void pack128(const std::uint32_t* in, std::uint32_t* out, unsigned b)
+{
+    if (b == 0)
+        return;
+#if defined(STL_DEMO_SIMD)
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(detail::low_bits(b)));
+    __m128i acc = _mm_setzero_si128();
+    unsigned shift = 0;
+    for (std::size_t k = 0; k < 32; ++k) {
+        const __m128i v = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 4 * k)), mask);
+        acc = _mm_or_si128(acc, _mm_sll_epi32(v, _mm_cvtsi32_si128(static_cast<int>(shift))));
+        shift += b;
+        if (shift >= 32) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), acc);
+            out += 4;
+            shift -= 32;
+            acc = shift ? _mm_srl_epi32(v, _mm_cvtsi32_si128(static_cast<int>(b - shift))) : _mm_setzero_si128();
+        }
+    }
+#else
+    for (std::size_t lane = 0; lane < 4; ++lane) {
+        std::uint32_t acc = 0, *o = out + lane;
+        unsigned shift = 0;
+        for (std::size_t k = 0; k < 32; ++k) {
+            const std::uint32_t v = in[4 * k + lane] & detail::low_bits(b);
+            acc |= v << shift;
+            shift += b;
+            if (shift >= 32) {
+                *o = acc;
+                o += 4;
+                shift -= 32;
+                acc = shift ? v >> (b - shift) : 0;
+            }
+        }
+    }
+#endif
+}
+
+inline void unpack128(const std::uint32_t* in, std::uint32_t* out, unsigned b)
+{
+#if defined(STL_DEMO_SIMD)
+    detail::plain finish;
+    detail::unpack(in, out, b, finish);
+#else
+    for (std::size_t i = 0; i < kBlock; ++i) {
+        out[i] = detail::extract(in, b, i % 4, i / 4);
+    }
+#endif
+}
+
+class bp128 {
+public:
+    bp128() : mode_(transform::none), size_(0) {}
+    bp128(const std::uint32_t* in, std::size_t n, transform mode = transform::none);
+    explicit bp128(const std::vector<std::uint32_t>& in, transform mode = transform::none)
+        : bp128(in.data(), in.size(), mode)
+    {
+    }
+
+    std::size_t size() const { return size_; }
+    std::size_t blocks() const { return bits_.size(); }
+    // the packed words and the block index
+    std::size_t bytes() const;
+
+    void decode(std::uint32_t* out) const;
+    std::vector<std::uint32_t> decode() const;
+    // the values [128 * block, min(128 * block + 128, size()))
+    void decode_block(std::size_t block, std::uint32_t* out) const;
+    // none / frame: read from the packed bits; delta: the running sum of one lane
+    std::uint32_t operator[](std::size_t i) const;
+
+private:
+    void unpack_block(std::size_t block, std::uint32_t* out) const; // always 128 values
+
+    transform mode_;
+    std::size_t size_;
+    std::vector<std::uint32_t> words_;
+    std::vector<std::uint64_t> offsets_; // the first word of every block
+    std::vector<std::uint32_t> bases_;   // delta: the value before the block, frame: its minimum
+    std::vector<std::uint8_t> bits_;
+};
+
+class stream_vbyte {
+public:
+    stream_vbyte() : mode_(transform::none), size_(0) {}
+    stream_vbyte(const std::uint32_t* in, std::size_t n, transform mode = transform::none);
+    explicit stream_vbyte(const std::vector<std::uint32_t>& in, transform mode = transform::none)
+        : stream_vbyte(in.data(), in.size(), mode)
+    {
+    }
+
+    std::size_t size() const { return size_; }
+    std::size_t blocks() const { return bases_.size(); }
+    // control and data bytes and the block index
+    std::size_t bytes() const;
+
+    void decode(std::uint32_t* out) const;
+    std::vector<std::uint32_t> decode() const;
+    void decode_block(std::size_t block, std::uint32_t* out) const;
+    std::uint32_t operator[](std::size_t i) const;
+
+private:
+    transform mode_;
+    std::size_t size_;
+    std::vector<std::uint8_t> control_; // 32 bytes per block, 2 bits per value
+    std::vector<std::uint8_t> data_;    // 16 more bytes at the end: the 16 byte loads of the last values
+    std::vector<std::uint64_t> data_offsets_;
+    std::vector<std::uint32_t> bases_;
+};
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_CODEC_KERNELS_H
@@ -0,0 +1,135 @@
+#include "compare_kernels.h"
+#include "helper.h"
+
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace algorithms {
+namespace compare_kernels {
+
+// range_test_equality(), range_test_equality_unordered() and range_mismatch() of non_modifying.cpp
+void same_as_std_demo()
+{
+    vector<int> coll1 = { 1, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    list<int> coll2 = { 1, 9, 8, 7, 6, 5, 4, 3, 2, 1 };
+    helper::PRINT_ELEMENT(coll1, "coll1: ");
+    helper::PRINT_ELEMENT(coll2, "coll2: ");
+    cout << boolalpha << "is_permutation: " << compare_kernels::is_permutation(coll1.cbegin(), coll1.cend(), coll2.cbegin())
+         << " (std: " << std::is_permutation(coll1.cbegin(), coll1.cend(), coll2.cbegin()) << ")" << endl;
+
+    // the hash table path: strings, and integers spread over a wide domain
+    vector<string> words1 = {"ab", "cd", "ef", "cd"};
+    vector<string> words2 = {"cd", "ef", "cd", "ab"};
+    vector<long long> wide1 = {1LL << 40, -7, 1LL << 40, 3};
+    vector<long long> wide2 = {3, 1LL << 40, -7, -(1LL << 40)};
+    cout << "is_permutation(strings): " << compare_kernels::is_permutation(words1.begin(), words1.end(), words2.begin())
+         << ", is_permutation(wide ints): " << compare_kernels::is_permutation(wide1.begin(), wide1.end(), wide2.begin())
+         << endl;
+
+    vector<int> a = { 1, 2, 3, 4, 5, 6 };
+    vector<int> b = { 1, 2, 4, 8, 16, 3 };
+    auto values = compare_kernels::mismatch(a.cbegin(), a.cend(), b.cbegin());
+    cout << "first mismatch: " << *values.first << " and " << *values.second << endl;
+    cout << "a == a: " << compare_kernels::equal(a.begin(), a.end(), a.begin())
+         << ", a == b: " << compare_kernels::parallel::equal(a.begin(), a.end(), b.begin()) << endl;
+
+    // floating point is not compared bytewise: 0.0 == -0.0
+    vector<double> zeros = {0.0, 1.0};
+    vector<double> neg_zeros = {-0.0, 1.0};
+    cout << "{0.0, 1.0} == {-0.0, 1.0}: " << compare_kernels::equal(zeros.begin(), zeros.end(), neg_zeros.begin()) << endl;
+}
+
+bool cross_check(mt19937& gen, int rounds)
+{
+    uniform_int_distribution<int> len(0, 300);
+    for (int r = 0; r < rounds; ++r) {
+        const int domain = r % 2 ? 10 : 1000000000;
+        uniform_int_distribution<int> val(-domain, domain);
+        vector<int> v1(len(gen));
+        for (auto& x : v1) {
+            x = val(gen);
+        }
+        vector<int> v2(v1);
+        shuffle(v2.begin(), v2.end(), gen);
+        if (!v2.empty() && r % 3 == 0)
+            v2[v2.size() / 2] = val(gen);
+        if (compare_kernels::is_permutation(v1.begin(), v1.end(), v2.begin()) != std::is_permutation(v1.begin(), v1.end(), v2.begin()) ||
+            compare_kernels::mismatch(v1.begin(), v1.end(), v2.begin()) != std::mismatch(v1.begin(), v1.end(), v2.begin()) ||
+            compare_kernels::parallel::mismatch(v1.begin(), v1.end(), v2.begin()) != std::mismatch(v1.begin(), v1.end(), v2.begin()))
+            return false;
+        // another value type: 2^32 + x must not be narrowed to x
+        vector<long long> w2(v2.begin(), v2.end());
+        if (!w2.empty() && r % 5 == 0)
+            w2[w2.size() / 3] += 1ll << 32;
+        if (compare_kernels::is_permutation(v1.begin(), v1.end(), w2.begin()) != std::is_permutation(v1.begin(), v1.end(), w2.begin()))
+            return false;
+    }
+    return true;
+}
+
+template <typename F>
+long long time_us(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::microseconds>(t1 - t0).count();
+}
+
+void benchmark()
+{
+    // reconciliation of two snapshots of 10M row ids
+    const size_t kRows = 10000000;
+    mt19937 gen(42);
+    vector<int> snapshot1(kRows);
+    for (size_t i = 0; i < kRows; ++i) {
+        snapshot1[i] = static_cast<int>(i * 3);
+    }
+    vector<int> snapshot2(snapshot1);
+    shuffle(snapshot2.begin(), snapshot2.end(), gen);
+    vector<long long> keys1(kRows);
+    for (auto& k : keys1) {
+        k = static_cast<long long>(gen()) << 20 ^ gen();
+    }
+    vector<long long> keys2(keys1);
+    shuffle(keys2.begin(), keys2.end(), gen);
+
+    // std::is_permutation is quadratic, only a small slice is affordable
+    const size_t kSlice = 20000;
+    vector<int> slice1(snapshot1.begin(), snapshot1.begin() + kSlice);
+    vector<int> slice2(slice1.rbegin(), slice1.rend());
+    bool r1 = false, r2 = false, r3 = false;
+    long long t = time_us([&] { r1 = std::is_permutation(slice1.begin(), slice1.end(), slice2.begin()); });
+    cout << "std::is_permutation, " << kSlice << " rows: " << t << " us (" << boolalpha << r1 << ")" << endl;
+    t = time_us([&] { r2 = compare_kernels::is_permutation(snapshot1.begin(), snapshot1.end(), snapshot2.begin()); });
+    cout << "is_permutation, " << kRows << " rows, counting: " << t << " us (" << r2 << ")" << endl;
+    t = time_us([&] { r3 = compare_kernels::is_permutation(keys1.begin(), keys1.end(), keys2.begin()); });
+    cout << "is_permutation, " << kRows << " rows, hashing: " << t << " us (" << r3 << ")" << endl;
+
+    // identical snapshots except for the very last row
+    vector<int> copy(snapshot1);
+    copy.back() = -1;
+    size_t m1 = 0, m2 = 0, m3 = 0;
+    long long a = time_us([&] { m1 = std::mismatch(snapshot1.begin(), snapshot1.end(), copy.begin()).first - snapshot1.begin(); });
+    long long b = time_us([&] { m2 = compare_kernels::mismatch(snapshot1.begin(), snapshot1.end(), copy.begin()).first - snapshot1.begin(); });
+    long long c = time_us([&] { m3 = compare_kernels::parallel::mismatch(snapshot1.begin(), snapshot1.end(), copy.begin()).first - snapshot1.begin(); });
+    cout << "mismatch: std " << a << " us, memcmp " << b << " us, parallel " << c << " us"
+         << (m1 == m2 && m2 == m3 ? "" : "  MISMATCH") << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    mt19937 gen(7);
+    cout << "cross check: " << boolalpha << cross_check(gen, 3000) << endl;
+    benchmark();
+}
+
+}
+}
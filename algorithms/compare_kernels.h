@@ -0,0 +1,339 @@
+#ifndef STL_DEMO_ALGORITHMS_COMPARE_KERNELS_H
+#define STL_DEMO_ALGORITHMS_COMPARE_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "simd.h"
+#include "parallel.h"
+#include "reduce_kernels.h"
+
+namespace algorithms {
+namespace compare_kernels {
+
+/*
+ * Faster versions of the range comparisons in non_modifying.cpp
+ *
+ *     Name                 std::                               here
+ *     is_permutation()     O(n²) in the worst case             O(n): flat hash table of counts, or a plain counting
+ *                                                              array when the values are integers in a small domain
+ *     equal()              element by element                  memcmp() for trivially comparable types
+ *     mismatch()           element by element                  memcmp() block by block, then the exact position
+ *
+ * 为什么 std::is_permutation 是 O(n²): 它只要求元素能用 == 比较，所以只能对每个元素去另一个区间里数个数。
+ * 如果元素可以 hash (或者本身就是小范围的整数)，先数一遍 range1 里每个值出现的次数，再用 range2 减回去，
+ * 两遍扫描就够了。
+ *
+ * memcmp 只能用在 "按字节相等 <=> 值相等" 的类型上: 整数、枚举、指针。float/double 不行 (0.0 == -0.0，NaN != NaN)，
+ * 有 padding 的 struct 也不行，这些类型仍然逐个元素用 == 比较。
+ *
+ * parallel:: 里的 equal()/mismatch() 把区间切块交给多个线程，结果和单线程版本一样。
+ */
+
+// byte equality is the same as operator==
+template <typename T>
+struct is_trivially_comparable
+    : std::integral_constant<bool, std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value> {};
+
+namespace detail {
+
+using simd::value_of;
+using simd::is_contiguous;
+using simd::to_pointer;
+
+template <typename It1, typename It2>
+struct use_memcmp
+    : std::integral_constant<bool, is_contiguous<It1>::value && is_contiguous<It2>::value &&
+                                       std::is_same<typename value_of<It1>::type, typename value_of<It2>::type>::value &&
+                                       is_trivially_comparable<typename value_of<It1>::type>::value> {};
+
+// index of the first difference of a[0, n) and b[0, n), or n
+template <typename T>
+std::size_t mismatch_memcmp(const T* a, const T* b, std::size_t n)
+{
+    // memcmp() only says *whether* two blocks differ; blocks of 4 KB keep the rescan short
+    const std::size_t kBlock = 4096 / sizeof(T);
+    std::size_t i = 0;
+    while (i < n) {
+        const std::size_t len = std::min(kBlock, n - i);
+        if (std::memcmp(a + i, b + i, len * sizeof(T)) != 0)
+            break;
+        i += len;
+    }
+    for (; i < n; ++i) {
+        if (!(a[i] == b[i]))
+            return i;
+    }
+    return n;
+}
+
+template <typename It1, typename It2>
+std::pair<It1, It2> mismatch(It1 first1, It1 last1, It2 first2, std::true_type)
+{
+    const std::size_t n = static_cast<std::size_t>(last1 - first1);
+    if (n == 0)
+        return std::make_pair(first1, first2);
+    const std::size_t i = mismatch_memcmp(to_pointer(first1), to_pointer(first2), n);
+    return std::make_pair(first1 + i, first2 + i);
+}
+
+template <typename It1, typename It2>
+std::pair<It1, It2> mismatch(It1 first1, It1 last1, It2 first2, std::false_type)
+{
+    return std::mismatch(first1, last1, first2);
+}
+
+template <typename It1, typename It2>
+bool equal(It1 first1, It1 last1, It2 first2, std::true_type)
+{
+    const std::size_t n = static_cast<std::size_t>(last1 - first1);
+    return n == 0 || std::memcmp(to_pointer(first1), to_pointer(first2), n * sizeof(typename value_of<It1>::type)) == 0;
+}
+
+template <typename It1, typename It2>
+bool equal(It1 first1, It1 last1, It2 first2, std::false_type)
+{
+    return std::equal(first1, last1, first2);
+}
+
+// -- is_permutation --
+
+// small integer domain: one counter per value in [lo, hi]
+template <typename It1, typename It2>
+bool permutation_by_counting(It1 first1, It1 last1, It2 first2, It2 last2,
+                             typename value_of<It1>::type lo, std::size_t domain)
+{
+    typedef typename value_of<It1>::type T;
+    typedef typename std::make_unsigned<T>::type U;
+    std::vector<std::uint32_t> counts(domain, 0);
+    for (; first1 != last1; ++first1) {
+        ++counts[static_cast<std::size_t>(static_cast<U>(*first1) - static_cast<U>(lo))];
+    }
+    for (; first2 != last2; ++first2) {
+        const std::size_t slot = static_cast<std::size_t>(static_cast<U>(*first2) - static_cast<U>(lo));
+        if (slot >= domain || counts[slot] == 0)
+            return false;
+        --counts[slot];
+    }
+    return true;
+}
+
+/*
+ * Open addressing table of (key, count) with linear probing. std::unordered_map allocates a node per
+ * distinct key, which dominates the running time for millions of keys; here key and counter sit next
+ * to each other in one flat array, so a lookup costs one cache miss. The hash value is mixed again,
+ * std::hash of an integer is usually the integer itself.
+ */
+template <typename T, typename Hash, typename KeyEqual>
+class count_table {
+public:
+    count_table(std::size_t n, Hash hash, KeyEqual eq) : hash_(hash), eq_(eq)
+    {
+        std::size_t cap = 16;
+        while (cap < n + n / 2) {
+            cap <<= 1;
+        }
+        slots_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    void add(const T& key)
+    {
+        std::size_t i = home(key);
+        while (slots_[i].used && !eq_(slots_[i].key, key)) {
+            i = (i + 1) & mask_;
+        }
+        if (!slots_[i].used) {
+            slots_[i].used = true;
+            slots_[i].key = key;
+        }
+        ++slots_[i].count;
+    }
+
+    // false if the key is not there (any more)
+    bool remove(const T& key)
+    {
+        for (std::size_t i = home(key); slots_[i].used; i = (i + 1) & mask_) {
+            if (eq_(slots_[i].key, key)) {
+                if (slots_[i].count == 0)
+                    return false;
+                --slots_[i].count;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct slot {
+        T key;
+        std::size_t count;
+        bool used;
+        slot() : key(), count(0), used(false) {}
+    };
+
+    std::size_t home(const T& key) const
+    {
+        std::uint64_t h = static_cast<std::uint64_t>(hash_(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return static_cast<std::size_t>(h) & mask_;
+    }
+
+    Hash hash_;
+    KeyEqual eq_;
+    std::vector<slot> slots_;
+    std::size_t mask_;
+};
+
+template <typename It1, typename It2, typename Hash, typename KeyEqual>
+bool permutation_by_hashing(It1 first1, It1 last1, It2 first2, It2 last2, std::size_t n, Hash hash, KeyEqual eq)
+{
+    typedef typename value_of<It1>::type T;
+    count_table<T, Hash, KeyEqual> counts(n, hash, eq);
+    for (; first1 != last1; ++first1) {
+        counts.add(*first1);
+    }
+    for (; first2 != last2; ++first2) {
+        if (!counts.remove(*first2))
+            return false;
+    }
+    // same length and no counter went below zero: every counter is back to zero
+    return true;
+}
+
+// the counting array is used while it is at most this many times larger than the input
+static const std::size_t kDomainFactor = 4;
+static const std::size_t kMaxDomain = std::size_t(1) << 26;
+
+template <typename It1, typename It2, typename Hash, typename KeyEqual>
+bool is_permutation_rest(It1 first1, It1 last1, It2 first2, It2 last2, std::size_t n, Hash hash, KeyEqual eq,
+                         std::true_type /* integral with the default hash */)
+{
+    typedef typename value_of<It1>::type T;
+    typedef typename std::make_unsigned<T>::type U;
+    auto mm = reduce_kernels::minmax_element(first1, last1);
+    const U span = static_cast<U>(static_cast<U>(*mm.second) - static_cast<U>(*mm.first));
+    if (span < std::min(kMaxDomain, kDomainFactor * n + 1024) && n < 0xffffffffu)
+        return permutation_by_counting(first1, last1, first2, last2, *mm.first, static_cast<std::size_t>(span) + 1);
+    return permutation_by_hashing(first1, last1, first2, last2, n, hash, eq);
+}
+
+template <typename It1, typename It2, typename Hash, typename KeyEqual>
+bool is_permutation_rest(It1 first1, It1 last1, It2 first2, It2 last2, std::size_t n, Hash hash, KeyEqual eq,
+                         std::false_type)
+{
+    return permutation_by_hashing(first1, last1, first2, last2, n, hash, eq);
+}
+
+} // namespace detail
+
+template <typename It1, typename It2>
+std::pair<It1, It2> mismatch(It1 first1, It1 last1, It2 first2)
+{
+    return detail::mismatch(first1, last1, first2, detail::use_memcmp<It1, It2>());
+}
+
+template <typename It1, typename It2>
+bool equal(It1 first1, It1 last1, It2 first2)
+{
+    return detail::equal(first1, last1, first2, detail::use_memcmp<It1, It2>());
+}
+
+/*
+ * Hash and KeyEqual must agree with each other like for an unordered_map;
+ * the counting array path is only taken for integers with the default std::hash / std::equal_to.
+ */
+template <typename It1, typename It2, typename Hash, typename KeyEqual>
+bool is_permutation(It1 first1, It1 last1, It2 first2, It2 last2, Hash hash, KeyEqual eq)
+{
+    typedef typename detail::value_of<It1>::type T;
+    if (std::distance(first1, last1) != std::distance(first2, last2))
+        return false;
+    // the common prefix needs no counting at all
+    for (; first1 != last1 && eq(*first1, *first2); ++first1, ++first2) {
+    }
+    const std::size_t n = static_cast<std::size_t>(std::distance(first1, last1));
+    if (n == 0)
+        return true;
+    return detail::is_permutation_rest(first1, last1, first2, last2, n, hash, eq,
+                                       std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                                                        std::is_same<Hash, std::hash<T>>::value &&
+                                                                        std::is_same<KeyEqual, std::equal_to<T>>::value>());
+}
+
+namespace detail {
+
+template <typename It1, typename It2>
+bool is_permutation(It1 first1, It1 last1, It2 first2, It2 last2, std::true_type /* same value type */)
+{
+    typedef typename value_of<It1>::type T;
+    return compare_kernels::is_permutation(first1, last1, first2, last2, std::hash<T>(), std::equal_to<T>());
+}
+
+// int against long long, const char* against std::string: std::hash<T1> would convert the second range to
+// the first value type (and narrow it), so compare with == like std::is_permutation
+template <typename It1, typename It2>
+bool is_permutation(It1 first1, It1 last1, It2 first2, It2 last2, std::false_type)
+{
+    if (std::distance(first1, last1) != std::distance(first2, last2))
+        return false;
+    return std::is_permutation(first1, last1, first2);
+}
+
+} // namespace detail
+
+template <typename It1, typename It2>
+bool is_permutation(It1 first1, It1 last1, It2 first2, It2 last2)
+{
+    return detail::is_permutation(first1, last1, first2, last2,
+                                  std::is_same<typename detail::value_of<It1>::type, typename detail::value_of<It2>::type>());
+}
+
+// the C++11 signature: the second range has as many elements as the first one
+template <typename It1, typename It2>
+bool is_permutation(It1 first1, It1 last1, It2 first2)
+{
+    It2 last2 = first2;
+    std::advance(last2, std::distance(first1, last1));
+    return compare_kernels::is_permutation(first1, last1, first2, last2);
+}
+
+namespace parallel {
+
+static const std::size_t kMinPerThread = 1 << 18;
+
+// random access ranges only; contiguous trivially comparable ones use memcmp() inside every block
+template <typename It1, typename It2>
+std::pair<It1, It2> mismatch(It1 first1, It1 last1, It2 first2)
+{
+    const std::size_t n = static_cast<std::size_t>(last1 - first1);
+    const std::size_t i = algorithms::parallel::first_match(n, 0, kMinPerThread, [&] (std::size_t b, std::size_t e) {
+        const std::size_t hit = static_cast<std::size_t>(compare_kernels::mismatch(first1 + b, first1 + e, first2 + b).first - first1);
+        return hit == e ? n : hit;
+    });
+    return std::make_pair(first1 + i, first2 + i);
+}
+
+template <typename It1, typename It2>
+bool equal(It1 first1, It1 last1, It2 first2)
+{
+    return parallel::mismatch(first1, last1, first2).first == last1;
+}
+
+} // namespace parallel
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_COMPARE_KERNELS_H
@@ -7,6 +7,19 @@
 #include "sorting.h"
 #include "sorted_range.h"
 #include "numerics.h"
+#include "search_kernels.h"
+#include "reduce_kernels.h"
+#include "compare_kernels.h"
+#include "external_sort.h"
+#include "partition_kernels.h"
+#include "scan_kernels.h"
+#include "remove_kernels.h"
+#include "random_kernels.h"
+#include "reorder_kernels.h"
+#include "permute_kernels.h"
+#include "bulk_kernels.h"
+#include "heap_kernels.h"
+#include "codec_kernels.h"
 
 #include <iostream>
 
@@ -55,6 +68,19 @@ void Demos()
     //sorting::Run();
     //sorted_range::Run();
     numerics_::Run();
+    //search_kernels::Run();
+    //reduce_kernels::Run();
+    //compare_kernels::Run();
+    //external_sort::Run();
+    //partition_kernels::Run();
+    //scan_kernels::Run();
+    //remove_kernels::Run();
+    //random_kernels::Run();
+    //reorder_kernels::Run();
+    //permute_kernels::Run();
+    //bulk_kernels::Run();
+    //heap_kernels::Run();
+    //codec_kernels::Run();
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "external_sort.h"
+#include "helper.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace algorithms {
+namespace external_sort {
+
+struct event {
+    uint64_t timestamp;
+    uint32_t sensor;
+    float value;
+};
+
+bool operator<(const event& a, const event& b)
+{
+    return a.timestamp < b.timestamp;
+}
+
+void lines_demo()
+{
+    // a memory budget of a few bytes forces one run per couple of lines
+    istringstream in("pear\napple\nfig\nbanana\ncherry\nkiwi\ndate\ngrape\n");
+    ostringstream out;
+    options opt;
+    opt.memory_budget = 200;
+    opt.io_buffer = 64;
+    opt.max_fan_in = 2;
+    stats s = sort_stream(in, out, opt, stream::records::line_codec());
+    cout << "sorted lines: " << out.str().size() << " bytes, " << s.records << " records, "
+         << s.runs << " runs, " << s.merge_passes << " merge passes" << endl;
+    cout << out.str();
+
+    // descending, with a custom comparator
+    istringstream in2("3\n1\n2\n");
+    ostringstream out2;
+    sort_stream(in2, out2, options(), stream::records::line_codec(), greater<string>());
+    cout << "descending: " << out2.str();
+}
+
+void file_demo()
+{
+    // 64 MB of events, sorted with a budget of 8 MB
+    const size_t kEvents = 4 * 1024 * 1024;
+    const string input = options::default_temp_dir() + "/stl_demo_events.bin";
+    const string output = options::default_temp_dir() + "/stl_demo_events.sorted";
+    {
+        mt19937_64 gen(42);
+        stream::records::buffered_ofstream out(input, 1 << 20);
+        stream::records::binary_codec<event> codec;
+        for (size_t i = 0; i < kEvents; ++i) {
+            event e = {gen(), static_cast<uint32_t>(i % 1000), static_cast<float>(i)};
+            codec.write(out.get(), e);
+        }
+        out.close();
+    }
+
+    options opt;
+    opt.memory_budget = 8 << 20;
+    opt.io_buffer = 256 << 10;
+    opt.max_fan_in = 4;
+    auto t0 = chrono::steady_clock::now();
+    stats s = sort_file(input, output, opt, stream::records::binary_codec<event>());
+    auto t1 = chrono::steady_clock::now();
+    cout << "external sort: " << s.records << " records, " << s.runs << " runs, " << s.merge_passes
+         << " merge passes in " << chrono::duration_cast<chrono::milliseconds>(t1 - t0).count() << " ms" << endl;
+
+    // check the result against an in-memory sort
+    vector<event> all;
+    {
+        stream::records::buffered_ifstream in(input, 1 << 20);
+        stream::records::binary_codec<event> codec;
+        event e;
+        while (codec.read(in.get(), e)) {
+            all.push_back(e);
+        }
+    }
+    auto t2 = chrono::steady_clock::now();
+    sort(all.begin(), all.end());
+    auto t3 = chrono::steady_clock::now();
+    bool same = true;
+    size_t n = 0;
+    {
+        stream::records::buffered_ifstream in(output, 1 << 20);
+        stream::records::binary_codec<event> codec;
+        event e;
+        while (codec.read(in.get(), e)) {
+            same = same && n < all.size() && e.timestamp == all[n].timestamp;
+            ++n;
+        }
+    }
+    cout << "in-memory std::sort: " << chrono::duration_cast<chrono::milliseconds>(t3 - t2).count() << " ms, "
+         << "same order: " << boolalpha << (same && n == all.size()) << endl;
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
+
+void Run()
+{
+    lines_demo();
+    file_demo();
+}
+
+}
+}
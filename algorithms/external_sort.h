@@ -0,0 +1,367 @@
+#ifndef STL_DEMO_ALGORITHMS_EXTERNAL_SORT_H
+#define STL_DEMO_ALGORITHMS_EXTERNAL_SORT_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <future>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__)
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+#include "../stream/records.h"
+
+namespace algorithms {
+namespace external_sort {
+
+/*
+ * External merge sort: sorts record streams that do not fit into memory.
+ *
+ *   1. run formation: read records until half of the memory budget is used, std::sort() them and write
+ *      them to a temporary file (a "run"). While one half is sorted and written by a worker thread,
+ *      the main thread already fills the other half, so reading and sorting/writing overlap.
+ *   2. merge: k runs are merged at once with a loser tree (log2(k) comparisons per record).
+ *      If there are more runs than the fan-in allows, groups of runs are merged into longer runs
+ *      first (several passes). The output is written in blocks by a second thread while the next
+ *      block is being merged.
+ *
+ * 只需要 O(memory_budget) 的内存，输入可以任意大。数据的格式由 stream/records.h 里的 codec 决定:
+ * binary_codec<T> 读写定长的二进制记录，line_codec 按行读写文本。
+ *
+ * 如果输入一次就能放进内存，不会产生临时文件，直接排序输出。
+ */
+
+struct options {
+    std::size_t memory_budget; // bytes of records held in memory at a time
+    std::size_t io_buffer;     // buffer of every temporary file stream
+    std::size_t max_fan_in;    // runs merged at once
+    std::string temp_dir;
+
+    options()
+        : memory_budget(std::size_t(256) << 20), io_buffer(std::size_t(1) << 20), max_fan_in(64),
+          temp_dir(default_temp_dir())
+    {
+    }
+
+    static std::string default_temp_dir()
+    {
+        const char* dir = std::getenv("TMPDIR");
+        return dir && *dir ? dir : "/tmp";
+    }
+};
+
+struct stats {
+    std::size_t records;
+    std::size_t runs;          // sorted runs written in phase 1
+    std::size_t merge_passes;  // 0 when everything fit into memory
+};
+
+namespace detail {
+
+// a temporary file that is deleted together with this object
+class temp_file {
+public:
+    explicit temp_file(const std::string& dir)
+    {
+#if defined(__unix__)
+        // mkstemp creates the file exclusively: no other process (or a second sort) can get the same name
+        std::string pattern = dir + "/stl_demo_sort_XXXXXX";
+        const int fd = mkstemp(&pattern[0]);
+        if (fd < 0)
+            throw std::runtime_error("cannot create a temporary file in " + dir);
+        close(fd);
+        path_ = pattern;
+#else
+        static std::atomic<unsigned> counter(0);
+        const long long stamp = static_cast<long long>(std::chrono::steady_clock::now().time_since_epoch().count());
+        path_ = dir + "/stl_demo_sort_" + std::to_string(stamp) + "_" + std::to_string(counter++) + ".run";
+#endif
+    }
+
+    ~temp_file() { std::remove(path_.c_str()); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    temp_file(const temp_file&);
+    temp_file& operator=(const temp_file&);
+
+    std::string path_;
+};
+
+typedef std::vector<std::unique_ptr<temp_file>> run_list;
+
+// joins the thread on every way out of a scope: a joinable std::thread must not be destroyed
+class join_guard {
+public:
+    explicit join_guard(std::thread& t) : t_(t) {}
+    ~join_guard()
+    {
+        if (t_.joinable())
+            t_.join();
+    }
+
+private:
+    join_guard(const join_guard&);
+    join_guard& operator=(const join_guard&);
+
+    std::thread& t_;
+};
+
+/*
+ * Loser tree (tournament tree) over k sources.
+ *
+ * The leaves are the current records of the k sources, every inner node remembers the *loser* of the
+ * match played there, and node 0 the overall winner. After the winner was consumed only the matches on
+ * the path from its leaf to the root are replayed: exactly ceil(log2(k)) comparisons, compared to about
+ * 2 * log2(k) for a binary heap (sift down compares with both children).
+ *
+ * 内部节点 1..k-1 用堆的编号方式，叶子 i 的位置是 k + i；k 不必是 2 的幂。
+ */
+template <typename T, typename Compare>
+class loser_tree {
+public:
+    loser_tree(std::vector<T>& heads, std::vector<bool>& live, Compare comp)
+        : heads_(heads), live_(live), comp_(comp), k_(heads.size()), tree_(std::max<std::size_t>(k_, 1))
+    {
+        if (k_ == 0)
+            return;
+        // bottom-up build: winners of every node in a scratch array, losers stay in tree_
+        std::vector<std::size_t> winner(2 * k_);
+        for (std::size_t i = 0; i < k_; ++i) {
+            winner[k_ + i] = i;
+        }
+        for (std::size_t n = k_ - 1; n >= 1; --n) {
+            const std::size_t a = winner[2 * n], b = winner[2 * n + 1];
+            if (beats(a, b)) {
+                winner[n] = a;
+                tree_[n] = b;
+            } else {
+                winner[n] = b;
+                tree_[n] = a;
+            }
+        }
+        tree_[0] = k_ == 1 ? 0 : winner[1];
+    }
+
+    bool empty() const { return k_ == 0 || !live_[tree_[0]]; }
+
+    std::size_t top() const { return tree_[0]; }
+
+    // heads[top()] has been replaced (or its source marked dead): replay the path to the root
+    void replay()
+    {
+        std::size_t w = tree_[0];
+        for (std::size_t n = (k_ + w) / 2; n >= 1; n /= 2) {
+            if (beats(tree_[n], w))
+                std::swap(tree_[n], w);
+        }
+        tree_[0] = w;
+    }
+
+private:
+    // exhausted sources lose against everything
+    bool beats(std::size_t a, std::size_t b) const
+    {
+        if (!live_[a])
+            return false;
+        if (!live_[b])
+            return true;
+        return comp_(heads_[a], heads_[b]);
+    }
+
+    std::vector<T>& heads_;
+    std::vector<bool>& live_;
+    Compare comp_;
+    std::size_t k_;
+    std::vector<std::size_t> tree_;
+};
+
+template <typename Codec>
+void write_all(std::ostream& out, const std::vector<typename Codec::value_type>& recs, const Codec& codec)
+{
+    for (std::size_t i = 0; i < recs.size(); ++i) {
+        codec.write(out, recs[i]);
+    }
+}
+
+// merges `inputs` into `out`; the output goes in blocks through a writer thread
+template <typename Codec, typename Compare>
+void merge_runs(const std::vector<temp_file*>& inputs, std::ostream& out, const options& opt,
+                const Codec& codec, Compare comp)
+{
+    typedef typename Codec::value_type T;
+    const std::size_t k = inputs.size();
+    std::vector<std::unique_ptr<stream::records::buffered_ifstream>> readers;
+    std::vector<T> heads(k);
+    std::vector<bool> live(k);
+    for (std::size_t i = 0; i < k; ++i) {
+        readers.push_back(std::unique_ptr<stream::records::buffered_ifstream>(
+            new stream::records::buffered_ifstream(inputs[i]->path(), opt.io_buffer)));
+        live[i] = codec.read(readers[i]->get(), heads[i]);
+    }
+
+    loser_tree<T, Compare> tree(heads, live, comp);
+    const std::size_t kBlock = 8192;
+    std::vector<T> blocks[2];
+    int cur = 0;
+    std::future<void> pending;
+    while (!tree.empty()) {
+        const std::size_t w = tree.top();
+        blocks[cur].push_back(std::move(heads[w]));
+        live[w] = codec.read(readers[w]->get(), heads[w]);
+        tree.replay();
+        if (blocks[cur].size() == kBlock) {
+            if (pending.valid())
+                pending.get(); // the other block is free again
+            std::vector<T>& full = blocks[cur];
+            pending = std::async(std::launch::async, [&out, &full, &codec] {
+                write_all(out, full, codec);
+                full.clear();
+            });
+            cur ^= 1;
+        }
+    }
+    if (pending.valid())
+        pending.get();
+    write_all(out, blocks[cur], codec);
+}
+
+} // namespace detail
+
+template <typename Codec, typename Compare>
+stats sort_stream(std::istream& in, std::ostream& out, const options& opt, Codec codec, Compare comp)
+{
+    typedef typename Codec::value_type T;
+    stats result = {0, 0, 0};
+    detail::run_list runs;
+
+    // -- phase 1: sorted runs, reading overlaps with sorting/writing the previous half --
+    const std::size_t half = std::max<std::size_t>(opt.memory_budget / 2, 1);
+    std::vector<T> filling, flushing;
+    std::thread worker;
+    std::exception_ptr worker_error;
+    // a read error (or a failed temp_file) leaves the worker running: wait for it before flushing goes away
+    detail::join_guard guard(worker);
+    auto join_worker = [&] {
+        if (worker.joinable())
+            worker.join();
+        if (worker_error)
+            std::rethrow_exception(worker_error);
+    };
+
+    bool more = true;
+    while (more) {
+        std::size_t bytes = 0;
+        T rec;
+        while (bytes < half && (more = codec.read(in, rec))) {
+            bytes += codec.footprint(rec);
+            filling.push_back(std::move(rec));
+        }
+        result.records += filling.size();
+        if (!more && runs.empty() && !worker.joinable()) {
+            // everything fit into memory: no temporary files at all
+            std::sort(filling.begin(), filling.end(), comp);
+            detail::write_all(out, filling, codec);
+            return result;
+        }
+        if (filling.empty())
+            break;
+        join_worker();
+        filling.swap(flushing);
+        filling.clear();
+        runs.push_back(std::unique_ptr<detail::temp_file>(new detail::temp_file(opt.temp_dir)));
+        detail::temp_file* run = runs.back().get();
+        worker = std::thread([&flushing, run, &opt, &codec, &comp, &worker_error] {
+            try {
+                std::sort(flushing.begin(), flushing.end(), comp);
+                stream::records::buffered_ofstream file(run->path(), opt.io_buffer);
+                detail::write_all(file.get(), flushing, codec);
+                file.close();
+            } catch (...) {
+                worker_error = std::current_exception();
+            }
+        });
+    }
+    join_worker();
+    std::vector<T>().swap(filling);
+    std::vector<T>().swap(flushing);
+    result.runs = runs.size();
+
+    // -- phase 2: k-way merges, every open run costs one io_buffer --
+    const std::size_t fan_in = std::max<std::size_t>(2, std::min(opt.max_fan_in, opt.memory_budget / opt.io_buffer));
+    while (runs.size() > fan_in) {
+        detail::run_list next;
+        for (std::size_t first = 0; first < runs.size(); first += fan_in) {
+            const std::size_t last = std::min(runs.size(), first + fan_in);
+            if (last - first == 1) {
+                next.push_back(std::move(runs[first]));
+                continue;
+            }
+            std::vector<detail::temp_file*> group;
+            for (std::size_t i = first; i < last; ++i) {
+                group.push_back(runs[i].get());
+            }
+            next.push_back(std::unique_ptr<detail::temp_file>(new detail::temp_file(opt.temp_dir)));
+            stream::records::buffered_ofstream file(next.back()->path(), opt.io_buffer);
+            detail::merge_runs(group, file.get(), opt, codec, comp);
+            file.close();
+            for (std::size_t i = first; i < last; ++i) {
+                runs[i].reset(); // delete the inputs as soon as possible
+            }
+        }
+        runs.swap(next);
+        ++result.merge_passes;
+    }
+    std::vector<detail::temp_file*> group;
+    for (std::size_t i = 0; i < runs.size(); ++i) {
+        group.push_back(runs[i].get());
+    }
+    detail::merge_runs(group, out, opt, codec, comp);
+    ++result.merge_passes;
+    return result;
+}
+
+template <typename Codec>
+stats sort_stream(std::istream& in, std::ostream& out, const options& opt, Codec codec)
+{
+    return sort_stream(in, out, opt, codec, std::less<typename Codec::value_type>());
+}
+
+template <typename Codec, typename Compare>
+stats sort_file(const std::string& in_path, const std::string& out_path, const options& opt, Codec codec, Compare comp)
+{
+    stream::records::buffered_ifstream in(in_path, opt.io_buffer);
+    stream::records::buffered_ofstream out(out_path, opt.io_buffer);
+    const stats result = sort_stream(in.get(), out.get(), opt, codec, comp);
+    out.close();
+    return result;
+}
+
+template <typename Codec>
+stats sort_file(const std::string& in_path, const std::string& out_path, const options& opt, Codec codec)
+{
+    return sort_file(in_path, out_path, opt, codec, std::less<typename Codec::value_type>());
+}
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_EXTERNAL_SORT_H
@@ -0,0 +1,356 @@
+#include "heap_kernels.h"
+#include "helper.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace algorithms {
+namespace heap_kernels {
+
+// heap_demo() of sorting.cpp
+void same_as_std_demo()
+{
+    vector<int> coll;
+    helper::INSERT_ELEMENTS(coll, 3, 7);
+    helper::INSERT_ELEMENTS(coll, 5, 9);
+    helper::INSERT_ELEMENTS(coll, 1, 4);
+    helper::PRINT_ELEMENT(coll, "on entry: ");
+
+    // D = 2 is the layout of std::make_heap
+    heap_kernels::make_heap(coll.begin(), coll.end());
+    helper::PRINT_ELEMENT(coll, "after make_heap(): ");
+    cout << "std::is_heap: " << boolalpha << std::is_heap(coll.begin(), coll.end()) << endl;
+
+    heap_kernels::pop_heap(coll.begin(), coll.end());
+    coll.pop_back();
+    helper::PRINT_ELEMENT(coll, "after pop_heap(): ");
+
+    coll.push_back(17);
+    heap_kernels::push_heap(coll.begin(), coll.end());
+    helper::PRINT_ELEMENT(coll, "after push_heap(): ");
+
+    // 一次加入一批
+    const size_t old_size = coll.size();
+    coll.insert(coll.end(), {11, 2, 13});
+    heap_kernels::push_heap_n(coll.begin(), coll.begin() + old_size, coll.end());
+    helper::PRINT_ELEMENT(coll, "after push_heap_n(11, 2, 13): ");
+    auto rest = heap_kernels::pop_heap_n(coll.begin(), coll.end(), 3);
+    helper::PRINT_ELEMENT(vector<int>(rest, coll.end()), "pop_heap_n(3): ");
+
+    // the same elements as a 4-ary heap: every node has up to 4 children
+    heap_kernels::make_heap<4>(coll.begin(), coll.end());
+    helper::PRINT_ELEMENT(coll, "make_heap<4>(): ");
+
+    dary_heap<int, 4, greater<int>> smallest;
+    smallest.push_n(coll.begin(), coll.end());
+    vector<int> first3;
+    smallest.pop_n(3, back_inserter(first3));
+    helper::PRINT_ELEMENT(first3, "3 smallest: ");
+
+    // decrease-key: the handle of 40 gets the priority 1
+    pairing_heap<int, greater<int>> tasks;
+    tasks.push(30);
+    auto h = tasks.push(40);
+    tasks.push(20);
+    tasks.update(h, 1);
+    cout << "pairing_heap top after update(40 -> 1): " << tasks.top() << endl;
+
+    radix_heap<uint32_t, char> events;
+    events.push(30, 'c');
+    events.push(10, 'a');
+    events.push(20, 'b');
+    cout << "radix_heap: ";
+    cout << events.top_key() << events.top_value() << " ";
+    events.pop();
+    // monotone: an event scheduled while handling the one at 10 is not earlier than 10
+    events.push(15, 'x');
+    while (!events.empty()) {
+        cout << events.top_key() << events.top_value() << " ";
+        events.pop();
+    }
+    cout << endl;
+}
+
+// counts the compares of pop_heap
+struct counting_less {
+    size_t* count;
+    bool operator()(int a, int b) const
+    {
+        ++*count;
+        return a < b;
+    }
+};
+
+bool cross_check()
+{
+    mt19937 gen(13);
+    bool ok = true;
+    for (size_t n : {0, 1, 2, 3, 10, 100, 1001, 30000}) {
+        vector<int> data(n);
+        for (auto& x : data) {
+            x = static_cast<int>(gen() % 1000);
+        }
+
+        // heap sort through pop_heap_n == sort, for D = 2, 3, 4, 8
+        vector<int> sorted(data);
+        sort(sorted.begin(), sorted.end());
+        vector<int> a(data);
+        heap_kernels::make_heap(a.begin(), a.end());
+        ok = ok && std::is_heap(a.begin(), a.end());
+        heap_kernels::pop_heap_n(a.begin(), a.end(), n);
+        ok = ok && a == sorted;
+        a = data;
+        heap_kernels::make_heap<3>(a.begin(), a.end());
+        ok = ok && heap_kernels::is_heap<3>(a.begin(), a.end());
+        heap_kernels::pop_heap_n<3>(a.begin(), a.end(), n);
+        ok = ok && a == sorted;
+        a = data;
+        heap_kernels::make_heap<8>(a.begin(), a.end(), greater<int>());
+        heap_kernels::pop_heap_n<8>(a.begin(), a.end(), n, greater<int>());
+        ok = ok && equal(a.rbegin(), a.rend(), sorted.begin());
+
+        // batches of every size onto heaps of every size
+        for (size_t split : {size_t(0), n / 2, n - n / 8, n}) {
+            if (split > n)
+                continue;
+            a = data;
+            heap_kernels::make_heap<4>(a.begin(), a.begin() + split);
+            heap_kernels::push_heap_n<4>(a.begin(), a.begin() + split, a.end());
+            ok = ok && heap_kernels::is_heap<4>(a.begin(), a.end());
+            a = data;
+            std::make_heap(a.begin(), a.begin() + split);
+            heap_kernels::push_heap_n(a.begin(), a.begin() + split, a.end());
+            ok = ok && std::is_heap(a.begin(), a.end());
+        }
+
+        // the queues against std::priority_queue, pushes and pops interleaved
+        priority_queue<int> expected;
+        dary_heap<int> dh;
+        pairing_heap<int> ph;
+        for (size_t i = 0; i < n; ++i) {
+            expected.push(data[i]);
+            dh.push(data[i]);
+            ph.push(data[i]);
+            if (i % 3 == 2) {
+                ok = ok && dh.top() == expected.top() && ph.top() == expected.top();
+                expected.pop();
+                dh.pop();
+                ph.pop();
+            }
+        }
+        while (!expected.empty()) {
+            ok = ok && dh.top() == expected.top() && ph.top() == expected.top();
+            expected.pop();
+            dh.pop();
+            ph.pop();
+        }
+        ok = ok && dh.empty() && ph.empty();
+    }
+
+    // pairing_heap::update against a brute force minimum
+    pairing_heap<int, greater<int>> ph;
+    vector<pairing_heap<int, greater<int>>::handle> handles;
+    vector<int> values;
+    for (int i = 0; i < 5000; ++i) {
+        values.push_back(1000000 + static_cast<int>(gen() % 1000000));
+        handles.push_back(ph.push(values.back()));
+    }
+    for (int r = 0; r < 20000; ++r) {
+        const size_t i = gen() % values.size();
+        values[i] -= static_cast<int>(gen() % 1000);
+        ph.update(handles[i], values[i]);
+        ok = ok && ph.top() == *min_element(values.begin(), values.end());
+    }
+
+    // radix_heap pops in order while keys keep coming
+    radix_heap<uint64_t, int> rh;
+    priority_queue<uint64_t, vector<uint64_t>, greater<uint64_t>> mins;
+    uint64_t now = 0;
+    for (int i = 0; i < 100000; ++i) {
+        const uint64_t key = now + gen() % 100000;
+        rh.push(key, i);
+        mins.push(key);
+        if (i % 2 == 1) {
+            ok = ok && rh.top_key() == mins.top();
+            now = mins.top();
+            rh.pop();
+            mins.pop();
+        }
+    }
+    while (!mins.empty()) {
+        ok = ok && rh.top_key() == mins.top();
+        rh.pop();
+        mins.pop();
+    }
+    ok = ok && rh.empty();
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+// random directed graph in compressed rows: the edges of u are [offset[u], offset[u + 1])
+struct graph {
+    vector<uint32_t> offset, target, weight;
+};
+
+graph random_graph(uint32_t nodes, uint32_t degree, mt19937& gen)
+{
+    graph g;
+    g.offset.resize(nodes + 1);
+    for (uint32_t u = 0; u <= nodes; ++u) {
+        g.offset[u] = u * degree;
+    }
+    g.target.resize(size_t(nodes) * degree);
+    g.weight.resize(size_t(nodes) * degree);
+    for (size_t e = 0; e < g.target.size(); ++e) {
+        g.target[e] = gen() % nodes;
+        g.weight[e] = 1 + gen() % 1000;
+    }
+    return g;
+}
+
+static const uint32_t kUnreached = numeric_limits<uint32_t>::max();
+
+// lazy deletion: a vertex may be queued several times, stale entries are skipped
+template <typename Queue, typename Push, typename Top, typename Pop>
+uint64_t dijkstra_lazy(const graph& g, Queue& q, Push push, Top top, Pop pop)
+{
+    vector<uint32_t> dist(g.offset.size() - 1, kUnreached);
+    dist[0] = 0;
+    push(q, 0, 0);
+    while (!q.empty()) {
+        const pair<uint32_t, uint32_t> du = top(q);
+        pop(q);
+        const uint32_t d = du.first, u = du.second;
+        if (d != dist[u])
+            continue;
+        for (uint32_t e = g.offset[u]; e < g.offset[u + 1]; ++e) {
+            const uint32_t v = g.target[e], nd = d + g.weight[e];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                push(q, nd, v);
+            }
+        }
+    }
+    uint64_t sum = 0;
+    for (uint32_t d : dist) {
+        sum += d == kUnreached ? 0 : d;
+    }
+    return sum;
+}
+
+void benchmark()
+{
+    // pop 10M elements one by one: compares and time
+    const size_t kValues = 10000000;
+    mt19937 gen(42);
+    vector<int> data(kValues);
+    for (auto& x : data) {
+        x = static_cast<int>(gen());
+    }
+    vector<int> work(data);
+    size_t compares = 0;
+    std::make_heap(work.begin(), work.end());
+    long long t = time_ms([&] {
+        for (auto last = work.end(); last != work.begin(); --last) {
+            std::pop_heap(work.begin(), last, counting_less{&compares});
+        }
+    });
+    cout << "std::pop_heap x 10M: " << t << " ms, " << compares / kValues << " compares per pop" << endl;
+    work = data;
+    compares = 0;
+    std::make_heap(work.begin(), work.end());
+    t = time_ms([&] { heap_kernels::pop_heap_n(work.begin(), work.end(), kValues, counting_less{&compares}); });
+    cout << "pop_heap_n (bottom-up) 10M: " << t << " ms, " << compares / kValues << " compares per pop" << endl;
+    work = data;
+    compares = 0;
+    heap_kernels::make_heap<4>(work.begin(), work.end());
+    t = time_ms([&] { heap_kernels::pop_heap_n<4>(work.begin(), work.end(), kValues, counting_less{&compares}); });
+    cout << "pop_heap_n<4> 10M: " << t << " ms, " << compares / kValues << " compares per pop" << endl;
+
+    // the same graph through every queue: 2M vertices, 16M edges
+    const graph g = random_graph(2000000, 8, gen);
+    typedef pair<uint32_t, uint32_t> entry;  // (distance, vertex)
+    uint64_t sum = 0;
+
+    priority_queue<entry, vector<entry>, greater<entry>> pq;
+    t = time_ms([&] {
+        sum = dijkstra_lazy(g, pq,
+            [] (priority_queue<entry, vector<entry>, greater<entry>>& q, uint32_t d, uint32_t v) { q.push(entry(d, v)); },
+            [] (priority_queue<entry, vector<entry>, greater<entry>>& q) { return q.top(); },
+            [] (priority_queue<entry, vector<entry>, greater<entry>>& q) { q.pop(); });
+    });
+    cout << "dijkstra std::priority_queue: " << t << " ms, checksum " << sum << endl;
+
+    dary_heap<entry, 4, greater<entry>> dh;
+    t = time_ms([&] {
+        sum = dijkstra_lazy(g, dh,
+            [] (dary_heap<entry, 4, greater<entry>>& q, uint32_t d, uint32_t v) { q.push(entry(d, v)); },
+            [] (dary_heap<entry, 4, greater<entry>>& q) { return q.top(); },
+            [] (dary_heap<entry, 4, greater<entry>>& q) { q.pop(); });
+    });
+    cout << "dijkstra dary_heap<4>: " << t << " ms, checksum " << sum << endl;
+
+    radix_heap<uint32_t, uint32_t> rh;
+    t = time_ms([&] {
+        sum = dijkstra_lazy(g, rh,
+            [] (radix_heap<uint32_t, uint32_t>& q, uint32_t d, uint32_t v) { q.push(d, v); },
+            [] (radix_heap<uint32_t, uint32_t>& q) { return entry(q.top_key(), q.top_value()); },
+            [] (radix_heap<uint32_t, uint32_t>& q) { q.pop(); });
+    });
+    cout << "dijkstra radix_heap: " << t << " ms, checksum " << sum << endl;
+
+    // decrease-key instead of duplicates: every vertex is queued at most once
+    t = time_ms([&] {
+        const size_t nodes = g.offset.size() - 1;
+        vector<uint32_t> dist(nodes, kUnreached);
+        vector<pairing_heap<entry, greater<entry>>::handle> where(nodes, nullptr);
+        vector<bool> done(nodes, false);
+        pairing_heap<entry, greater<entry>> q;
+        dist[0] = 0;
+        where[0] = q.push(entry(0, 0));
+        while (!q.empty()) {
+            const uint32_t d = q.top().first, u = q.top().second;
+            q.pop();
+            done[u] = true;
+            for (uint32_t e = g.offset[u]; e < g.offset[u + 1]; ++e) {
+                const uint32_t v = g.target[e], nd = d + g.weight[e];
+                if (!done[v] && nd < dist[v]) {
+                    if (dist[v] == kUnreached)
+                        where[v] = q.push(entry(nd, v));
+                    else
+                        q.update(where[v], entry(nd, v));
+                    dist[v] = nd;
+                }
+            }
+        }
+        sum = 0;
+        for (uint32_t d : dist) {
+            sum += d == kUnreached ? 0 : d;
+        }
+    });
+    cout << "dijkstra pairing_heap (decrease-key): " << t << " ms, checksum " << sum << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
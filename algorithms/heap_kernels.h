@@ -0,0 +1,501 @@
+#ifndef STL_DEMO_ALGORITHMS_HEAP_KERNELS_H
+#define STL_DEMO_ALGORITHMS_HEAP_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace algorithms {
+namespace heap_kernels {
+
+/*
+ * Heaps beyond heap_demo() of sorting.cpp.
+ *
+ *     make_heap / push_heap / pop_heap <D>   implicit D-ary heap in a random access range; D = 2 is exactly the
+ *                                            layout of std::make_heap, so both can work on the same vector
+ *     pop_heap                               Floyd's bottom-up pop: the hole goes down to a leaf with one compare
+ *                                            per level (D - 1 for D children), the last element then climbs up
+ *                                            a level or two, instead of 2 compares per level top down
+ *     push_heap_n                            appends a batch: only the ancestors of the new elements are heapified,
+ *                                            level by level, instead of k separate push_heap calls
+ *     pop_heap_n                             the k largest to [last - k, last), ascending like k pop_heap calls
+ *     dary_heap<T, D>                        priority_queue on top of them, 4 children per node by default:
+ *                                            half the depth of a binary heap, and the 4 children share a cache line
+ *     pairing_heap<T>                        node based, push is O(1), update() raises the priority of an element
+ *                                            through its handle (decrease-key of Dijkstra)
+ *     radix_heap<Key, Value>                 monotone priority queue for unsigned keys: no key pushed is smaller
+ *                                            than the last one popped (Dijkstra, event time simulation).
+ *                                            Buckets by the highest bit that differs from the last popped key,
+ *                                            every element moves down at most once per bit
+ *
+ * 和 std:: 一样是大顶堆：comp(a, b) 为 true 表示 a 的优先级比 b 低；要小顶堆就传 std::greater。
+ */
+
+namespace detail {
+
+template <std::size_t D, typename It, typename Compare>
+void sift_up(It first, std::size_t hole, Compare& comp)
+{
+    typename std::iterator_traits<It>::value_type v = std::move(first[hole]);
+    while (hole > 0) {
+        const std::size_t parent = (hole - 1) / D;
+        if (!comp(first[parent], v))
+            break;
+        first[hole] = std::move(first[parent]);
+        hole = parent;
+    }
+    first[hole] = std::move(v);
+}
+
+// the largest of the children [child, min(child + D, n))
+template <std::size_t D, typename It, typename Compare>
+std::size_t max_child(It first, std::size_t child, std::size_t n, Compare& comp)
+{
+    std::size_t best = child;
+    const std::size_t end = std::min(child + D, n);
+    for (std::size_t c = child + 1; c < end; ++c) {
+        if (comp(first[best], first[c]))
+            best = c;
+    }
+    return best;
+}
+
+// classic top-down sift, stops as soon as the element is not smaller than its largest child
+template <std::size_t D, typename It, typename Compare>
+void sift_down(It first, std::size_t n, std::size_t hole, Compare& comp)
+{
+    typename std::iterator_traits<It>::value_type v = std::move(first[hole]);
+    for (std::size_t child = D * hole + 1; child < n; child = D * hole + 1) {
+        const std::size_t best = max_child<D>(first, child, n, comp);
+        if (!comp(v, first[best]))
+            break;
+        first[hole] = std::move(first[best]);
+        hole = best;
+    }
+    first[hole] = std::move(v);
+}
+
+/*
+ * Floyd: first[hole] is empty (moved from); the hole walks down along the largest children to a leaf,
+ * then v is put there and sifts up. v usually comes from the bottom, so it climbs only a level or two.
+ */
+template <std::size_t D, typename It, typename Compare>
+void sift_hole_bottom_up(It first, std::size_t n, std::size_t hole,
+                         typename std::iterator_traits<It>::value_type&& v, Compare& comp)
+{
+    for (std::size_t child = D * hole + 1; child < n; child = D * hole + 1) {
+        const std::size_t best = max_child<D>(first, child, n, comp);
+        first[hole] = std::move(first[best]);
+        hole = best;
+    }
+    first[hole] = std::move(v);
+    sift_up<D>(first, hole, comp);
+}
+
+// [0, n) is a heap except for the subtrees of [lo, hi]: heapify their ancestors level by level
+template <std::size_t D, typename It, typename Compare>
+void heapify_range(It first, std::size_t n, std::size_t lo, std::size_t hi, Compare& comp)
+{
+    while (hi > 0) {
+        lo = (lo - 1) / D;
+        hi = (hi - 1) / D;
+        for (std::size_t i = hi + 1; i-- > lo;) {
+            sift_down<D>(first, n, i, comp);
+        }
+        if (lo == 0)
+            break;
+    }
+}
+
+template <typename It>
+struct default_less {
+    typedef std::less<typename std::iterator_traits<It>::value_type> type;
+};
+
+} // namespace detail
+
+template <std::size_t D = 2, typename It, typename Compare>
+void make_heap(It first, It last, Compare comp)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    for (std::size_t i = n < 2 ? 0 : (n - 2) / D + 1; i-- > 0;) {
+        detail::sift_down<D>(first, n, i, comp);
+    }
+}
+
+template <std::size_t D = 2, typename It>
+void make_heap(It first, It last)
+{
+    heap_kernels::make_heap<D>(first, last, typename detail::default_less<It>::type());
+}
+
+// [first, last - 1) is a heap, last[-1] joins it
+template <std::size_t D = 2, typename It, typename Compare>
+void push_heap(It first, It last, Compare comp)
+{
+    if (last - first > 1)
+        detail::sift_up<D>(first, static_cast<std::size_t>(last - first) - 1, comp);
+}
+
+template <std::size_t D = 2, typename It>
+void push_heap(It first, It last)
+{
+    heap_kernels::push_heap<D>(first, last, typename detail::default_less<It>::type());
+}
+
+// the largest element to last[-1], [first, last - 1) stays a heap
+template <std::size_t D = 2, typename It, typename Compare>
+void pop_heap(It first, It last, Compare comp)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (n < 2)
+        return;
+    typename std::iterator_traits<It>::value_type v = std::move(last[-1]);
+    last[-1] = std::move(first[0]);
+    detail::sift_hole_bottom_up<D>(first, n - 1, 0, std::move(v), comp);
+}
+
+template <std::size_t D = 2, typename It>
+void pop_heap(It first, It last)
+{
+    heap_kernels::pop_heap<D>(first, last, typename detail::default_less<It>::type());
+}
+
+template <std::size_t D = 2, typename It, typename Compare>
+bool is_heap(It first, It last, Compare comp)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    for (std::size_t i = 1; i < n; ++i) {
+        if (comp(first[(i - 1) / D], first[i]))
+            return false;
+    }
+    return true;
+}
+
+template <std::size_t D = 2, typename It>
+bool is_heap(It first, It last)
+{
+    return heap_kernels::is_heap<D>(first, last, typename detail::default_less<It>::type());
+}
+
+/*
+ * [first, middle) is a heap, the elements [middle, last) join it.
+ * A batch larger than the heap rebuilds everything (make_heap is linear).
+ */
+template <std::size_t D = 2, typename It, typename Compare>
+void push_heap_n(It first, It middle, It last, Compare comp)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t old_size = static_cast<std::size_t>(middle - first);
+    const std::size_t k = n - old_size;
+    if (k == 0)
+        return;
+    if (k >= old_size) {
+        heap_kernels::make_heap<D>(first, last, comp);
+        return;
+    }
+    detail::heapify_range<D>(first, n, old_size, n - 1, comp);
+}
+
+template <std::size_t D = 2, typename It>
+void push_heap_n(It first, It middle, It last)
+{
+    heap_kernels::push_heap_n<D>(first, middle, last, typename detail::default_less<It>::type());
+}
+
+// the k largest elements to [last - k, last) in ascending order; returns last - k, the end of the remaining heap
+template <std::size_t D = 2, typename It, typename Compare>
+It pop_heap_n(It first, It last, std::size_t k, Compare comp)
+{
+    k = std::min(k, static_cast<std::size_t>(last - first));
+    for (std::size_t i = 0; i < k; ++i, --last) {
+        heap_kernels::pop_heap<D>(first, last, comp);
+    }
+    return last;
+}
+
+template <std::size_t D = 2, typename It>
+It pop_heap_n(It first, It last, std::size_t k)
+{
+    return heap_kernels::pop_heap_n<D>(first, last, k, typename detail::default_less<It>::type());
+}
+
+// priority_queue with D children per node; top() is the largest element by comp
+template <typename T, std::size_t D = 4, typename Compare = std::less<T>>
+class dary_heap {
+public:
+    explicit dary_heap(Compare comp = Compare()) : comp_(comp) {}
+
+    bool empty() const { return data_.empty(); }
+    std::size_t size() const { return data_.size(); }
+    const T& top() const { return data_.front(); }
+    void reserve(std::size_t n) { data_.reserve(n); }
+    void clear() { data_.clear(); }
+
+    void push(const T& value)
+    {
+        data_.push_back(value);
+        heap_kernels::push_heap<D>(data_.begin(), data_.end(), comp_);
+    }
+
+    void push(T&& value)
+    {
+        data_.push_back(std::move(value));
+        heap_kernels::push_heap<D>(data_.begin(), data_.end(), comp_);
+    }
+
+    template <typename It>
+    void push_n(It first, It last)
+    {
+        const std::size_t old_size = data_.size();
+        data_.insert(data_.end(), first, last);
+        heap_kernels::push_heap_n<D>(data_.begin(), data_.begin() + old_size, data_.end(), comp_);
+    }
+
+    void pop()
+    {
+        heap_kernels::pop_heap<D>(data_.begin(), data_.end(), comp_);
+        data_.pop_back();
+    }
+
+    // the k largest elements to out, largest first
+    template <typename Out>
+    Out pop_n(std::size_t k, Out out)
+    {
+        k = std::min(k, data_.size());
+        for (std::size_t i = 0; i < k; ++i) {
+            *out++ = std::move(data_.front());
+            pop();
+        }
+        return out;
+    }
+
+private:
+    std::vector<T> data_;
+    Compare comp_;
+};
+
+/*
+ * Pairing heap: a tree of nodes, every node points to its leftmost child and to its siblings.
+ * push() and update() link one tree with the root (one compare); pop() merges the children of the root
+ * in two passes: pairs from left to right, then the pairs from right to left.
+ * The nodes live in a pool, handles stay valid until their element is popped.
+ */
+template <typename T, typename Compare = std::less<T>>
+class pairing_heap {
+    struct node {
+        T value;
+        node* child;
+        node* next;
+        node* prev;  // the left sibling, or the parent for the leftmost child
+    };
+
+public:
+    typedef node* handle;
+
+    explicit pairing_heap(Compare comp = Compare()) : root_(nullptr), size_(0), comp_(comp) {}
+    pairing_heap(const pairing_heap&) = delete;
+    pairing_heap& operator=(const pairing_heap&) = delete;
+
+    bool empty() const { return root_ == nullptr; }
+    std::size_t size() const { return size_; }
+    const T& top() const { return root_->value; }
+    const T& value(handle h) const { return h->value; }
+
+    handle push(const T& value)
+    {
+        node* n = allocate(value);
+        root_ = root_ ? link(root_, n) : n;
+        ++size_;
+        return n;
+    }
+
+    void pop()
+    {
+        node* old = root_;
+        root_ = merge_pairs(old->child);
+        free_.push_back(old);
+        --size_;
+    }
+
+    // value must not have a lower priority than the current value of h, comp(h->value, value) or equal
+    void update(handle h, const T& value)
+    {
+        h->value = value;
+        if (h == root_)
+            return;
+        if (h->prev->child == h)
+            h->prev->child = h->next;
+        else
+            h->prev->next = h->next;
+        if (h->next)
+            h->next->prev = h->prev;
+        h->next = h->prev = nullptr;
+        root_ = link(root_, h);
+    }
+
+    void clear()
+    {
+        pool_.clear();
+        free_.clear();
+        root_ = nullptr;
+        size_ = 0;
+    }
+
+private:
+    node* allocate(const T& value)
+    {
+        node n = {value, nullptr, nullptr, nullptr};
+        if (!free_.empty()) {
+            node* p = free_.back();
+            free_.pop_back();
+            *p = n;
+            return p;
+        }
+        pool_.push_back(n);
+        return &pool_.back();
+    }
+
+    // two roots become one tree, the loser is the new leftmost child of the winner
+    node* link(node* a, node* b)
+    {
+        if (comp_(a->value, b->value))
+            std::swap(a, b);
+        b->prev = a;
+        b->next = a->child;
+        if (a->child)
+            a->child->prev = b;
+        a->child = b;
+        a->next = a->prev = nullptr;
+        return a;
+    }
+
+    node* merge_pairs(node* first)
+    {
+        if (!first)
+            return nullptr;
+        pairs_.clear();
+        while (first) {
+            node* a = first;
+            node* b = a->next;
+            if (!b) {
+                a->next = a->prev = nullptr;
+                pairs_.push_back(a);
+                break;
+            }
+            first = b->next;
+            b->next = b->prev = nullptr;
+            pairs_.push_back(link(a, b));
+        }
+        node* r = pairs_.back();
+        for (std::size_t i = pairs_.size() - 1; i-- > 0;) {
+            r = link(pairs_[i], r);
+        }
+        return r;
+    }
+
+    std::deque<node> pool_;
+    std::vector<node*> free_, pairs_;
+    node* root_;
+    std::size_t size_;
+    Compare comp_;
+};
+
+/*
+ * Monotone min-heap for unsigned integer keys. The keys pushed must not be smaller than the key popped last.
+ *
+ * 桶 i 放的是和上一次弹出的 key (last_) 从第 i 位开始不同的元素，也就是 bit_width(key ^ last_) == i；
+ * 桶 0 里全都等于 last_，可以直接弹出。桶 0 空了，就在第一个非空的桶里找最小值作为新的 last_，
+ * 把这个桶里的元素重新分到更低的桶里。每个元素最多往下走 key 的位数那么多次。
+ */
+template <typename Key, typename Value>
+class radix_heap {
+    static_assert(std::is_unsigned<Key>::value, "radix_heap needs unsigned integer keys");
+    static const std::size_t kBuckets = std::numeric_limits<Key>::digits + 1;
+
+public:
+    radix_heap() : buckets_(kBuckets), last_(0), size_(0) {}
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+
+    void push(Key key, const Value& value)
+    {
+        buckets_[bucket(key)].push_back(std::make_pair(key, value));
+        ++size_;
+    }
+
+    Key top_key()
+    {
+        pull();
+        return last_;
+    }
+
+    const Value& top_value()
+    {
+        pull();
+        return buckets_[0].back().second;
+    }
+
+    void pop()
+    {
+        pull();
+        buckets_[0].pop_back();
+        --size_;
+    }
+
+    void clear()
+    {
+        for (auto& b : buckets_) {
+            b.clear();
+        }
+        last_ = 0;
+        size_ = 0;
+    }
+
+private:
+    std::size_t bucket(Key key) const
+    {
+        const unsigned long long diff = static_cast<unsigned long long>(key ^ last_);
+        return diff == 0 ? 0 : static_cast<std::size_t>(64 - __builtin_clzll(diff));
+    }
+
+    // makes bucket 0 non-empty
+    void pull()
+    {
+        if (!buckets_[0].empty())
+            return;
+        std::size_t i = 1;
+        while (buckets_[i].empty()) {
+            ++i;
+        }
+        std::vector<std::pair<Key, Value>>& from = buckets_[i];
+        Key smallest = from[0].first;
+        for (const auto& e : from) {
+            smallest = std::min(smallest, e.first);
+        }
+        last_ = smallest;
+        for (auto& e : from) {
+            buckets_[bucket(e.first)].push_back(std::move(e));
+        }
+        from.clear();
+    }
+
+    std::vector<std::vector<std::pair<Key, Value>>> buckets_;
+    Key last_;
+    std::size_t size_;
+};
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_HEAP_KERNELS_H
@@ -1,7 +1,9 @@
 #include "mutating.h"
 #include "helper.h"
+#include "random_kernels.h"
 
 #include <cstdlib>
+#include <random>
 
 using namespace std;
 
@@ -155,13 +157,17 @@ void shuffling_demo()
           which should return a random number greater than or equal to zero and less than max. Thus, it
           should not return max itself.
         • For shuffle(), you should not pass an engine just temporarily created.
+
+        random_shuffle() 在 C++14 里被标记为 deprecated，C++17 里被删除了 (它通常基于 rand()，
+        质量差，多线程下也无法复现)，所以这里只演示 shuffle()。更快的 engine 见 random_kernels.h
      */
 
     vector<int> coll;
     helper::INSERT_ELEMENTS(coll, 1, 9);
     helper::PRINT_ELEMENT(coll, "coll: ");
 
-    random_shuffle(coll.begin(), coll.end());
+    random_kernels::xoshiro256ss rng(42);
+    std::shuffle(coll.begin(), coll.end(), rng);
     helper::PRINT_ELEMENT(coll, "coll shuffled: ");
 
     sort(coll.begin(), coll.end());
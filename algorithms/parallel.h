@@ -0,0 +1,132 @@
+#ifndef STL_DEMO_ALGORITHMS_PARALLEL_H
+#define STL_DEMO_ALGORITHMS_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace algorithms {
+namespace parallel {
+
+/*
+ * Minimal fork/join helpers on top of std::thread, shared by the *_kernels.h files.
+ *
+ * 区间 [0, n) 被切成若干块，每个线程处理一块；调用线程自己处理最后一块，然后 join 其它线程。
+ * 数据量小于 min_per_thread * 2 时不开线程，直接在当前线程里完成，避免线程创建的开销。
+ */
+
+// hardware threads, or the value of the STL_DEMO_THREADS environment variable if it is set
+inline std::size_t thread_count()
+{
+    static const std::size_t count = [] {
+        const char* env = std::getenv("STL_DEMO_THREADS");
+        const long requested = env ? std::atol(env) : 0;
+        if (requested > 0)
+            return static_cast<std::size_t>(requested);
+        const unsigned hw = std::thread::hardware_concurrency();
+        return static_cast<std::size_t>(hw == 0 ? 2 : hw);
+    }();
+    return count;
+}
+
+// number of chunks worth running for n elements
+inline std::size_t chunk_count(std::size_t n, std::size_t min_per_thread)
+{
+    const std::size_t hw = thread_count();
+    std::size_t by_size = min_per_thread == 0 ? n : n / min_per_thread;
+    return std::max<std::size_t>(1, std::min(hw, by_size));
+}
+
+// fn(chunk_index, begin, end) for every chunk; chunks are contiguous and in order
+template <typename Fn>
+void for_each_chunk(std::size_t n, std::size_t chunks, Fn fn)
+{
+    if (chunks <= 1) {
+        fn(std::size_t(0), std::size_t(0), n);
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(chunks - 1);
+    const std::size_t step = n / chunks;
+    for (std::size_t c = 0; c + 1 < chunks; ++c) {
+        threads.push_back(std::thread(fn, c, c * step, (c + 1) * step));
+    }
+    fn(chunks - 1, (chunks - 1) * step, n);
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+template <typename Fn>
+void for_each_chunk_min(std::size_t n, std::size_t min_per_thread, Fn fn)
+{
+    for_each_chunk(n, chunk_count(n, min_per_thread), fn);
+}
+
+/*
+ * Earliest match over [0, n).
+ *
+ * search(begin, end) returns the index of the first match inside [begin, end), or `n`.
+ * Neighbouring blocks overlap by `overlap` elements (needle length - 1 for a sub range search),
+ * so a match that crosses a block border is still seen by the block it starts in.
+ * Every chunk is processed in blocks; once another thread has found a match before the current
+ * block, the chunk stops early, so the cost after the first hit is at most one block per thread.
+ */
+template <typename Search>
+std::size_t first_match(std::size_t n, std::size_t overlap, std::size_t min_per_thread, Search search)
+{
+    const std::size_t kBlock = 1 << 16;
+    std::atomic<std::size_t> best(n);
+    for_each_chunk_min(n, min_per_thread, [&] (std::size_t, std::size_t b, std::size_t e) {
+        for (std::size_t sb = b; sb < e; sb += kBlock) {
+            if (best.load(std::memory_order_relaxed) <= sb)
+                return;
+            const std::size_t se = std::min(e, sb + kBlock);
+            const std::size_t hit = search(sb, std::min(n, se + overlap));
+            if (hit < se) {
+                std::size_t cur = best.load();
+                while (hit < cur && !best.compare_exchange_weak(cur, hit)) {
+                }
+                return;
+            }
+        }
+    });
+    return best.load();
+}
+
+/*
+ * Latest match over [0, n), the mirror image of first_match(): blocks are scanned from the back
+ * and search(begin, end) has to return the index of the *last* match inside [begin, end), or `n`.
+ */
+template <typename Search>
+std::size_t last_match(std::size_t n, std::size_t overlap, std::size_t min_per_thread, Search search)
+{
+    const std::size_t kBlock = 1 << 16;
+    const std::size_t none = n;
+    std::atomic<std::size_t> best(none);
+    for_each_chunk_min(n, min_per_thread, [&] (std::size_t, std::size_t b, std::size_t e) {
+        for (std::size_t se = e; se > b;) {
+            const std::size_t sb = se - std::min(se - b, kBlock);
+            const std::size_t cur_best = best.load(std::memory_order_relaxed);
+            if (cur_best != none && cur_best >= se)
+                return;
+            const std::size_t hit = search(sb, std::min(n, se + overlap));
+            if (hit != none) {
+                std::size_t cur = best.load();
+                while ((cur == none || hit > cur) && !best.compare_exchange_weak(cur, hit)) {
+                }
+                return;
+            }
+            se = sb;
+        }
+    });
+    return best.load();
+}
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_PARALLEL_H
@@ -0,0 +1,140 @@
+#include "partition_kernels.h"
+#include "helper.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace algorithms {
+namespace partition_kernels {
+
+// moving_partition_demo() of mutating.cpp and nth_element_demo() of sorting.cpp
+void same_as_std_demo()
+{
+    vector<int> coll1;
+    helper::INSERT_ELEMENTS(coll1, 1, 9);
+    vector<int> coll2(coll1);
+
+    auto pos1 = parallel::partition(coll1.begin(), coll1.end(), [] (int elem) { return elem % 2 == 0; });
+    helper::PRINT_ELEMENT(coll1, "coll1 partitioned: ");
+    cout << "first odd element: " << *pos1 << endl;
+    auto pos2 = parallel::stable_partition(coll2.begin(), coll2.end(), [] (int elem) { return elem % 2 == 0; });
+    helper::PRINT_ELEMENT(coll2, "coll2 stable partitioned: ");
+    cout << "first odd element: " << *pos2 << endl;
+
+    vector<int> coll;
+    helper::INSERT_ELEMENTS(coll, 3, 7);
+    helper::INSERT_ELEMENTS(coll, 2, 6);
+    helper::INSERT_ELEMENTS(coll, 1, 5);
+    parallel::nth_element(coll.begin(), coll.begin() + 3, coll.end());
+    helper::PRINT_ELEMENT(coll, "four lowest in front: ");
+    parallel::partial_sort(coll.begin(), coll.begin() + 5, coll.end());
+    helper::PRINT_ELEMENT(coll, "first five sorted: ");
+
+    // a stream of values, only the 3 largest are kept
+    top_k<int> best(3);
+    for (int x : {5, 1, 9, 7, 3, 8, 2}) {
+        best.push(x);
+    }
+    helper::PRINT_ELEMENT(best.sorted(), "top 3: ");
+    top_k<int, greater<int>> smallest(3);
+    smallest.push(coll.begin(), coll.end());
+    helper::PRINT_ELEMENT(smallest.sorted(), "3 smallest: ");
+}
+
+// with many elements the parallel code paths run (more of them with STL_DEMO_THREADS=8)
+bool cross_check()
+{
+    mt19937 gen(7);
+    uniform_int_distribution<int> val(0, 1000);
+    vector<int> data(3000000);
+    for (auto& x : data) {
+        x = val(gen);
+    }
+    auto is_even = [] (int x) { return x % 2 == 0; };
+
+    vector<int> a(data), b(data);
+    auto pa = parallel::partition(a.begin(), a.end(), is_even);
+    auto pb = std::partition(b.begin(), b.end(), is_even);
+    bool ok = pa - a.begin() == pb - b.begin() && std::is_partitioned(a.begin(), a.end(), is_even);
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    ok = ok && a == b;
+
+    a = data;
+    b = data;
+    parallel::stable_partition(a.begin(), a.end(), is_even);
+    std::stable_partition(b.begin(), b.end(), is_even);
+    ok = ok && a == b;
+
+    a = data;
+    b = data;
+    const size_t nth = data.size() / 3;
+    parallel::nth_element(a.begin(), a.begin() + nth, a.end());
+    std::nth_element(b.begin(), b.begin() + nth, b.end());
+    ok = ok && a[nth] == b[nth] && *std::max_element(a.begin(), a.begin() + nth) <= a[nth] &&
+         *std::min_element(a.begin() + nth, a.end()) >= a[nth];
+
+    std::partial_sort(b.begin(), b.begin() + 100, b.end(), greater<int>());
+    vector<int> best = parallel::top_k(data.begin(), data.end(), 100);
+    ok = ok && std::equal(best.begin(), best.end(), b.begin());
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+void benchmark()
+{
+    // top 100 of 100M scores
+    const size_t kScores = 100000000;
+    const size_t k = 100;
+    mt19937 gen(42);
+    uniform_real_distribution<float> score(0.0f, 1.0f);
+    vector<float> scores(kScores);
+    for (auto& s : scores) {
+        s = score(gen);
+    }
+
+    vector<float> work(scores);
+    long long t = time_ms([&] { std::partial_sort(work.begin(), work.begin() + k, work.end(), greater<float>()); });
+    cout << "std::partial_sort: " << t << " ms, best " << work[0] << endl;
+
+    work = scores;
+    t = time_ms([&] { std::nth_element(work.begin(), work.begin() + k, work.end(), greater<float>()); });
+    cout << "std::nth_element: " << t << " ms" << endl;
+
+    work = scores;
+    t = time_ms([&] { parallel::nth_element(work.begin(), work.begin() + k, work.end(), greater<float>()); });
+    cout << "parallel::nth_element: " << t << " ms" << endl;
+
+    vector<float> best;
+    t = time_ms([&] { best = parallel::top_k(scores.begin(), scores.end(), k); });
+    cout << "parallel::top_k (read only, no copy): " << t << " ms, best " << best[0] << endl;
+
+    work = scores;
+    t = time_ms([&] { std::partition(work.begin(), work.end(), [] (float s) { return s > 0.5f; }); });
+    cout << "std::partition: " << t << " ms" << endl;
+    work = scores;
+    t = time_ms([&] { parallel::partition(work.begin(), work.end(), [] (float s) { return s > 0.5f; }); });
+    cout << "parallel::partition: " << t << " ms (" << algorithms::parallel::thread_count() << " threads)" << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
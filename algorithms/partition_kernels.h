@@ -0,0 +1,326 @@
+#ifndef STL_DEMO_ALGORITHMS_PARTITION_KERNELS_H
+#define STL_DEMO_ALGORITHMS_PARTITION_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+
+namespace algorithms {
+namespace partition_kernels {
+
+/*
+ * Selection without full sorting, for top-k queries:
+ *
+ *     top_k<T, Compare>                 streaming accumulator: keeps the k greatest elements seen so far
+ *                                       in a bounded min-heap, accumulators of several threads can be merged
+ *     parallel::partition()             like std::partition, order inside both groups is unspecified
+ *     parallel::stable_partition()      like std::stable_partition
+ *     parallel::nth_element()           introselect, every partition step runs on all threads
+ *     parallel::partial_sort()          nth_element + sorting the front part
+ *     parallel::top_k()                 one top_k accumulator per thread, merged at the end
+ *
+ * 所有 parallel:: 函数只接受随机访问迭代器，数据量小的时候直接调用 std:: 版本。
+ */
+
+/*
+ * Keeps the k greatest elements according to Compare (std::less: the k largest values).
+ * The heap top is the smallest of them, i.e. the threshold a new element has to beat, so for a stream
+ * of n values only the rare winners pay O(log k), everybody else one comparison.
+ */
+template <typename T, typename Compare = std::less<T>>
+class top_k {
+public:
+    explicit top_k(std::size_t k, Compare comp = Compare()) : k_(k), comp_(comp)
+    {
+        heap_.reserve(k);
+    }
+
+    void push(const T& x)
+    {
+        if (heap_.size() < k_) {
+            heap_.push_back(x);
+            std::push_heap(heap_.begin(), heap_.end(), heap_order());
+        } else if (k_ > 0 && comp_(heap_.front(), x)) {
+            std::pop_heap(heap_.begin(), heap_.end(), heap_order());
+            heap_.back() = x;
+            std::push_heap(heap_.begin(), heap_.end(), heap_order());
+        }
+    }
+
+    template <typename InputIterator>
+    void push(InputIterator first, InputIterator last)
+    {
+        for (; first != last; ++first) {
+            push(*first);
+        }
+    }
+
+    void merge(const top_k& other)
+    {
+        push(other.heap_.begin(), other.heap_.end());
+    }
+
+    std::size_t size() const { return heap_.size(); }
+    std::size_t capacity() const { return k_; }
+
+    // the smallest of the kept elements; only meaningful when size() == capacity()
+    const T& threshold() const { return heap_.front(); }
+
+    // the kept elements, greatest first
+    std::vector<T> sorted() const
+    {
+        std::vector<T> result(heap_);
+        std::sort_heap(result.begin(), result.end(), heap_order());
+        return result;
+    }
+
+private:
+    // min-heap with respect to comp_
+    struct inverted {
+        const top_k* self;
+        bool operator()(const T& a, const T& b) const { return self->comp_(b, a); }
+    };
+
+    inverted heap_order() const
+    {
+        inverted order = {this};
+        return order;
+    }
+
+    std::size_t k_;
+    Compare comp_;
+    std::vector<T> heap_;
+};
+
+namespace parallel {
+
+static const std::size_t kMinPerThread = 1 << 16;
+
+namespace detail {
+
+typedef std::pair<std::size_t, std::size_t> interval; // [first, second)
+
+// swaps the elements of two interval lists of equal total length, position by position, on all threads
+template <typename It>
+void swap_intervals(It first, const std::vector<interval>& a, const std::vector<interval>& b, std::size_t total)
+{
+    algorithms::parallel::for_each_chunk_min(total, kMinPerThread, [&] (std::size_t, std::size_t from, std::size_t to) {
+        // seek both lists to offset `from`
+        std::size_t ia = 0, ib = 0, oa = from, ob = from;
+        while (oa >= a[ia].second - a[ia].first) {
+            oa -= a[ia].second - a[ia].first;
+            ++ia;
+        }
+        while (ob >= b[ib].second - b[ib].first) {
+            ob -= b[ib].second - b[ib].first;
+            ++ib;
+        }
+        std::size_t pa = a[ia].first + oa, pb = b[ib].first + ob;
+        for (std::size_t i = from; i < to; ++i) {
+            std::iter_swap(first + pa, first + pb);
+            if (++pa == a[ia].second && ++ia < a.size())
+                pa = a[ia].first;
+            if (++pb == b[ib].second && ++ib < b.size())
+                pb = b[ib].first;
+        }
+    });
+}
+
+} // namespace detail
+
+/*
+ * Every thread partitions its own chunk. Afterwards the misplaced elements are exactly the "false"
+ * tails of the chunks that lie left of the final split point and the "true" heads that lie right of it;
+ * both sets have the same size and are swapped pairwise, again by all threads.
+ */
+template <typename It, typename Pred>
+It partition(It first, It last, Pred pred)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t chunks = algorithms::parallel::chunk_count(n, kMinPerThread);
+    if (chunks <= 1)
+        return std::partition(first, last, pred);
+
+    std::vector<std::size_t> begins(chunks), ends(chunks), trues(chunks);
+    algorithms::parallel::for_each_chunk(n, chunks, [&] (std::size_t c, std::size_t b, std::size_t e) {
+        begins[c] = b;
+        ends[c] = e;
+        trues[c] = static_cast<std::size_t>(std::partition(first + b, first + e, pred) - (first + b));
+    });
+
+    std::size_t split = 0;
+    for (std::size_t c = 0; c < chunks; ++c) {
+        split += trues[c];
+    }
+    std::vector<detail::interval> false_left, true_right;
+    std::size_t total = 0;
+    for (std::size_t c = 0; c < chunks; ++c) {
+        const std::size_t mid = begins[c] + trues[c];
+        if (mid < split && mid < ends[c]) {
+            false_left.push_back(detail::interval(mid, std::min(ends[c], split)));
+            total += false_left.back().second - false_left.back().first;
+        }
+        if (mid > split && begins[c] < mid)
+            true_right.push_back(detail::interval(std::max(begins[c], split), mid));
+    }
+    if (total > 0)
+        detail::swap_intervals(first, false_left, true_right, total);
+    return first + split;
+}
+
+/*
+ * Pass 1 evaluates the predicate once per element and counts the matches per chunk; the prefix sums of
+ * the counts give every chunk its output positions, pass 2 moves the elements into a buffer and pass 3
+ * moves them back. The buffer needs a default constructible value type.
+ */
+template <typename It, typename Pred>
+It stable_partition(It first, It last, Pred pred)
+{
+    typedef typename std::iterator_traits<It>::value_type V;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t chunks = algorithms::parallel::chunk_count(n, kMinPerThread);
+    if (chunks <= 1)
+        return std::stable_partition(first, last, pred);
+
+    std::vector<unsigned char> flags(n);
+    std::vector<std::size_t> trues(chunks), true_pos(chunks), false_pos(chunks);
+    algorithms::parallel::for_each_chunk(n, chunks, [&] (std::size_t c, std::size_t b, std::size_t e) {
+        std::size_t t = 0;
+        for (std::size_t i = b; i < e; ++i) {
+            flags[i] = pred(first[i]) ? 1 : 0;
+            t += flags[i];
+        }
+        trues[c] = t;
+    });
+
+    std::size_t split = 0;
+    for (std::size_t c = 0; c < chunks; ++c) {
+        split += trues[c];
+    }
+    const std::size_t step = n / chunks;
+    for (std::size_t c = 0, t = 0, f = split; c < chunks; ++c) {
+        true_pos[c] = t;
+        false_pos[c] = f;
+        const std::size_t len = (c + 1 == chunks ? n : (c + 1) * step) - c * step;
+        t += trues[c];
+        f += len - trues[c];
+    }
+
+    std::vector<V> buffer(n);
+    algorithms::parallel::for_each_chunk(n, chunks, [&] (std::size_t c, std::size_t b, std::size_t e) {
+        std::size_t t = true_pos[c], f = false_pos[c];
+        for (std::size_t i = b; i < e; ++i) {
+            buffer[flags[i] ? t++ : f++] = std::move(first[i]);
+        }
+    });
+    algorithms::parallel::for_each_chunk(n, chunks, [&] (std::size_t, std::size_t b, std::size_t e) {
+        std::move(buffer.begin() + b, buffer.begin() + e, first + b);
+    });
+    return first + split;
+}
+
+/*
+ * Introselect with sampled pivots (in the spirit of Floyd-Rivest): the pivot is taken from a sorted
+ * sample at about the rank nth has in the range, shifted a little towards the larger side, so that nth
+ * almost always lands in the *smaller* part. One round therefore costs one parallel partition of the
+ * range plus, at most, one of the small part (to split off the elements equal to the pivot).
+ * Small ranges, and ranges that did not shrink fast enough (2 * log2(n) rounds), are finished by
+ * std::nth_element.
+ */
+template <typename It, typename Compare>
+void nth_element(It first, It nth, It last, Compare comp)
+{
+    typedef typename std::iterator_traits<It>::value_type V;
+    const std::size_t kSequential = 4 * kMinPerThread;
+    const std::size_t kSample = 1023;
+    const std::size_t kMargin = 32; // about two standard deviations of the sampled rank
+    std::size_t rounds = 0;
+    for (std::size_t n = static_cast<std::size_t>(last - first); n > 1; n >>= 1) {
+        rounds += 2;
+    }
+
+    while (static_cast<std::size_t>(last - first) > kSequential && rounds-- > 0) {
+        const std::size_t n = static_cast<std::size_t>(last - first);
+        std::vector<V> sample;
+        sample.reserve(kSample);
+        for (std::size_t i = 0; i < kSample; ++i) {
+            sample.push_back(first[i * (n / kSample)]);
+        }
+        const std::size_t rank = static_cast<std::size_t>((nth - first) * double(kSample) / n);
+        const std::size_t pick = rank < kSample / 2 ? std::min(kSample - 1, rank + kMargin)
+                                                    : (rank > kMargin ? rank - kMargin : 0);
+        std::nth_element(sample.begin(), sample.begin() + pick, sample.end(), comp);
+        const V pivot = sample[pick];
+
+        It lower = parallel::partition(first, last, [&] (const V& x) { return comp(x, pivot); });
+        if (nth < lower) {
+            last = lower;
+            continue;
+        }
+        // the pivot is an element of the range, so this part is never empty
+        It upper = parallel::partition(lower, last, [&] (const V& x) { return !comp(pivot, x); });
+        if (nth < upper)
+            return;
+        first = upper;
+    }
+    std::nth_element(first, nth, last, comp);
+}
+
+template <typename It>
+void nth_element(It first, It nth, It last)
+{
+    parallel::nth_element(first, nth, last, std::less<typename std::iterator_traits<It>::value_type>());
+}
+
+template <typename It, typename Compare>
+void partial_sort(It first, It middle, It last, Compare comp)
+{
+    if (middle == first)
+        return;
+    if (middle != last)
+        parallel::nth_element(first, middle, last, comp);
+    std::sort(first, middle, comp);
+}
+
+template <typename It>
+void partial_sort(It first, It middle, It last)
+{
+    parallel::partial_sort(first, middle, last, std::less<typename std::iterator_traits<It>::value_type>());
+}
+
+// the k greatest elements of [first, last), greatest first
+template <typename It, typename Compare>
+std::vector<typename std::iterator_traits<It>::value_type> top_k(It first, It last, std::size_t k, Compare comp)
+{
+    typedef typename std::iterator_traits<It>::value_type V;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t chunks = algorithms::parallel::chunk_count(n, std::max(kMinPerThread, k));
+    std::vector<partition_kernels::top_k<V, Compare>> partial(chunks, partition_kernels::top_k<V, Compare>(k, comp));
+    algorithms::parallel::for_each_chunk(n, chunks, [&] (std::size_t c, std::size_t b, std::size_t e) {
+        partial[c].push(first + b, first + e);
+    });
+    for (std::size_t c = 1; c < chunks; ++c) {
+        partial[0].merge(partial[c]);
+    }
+    return partial[0].sorted();
+}
+
+template <typename It>
+std::vector<typename std::iterator_traits<It>::value_type> top_k(It first, It last, std::size_t k)
+{
+    return parallel::top_k(first, last, k, std::less<typename std::iterator_traits<It>::value_type>());
+}
+
+} // namespace parallel
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_PARTITION_KERNELS_H
@@ -0,0 +1,227 @@
+#include "permute_kernels.h"
+#include "helper.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace algorithms {
+namespace permute_kernels {
+
+// permuting_demo() of mutating.cpp
+void same_as_std_demo()
+{
+    vector<int> coll;
+    helper::INSERT_ELEMENTS(coll, 1, 3);
+    helper::PRINT_ELEMENT(coll, "coll: ");
+
+    // 每一步只交换一次，顺序不是字典序
+    cout << "heap:" << endl;
+    for_each_permutation_heap(coll.begin(), coll.end(), [] (vector<int>::iterator b, vector<int>::iterator e) {
+        helper::PRINT_ELEMENT(vector<int>(b, e));
+    });
+    coll = {1, 2, 3};
+    cout << "plain changes:" << endl;
+    for_each_permutation_plain(coll.begin(), coll.end(), [] (vector<int>::iterator b, vector<int>::iterator e) {
+        helper::PRINT_ELEMENT(vector<int>(b, e));
+    });
+
+    // rank <-> permutation, the same order as next_permutation()
+    coll = {1, 2, 3, 4};
+    unrank_permutation(13, coll.begin(), coll.end());
+    helper::PRINT_ELEMENT(coll, "permutation 13 of 1..4: ");
+    cout << "rank: " << permutation_rank(coll.begin(), coll.end()) << endl;
+
+    // 2 of 4
+    vector<string> names = {"ann", "bob", "cid", "dan"};
+    cout << "pairs: ";
+    for_each_combination(names.begin(), names.end(), 2, [] (vector<string>::const_iterator b, vector<string>::const_iterator) {
+        cout << b[0] << "+" << b[1] << " ";
+    });
+    cout << endl;
+    cout << "3-subsets of 5 as masks: ";
+    for_each_k_subset(5, 3, [] (uint64_t mask) { cout << mask << "(" << k_subset_rank(mask) << ") "; });
+    cout << endl;
+}
+
+bool cross_check()
+{
+    bool ok = true;
+    // both orders visit n! distinct permutations
+    for (size_t n = 0; n <= 8; ++n) {
+        vector<int> v(n);
+        iota(v.begin(), v.end(), 0);
+        set<vector<int>> heap_seen, plain_seen;
+        for_each_permutation_heap(v.begin(), v.end(), [&] (vector<int>::iterator b, vector<int>::iterator e) {
+            heap_seen.insert(vector<int>(b, e));
+        });
+        iota(v.begin(), v.end(), 0);
+        size_t steps = 0;
+        vector<int> prev(v);
+        for_each_permutation_plain(v.begin(), v.end(), [&] (vector<int>::iterator b, vector<int>::iterator e) {
+            plain_seen.insert(vector<int>(b, e));
+            // exactly one adjacent pair changed
+            size_t diff = 0;
+            for (size_t i = 0; i < n; ++i) {
+                diff += prev[i] != b[i];
+            }
+            ok = ok && (steps == 0 ? diff == 0 : diff == 2);
+            prev.assign(b, e);
+            ++steps;
+        });
+        ok = ok && heap_seen.size() == factorial(n) && plain_seen.size() == factorial(n) && steps == factorial(n);
+    }
+
+    // rank/unrank against next_permutation()
+    vector<int> v = {1, 2, 3, 4, 5, 6};
+    for (uint64_t r = 0; r < factorial(6); ++r) {
+        vector<int> u = {1, 2, 3, 4, 5, 6};
+        unrank_permutation(r, u.begin(), u.end());
+        ok = ok && u == v && permutation_rank(v.begin(), v.end()) == r;
+        next_permutation(v.begin(), v.end());
+    }
+
+    // Gosper order, subset ranks, and the parallel split
+    for (size_t n = 1; n <= 20; n += 3) {
+        for (size_t k = 0; k <= n; k += 2) {
+            uint64_t r = 0;
+            for_each_k_subset(n, k, [&] (uint64_t mask) {
+                ok = ok && static_cast<size_t>(__builtin_popcountll(mask)) == k && k_subset_rank(mask) == r &&
+                     k_subset_unrank(r, k) == mask;
+                ++r;
+            });
+            ok = ok && r == binomial(n, k);
+            vector<uint64_t> sums(algorithms::parallel::thread_count() + 1, 0);
+            parallel::for_each_k_subset(n, k, [&] (size_t c, uint64_t mask) { sums[c] += mask; });
+            uint64_t expected = 0;
+            for_each_k_subset(n, k, [&] (uint64_t mask) { expected += mask; });
+            ok = ok && accumulate(sums.begin(), sums.end(), uint64_t(0)) == expected;
+        }
+    }
+
+    // parallel search == sequential search, including the tie break
+    vector<int> w = {4, 1, 3, 0, 2, 6, 5, 7};
+    auto cost = [] (const int* b, const int* e) {
+        int s = 0;
+        for (const int* p = b + 1; p < e; ++p) {
+            s += (p[-1] - p[0]) * (p[-1] - p[0]) % 5;
+        }
+        return s;
+    };
+    vector<int> s(w);
+    sort(s.begin(), s.end());
+    vector<int> best_seq;
+    int best_cost = 1 << 30;
+    do {
+        const int c = cost(s.data(), s.data() + s.size());
+        if (c < best_cost) {
+            best_cost = c;
+            best_seq = s;
+        }
+    } while (next_permutation(s.begin(), s.end()));
+    ok = ok && parallel::best_permutation(w.begin(), w.end(), cost) == best_cost && w == best_seq;
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+// the shortest open route through 11 cities, which start at a fixed depot
+void benchmark()
+{
+    const size_t kCities = 11;
+    mt19937 gen(3);
+    uniform_real_distribution<double> coord(0, 100);
+    vector<double> x(kCities + 1), y(kCities + 1);
+    for (size_t i = 0; i <= kCities; ++i) {
+        x[i] = coord(gen);
+        y[i] = coord(gen);
+    }
+    // city kCities is the depot
+    vector<double> dist((kCities + 1) * (kCities + 1));
+    for (size_t i = 0; i <= kCities; ++i) {
+        for (size_t j = 0; j <= kCities; ++j) {
+            dist[i * (kCities + 1) + j] = hypot(x[i] - x[j], y[i] - y[j]);
+        }
+    }
+    auto d = [&] (size_t a, size_t b) { return dist[a * (kCities + 1) + b]; };
+    auto route = [&] (const size_t* b, const size_t* e) {
+        double len = d(kCities, *b);
+        for (const size_t* p = b + 1; p < e; ++p) {
+            len += d(p[-1], *p);
+        }
+        return len;
+    };
+
+    vector<size_t> order(kCities);
+    double best = 0;
+    iota(order.begin(), order.end(), 0);
+    long long t = time_ms([&] {
+        best = 1e300;
+        do {
+            best = min(best, route(order.data(), order.data() + kCities));
+        } while (next_permutation(order.begin(), order.end()));
+    });
+    cout << "next_permutation + full cost: " << t << " ms, best " << best << endl;
+
+    iota(order.begin(), order.end(), 0);
+    t = time_ms([&] {
+        best = 1e300;
+        for_each_permutation_heap(order.begin(), order.end(), [&] (vector<size_t>::iterator b, vector<size_t>::iterator) {
+            best = min(best, route(&*b, &*b + kCities));
+        });
+    });
+    cout << "heap + full cost: " << t << " ms, best " << best << endl;
+
+    // 相邻交换只改变三条边，所以代价可以增量更新
+    iota(order.begin(), order.end(), 0);
+    t = time_ms([&] {
+        const size_t* o = order.data();
+        auto at = [&] (size_t i) { return i == 0 ? kCities : o[i - 1]; };  // position 0 is the depot
+        double len = route(o, o + kCities);
+        best = len;
+        plain_changes steps(kCities);
+        size_t i;
+        while (steps.next(i)) {
+            // swap o[i] and o[i + 1]; positions shifted by one for the depot
+            const size_t a = at(i), u = o[i], v = o[i + 1];
+            len -= d(a, u) + d(u, v);
+            len += d(a, v) + d(v, u);
+            if (i + 2 < kCities) {
+                const size_t c = o[i + 2];
+                len += d(u, c) - d(v, c);
+            }
+            swap(order[i], order[i + 1]);
+            best = min(best, len);
+        }
+    });
+    cout << "plain changes + O(1) update: " << t << " ms, best " << best << endl;
+
+    iota(order.begin(), order.end(), 0);
+    t = time_ms([&] { best = parallel::best_permutation(order.begin(), order.end(), route); });
+    cout << "parallel::best_permutation: " << t << " ms, best " << best << " ("
+         << algorithms::parallel::thread_count() << " threads)" << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
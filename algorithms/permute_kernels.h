@@ -0,0 +1,379 @@
+#ifndef STL_DEMO_ALGORITHMS_PERMUTE_KERNELS_H
+#define STL_DEMO_ALGORITHMS_PERMUTE_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+
+namespace algorithms {
+namespace permute_kernels {
+
+/*
+ * Enumeration of permutations and k-subsets, for permuting_demo() of mutating.cpp.
+ *
+ *     heap_order          Heap's algorithm: every permutation is one swap away from the previous one
+ *     plain_changes       Steinhaus-Johnson-Trotter, loopless: every step swaps two *adjacent* elements
+ *                         and costs O(1) in the worst case (focus pointers, no search for the mobile element)
+ *     next_k_subset()     Gosper's hack: the next larger integer with the same number of 1 bits
+ *     rank / unrank       lexicographic rank of a permutation (n <= 20), colex rank of a k-subset (n <= 63)
+ *     parallel::          the rank range [0, n!) or [0, C(n, k)) is cut into one block per thread,
+ *                         every thread unranks the start of its block and steps from there
+ *
+ * next_permutation() 每一步平均要比较、交换 e 次左右，并且结果是字典序；Heap 和 SJT 的顺序不是字典序，
+ * 但是每一步只交换一次。SJT 只交换相邻的两个元素，所以路径长度这类代价可以 O(1) 增量更新，不用每次从头算。
+ * heap_order / plain_changes 只产生交换的位置，由调用者自己去交换数据 (也可以同时更新代价)。
+ */
+
+// n! for n <= 20, the largest that fits into 64 bits
+inline std::uint64_t factorial(std::size_t n)
+{
+    std::uint64_t f = 1;
+    for (std::size_t i = 2; i <= n; ++i) {
+        f *= i;
+    }
+    return f;
+}
+
+// C(n, k) for n <= 64
+inline std::uint64_t binomial(std::size_t n, std::size_t k)
+{
+    static const std::vector<std::vector<std::uint64_t>> table = [] {
+        std::vector<std::vector<std::uint64_t>> t(65, std::vector<std::uint64_t>(65, 0));
+        for (std::size_t i = 0; i <= 64; ++i) {
+            t[i][0] = 1;
+            for (std::size_t j = 1; j <= i; ++j) {
+                t[i][j] = t[i - 1][j - 1] + (j < i ? t[i - 1][j] : 0);
+            }
+        }
+        return t;
+    }();
+    return k > n ? 0 : table[n][k];
+}
+
+/*
+ * Heap's algorithm, iterative. After construction the identity is the first permutation;
+ * next(i, j) returns false after the last one, otherwise the caller swaps positions i and j.
+ */
+class heap_order {
+public:
+    explicit heap_order(std::size_t n) : c_(n, 0), i_(1) {}
+
+    bool next(std::size_t& i, std::size_t& j)
+    {
+        while (i_ < c_.size()) {
+            if (c_[i_] < i_) {
+                i = i_ % 2 == 0 ? 0 : c_[i_];
+                j = i_;
+                ++c_[i_];
+                i_ = 1;
+                return true;
+            }
+            c_[i_] = 0;
+            ++i_;
+        }
+        return false;
+    }
+
+private:
+    std::vector<std::size_t> c_;
+    std::size_t i_;
+};
+
+/*
+ * Steinhaus-Johnson-Trotter with Even's directions and Ehrlich's focus pointers.
+ * next(i) returns false after the last permutation, otherwise the caller swaps positions i and i + 1.
+ *
+ * 最大的元素在其余 n - 1 个元素的每个排列上来回扫一遍，这 n - 1 步只是一个计数器 (sweep_)；
+ * 扫到头以后，其余 n - 1 个元素才用 focus pointer 走一步：
+ * 值 1..n-1 放在位置 1..n-1，两端各有一个值为 n 的哨兵，所以 "走到头" 和 "碰到更大的值" 是同一个判断，
+ * focus_[n - 1] 总是指向下一个要移动的值，和 Gray code 的 focus pointer 一样，不需要循环查找。
+ */
+class plain_changes {
+public:
+    explicit plain_changes(std::size_t n)
+        : m_(n == 0 ? 0 : n - 1), value_(m_ + 2), pos_(m_ + 2), dir_(m_ + 2, -1), focus_(m_ + 1),
+          sweep_(static_cast<std::ptrdiff_t>(m_) - 1), step_(-1), left_(m_), largest_first_(false)
+    {
+        for (std::size_t v = 0; v < m_ + 2; ++v) {
+            value_[v] = v;
+            pos_[v] = v;
+        }
+        value_[0] = value_[m_ + 1] = m_ + 1;
+        for (std::size_t v = 0; v <= m_; ++v) {
+            focus_[v] = v;
+        }
+    }
+
+    bool next(std::size_t& i)
+    {
+        if (left_ > 0) {
+            --left_;
+            i = static_cast<std::size_t>(sweep_);
+            sweep_ += step_;
+            return true;
+        }
+        std::size_t k;
+        if (!next_rest(k))
+            return false;
+        // the largest element sits at one end and turns around
+        largest_first_ = !largest_first_;
+        i = largest_first_ ? k + 1 : k;
+        step_ = -step_;
+        sweep_ = largest_first_ ? 0 : static_cast<std::ptrdiff_t>(m_) - 1;
+        left_ = m_;
+        return true;
+    }
+
+private:
+    // one plain change of the n - 1 smaller elements, k is relative to their block
+    bool next_rest(std::size_t& k)
+    {
+        const std::size_t m = focus_[m_];
+        focus_[m_] = m_;
+        if (m <= 1)
+            return false;
+        const std::size_t p = pos_[m];
+        const std::size_t q = p + dir_[m];
+        const std::size_t other = value_[q];
+        value_[p] = other;
+        value_[q] = m;
+        pos_[other] = p;
+        pos_[m] = q;
+        k = std::min(p, q) - 1;
+        if (value_[q + dir_[m]] > m) {
+            dir_[m] = -dir_[m];
+            focus_[m] = focus_[m - 1];
+            focus_[m - 1] = m - 1;
+        }
+        return true;
+    }
+
+    std::size_t m_;
+    std::vector<std::size_t> value_, pos_;
+    std::vector<std::ptrdiff_t> dir_;
+    std::vector<std::size_t> focus_;
+    std::ptrdiff_t sweep_, step_;
+    std::size_t left_;
+    bool largest_first_;
+};
+
+// f(first, last) for all n! orders of [first, last), one swap apart; the range ends up permuted
+template <typename It, typename F>
+void for_each_permutation_heap(It first, It last, F f)
+{
+    using std::swap;
+    heap_order order(static_cast<std::size_t>(std::distance(first, last)));
+    std::size_t i, j;
+    f(first, last);
+    while (order.next(i, j)) {
+        swap(first[i], first[j]);
+        f(first, last);
+    }
+}
+
+// f(first, last) for all n! orders of [first, last), one adjacent swap apart; the range ends up as (a1 a0 a2 a3 ...)
+template <typename It, typename F>
+void for_each_permutation_plain(It first, It last, F f)
+{
+    using std::swap;
+    plain_changes order(static_cast<std::size_t>(std::distance(first, last)));
+    std::size_t i;
+    f(first, last);
+    while (order.next(i)) {
+        swap(first[i], first[i + 1]);
+        f(first, last);
+    }
+}
+
+// Gosper's hack: the next larger integer with the same popcount; x != 0
+inline std::uint64_t next_k_subset(std::uint64_t x)
+{
+    const std::uint64_t lowest = x & (~x + 1);
+    const std::uint64_t ripple = x + lowest;
+    return (((ripple ^ x) >> 2) >> __builtin_ctzll(x)) | ripple;
+}
+
+// f(mask) for every k-subset of {0, ..., n - 1} in increasing order of mask, n <= 63
+template <typename F>
+void for_each_k_subset(std::size_t n, std::size_t k, F f)
+{
+    if (k > n)
+        return;
+    if (k == 0) {
+        f(std::uint64_t(0));
+        return;
+    }
+    const std::uint64_t end = std::uint64_t(1) << n;
+    for (std::uint64_t x = (std::uint64_t(1) << k) - 1; x < end; x = next_k_subset(x)) {
+        f(x);
+    }
+}
+
+// f(chosen.cbegin(), chosen.cend()) for every combination of k elements of [first, last), in order
+template <typename It, typename F>
+void for_each_combination(It first, It last, std::size_t k, F f)
+{
+    const std::vector<typename std::iterator_traits<It>::value_type> all(first, last);
+    std::vector<typename std::iterator_traits<It>::value_type> chosen;
+    chosen.reserve(k);
+    for_each_k_subset(all.size(), k, [&] (std::uint64_t mask) {
+        chosen.clear();
+        for (; mask != 0; mask &= mask - 1) {
+            chosen.push_back(all[__builtin_ctzll(mask)]);
+        }
+        f(chosen.cbegin(), chosen.cend());
+    });
+}
+
+/*
+ * Lexicographic rank of the permutation [first, last) of distinct elements, in [0, n!).
+ * 用 Lehmer code：第 i 位的数字是它后面比它小的元素个数，权重是 (n - 1 - i)!。
+ */
+template <typename It>
+std::uint64_t permutation_rank(It first, It last)
+{
+    const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    std::uint64_t rank = 0;
+    std::size_t i = 0;
+    for (It a = first; a != last; ++a, ++i) {
+        std::uint64_t smaller = 0;
+        for (It b = std::next(a); b != last; ++b) {
+            smaller += *b < *a;
+        }
+        rank += smaller * factorial(n - 1 - i);
+    }
+    return rank;
+}
+
+// turns the sorted range [first, last) of distinct elements into its rank-th lexicographic permutation
+template <typename It>
+void unrank_permutation(std::uint64_t rank, It first, It last)
+{
+    const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    for (std::size_t i = 0; i + 1 < n; ++i, ++first) {
+        const std::uint64_t f = factorial(n - 1 - i);
+        const std::size_t index = static_cast<std::size_t>(rank / f);
+        rank %= f;
+        It chosen = std::next(first, index);
+        std::rotate(first, chosen, std::next(chosen));
+    }
+}
+
+// position of mask among the k-subsets in the order of for_each_k_subset(): sum of C(c_i, i + 1)
+inline std::uint64_t k_subset_rank(std::uint64_t mask)
+{
+    std::uint64_t rank = 0;
+    for (std::size_t i = 1; mask != 0; mask &= mask - 1, ++i) {
+        rank += binomial(static_cast<std::size_t>(__builtin_ctzll(mask)), i);
+    }
+    return rank;
+}
+
+inline std::uint64_t k_subset_unrank(std::uint64_t rank, std::size_t k)
+{
+    std::uint64_t mask = 0;
+    std::size_t c = 63;
+    for (std::size_t i = k; i >= 1; --i) {
+        while (binomial(c, i) > rank) {
+            --c;
+        }
+        mask |= std::uint64_t(1) << c;
+        rank -= binomial(c, i);
+    }
+    return mask;
+}
+
+namespace parallel {
+
+// blocks of less than this many permutations or subsets are not worth a thread
+static const std::size_t kMinPerThread = 1 << 12;
+
+/*
+ * fn(chunk, begin, end) for every lexicographic permutation of the distinct elements [first, last),
+ * begin/end are const T* into a copy owned by the calling thread. fn is called concurrently.
+ */
+template <typename It, typename Fn>
+void for_each_permutation(It first, It last, Fn fn)
+{
+    typedef typename std::iterator_traits<It>::value_type T;
+    std::vector<T> sorted(first, last);
+    std::sort(sorted.begin(), sorted.end());
+    const std::uint64_t total = factorial(sorted.size());
+    algorithms::parallel::for_each_chunk_min(static_cast<std::size_t>(total), kMinPerThread,
+                                             [&] (std::size_t c, std::size_t b, std::size_t e) {
+        std::vector<T> local(sorted);
+        unrank_permutation(b, local.begin(), local.end());
+        const T* data = local.data();
+        for (std::size_t r = b; r < e; ++r) {
+            fn(c, data, data + local.size());
+            std::next_permutation(local.begin(), local.end());
+        }
+    });
+}
+
+/*
+ * Brute-force search: writes the lexicographically first permutation of minimal cost(begin, end)
+ * into [first, last) and returns that cost. cost takes const T* and is called concurrently.
+ */
+template <typename It, typename Cost>
+typename std::result_of<Cost(const typename std::iterator_traits<It>::value_type*,
+                             const typename std::iterator_traits<It>::value_type*)>::type
+best_permutation(It first, It last, Cost cost)
+{
+    typedef typename std::iterator_traits<It>::value_type T;
+    typedef typename std::result_of<Cost(const T*, const T*)>::type R;
+    const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    const std::size_t chunks = algorithms::parallel::chunk_count(static_cast<std::size_t>(factorial(n)), kMinPerThread);
+    std::vector<std::pair<R, std::vector<T>>> best(chunks);
+    std::vector<char> found(chunks, 0);
+    for_each_permutation(first, last, [&] (std::size_t c, const T* b, const T* e) {
+        const R value = cost(b, e);
+        if (!found[c] || value < best[c].first) {
+            found[c] = 1;
+            best[c].first = value;
+            best[c].second.assign(b, e);
+        }
+    });
+    // chunks are in rank order, so the earliest chunk wins a tie
+    std::size_t winner = 0;
+    for (std::size_t c = 1; c < chunks; ++c) {
+        if (best[c].first < best[winner].first)
+            winner = c;
+    }
+    std::copy(best[winner].second.begin(), best[winner].second.end(), first);
+    return best[winner].first;
+}
+
+// fn(chunk, mask) for every k-subset of {0, ..., n - 1}, n <= 63; fn is called concurrently
+template <typename Fn>
+void for_each_k_subset(std::size_t n, std::size_t k, Fn fn)
+{
+    if (k == 0 || k > n) {
+        permute_kernels::for_each_k_subset(n, k, [&] (std::uint64_t mask) { fn(std::size_t(0), mask); });
+        return;
+    }
+    const std::uint64_t total = binomial(n, k);
+    algorithms::parallel::for_each_chunk_min(static_cast<std::size_t>(total), kMinPerThread,
+                                             [&] (std::size_t c, std::size_t b, std::size_t e) {
+        std::uint64_t mask = k_subset_unrank(b, k);
+        for (std::size_t r = b; r < e; ++r) {
+            fn(c, mask);
+            mask = next_k_subset(mask);
+        }
+    });
+}
+
+}
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_PERMUTE_KERNELS_H
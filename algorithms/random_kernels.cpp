@@ -0,0 +1,202 @@
+#include "random_kernels.h"
+#include "helper.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace algorithms {
+namespace random_kernels {
+
+// shuffling_demo() of mutating.cpp
+void shuffling_demo()
+{
+    vector<int> coll;
+    helper::INSERT_ELEMENTS(coll, 1, 9);
+    helper::PRINT_ELEMENT(coll, "coll: ");
+
+    xoshiro256ss rng(42);
+    random_kernels::shuffle(coll.begin(), coll.end(), rng);
+    helper::PRINT_ELEMENT(coll, "coll shuffled: ");
+
+    // an URBG like any other: std::shuffle and the distributions accept it
+    pcg32 pcg(42, 54);
+    std::shuffle(coll.begin(), coll.end(), pcg);
+    helper::PRINT_ELEMENT(coll, "coll std::shuffle(pcg32): ");
+    normal_distribution<double> normal(0.0, 1.0);
+    cout << "normal(pcg32): " << normal(pcg) << endl;
+
+    // dice without modulo bias
+    cout << "dice: ";
+    for (int i = 0; i < 10; ++i) {
+        cout << uniform_index(rng, 6) + 1 << " ";
+    }
+    cout << endl;
+
+    // the same seed gives the same permutation, whatever the number of threads
+    parallel::shuffle(coll.begin(), coll.end(), 7);
+    helper::PRINT_ELEMENT(coll, "coll parallel::shuffle(seed 7): ");
+
+    // 3 lines out of a stream
+    reservoir<int> lines(3, xoshiro256ss(1));
+    for (int i = 1; i <= 1000; ++i) {
+        lines.push(i);
+    }
+    helper::PRINT_ELEMENT(lines.items(), "3 of 1000: ");
+}
+
+// the published first outputs of the reference implementations
+bool reference_check()
+{
+    pcg32 pcg(42, 54);
+    const uint32_t expected[] = {0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e};
+    bool ok = true;
+    for (uint32_t e : expected) {
+        ok = ok && pcg() == e;
+    }
+
+    // discard() in O(log n) lands on the same state as stepping
+    pcg32 a(7, 3), b(7, 3);
+    a.discard(12345);
+    for (int i = 0; i < 12345; ++i) {
+        b();
+    }
+    ok = ok && a == b;
+
+    splitmix64 sm(1234567);
+    ok = ok && sm() == 6457827717110365317ULL && sm() == 3203168211198807973ULL;
+    return ok;
+}
+
+// counts every permutation of 4 elements: all 24 have to show up about equally often
+template <typename Shuffle>
+bool uniform_permutations(Shuffle shuffle_once)
+{
+    const int kRounds = 240000;
+    map<vector<int>, int> counts;
+    for (int r = 0; r < kRounds; ++r) {
+        vector<int> v = {0, 1, 2, 3};
+        shuffle_once(v, r);
+        ++counts[v];
+    }
+    // expected 10000 each, the standard deviation is about 98
+    bool ok = counts.size() == 24;
+    for (const auto& c : counts) {
+        ok = ok && c.second > 9500 && c.second < 10500;
+    }
+    return ok;
+}
+
+bool cross_check()
+{
+    xoshiro256ss rng(3);
+    bool ok = reference_check();
+
+    ok = ok && uniform_permutations([&] (vector<int>& v, int) { random_kernels::shuffle(v.begin(), v.end(), rng); });
+    // merge shuffle with blocks of one element: every permutation comes from the merges
+    ok = ok && uniform_permutations([] (vector<int>& v, int r) {
+        parallel::detail::merge_shuffle(v.begin(), v.end(), static_cast<uint64_t>(r), 1);
+    });
+
+    // uniform_index(): bias check with a range that is not a power of 2
+    vector<int> buckets(7);
+    for (int i = 0; i < 700000; ++i) {
+        ++buckets[uniform_index(rng, 7)];
+    }
+    for (int b : buckets) {
+        ok = ok && b > 99000 && b < 101000;
+    }
+
+    // a large parallel shuffle is a permutation, and reproducible
+    vector<int> v(1000003), w;
+    iota(v.begin(), v.end(), 0);
+    w = v;
+    parallel::shuffle(v.begin(), v.end(), 99);
+    parallel::shuffle(w.begin(), w.end(), 99);
+    ok = ok && v == w;
+    sort(w.begin(), w.end());
+    for (size_t i = 0; i < w.size() && ok; ++i) {
+        ok = w[i] == static_cast<int>(i);
+    }
+
+    // sample(): every element equally likely to be picked
+    vector<int> hits(100);
+    vector<int> population(100);
+    iota(population.begin(), population.end(), 0);
+    for (int r = 0; r < 20000; ++r) {
+        vector<int> picked;
+        random_kernels::sample(population.begin(), population.end(), back_inserter(picked), 10, rng);
+        ok = ok && picked.size() == 10;
+        for (int p : picked) {
+            ++hits[p];
+        }
+    }
+    for (int h : hits) {
+        ok = ok && h > 1800 && h < 2200;
+    }
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+void benchmark()
+{
+    const size_t kValues = 50000000;
+    vector<uint32_t> data(kValues);
+    iota(data.begin(), data.end(), 0);
+
+    mt19937 mt(42);
+    long long t = time_ms([&] { std::shuffle(data.begin(), data.end(), mt); });
+    cout << "std::shuffle(mt19937): " << t << " ms" << endl;
+    xoshiro256ss rng(42);
+    t = time_ms([&] { random_kernels::shuffle(data.begin(), data.end(), rng); });
+    cout << "shuffle(xoshiro256ss): " << t << " ms" << endl;
+    pcg32 pcg(42);
+    t = time_ms([&] { random_kernels::shuffle(data.begin(), data.end(), pcg); });
+    cout << "shuffle(pcg32): " << t << " ms" << endl;
+    t = time_ms([&] { parallel::shuffle(data.begin(), data.end(), 42); });
+    cout << "parallel::shuffle: " << t << " ms (" << algorithms::parallel::thread_count() << " threads)" << endl;
+
+    // bounded integers: the distribution object vs. Lemire
+    uint64_t sum = 0;
+    uniform_int_distribution<uint32_t> dist(0, 999);
+    t = time_ms([&] {
+        for (size_t i = 0; i < kValues; ++i) {
+            sum += dist(mt);
+        }
+    });
+    cout << "uniform_int_distribution(mt19937): " << t << " ms" << endl;
+    t = time_ms([&] {
+        for (size_t i = 0; i < kValues; ++i) {
+            sum += uniform_index(rng, 1000);
+        }
+    });
+    cout << "uniform_index(xoshiro256ss): " << t << " ms (checksum " << sum % 1000 << ")" << endl;
+
+    // 1000 of 50M: algorithm L skips over almost all of them
+    vector<uint32_t> picked;
+    t = time_ms([&] { random_kernels::sample(data.begin(), data.end(), back_inserter(picked), 1000, rng); });
+    cout << "sample 1000 of " << kValues << ": " << t << " ms" << endl;
+}
+
+void Run()
+{
+    shuffling_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
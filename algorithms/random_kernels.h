@@ -0,0 +1,525 @@
+#ifndef STL_DEMO_ALGORITHMS_RANDOM_KERNELS_H
+#define STL_DEMO_ALGORITHMS_RANDOM_KERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+
+namespace algorithms {
+namespace random_kernels {
+
+/*
+ * Fast random numbers for shuffling and sampling:
+ *
+ *     splitmix64                 seeds the other engines (any 64 bit value gives a good state)
+ *     xoshiro256ss               xoshiro256** (Blackman/Vigna), 64 bit output, jump() for 2^128 independent streams
+ *     pcg32                      PCG-XSH-RR (O'Neill), 32 bit output, 2^63 selectable streams, discard() in O(log n)
+ *     uniform_index(gen, n)      Lemire's nearly divisionless bounded integer in [0, n)
+ *     shuffle(beg, end, gen)     Fisher-Yates with uniform_index()
+ *     parallel::shuffle()        MergeShuffle (Bacher et al.): the result only depends on the seed, not on the threads
+ *     reservoir<T>               k samples of a stream of unknown length (Li's algorithm L)
+ *     sample(beg, end, out, k)   the same for a range
+ *
+ * 三个 engine 都满足 UniformRandomBitGenerator (result_type, min(), max(), operator())，
+ * 所以也可以直接交给 std::shuffle, std::uniform_int_distribution 等标准库设施。
+ *
+ * 和 std::default_random_engine (libstdc++ 里是 minstd_rand0) 不同，它们在所有平台上输出相同的序列，
+ * 同一个种子总能复现同一个结果。
+ */
+
+class splitmix64 {
+public:
+    typedef std::uint64_t result_type;
+
+    explicit splitmix64(std::uint64_t seed = 0) : state_(seed) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+class xoshiro256ss {
+public:
+    typedef std::uint64_t result_type;
+
+    explicit xoshiro256ss(std::uint64_t seed = 0x5eed) { this->seed(seed); }
+
+    void seed(std::uint64_t seed)
+    {
+        splitmix64 sm(seed);
+        for (int i = 0; i < 4; ++i) {
+            s_[i] = sm();
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        const std::uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const std::uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    void discard(unsigned long long n)
+    {
+        for (; n > 0; --n) {
+            (*this)();
+        }
+    }
+
+    // equivalent to 2^128 calls: gives a non-overlapping stream to every thread
+    void jump()
+    {
+        static const std::uint64_t kJump[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                              0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+        std::uint64_t s[4] = {0, 0, 0, 0};
+        for (int i = 0; i < 4; ++i) {
+            for (int b = 0; b < 64; ++b) {
+                if (kJump[i] & (std::uint64_t(1) << b)) {
+                    for (int j = 0; j < 4; ++j) {
+                        s[j] ^= s_[j];
+                    }
+                }
+                (*this)();
+            }
+        }
+        std::copy(s, s + 4, s_);
+    }
+
+    friend bool operator==(const xoshiro256ss& a, const xoshiro256ss& b) { return std::equal(a.s_, a.s_ + 4, b.s_); }
+    friend bool operator!=(const xoshiro256ss& a, const xoshiro256ss& b) { return !(a == b); }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    std::uint64_t s_[4];
+};
+
+class pcg32 {
+public:
+    typedef std::uint32_t result_type;
+
+    explicit pcg32(std::uint64_t seed = 0x853c49e6748fea9bULL, std::uint64_t stream = 0xda3e39cb94b95bdbULL)
+    {
+        this->seed(seed, stream);
+    }
+
+    void seed(std::uint64_t seed, std::uint64_t stream = 0xda3e39cb94b95bdbULL)
+    {
+        state_ = 0;
+        inc_ = (stream << 1) | 1;
+        step();
+        state_ += seed;
+        step();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        const std::uint64_t old = state_;
+        step();
+        const std::uint32_t xorshifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+        const unsigned rot = static_cast<unsigned>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // jump ahead by n steps in O(log n): the LCG step composed with itself (Brown, "Random number
+    // generation with arbitrary strides")
+    void discard(unsigned long long n)
+    {
+        std::uint64_t mult = kMultiplier, plus = inc_, acc_mult = 1, acc_plus = 0;
+        for (; n > 0; n >>= 1) {
+            if (n & 1) {
+                acc_mult *= mult;
+                acc_plus = acc_plus * mult + plus;
+            }
+            plus = (mult + 1) * plus;
+            mult *= mult;
+        }
+        state_ = acc_mult * state_ + acc_plus;
+    }
+
+    friend bool operator==(const pcg32& a, const pcg32& b) { return a.state_ == b.state_ && a.inc_ == b.inc_; }
+    friend bool operator!=(const pcg32& a, const pcg32& b) { return !(a == b); }
+
+private:
+    static const std::uint64_t kMultiplier = 6364136223846793005ULL;
+
+    void step() { state_ = state_ * kMultiplier + inc_; }
+
+    std::uint64_t state_;
+    std::uint64_t inc_;
+};
+
+namespace detail {
+
+// 32 / 64 when the engine returns that many uniform bits per call, 0 otherwise (e.g. minstd_rand)
+template <typename Gen>
+struct word_bits
+    : std::integral_constant<int, Gen::min() != 0 ? 0
+                                  : Gen::max() == std::numeric_limits<std::uint64_t>::max() ? 64
+                                  : Gen::max() == std::numeric_limits<std::uint32_t>::max() ? 32
+                                                                                            : 0> {};
+
+template <typename Gen>
+std::uint32_t next32(Gen& gen, std::integral_constant<int, 64>) { return static_cast<std::uint32_t>(gen() >> 32); }
+template <typename Gen>
+std::uint32_t next32(Gen& gen, std::integral_constant<int, 32>) { return static_cast<std::uint32_t>(gen()); }
+
+template <typename Gen>
+std::uint64_t next64(Gen& gen, std::integral_constant<int, 64>) { return static_cast<std::uint64_t>(gen()); }
+template <typename Gen>
+std::uint64_t next64(Gen& gen, std::integral_constant<int, 32>)
+{
+    const std::uint64_t hi = static_cast<std::uint64_t>(gen());
+    return (hi << 32) | static_cast<std::uint64_t>(gen());
+}
+
+/*
+ * Lemire, "Fast Random Integer Generation in an Interval" (2019): the high half of x * range is uniform
+ * in [0, range) except for a bias that only exists when the low half is below 2^32 mod range; that
+ * (expensive) remainder is only computed when the low half is below range, which is rare for small ranges.
+ */
+template <typename Gen, int Bits>
+std::uint32_t bounded32(Gen& gen, std::uint32_t range, std::integral_constant<int, Bits> bits)
+{
+    std::uint64_t m = static_cast<std::uint64_t>(next32(gen, bits)) * range;
+    std::uint32_t low = static_cast<std::uint32_t>(m);
+    if (low < range) {
+        const std::uint32_t threshold = static_cast<std::uint32_t>(-range) % range;
+        while (low < threshold) {
+            m = static_cast<std::uint64_t>(next32(gen, bits)) * range;
+            low = static_cast<std::uint32_t>(m);
+        }
+    }
+    return static_cast<std::uint32_t>(m >> 32);
+}
+
+template <typename Gen, int Bits>
+std::uint64_t bounded64(Gen& gen, std::uint64_t range, std::integral_constant<int, Bits> bits)
+{
+    typedef unsigned __int128 u128;
+    u128 m = static_cast<u128>(next64(gen, bits)) * range;
+    std::uint64_t low = static_cast<std::uint64_t>(m);
+    if (low < range) {
+        const std::uint64_t threshold = static_cast<std::uint64_t>(-range) % range;
+        while (low < threshold) {
+            m = static_cast<u128>(next64(gen, bits)) * range;
+            low = static_cast<std::uint64_t>(m);
+        }
+    }
+    return static_cast<std::uint64_t>(m >> 64);
+}
+
+template <typename Gen, int Bits>
+std::uint64_t uniform_index(Gen& gen, std::uint64_t range, std::integral_constant<int, Bits> bits)
+{
+    return range <= 0xffffffffULL ? bounded32(gen, static_cast<std::uint32_t>(range), bits) : bounded64(gen, range, bits);
+}
+
+// engines with an odd output range go through the standard distribution
+template <typename Gen>
+std::uint64_t uniform_index(Gen& gen, std::uint64_t range, std::integral_constant<int, 0>)
+{
+    return std::uniform_int_distribution<std::uint64_t>(0, range - 1)(gen);
+}
+
+// uniform double in (0, 1), never 0: its logarithm is taken
+template <typename Gen>
+double open_unit(Gen& gen)
+{
+    const std::uint64_t x = next64(gen, std::integral_constant<int, word_bits<Gen>::value == 0 ? 32 : word_bits<Gen>::value>());
+    return (static_cast<double>(x >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+} // namespace detail
+
+// uniform integer in [0, range), range > 0
+template <typename Gen>
+std::uint64_t uniform_index(Gen& gen, std::uint64_t range)
+{
+    return detail::uniform_index(gen, range, detail::word_bits<Gen>());
+}
+
+// Fisher-Yates, from the back; one (almost always division free) bounded integer per element
+template <typename It, typename Gen>
+void shuffle(It first, It last, Gen& gen)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    for (std::size_t i = n; i > 1; --i) {
+        const std::size_t j = static_cast<std::size_t>(uniform_index(gen, i));
+        using std::swap;
+        swap(first[i - 1], first[j]);
+    }
+}
+
+/*
+ * Uniform sample of k elements out of a stream whose length is not known in advance.
+ *
+ * Algorithm L (Li, 1994): once the reservoir is full, the number of elements to skip until the next
+ * replacement is geometrically distributed and drawn directly, so a stream of n elements needs only
+ * O(k * (1 + log(n / k))) random numbers instead of one per element (algorithm R).
+ */
+template <typename T, typename Gen = xoshiro256ss>
+class reservoir {
+public:
+    explicit reservoir(std::size_t k, Gen gen = Gen()) : k_(k), gen_(gen), seen_(0), next_(0), w_(1.0)
+    {
+        items_.reserve(k);
+    }
+
+    void push(const T& x)
+    {
+        const std::uint64_t index = seen_++;
+        if (index < k_) {
+            items_.push_back(x);
+            if (index + 1 == k_) {
+                w_ = std::exp(std::log(detail::open_unit(gen_)) / k_);
+                next_ = seen_ + skip();
+            }
+        } else if (index == next_ && k_ > 0) {
+            items_[static_cast<std::size_t>(uniform_index(gen_, k_))] = x;
+            w_ *= std::exp(std::log(detail::open_unit(gen_)) / k_);
+            next_ = seen_ + skip();
+        }
+    }
+
+    // elements the next push() calls will not take; lets a random access caller jump over them
+    std::uint64_t skip_ahead() const { return seen_ < k_ || next_ < seen_ ? 0 : next_ - seen_; }
+
+    void skip(std::uint64_t n) { seen_ += n; }
+
+    std::uint64_t seen() const { return seen_; }
+
+    // the sample, in no particular order
+    const std::vector<T>& items() const { return items_; }
+
+private:
+    std::uint64_t skip()
+    {
+        const double s = std::floor(std::log(detail::open_unit(gen_)) / std::log1p(-w_));
+        return s < 9.0e18 ? static_cast<std::uint64_t>(s) : std::numeric_limits<std::uint64_t>::max() / 2;
+    }
+
+    std::size_t k_;
+    Gen gen_;
+    std::vector<T> items_;
+    std::uint64_t seen_;
+    std::uint64_t next_; // index of the next element that goes into the reservoir
+    double w_;
+};
+
+namespace detail {
+
+template <typename It, typename Out, typename Gen>
+Out sample(It first, It last, Out out, std::size_t k, Gen& gen, std::input_iterator_tag)
+{
+    typedef typename std::iterator_traits<It>::value_type T;
+    reservoir<T, Gen&> r(k, gen);
+    for (; first != last; ++first) {
+        r.push(*first);
+    }
+    return std::copy(r.items().begin(), r.items().end(), out);
+}
+
+// random access: the skipped elements are never touched
+template <typename It, typename Out, typename Gen>
+Out sample(It first, It last, Out out, std::size_t k, Gen& gen, std::random_access_iterator_tag)
+{
+    typedef typename std::iterator_traits<It>::value_type T;
+    const std::uint64_t n = static_cast<std::uint64_t>(last - first);
+    reservoir<T, Gen&> r(k, gen);
+    while (r.seen() < n) {
+        const std::uint64_t s = std::min(r.skip_ahead(), n - r.seen());
+        r.skip(s);
+        if (r.seen() < n)
+            r.push(first[static_cast<std::size_t>(r.seen())]);
+    }
+    return std::copy(r.items().begin(), r.items().end(), out);
+}
+
+} // namespace detail
+
+// k elements chosen uniformly without replacement (all of them if there are fewer), in no particular order
+template <typename It, typename Out, typename Gen>
+Out sample(It first, It last, Out out, std::size_t k, Gen& gen)
+{
+    return detail::sample(first, last, out, k, gen, typename std::iterator_traits<It>::iterator_category());
+}
+
+namespace parallel {
+
+namespace detail {
+
+// independent engine for task `index` of `level`: a function of the seed only
+inline xoshiro256ss task_engine(std::uint64_t seed, std::uint64_t level, std::uint64_t index)
+{
+    splitmix64 sm(seed);
+    splitmix64 mixed(sm() ^ (level << 48) ^ index);
+    return xoshiro256ss(mixed());
+}
+
+class bit_source {
+public:
+    explicit bit_source(xoshiro256ss& gen) : gen_(gen), bits_(0), left_(0) {}
+
+    bool next()
+    {
+        if (left_ == 0) {
+            bits_ = gen_();
+            left_ = 64;
+        }
+        const bool bit = bits_ & 1;
+        bits_ >>= 1;
+        --left_;
+        return bit;
+    }
+
+private:
+    xoshiro256ss& gen_;
+    std::uint64_t bits_;
+    unsigned left_;
+};
+
+/*
+ * MergeShuffle merge: [first, mid) and [mid, last) are uniformly shuffled, the result is a uniform
+ * shuffle of [first, last). Coin flips decide from which side the next element comes; when one side
+ * runs out, the rest is inserted Fisher-Yates style (about sqrt(n) elements).
+ */
+template <typename It>
+It merge_flips(It i, It j, It last, bit_source& coin, std::false_type)
+{
+    using std::swap;
+    for (;; ++i) {
+        if (coin.next()) {
+            if (j == last)
+                break;
+            swap(*i, *j);
+            ++j;
+        } else if (i == j) {
+            break;
+        }
+    }
+    return i;
+}
+
+// the coin is a 50/50 branch: for trivially copyable elements the side is selected without one
+// (a swap with itself when the element stays)
+template <typename It>
+It merge_flips(It i, It j, It last, bit_source& coin, std::true_type)
+{
+    for (;; ++i) {
+        const bool take = coin.next();
+        if (take ? j == last : i == j)
+            break;
+        const It k = take ? j : i;
+        const typename std::iterator_traits<It>::value_type x = *i;
+        *i = *k;
+        *k = x;
+        j += take;
+    }
+    return i;
+}
+
+template <typename It>
+void merge(It first, It mid, It last, xoshiro256ss& gen)
+{
+    using std::swap;
+    bit_source coin(gen);
+    It i = merge_flips(first, mid, last, coin, std::is_trivially_copyable<typename std::iterator_traits<It>::value_type>());
+    for (; i != last; ++i) {
+        const std::size_t pos = static_cast<std::size_t>(uniform_index(gen, static_cast<std::uint64_t>(i - first) + 1));
+        swap(*i, first[pos]);
+    }
+}
+
+// runs task(index) for index in [0, tasks) on the available threads
+template <typename Task>
+void run_tasks(std::size_t tasks, Task task)
+{
+    algorithms::parallel::for_each_chunk(tasks, std::min(tasks, algorithms::parallel::thread_count()),
+                                         [&] (std::size_t, std::size_t b, std::size_t e) {
+        for (std::size_t t = b; t < e; ++t) {
+            task(t);
+        }
+    });
+}
+
+template <typename It>
+void merge_shuffle(It first, It last, std::uint64_t seed, std::size_t leaf_size)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t leaves = 1;
+    while (n / (leaves * 2) >= leaf_size) {
+        leaves *= 2;
+    }
+    auto bound = [&] (std::size_t leaf) { return first + static_cast<std::ptrdiff_t>(leaf * (n / leaves)); };
+    auto end_of = [&] (std::size_t leaf) { return leaf == leaves ? last : bound(leaf); };
+
+    run_tasks(leaves, [&] (std::size_t t) {
+        xoshiro256ss gen = task_engine(seed, 0, t);
+        random_kernels::shuffle(bound(t), end_of(t + 1), gen);
+    });
+    std::uint64_t level = 1;
+    for (std::size_t width = 2; width <= leaves; width *= 2, ++level) {
+        run_tasks(leaves / width, [&] (std::size_t t) {
+            xoshiro256ss gen = task_engine(seed, level, t);
+            merge(bound(t * width), bound(t * width + width / 2), end_of(t * width + width), gen);
+        });
+    }
+}
+
+} // namespace detail
+
+// large leaves: a leaf shuffle is cheaper than the merge levels it saves
+static const std::size_t kLeafSize = 1 << 20;
+
+/*
+ * The range is cut into a power of 2 number of blocks, determined by its length alone. Every block is
+ * shuffled with its own engine, then neighbouring blocks are merged pairwise, level by level
+ * (one task per pair, the last level is a single merge). Engines are derived from (seed, level, block),
+ * so the permutation does not depend on the number of threads.
+ */
+template <typename It>
+void shuffle(It first, It last, std::uint64_t seed)
+{
+    detail::merge_shuffle(first, last, seed, kLeafSize);
+}
+
+} // namespace parallel
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_RANDOM_KERNELS_H
@@ -0,0 +1,159 @@
+#include "reduce_kernels.h"
+#include "helper.h"
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace algorithms {
+namespace reduce_kernels {
+
+// count_demo() and min_max_demo() of non_modifying.cpp on top of the kernels
+void same_as_std_demo()
+{
+    vector<int> coll;
+    helper::INSERT_ELEMENTS(coll, 1, 9);
+    helper::PRINT_ELEMENT(coll, "coll: ");
+
+    cout << "number of elements equal to 4: " << reduce_kernels::count(coll.cbegin(), coll.cend(), 4) << endl;
+    cout << "number of elements greater than 6: " << reduce_kernels::count_if(coll.begin(), coll.end(), simd::greater_than(6)) << endl;
+    // not one of the simd:: predicates: plain std::count_if
+    cout << "number of elements with even value: "
+         << reduce_kernels::count_if(coll.begin(), coll.end(), [] (int elem) { return elem % 2 == 0; }) << endl;
+
+    vector<int> vec;
+    helper::INSERT_ELEMENTS(vec, 2, 6);
+    helper::INSERT_ELEMENTS(vec, -3, 6);
+    helper::PRINT_ELEMENT(vec, "vec: ");
+
+    cout << "min element: " << *reduce_kernels::min_element(vec.begin(), vec.end()) << endl;
+    cout << "max element: " << *reduce_kernels::max_element(vec.begin(), vec.end()) << endl;
+    auto min_max = reduce_kernels::minmax_element(vec.begin(), vec.end());
+    cout << "distance of min & max: " << distance(min_max.first, min_max.second)
+         << " (std: " << distance(std::minmax_element(vec.begin(), vec.end()).first, std::minmax_element(vec.begin(), vec.end()).second)
+         << ")" << endl; // 最后一个最大的元素
+    cout << "minimum of absolute values: " << *reduce_kernels::min_element(vec.cbegin(), vec.cend(), abs_less()) << endl;
+    cout << "maximum of absolute values: " << *reduce_kernels::max_element(vec.cbegin(), vec.cend(), abs_less()) << endl;
+
+    // deque is not contiguous, the same calls fall back to std::
+    deque<int> coll2(vec.begin(), vec.end());
+    cout << "deque max of absolute values: " << *reduce_kernels::max_element(coll2.cbegin(), coll2.cend(), abs_less()) << endl;
+
+    // a NaN makes the result depend on the order, the kernels then return exactly what std:: returns
+    vector<double> with_nan = {3.0, numeric_limits<double>::quiet_NaN(), -7.5, 2.0};
+    cout << "min with NaN: index " << reduce_kernels::min_element(with_nan.begin(), with_nan.end()) - with_nan.begin()
+         << " (std: " << std::min_element(with_nan.begin(), with_nan.end()) - with_nan.begin() << ")" << endl;
+}
+
+template <typename T, typename Dist>
+bool cross_check(mt19937& gen, Dist dist, int rounds)
+{
+    uniform_int_distribution<int> len(1, 20000);
+    for (int r = 0; r < rounds; ++r) {
+        vector<T> v(len(gen));
+        for (auto& x : v) {
+            x = static_cast<T>(dist(gen));
+        }
+        const T value = v[v.size() / 2];
+        if (reduce_kernels::count(v.begin(), v.end(), value) != std::count(v.begin(), v.end(), value) ||
+            reduce_kernels::count_if(v.begin(), v.end(), simd::less_than(value)) !=
+                std::count_if(v.begin(), v.end(), [value] (T x) { return x < value; }) ||
+            reduce_kernels::min_element(v.begin(), v.end()) != std::min_element(v.begin(), v.end()) ||
+            reduce_kernels::max_element(v.begin(), v.end()) != std::max_element(v.begin(), v.end()) ||
+            reduce_kernels::minmax_element(v.begin(), v.end()) != std::minmax_element(v.begin(), v.end()) ||
+            reduce_kernels::min_element(v.begin(), v.end(), abs_less()) != std::min_element(v.begin(), v.end(), abs_less()) ||
+            reduce_kernels::minmax_element(v.begin(), v.end(), abs_less()) != std::minmax_element(v.begin(), v.end(), abs_less()))
+            return false;
+        // values the element type can not hold: -1 is not 65535 in a range of unsigned short
+        const long long wide = (1ll << 16) + static_cast<long long>(value);
+        if (reduce_kernels::count(v.begin(), v.end(), wide) != std::count(v.begin(), v.end(), wide) ||
+            reduce_kernels::count(v.begin(), v.end(), -1ll) != std::count(v.begin(), v.end(), -1ll) ||
+            reduce_kernels::count(v.begin(), v.end(), value + 0.5) != std::count(v.begin(), v.end(), value + 0.5))
+            return false;
+    }
+    return true;
+}
+
+template <typename F>
+long long time_us(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::microseconds>(t1 - t0).count();
+}
+
+// per column statistics of one batch: count of a key, count below a threshold, min/max and max |x|
+template <typename T>
+void column_benchmark(const char* name, const vector<T>& col, T key, T threshold)
+{
+    long long n1 = 0, n2 = 0;
+    size_t lo = 0, hi = 0, amax = 0;
+    long long t_std = time_us([&] {
+        n1 = std::count(col.begin(), col.end(), key);
+        n2 = std::count_if(col.begin(), col.end(), [threshold] (T x) { return x < threshold; });
+        auto mm = std::minmax_element(col.begin(), col.end());
+        lo = mm.first - col.begin();
+        hi = mm.second - col.begin();
+        amax = std::max_element(col.begin(), col.end(), abs_less()) - col.begin();
+    });
+    long long m1 = 0, m2 = 0;
+    size_t lo2 = 0, hi2 = 0, amax2 = 0;
+    long long t_simd = time_us([&] {
+        m1 = reduce_kernels::count(col.begin(), col.end(), key);
+        m2 = reduce_kernels::count_if(col.begin(), col.end(), simd::less_than(threshold));
+        auto mm = reduce_kernels::minmax_element(col.begin(), col.end());
+        lo2 = mm.first - col.begin();
+        hi2 = mm.second - col.begin();
+        amax2 = reduce_kernels::max_element(col.begin(), col.end(), abs_less()) - col.begin();
+    });
+    const bool same = n1 == m1 && n2 == m2 && lo == lo2 && hi == hi2 && amax == amax2;
+    cout << name << ": std " << t_std << " us, simd " << t_simd << " us" << (same ? "" : "  MISMATCH") << endl;
+}
+
+void benchmark()
+{
+    const size_t kRows = 16 * 1024 * 1024;
+    mt19937 gen(42);
+    uniform_int_distribution<int> ints(-1000000, 1000000);
+    normal_distribution<double> reals(0.0, 100.0);
+
+    vector<int> c_int(kRows);
+    vector<float> c_float(kRows);
+    vector<double> c_double(kRows);
+    for (size_t i = 0; i < kRows; ++i) {
+        c_int[i] = ints(gen);
+        c_double[i] = reals(gen);
+        c_float[i] = static_cast<float>(c_double[i]);
+    }
+    column_benchmark("int column", c_int, c_int[123], 0);
+    column_benchmark("float column", c_float, c_float[123], 0.0f);
+    column_benchmark("double column", c_double, c_double[123], 0.0);
+}
+
+void Run()
+{
+    same_as_std_demo();
+
+    mt19937 gen(7);
+    // narrow value ranges produce many ties, which is where first/last semantics matter
+    uniform_int_distribution<int> small(-20, 20);
+    uniform_int_distribution<int> wide(numeric_limits<int>::min(), numeric_limits<int>::max());
+    normal_distribution<double> real(0.0, 10.0);
+    cout << "cross check: " << boolalpha
+         << (cross_check<signed char>(gen, small, 200) && cross_check<unsigned short>(gen, small, 200) &&
+             cross_check<int>(gen, small, 200) && cross_check<int>(gen, wide, 200) &&
+             cross_check<long long>(gen, small, 200) && cross_check<float>(gen, small, 200) &&
+             cross_check<double>(gen, real, 200))
+         << endl;
+
+    benchmark();
+}
+
+}
+}
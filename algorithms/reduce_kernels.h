@@ -0,0 +1,373 @@
+#ifndef STL_DEMO_ALGORITHMS_REDUCE_KERNELS_H
+#define STL_DEMO_ALGORITHMS_REDUCE_KERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "simd.h"
+
+namespace algorithms {
+namespace reduce_kernels {
+
+/*
+ * count() / count_if() / min_element() / max_element() / minmax_element() from non_modifying.cpp,
+ * with SIMD paths for contiguous ranges of arithmetic types (int, float, double, ...):
+ *
+ *     count(beg, end, value)
+ *     count_if(beg, end, simd::less_than(x))        simd::equal_to / greater_than / ... are vectorized
+ *     min_element(beg, end)                          same as min_element(beg, end, std::less<T>())
+ *     min_element(beg, end, abs_less())              compare |x|, like absLess() in min_max_demo()
+ *     max_element(...) / minmax_element(...)         the same two modes
+ *
+ * 返回值和 std:: 版本完全一致: min_element/max_element 返回第一个最小/最大值，minmax_element 返回第一个最小值
+ * 和 *最后* 一个最大值。其它比较函数、或者不连续的容器 (deque, list) 直接调用 std:: 版本。
+ *
+ * 下标恢复: 区间按 4096 个元素分块，每块先用 SIMD 求出块内的最小/最大值，只记住 "第一个更小的块"，
+ * 最后只在那一个块里再扫一遍找到具体位置，所以总的代价仍然接近一遍扫描。
+ * 浮点数里如果有 NaN，比较的结果取决于元素的顺序，这时退回 std:: 版本以保证结果一样。
+ */
+
+// |a| < |b|, without the overflow of std::abs(INT_MIN)
+struct abs_less {
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value, bool>::type operator()(T a, T b) const
+    {
+        typedef typename std::make_unsigned<T>::type U;
+        return magnitude<U>(a) < magnitude<U>(b);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value, bool>::type operator()(T a, T b) const
+    {
+        return std::fabs(a) < std::fabs(b);
+    }
+
+    template <typename U, typename T>
+    static U magnitude(T x)
+    {
+        return x < 0 ? static_cast<U>(U(0) - static_cast<U>(x)) : static_cast<U>(x);
+    }
+};
+
+namespace detail {
+
+using simd::value_of;
+using simd::use_simd;
+using simd::to_pointer;
+
+// Key policies: what the kernels actually compare
+template <typename T>
+struct plain_key {
+    typedef T type;
+    static T key(T x) { return x; }
+#if defined(STL_DEMO_SIMD)
+    static simd::reg key(simd::reg x) { return x; }
+#endif
+};
+
+template <typename T, bool = std::is_integral<T>::value>
+struct abs_key {
+    // integers: the magnitude as an unsigned value, so |INT_MIN| is representable
+    typedef typename std::make_unsigned<T>::type type;
+    static type key(T x) { return abs_less::magnitude<type>(x); }
+#if defined(STL_DEMO_SIMD)
+    static simd::reg key(simd::reg x) { return simd::lane<T>::abs(x); }
+#endif
+};
+
+template <typename T>
+struct abs_key<T, false> {
+    typedef T type;
+    static T key(T x) { return std::fabs(x); }
+#if defined(STL_DEMO_SIMD)
+    static simd::reg key(simd::reg x) { return simd::lane<T>::abs(x); }
+#endif
+};
+
+// comparator -> key policy; `void` means "not vectorizable, use std::"
+template <typename Comp, typename T>
+struct key_for {
+    typedef void type;
+};
+
+template <typename T>
+struct key_for<std::less<T>, T> {
+    typedef plain_key<T> type;
+};
+
+template <typename T>
+struct key_for<abs_less, T> {
+    typedef abs_key<T> type;
+};
+
+template <typename Comp, typename It, bool = use_simd<It>::value>
+struct vectorizable : std::false_type {};
+
+template <typename Comp, typename It>
+struct vectorizable<Comp, It, true>
+    : std::integral_constant<bool, !std::is_void<typename key_for<Comp, typename value_of<It>::type>::type>::value> {};
+
+// -- count --
+
+template <typename T, typename Pred>
+std::size_t count_pred(const T* p, std::size_t n, const Pred& pred)
+{
+    std::size_t i = 0;
+    std::size_t total = 0;
+#if defined(STL_DEMO_SIMD)
+    typedef simd::lane<T> L;
+    typedef simd::detail::int_ops<sizeof(T)> ops;
+    typedef typename simd::uint_of<sizeof(T)>::type U;
+    const std::size_t W = L::width;
+    const simd::reg v = L::set1(pred.value);
+    // a matching lane is all ones (-1): adding the masks counts downwards in every lane.
+    // 8 bit lanes overflow after 255 rounds, so the lanes are flushed into `total` every 255 rounds
+    while (i + W <= n) {
+        const std::size_t rounds = std::min<std::size_t>((n - i) / W, 255);
+        simd::reg acc = simd::zero();
+        for (std::size_t r = 0; r < rounds; ++r, i += W) {
+            acc = ops::add(acc, pred.mask(L::load(p + i), v));
+        }
+        U lanes[W];
+        simd::storeu(lanes, acc);
+        for (std::size_t j = 0; j < W; ++j) {
+            total += static_cast<U>(U(0) - lanes[j]);
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (pred(p[i]))
+            ++total;
+    }
+    return total;
+}
+
+// -- min / max with index recovery --
+
+static const std::size_t kBlock = 4096;
+
+template <typename K>
+bool is_nan(K k, std::true_type) { return std::isnan(k); }
+template <typename K>
+bool is_nan(K, std::false_type) { return false; }
+
+// min and max key of p[0, n), n > 0; returns false if a NaN was seen
+template <typename T, typename Key>
+bool reduce_block(const T* p, std::size_t n, typename Key::type& lo, typename Key::type& hi)
+{
+    typedef typename Key::type K;
+    K l = Key::key(p[0]);
+    K h = l;
+    bool nan = false;
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    typedef simd::lane<K> L;
+    const std::size_t W = L::width;
+    if (n >= W) {
+        simd::reg x = Key::key(simd::loadu(p));
+        simd::reg vl = x;
+        simd::reg vh = x;
+        simd::reg vnan = L::ne(x, x); // only a NaN differs from itself, integers never set it
+        for (i = W; i + W <= n; i += W) {
+            x = Key::key(simd::loadu(p + i));
+            vl = L::min(vl, x);
+            vh = L::max(vh, x);
+            if (std::is_floating_point<K>::value)
+                vnan = simd::or_(vnan, L::ne(x, x));
+        }
+        K lanes[W];
+        simd::storeu(lanes, vl);
+        l = *std::min_element(lanes, lanes + W);
+        simd::storeu(lanes, vh);
+        h = *std::max_element(lanes, lanes + W);
+        nan = simd::bytemask(vnan) != 0;
+    }
+#endif
+    for (; i < n; ++i) {
+        const K k = Key::key(p[i]);
+        if (k < l)
+            l = k;
+        if (h < k)
+            h = k;
+        if (is_nan(k, std::is_floating_point<K>()))
+            nan = true;
+    }
+    lo = l;
+    hi = h;
+    return !nan;
+}
+
+// Mode: 0 = first min, 1 = first max, 2 = first min and last max (minmax_element)
+template <typename T, typename Key, int Mode>
+bool locate(const T* p, std::size_t n, std::size_t& min_pos, std::size_t& max_pos)
+{
+    typedef typename Key::type K;
+    K best_lo, best_hi;
+    if (!reduce_block<T, Key>(p, std::min(n, kBlock), best_lo, best_hi))
+        return false;
+    std::size_t lo_block = 0, hi_block = 0;
+    for (std::size_t b = kBlock; b < n; b += kBlock) {
+        K lo, hi;
+        if (!reduce_block<T, Key>(p + b, std::min(n - b, kBlock), lo, hi))
+            return false;
+        if (lo < best_lo) {
+            best_lo = lo;
+            lo_block = b;
+        }
+        if (Mode == 2 ? !(hi < best_hi) : best_hi < hi) {
+            best_hi = hi;
+            hi_block = b;
+        }
+    }
+    // only the winning block is scanned a second time
+    std::size_t i = lo_block;
+    while (!(Key::key(p[i]) == best_lo)) {
+        ++i;
+    }
+    min_pos = i;
+    if (Mode == 2) {
+        i = std::min(n, hi_block + kBlock) - 1;
+        while (!(Key::key(p[i]) == best_hi)) {
+            --i;
+        }
+    } else {
+        i = hi_block;
+        while (!(Key::key(p[i]) == best_hi)) {
+            ++i;
+        }
+    }
+    max_pos = i;
+    return true;
+}
+
+template <typename It, typename Comp>
+It min_element(It first, It last, Comp comp, std::true_type)
+{
+    typedef typename value_of<It>::type T;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t lo, hi;
+    if (n == 0 || !locate<T, typename key_for<Comp, T>::type, 0>(to_pointer(first), n, lo, hi))
+        return std::min_element(first, last, comp);
+    return first + lo;
+}
+
+template <typename It, typename Comp>
+It min_element(It first, It last, Comp comp, std::false_type)
+{
+    return std::min_element(first, last, comp);
+}
+
+template <typename It, typename Comp>
+It max_element(It first, It last, Comp comp, std::true_type)
+{
+    typedef typename value_of<It>::type T;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t lo, hi;
+    if (n == 0 || !locate<T, typename key_for<Comp, T>::type, 1>(to_pointer(first), n, lo, hi))
+        return std::max_element(first, last, comp);
+    return first + hi;
+}
+
+template <typename It, typename Comp>
+It max_element(It first, It last, Comp comp, std::false_type)
+{
+    return std::max_element(first, last, comp);
+}
+
+template <typename It, typename Comp>
+std::pair<It, It> minmax_element(It first, It last, Comp comp, std::true_type)
+{
+    typedef typename value_of<It>::type T;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t lo, hi;
+    if (n == 0 || !locate<T, typename key_for<Comp, T>::type, 2>(to_pointer(first), n, lo, hi))
+        return std::minmax_element(first, last, comp);
+    return std::make_pair(first + lo, first + hi);
+}
+
+template <typename It, typename Comp>
+std::pair<It, It> minmax_element(It first, It last, Comp comp, std::false_type)
+{
+    return std::minmax_element(first, last, comp);
+}
+
+template <typename It, typename Pred>
+typename std::iterator_traits<It>::difference_type count_if(It first, It last, Pred pred, std::true_type)
+{
+    return static_cast<typename std::iterator_traits<It>::difference_type>(
+        count_pred(to_pointer(first), static_cast<std::size_t>(last - first), pred));
+}
+
+template <typename It, typename Pred>
+typename std::iterator_traits<It>::difference_type count_if(It first, It last, Pred pred, std::false_type)
+{
+    return std::count_if(first, last, pred);
+}
+
+} // namespace detail
+
+template <typename It, typename T>
+typename std::iterator_traits<It>::difference_type count(It first, It last, const T& value)
+{
+    typedef typename detail::value_of<It>::type V;
+    if (!simd::representable<V>(value))
+        return std::count(first, last, value);
+    return detail::count_if(first, last, simd::equal_to(static_cast<V>(value)), detail::use_simd<It>());
+}
+
+// vectorized for the simd::equal_to / less_than / ... predicates, any other predicate goes to std::count_if
+template <typename It, typename Pred>
+typename std::iterator_traits<It>::difference_type count_if(It first, It last, Pred pred)
+{
+    return detail::count_if(first, last, pred,
+                            std::integral_constant<bool, detail::use_simd<It>::value &&
+                                                             simd::is_simd_predicate_for<Pred, typename detail::value_of<It>::type>::value>());
+}
+
+template <typename It, typename Comp>
+It min_element(It first, It last, Comp comp)
+{
+    return detail::min_element(first, last, comp, detail::vectorizable<Comp, It>());
+}
+
+template <typename It>
+It min_element(It first, It last)
+{
+    return reduce_kernels::min_element(first, last, std::less<typename detail::value_of<It>::type>());
+}
+
+template <typename It, typename Comp>
+It max_element(It first, It last, Comp comp)
+{
+    return detail::max_element(first, last, comp, detail::vectorizable<Comp, It>());
+}
+
+template <typename It>
+It max_element(It first, It last)
+{
+    return reduce_kernels::max_element(first, last, std::less<typename detail::value_of<It>::type>());
+}
+
+template <typename It, typename Comp>
+std::pair<It, It> minmax_element(It first, It last, Comp comp)
+{
+    return detail::minmax_element(first, last, comp, detail::vectorizable<Comp, It>());
+}
+
+template <typename It>
+std::pair<It, It> minmax_element(It first, It last)
+{
+    return reduce_kernels::minmax_element(first, last, std::less<typename detail::value_of<It>::type>());
+}
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_REDUCE_KERNELS_H
@@ -0,0 +1,180 @@
+#include "remove_kernels.h"
+#include "helper.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace algorithms {
+namespace remove_kernels {
+
+// remove_certain_values() and remove_duplicates() of removing.cpp
+void same_as_std_demo()
+{
+    vector<int> coll;
+    helper::INSERT_ELEMENTS(coll, 2, 6);
+    helper::INSERT_ELEMENTS(coll, 4, 9);
+    helper::INSERT_ELEMENTS(coll, 1, 7);
+    helper::PRINT_ELEMENT(coll, "coll: ");
+
+    coll.erase(remove_kernels::remove(coll.begin(), coll.end(), 5), coll.end());
+    helper::PRINT_ELEMENT(coll, "coll without 5: ");
+    coll.erase(remove_kernels::remove_if(coll.begin(), coll.end(), simd::less_than(5)), coll.end());
+    helper::PRINT_ELEMENT(coll, "coll remove elements less than 5: ");
+
+    vector<int> coll2 = { 1, 4, 4, 6, 1, 2, 2, 3, 1, 6, 6, 6, 5, 7, 5, 4, 4 };
+    vector<int> coll3(coll2);
+    coll2.erase(remove_kernels::unique(coll2.begin(), coll2.end()), coll2.end());
+    helper::PRINT_ELEMENT(coll2, "coll2 unique: ");
+    // all duplicates, not only adjacent ones
+    coll3.erase(unique_unsorted(coll3.begin(), coll3.end()), coll3.end());
+    helper::PRINT_ELEMENT(coll3, "coll3 unique_unsorted: ");
+
+    vector<string> words = {"to", "be", "or", "not", "to", "be"};
+    words.erase(unique_unsorted(words.begin(), words.end()), words.end());
+    helper::PRINT_ELEMENT(words, "words: ");
+}
+
+template <typename T>
+bool check_type(mt19937& gen, size_t n)
+{
+    uniform_int_distribution<int> val(0, 9);
+    vector<T> data(n);
+    for (auto& x : data) {
+        x = static_cast<T>(val(gen));
+    }
+    // runs of equal values for unique()
+    vector<T> runs(n);
+    for (size_t i = 0; i < n; ++i) {
+        runs[i] = static_cast<T>(i / (1 + val(gen)) % 7);
+    }
+
+    bool ok = true;
+    for (int v = 0; v < 10; v += 3) {
+        vector<T> a(data), b(data);
+        auto pa = remove_kernels::remove(a.begin(), a.end(), static_cast<T>(v));
+        auto pb = std::remove(b.begin(), b.end(), static_cast<T>(v));
+        ok = ok && pa - a.begin() == pb - b.begin() && std::equal(a.begin(), pa, b.begin());
+
+        a = data;
+        b = data;
+        pa = remove_kernels::remove_if(a.begin(), a.end(), simd::greater_equal(static_cast<T>(v)));
+        pb = std::remove_if(b.begin(), b.end(), [v] (T x) { return x >= static_cast<T>(v); });
+        ok = ok && pa - a.begin() == pb - b.begin() && std::equal(a.begin(), pa, b.begin());
+
+        a = data;
+        b = data;
+        pa = parallel::remove(a.begin(), a.end(), static_cast<T>(v));
+        pb = std::remove(b.begin(), b.end(), static_cast<T>(v));
+        ok = ok && pa - a.begin() == pb - b.begin() && std::equal(a.begin(), pa, b.begin());
+
+        // values the element type can not hold remove nothing: 65536 + v is not v in a range of int8_t
+        const long long wide = (1ll << 16) + v;
+        ok = ok && remove_kernels::remove(a.begin(), a.end(), wide) == a.end() &&
+             parallel::remove(a.begin(), a.end(), wide) == a.end() &&
+             remove_kernels::remove(a.begin(), a.end(), v + 0.5) == a.end() &&
+             parallel::remove(a.begin(), a.end(), v + 0.5) == a.end();
+    }
+    vector<T> a(runs), b(runs);
+    auto pa = remove_kernels::unique(a.begin(), a.end());
+    auto pb = std::unique(b.begin(), b.end());
+    ok = ok && pa - a.begin() == pb - b.begin() && std::equal(a.begin(), pa, b.begin());
+    return ok;
+}
+
+// with many elements the parallel code paths run (more of them with STL_DEMO_THREADS=8)
+bool cross_check()
+{
+    mt19937 gen(7);
+    bool ok = true;
+    for (size_t n : {0, 1, 31, 33, 1000, 300007}) {
+        ok = ok && check_type<int8_t>(gen, n) && check_type<uint16_t>(gen, n) && check_type<int32_t>(gen, n) &&
+             check_type<int64_t>(gen, n) && check_type<float>(gen, n) && check_type<double>(gen, n);
+    }
+
+    // a lambda on ints takes the branchless path, parallel remove_if stitches the chunks
+    vector<int> data(1000003);
+    uniform_int_distribution<int> val(0, 1000);
+    for (auto& x : data) {
+        x = val(gen);
+    }
+    auto odd = [] (int x) { return x % 2 != 0; };
+    vector<int> a(data), b(data), c(data);
+    auto pa = remove_kernels::remove_if(a.begin(), a.end(), odd);
+    auto pb = std::remove_if(b.begin(), b.end(), odd);
+    auto pc = parallel::remove_if(c.begin(), c.end(), odd);
+    ok = ok && pa - a.begin() == pb - b.begin() && std::equal(a.begin(), pa, b.begin()) &&
+         pc - c.begin() == pb - b.begin() && std::equal(c.begin(), pc, b.begin());
+
+    // unique_unsorted == the first occurrences, in order
+    a = data;
+    pa = unique_unsorted(a.begin(), a.end());
+    vector<bool> seen(1001);
+    b.clear();
+    for (int x : data) {
+        if (!seen[x]) {
+            seen[x] = true;
+            b.push_back(x);
+        }
+    }
+    ok = ok && static_cast<size_t>(pa - a.begin()) == b.size() && std::equal(b.begin(), b.end(), a.begin());
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+void benchmark()
+{
+    // filter 100M values, about half of them survive: the worst case for branch prediction
+    const size_t kValues = 100000000;
+    vector<int32_t> data(kValues);
+    mt19937 gen(42);
+    for (auto& x : data) {
+        x = static_cast<int32_t>(gen() % 1000);
+    }
+
+    vector<int32_t> work(data);
+    size_t kept = 0;
+    long long t = time_ms([&] { kept = std::remove_if(work.begin(), work.end(), [] (int32_t x) { return x < 500; }) - work.begin(); });
+    cout << "std::remove_if: " << t << " ms, " << kept << " kept" << endl;
+    work = data;
+    t = time_ms([&] { kept = remove_kernels::remove_if(work.begin(), work.end(), [] (int32_t x) { return x < 500; }) - work.begin(); });
+    cout << "remove_if (lambda, branchless): " << t << " ms, " << kept << " kept" << endl;
+    work = data;
+    t = time_ms([&] { kept = remove_kernels::remove_if(work.begin(), work.end(), simd::less_than(500)) - work.begin(); });
+    cout << "remove_if (simd::less_than): " << t << " ms, " << kept << " kept" << endl;
+    work = data;
+    t = time_ms([&] { kept = parallel::remove_if(work.begin(), work.end(), simd::less_than(500)) - work.begin(); });
+    cout << "parallel::remove_if: " << t << " ms, " << kept << " kept ("
+         << algorithms::parallel::thread_count() << " threads)" << endl;
+
+    sort(data.begin(), data.end());
+    work = data;
+    t = time_ms([&] { kept = std::unique(work.begin(), work.end()) - work.begin(); });
+    cout << "std::unique: " << t << " ms, " << kept << " kept" << endl;
+    work = data;
+    t = time_ms([&] { kept = remove_kernels::unique(work.begin(), work.end()) - work.begin(); });
+    cout << "unique: " << t << " ms, " << kept << " kept" << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
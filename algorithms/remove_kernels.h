@@ -0,0 +1,428 @@
+#ifndef STL_DEMO_ALGORITHMS_REMOVE_KERNELS_H
+#define STL_DEMO_ALGORITHMS_REMOVE_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "simd.h"
+#include "parallel.h"
+
+namespace algorithms {
+namespace remove_kernels {
+
+/*
+ * Drop-in replacements for removing.cpp, in place and stable like the std:: versions:
+ *
+ *     remove() / remove_if()        stream compaction: the kept lanes of a register are packed to the
+ *                                   front with one shuffle and stored as a whole
+ *     unique()                      compaction with "x[i] != x[i - 1]" as the keep mask
+ *     unique_unsorted()             drops every element that was seen before (hash set), no sorting needed;
+ *                                   the first occurrences keep their order
+ *     parallel::remove_if()         every thread compacts its own chunk, then the chunks are stitched
+ *
+ * 压缩 (compaction) 的做法:
+ *   - AVX2: 每个 lane 一位的掩码查表得到 shuffle 控制字 (AVX-512 的 VPCOMPRESS 在 AVX2 上的模拟)，
+ *     4/8 字节的元素用 vpermd，1/2 字节的元素用 pshufb，每 8 个 lane 一张表。
+ *   - SSE2: 没有变长的 shuffle (pshufb 是 SSSE3)，逐个 lane 搬运反而比标量慢，所以直接用无分支的标量循环:
+ *         out[k] = x[i]; k += keep(x[i]);
+ *     每个元素都写，但没有分支预测失败 —— 保留概率接近 50% 时 std::remove_if 的瓶颈正是分支。
+ * 连续区间上的算术类型配任意谓词 (比如 lambda) 也走这个无分支循环；其它情况转给 std:: 版本。
+ *
+ * 谓词用 simd.h 里的 simd::less_than(5) 等才能向量化，remove(beg, end, value) 自动使用 simd::equal_to(value)。
+ */
+
+namespace detail {
+
+using simd::value_of;
+using simd::use_simd;
+
+#if defined(STL_DEMO_SIMD_AVX2)
+
+// compaction shuffles, indexed by an 8 bit keep mask
+struct compress_tables {
+    std::uint64_t bytes[256];          // indices of the set bits, packed to the front, one per byte
+    unsigned char words[256][16];      // the same as a pshufb control for 8 lanes of 2 bytes
+    unsigned char pairs[16];           // 4 bit mask of 8 byte lanes -> 8 bit mask of their 4 byte halves
+
+    compress_tables()
+    {
+        for (unsigned m = 0; m < 256; ++m) {
+            std::uint64_t packed = 0;
+            unsigned k = 0;
+            for (unsigned j = 0; j < 8; ++j) {
+                if (m & (1u << j)) {
+                    packed |= std::uint64_t(j) << (8 * k);
+                    words[m][2 * k] = static_cast<unsigned char>(2 * j);
+                    words[m][2 * k + 1] = static_cast<unsigned char>(2 * j + 1);
+                    ++k;
+                }
+            }
+            bytes[m] = packed;
+            for (; k < 8; ++k) {
+                words[m][2 * k] = words[m][2 * k + 1] = 0x80; // pshufb writes zero
+            }
+        }
+        for (unsigned m = 0; m < 16; ++m) {
+            unsigned d = 0;
+            for (unsigned j = 0; j < 4; ++j) {
+                if (m & (1u << j))
+                    d |= 3u << (2 * j);
+            }
+            pairs[m] = static_cast<unsigned char>(d);
+        }
+    }
+};
+
+inline const compress_tables& tables()
+{
+    static const compress_tables t;
+    return t;
+}
+
+inline void compress8(void* out, __m128i x, unsigned keep, const compress_tables& tab)
+{
+    // bytes 0-7 of x: the control only has to be right in its low 8 bytes
+    _mm_storel_epi64(static_cast<__m128i*>(out),
+                     _mm_shuffle_epi8(x, _mm_cvtsi64_si128(static_cast<long long>(tab.bytes[keep]))));
+}
+
+// the kept lanes of x are packed to the front, a whole register is stored
+inline std::size_t compress_lanes(unsigned char* out, simd::reg x, unsigned keep, const compress_tables& tab)
+{
+    std::size_t k = 0;
+    for (int half = 0; half < 2; ++half) {
+        const __m128i h = half ? _mm256_extracti128_si256(x, 1) : _mm256_castsi256_si128(x);
+        const unsigned lo = (keep >> (16 * half)) & 0xff, hi = (keep >> (16 * half + 8)) & 0xff;
+        compress8(out + k, h, lo, tab);
+        k += simd::popcount(lo);
+        compress8(out + k, _mm_srli_si128(h, 8), hi, tab);
+        k += simd::popcount(hi);
+    }
+    return k;
+}
+
+inline std::size_t compress_lanes(std::uint16_t* out, simd::reg x, unsigned keep, const compress_tables& tab)
+{
+    const unsigned lo = keep & 0xff, hi = keep >> 8;
+    const __m128i* ctrl_lo = reinterpret_cast<const __m128i*>(tab.words[lo]);
+    const __m128i* ctrl_hi = reinterpret_cast<const __m128i*>(tab.words[hi]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(_mm256_castsi256_si128(x), _mm_loadu_si128(ctrl_lo)));
+    const std::size_t k = simd::popcount(lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + k),
+                     _mm_shuffle_epi8(_mm256_extracti128_si256(x, 1), _mm_loadu_si128(ctrl_hi)));
+    return k + simd::popcount(hi);
+}
+
+inline std::size_t compress_lanes(std::uint32_t* out, simd::reg x, unsigned keep, const compress_tables& tab)
+{
+    const __m256i idx = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(tab.bytes[keep])));
+    simd::storeu(out, _mm256_permutevar8x32_epi32(x, idx));
+    return simd::popcount(keep);
+}
+
+inline std::size_t compress_lanes(std::uint64_t* out, simd::reg x, unsigned keep, const compress_tables& tab)
+{
+    compress_lanes(reinterpret_cast<std::uint32_t*>(out), x, tab.pairs[keep], tab);
+    return simd::popcount(keep);
+}
+
+// writes the kept lanes of x to out, returns how many were kept
+template <typename T>
+std::size_t compress(T* out, simd::reg x, unsigned keep, const compress_tables& tab)
+{
+    typedef typename simd::uint_of<sizeof(T)>::type U;
+    if (keep == 0)
+        return 0;
+    if (keep == simd::all_lanes<T>()) {
+        simd::storeu(out, x);
+        return simd::lane<T>::width;
+    }
+    return compress_lanes(reinterpret_cast<U*>(out), x, keep, tab);
+}
+
+#endif // STL_DEMO_SIMD_AVX2
+
+// -- pointer kernels, in place, return the new size --
+//
+// In place is safe because the output never overtakes the input: when block i is stored, the write
+// position is at most i, and the block was loaded before.
+
+template <typename T, typename Pred>
+std::size_t remove_branchless(T* p, std::size_t n, std::size_t i, std::size_t k, Pred& pred)
+{
+    for (; i < n; ++i) {
+        const T x = p[i];
+        p[k] = x;
+        k += pred(x) ? 0 : 1;
+    }
+    return k;
+}
+
+template <typename T, typename Pred>
+std::size_t remove_pred(T* p, std::size_t n, Pred pred)
+{
+    std::size_t i = 0, k = 0;
+#if defined(STL_DEMO_SIMD_AVX2)
+    typedef simd::lane<T> L;
+    const std::size_t W = L::width;
+    const simd::reg v = L::set1(pred.value);
+    const compress_tables& tab = tables();
+    for (; i + W <= n; i += W) {
+        const simd::reg x = L::load(p + i);
+        const unsigned keep = ~simd::lanemask<T>(pred.mask(x, v)) & simd::all_lanes<T>();
+        k += compress(p + k, x, keep, tab);
+    }
+#endif
+    return remove_branchless(p, n, i, k, pred);
+}
+
+// keeps x[i] when x[i] != x[i - 1]; equality is transitive, so comparing with the previous *input*
+// element gives the same result as std::unique, which compares with the previous *kept* one
+template <typename T>
+std::size_t unique(T* p, std::size_t n)
+{
+    if (n == 0)
+        return 0;
+    std::size_t i = 1, k = 1;
+    T prev = p[0];
+#if defined(STL_DEMO_SIMD_AVX2)
+    typedef simd::lane<T> L;
+    const std::size_t W = L::width;
+    const compress_tables& tab = tables();
+    for (; i + W <= n; i += W) {
+        const simd::reg x = L::load(p + i);
+        // lane 0 of the shifted load is p[i - 1], which the previous store may have overwritten:
+        // it comes from `prev` instead
+        simd::mask_t same = simd::lanemask<T>(L::eq(x, L::load(p + i - 1))) & ~simd::mask_t(1);
+        if (p[i] == prev)
+            same |= 1;
+        prev = p[i + W - 1];
+        k += compress(p + k, x, ~same & simd::all_lanes<T>(), tab);
+    }
+#endif
+    for (; i < n; ++i) {
+        const T x = p[i];
+        p[k] = x;
+        k += x == prev ? 0 : 1;
+        prev = x;
+    }
+    return k;
+}
+
+// -- iterator wrappers --
+
+template <typename It, typename Pred>
+It remove_if(It first, It last, Pred pred, std::true_type /* SIMD predicate */)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    return n == 0 ? last : first + remove_pred(&*first, n, pred);
+}
+
+template <typename It, typename Pred>
+It remove_if(It first, It last, Pred pred, std::false_type)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    return n == 0 ? last : first + remove_branchless(&*first, n, 0, 0, pred);
+}
+
+template <typename It, typename Pred>
+It remove_if(It first, It last, Pred pred)
+{
+    return remove_if(first, last, pred, simd::is_simd_predicate_for<Pred, typename value_of<It>::type>());
+}
+
+template <typename It, typename Pred>
+It remove_if_dispatch(It first, It last, Pred pred, std::true_type)
+{
+    return detail::remove_if(first, last, pred);
+}
+
+template <typename It, typename Pred>
+It remove_if_dispatch(It first, It last, Pred pred, std::false_type)
+{
+    return std::remove_if(first, last, pred);
+}
+
+template <typename It>
+It unique(It first, It last, std::true_type)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    return n == 0 ? last : first + detail::unique(&*first, n);
+}
+
+template <typename It>
+It unique(It first, It last, std::false_type)
+{
+    return std::unique(first, last);
+}
+
+/*
+ * Open addressing hash set that only answers "inserted now or seen before?".
+ * Linear probing over a power of 2 table, grown at a load factor of 1/2.
+ */
+template <typename T, typename Hash, typename KeyEqual>
+class seen_set {
+public:
+    seen_set(Hash hash, KeyEqual eq) : hash_(hash), eq_(eq), size_(0)
+    {
+        rehash(64);
+    }
+
+    // true when key was not in the set yet
+    bool insert(const T& key)
+    {
+        std::size_t i = home(key);
+        for (; used_[i]; i = (i + 1) & mask_) {
+            if (eq_(keys_[i], key))
+                return false;
+        }
+        keys_[i] = key;
+        used_[i] = 1;
+        if (++size_ * 2 > keys_.size())
+            rehash(keys_.size() * 2);
+        return true;
+    }
+
+private:
+    std::size_t home(const T& key) const
+    {
+        std::uint64_t h = static_cast<std::uint64_t>(hash_(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return static_cast<std::size_t>(h) & mask_;
+    }
+
+    void rehash(std::size_t cap)
+    {
+        std::vector<T> keys(cap);
+        std::vector<unsigned char> used(cap);
+        keys.swap(keys_);
+        used.swap(used_);
+        mask_ = cap - 1;
+        for (std::size_t j = 0; j < keys.size(); ++j) {
+            if (used[j]) {
+                std::size_t i = home(keys[j]);
+                while (used_[i]) {
+                    i = (i + 1) & mask_;
+                }
+                keys_[i] = keys[j];
+                used_[i] = 1;
+            }
+        }
+    }
+
+    Hash hash_;
+    KeyEqual eq_;
+    std::vector<T> keys_;
+    std::vector<unsigned char> used_;
+    std::size_t mask_;
+    std::size_t size_;
+};
+
+} // namespace detail
+
+template <typename It, typename Pred>
+It remove_if(It first, It last, Pred pred)
+{
+    return detail::remove_if_dispatch(first, last, pred, simd::use_simd<It>());
+}
+
+template <typename It, typename T>
+It remove(It first, It last, const T& value)
+{
+    typedef typename detail::value_of<It>::type V;
+    if (!simd::representable<V>(value))
+        return std::remove(first, last, value);
+    return remove_kernels::remove_if(first, last, simd::equal_to(static_cast<V>(value)));
+}
+
+// the same as std::unique(beg, end): only adjacent duplicates are removed
+template <typename It>
+It unique(It first, It last)
+{
+    return detail::unique(first, last, simd::use_simd<It>());
+}
+
+/*
+ * Removes every element equal to an element before it, wherever that one is; the range does not have
+ * to be sorted. Stable: the survivors are the first occurrences, in their original order.
+ * O(n) expected time, the hash set holds one copy of every distinct value.
+ */
+template <typename It, typename Hash, typename KeyEqual>
+It unique_unsorted(It first, It last, Hash hash, KeyEqual eq)
+{
+    typedef typename std::iterator_traits<It>::value_type T;
+    detail::seen_set<T, Hash, KeyEqual> seen(hash, eq);
+    It out = first;
+    for (; first != last; ++first) {
+        if (seen.insert(*first)) {
+            if (out != first)
+                *out = std::move(*first);
+            ++out;
+        }
+    }
+    return out;
+}
+
+template <typename It>
+It unique_unsorted(It first, It last)
+{
+    typedef typename std::iterator_traits<It>::value_type T;
+    return remove_kernels::unique_unsorted(first, last, std::hash<T>(), std::equal_to<T>());
+}
+
+namespace parallel {
+
+static const std::size_t kMinPerThread = 1 << 16;
+
+/*
+ * Every thread runs remove_if() on its own chunk, which leaves kept[c] survivors at the front of chunk c.
+ * The survivors are then moved down behind the ones of the previous chunks, one chunk after the other
+ * (the moves overlap, a plain memmove for trivial types). The predicate runs once per element.
+ */
+template <typename It, typename Pred>
+It remove_if(It first, It last, Pred pred)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t chunks = algorithms::parallel::chunk_count(n, kMinPerThread);
+    if (chunks <= 1)
+        return remove_kernels::remove_if(first, last, pred);
+
+    std::vector<std::size_t> begins(chunks), kept(chunks);
+    algorithms::parallel::for_each_chunk(n, chunks, [&] (std::size_t c, std::size_t b, std::size_t e) {
+        begins[c] = b;
+        kept[c] = static_cast<std::size_t>(remove_kernels::remove_if(first + b, first + e, pred) - (first + b));
+    });
+    It out = first + kept[0];
+    for (std::size_t c = 1; c < chunks; ++c) {
+        if (out != first + begins[c])
+            out = std::move(first + begins[c], first + begins[c] + kept[c], out);
+        else
+            out += kept[c];
+    }
+    return out;
+}
+
+template <typename It, typename T>
+It remove(It first, It last, const T& value)
+{
+    typedef typename std::iterator_traits<It>::value_type V;
+    if (!simd::representable<V>(value))
+        return std::remove(first, last, value);
+    return parallel::remove_if(first, last, simd::equal_to(static_cast<V>(value)));
+}
+
+} // namespace parallel
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_REMOVE_KERNELS_H
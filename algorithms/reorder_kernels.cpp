@@ -0,0 +1,204 @@
+#include "reorder_kernels.h"
+#include "helper.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace algorithms {
+namespace reorder_kernels {
+
+// reverse_order_demo(), rotate_demo() of mutating.cpp and swap_range_demo() of modifying.cpp
+void same_as_std_demo()
+{
+    vector<int> coll;
+    helper::INSERT_ELEMENTS(coll, 1, 9);
+    helper::PRINT_ELEMENT(coll, "coll: ");
+
+    reorder_kernels::reverse(coll.begin(), coll.end());
+    helper::PRINT_ELEMENT(coll, "reverse coll: ");
+    reorder_kernels::reverse(coll.begin() + 1, coll.end() - 1);
+    helper::PRINT_ELEMENT(coll, "reverse coll 2: ");
+    // ostream_iterator 不是连续内存，走 std::reverse_copy
+    reorder_kernels::reverse_copy(coll.begin(), coll.end(), ostream_iterator<int>(cout, " "));
+    cout << endl;
+
+    reorder_kernels::reverse(coll.begin(), coll.end());
+    //shift one element left
+    reorder_kernels::rotate(coll.begin(), coll.begin() + 1, coll.end());
+    helper::PRINT_ELEMENT(coll, "rotate first: ");
+    //shift 2 elements right
+    reorder_kernels::rotate(coll.begin(), coll.end() - 2, coll.end());
+    helper::PRINT_ELEMENT(coll, "rotate second: ");
+    vector<int> rotated(coll.size());
+    reorder_kernels::rotate_copy(coll.begin(), coll.begin() + 4, coll.end(), rotated.begin());
+    helper::PRINT_ELEMENT(rotated, "rotate_copy at 4: ");
+
+    // deque 不是连续内存，和 swap_range_demo() 一样交给 std::swap_ranges
+    vector<int> coll1;
+    deque<int> coll2;
+    helper::INSERT_ELEMENTS(coll1, 1, 9);
+    helper::INSERT_ELEMENTS(coll2, 10, 23);
+    reorder_kernels::swap_ranges(coll1.begin(), coll1.end(), coll2.begin());
+    helper::PRINT_ELEMENT(coll1, "coll1 swapped: ");
+    helper::PRINT_ELEMENT(coll2, "coll2 swapped: ");
+    vector<int> coll3;
+    helper::INSERT_ELEMENTS(coll3, 10, 18);
+    reorder_kernels::swap_ranges(coll1.begin(), coll1.end(), coll3.begin());
+    helper::PRINT_ELEMENT(coll1, "coll1 swapped with vector: ");
+}
+
+struct point {
+    float x, y, z;
+
+    bool operator==(const point& other) const { return x == other.x && y == other.y && z == other.z; }
+};
+
+template <typename T>
+bool check_type(mt19937& gen)
+{
+    bool ok = true;
+    for (size_t n : {0, 1, 2, 7, 31, 32, 33, 64, 100, 1000, 4099}) {
+        vector<T> data(n);
+        for (size_t i = 0; i < n; ++i) {
+            data[i] = static_cast<T>(gen());
+        }
+        vector<T> a(data), b(data);
+        reorder_kernels::reverse(a.begin(), a.end());
+        std::reverse(b.begin(), b.end());
+        ok = ok && a == b;
+
+        vector<T> c(n);
+        reorder_kernels::reverse_copy(data.begin(), data.end(), c.begin());
+        ok = ok && c == b;
+
+        // every middle for small n, a few for the larger ones
+        for (size_t m = 0; m <= n; m += (n < 100 ? 1 : n / 7 + 1)) {
+            a = data;
+            b = data;
+            auto ra = reorder_kernels::rotate(a.begin(), a.begin() + m, a.end());
+            auto rb = std::rotate(b.begin(), b.begin() + m, b.end());
+            ok = ok && a == b && ra - a.begin() == rb - b.begin();
+            reorder_kernels::rotate_copy(data.begin(), data.begin() + m, data.end(), c.begin());
+            ok = ok && c == b;
+        }
+
+        a = data;
+        b = c;
+        vector<T> a2(data), b2(c);
+        reorder_kernels::swap_ranges(a.begin(), a.end(), b.begin());
+        std::swap_ranges(a2.begin(), a2.end(), b2.begin());
+        ok = ok && a == a2 && b == b2;
+    }
+    return ok;
+}
+
+template <>
+bool check_type<point>(mt19937& gen)
+{
+    vector<point> data(1001);
+    for (auto& p : data) {
+        p = point{static_cast<float>(gen() % 100), static_cast<float>(gen() % 100), static_cast<float>(gen() % 100)};
+    }
+    vector<point> a(data), b(data);
+    reorder_kernels::reverse(a.begin(), a.end());
+    std::reverse(b.begin(), b.end());
+    bool ok = a == b;
+    reorder_kernels::rotate(a.begin(), a.begin() + 333, a.end());
+    std::rotate(b.begin(), b.begin() + 333, b.end());
+    return ok && a == b;
+}
+
+bool cross_check()
+{
+    mt19937 gen(5);
+    bool ok = check_type<uint8_t>(gen) && check_type<int16_t>(gen) && check_type<int32_t>(gen) &&
+              check_type<float>(gen) && check_type<int64_t>(gen) && check_type<double>(gen) && check_type<point>(gen);
+
+    // rotations too large for the buffer: Gries-Mills block swaps
+    vector<int32_t> data(1000003), a, b;
+    iota(data.begin(), data.end(), 0);
+    for (size_t m : {size_t(300001), size_t(500001), size_t(700001)}) {
+        a = data;
+        b = data;
+        reorder_kernels::rotate(a.begin(), a.begin() + m, a.end());
+        std::rotate(b.begin(), b.begin() + m, b.end());
+        ok = ok && a == b;
+    }
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+void benchmark()
+{
+    const size_t kValues = 100000000;
+    vector<int32_t> data(kValues);
+    iota(data.begin(), data.end(), 0);
+
+    long long t = time_ms([&] { std::reverse(data.begin(), data.end()); });
+    cout << "std::reverse: " << t << " ms" << endl;
+    t = time_ms([&] { reorder_kernels::reverse(data.begin(), data.end()); });
+    cout << "reverse: " << t << " ms (data[0] = " << data[0] << ")" << endl;
+
+    // in cache, bytes: the compiler vectorizes std::reverse of ints by itself with -mavx2, not always of bytes
+    vector<uint8_t> bytes(1 << 14);
+    iota(bytes.begin(), bytes.end(), 0);
+    t = time_ms([&] {
+        for (int r = 0; r < 20000; ++r) {
+            std::reverse(bytes.begin(), bytes.end());
+        }
+    });
+    cout << "std::reverse 16 KB x 20000: " << t << " ms" << endl;
+    t = time_ms([&] {
+        for (int r = 0; r < 20000; ++r) {
+            reorder_kernels::reverse(bytes.begin(), bytes.end());
+        }
+    });
+    cout << "reverse 16 KB x 20000: " << t << " ms (bytes[1] = " << int(bytes[1]) << ")" << endl;
+
+    vector<int32_t> out(kValues);
+    t = time_ms([&] { std::reverse_copy(data.begin(), data.end(), out.begin()); });
+    cout << "std::reverse_copy: " << t << " ms" << endl;
+    t = time_ms([&] { reorder_kernels::reverse_copy(data.begin(), data.end(), out.begin()); });
+    cout << "reverse_copy: " << t << " ms" << endl;
+
+    // a ring buffer that drops its first 1000 entries, and a rotation by a third
+    t = time_ms([&] { std::rotate(data.begin(), data.begin() + 1000, data.end()); });
+    cout << "std::rotate by 1000: " << t << " ms" << endl;
+    t = time_ms([&] { reorder_kernels::rotate(data.begin(), data.begin() + 1000, data.end()); });
+    cout << "rotate by 1000: " << t << " ms" << endl;
+    t = time_ms([&] { std::rotate(data.begin(), data.begin() + kValues / 3, data.end()); });
+    cout << "std::rotate by n/3: " << t << " ms" << endl;
+    t = time_ms([&] { reorder_kernels::rotate(data.begin(), data.begin() + kValues / 3, data.end()); });
+    cout << "rotate by n/3: " << t << " ms (data[0] = " << data[0] << ")" << endl;
+
+    t = time_ms([&] { std::swap_ranges(data.begin(), data.end(), out.begin()); });
+    cout << "std::swap_ranges: " << t << " ms" << endl;
+    t = time_ms([&] { reorder_kernels::swap_ranges(data.begin(), data.end(), out.begin()); });
+    cout << "swap_ranges: " << t << " ms" << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
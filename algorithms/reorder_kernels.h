@@ -0,0 +1,274 @@
+#ifndef STL_DEMO_ALGORITHMS_REORDER_KERNELS_H
+#define STL_DEMO_ALGORITHMS_REORDER_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "simd.h"
+
+namespace algorithms {
+namespace reorder_kernels {
+
+/*
+ * Drop-in replacements for reverse_order_demo(), rotate_demo() of mutating.cpp and swap_range_demo()
+ * of modifying.cpp, for contiguous ranges of trivially copyable elements (any struct, not only numbers):
+ *
+ *     reverse()          a register from the front and one from the back are loaded, their lanes reversed
+ *                        with one shuffle and stored crosswise (elements of 1, 2, 4 or 8 bytes)
+ *     reverse_copy()     the same, reading backwards and writing forwards
+ *     swap_ranges()      whole registers instead of one element at a time
+ *     rotate()           short side <= 1 MB: memcpy the short side away, memmove the long side, copy back
+ *                        (three sequential passes); otherwise Gries-Mills block swaps, no extra memory
+ *     rotate_copy()      two memcpy
+ *
+ * 元素按字节搬运，所以只要 std::is_trivially_copyable 成立就可以 (比如 struct { float re, im; })；
+ * 其它情况 (list, 带拷贝构造函数的类型) 直接转给 std:: 版本。
+ */
+
+namespace detail {
+
+using simd::value_of;
+using simd::is_bitwise;
+using simd::is_bitwise_pair;
+using simd::is_lane_size;
+
+// -- pointer kernels: only the registers see the elements as lanes of their size, the scalar tails stay on T --
+// (a float or a struct { float re, im; } must not be accessed through a uint32_t / uint64_t lvalue)
+
+template <typename T>
+void reverse(T* p, std::size_t n)
+{
+    std::size_t i = 0, j = n;
+#if defined(STL_DEMO_SIMD)
+    const std::size_t W = simd::kBytes / sizeof(T);
+    for (; j - i >= 2 * W; i += W, j -= W) {
+        const simd::reg front = simd::loadu(p + i);
+        const simd::reg back = simd::loadu(p + j - W);
+        simd::storeu(p + i, simd::reverse<T>(back));
+        simd::storeu(p + j - W, simd::reverse<T>(front));
+    }
+#endif
+    std::reverse(p + i, p + j);
+}
+
+template <typename T>
+void reverse_copy(const T* p, std::size_t n, T* out)
+{
+    std::size_t k = 0;
+#if defined(STL_DEMO_SIMD)
+    const std::size_t W = simd::kBytes / sizeof(T);
+    for (; k + W <= n; k += W) {
+        simd::storeu(out + k, simd::reverse<T>(simd::loadu(p + n - k - W)));
+    }
+#endif
+    for (; k < n; ++k) {
+        out[k] = p[n - 1 - k];
+    }
+}
+
+// a and b must not overlap
+inline void swap_bytes(unsigned char* a, unsigned char* b, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    const std::size_t B = simd::kBytes;
+    for (; i + 2 * B <= n; i += 2 * B) {
+        const simd::reg a0 = simd::loadu(a + i), a1 = simd::loadu(a + i + B);
+        const simd::reg b0 = simd::loadu(b + i), b1 = simd::loadu(b + i + B);
+        simd::storeu(a + i, b0);
+        simd::storeu(a + i + B, b1);
+        simd::storeu(b + i, a0);
+        simd::storeu(b + i + B, a1);
+    }
+#endif
+    unsigned char tmp[64];
+    while (i < n) {
+        const std::size_t len = std::min(n - i, sizeof(tmp));
+        std::memcpy(tmp, a + i, len);
+        std::memcpy(a + i, b + i, len);
+        std::memcpy(b + i, tmp, len);
+        i += len;
+    }
+}
+
+static const std::size_t kStackBuffer = 4096;
+static const std::size_t kHeapBuffer = std::size_t(1) << 20;
+
+// short side <= kHeapBuffer: three sequential passes over the memory
+inline void rotate_buffered(unsigned char* first, unsigned char* middle, unsigned char* last)
+{
+    const std::size_t a = static_cast<std::size_t>(middle - first), b = static_cast<std::size_t>(last - middle);
+    const std::size_t shorter = std::min(a, b);
+    unsigned char stack[kStackBuffer];
+    std::vector<unsigned char> heap;
+    unsigned char* buf = stack;
+    if (shorter > kStackBuffer) {
+        heap.resize(shorter);
+        buf = heap.data();
+    }
+    if (a <= b) {
+        std::memcpy(buf, first, a);
+        std::memmove(first, middle, b);
+        std::memcpy(first + b, buf, a);
+    } else {
+        std::memcpy(buf, middle, b);
+        std::memmove(first + b, first, a);
+        std::memcpy(first, buf, b);
+    }
+}
+
+// rotates the bytes [first, last) so that middle becomes the first byte
+inline void rotate_bytes(unsigned char* first, unsigned char* middle, unsigned char* last)
+{
+    /*
+     * Gries-Mills: with A = [first, middle) and B = [middle, last)
+     *   |A| <= |B|, B = B1 B2, |B2| = |A|:  swap A and B2 -> B2 B1 A, A is in place, rotate B2 B1 next
+     *   |A| >  |B|, A = A1 A2, |A1| = |B|:  swap A1 and B -> B A2 A1, B is in place, rotate A2 A1 next
+     * every swap puts the shorter side into its final place. 两边长度像辗转相除一样递减，
+     * 短的一边一旦放得进缓冲区就改用 rotate_buffered()，否则 (n/3, 2n/3 + 1) 这种会退化成逐个元素交换。
+     */
+    while (static_cast<std::size_t>(std::min(middle - first, last - middle)) > kHeapBuffer) {
+        const std::size_t left = static_cast<std::size_t>(middle - first), right = static_cast<std::size_t>(last - middle);
+        if (left <= right) {
+            swap_bytes(first, last - left, left);
+            last -= left;
+        } else {
+            swap_bytes(first, middle, right);
+            first += right;
+        }
+    }
+    if (first != middle && middle != last)
+        rotate_buffered(first, middle, last);
+}
+
+// -- iterator wrappers --
+
+template <typename It>
+void reverse(It first, It last, std::true_type)
+{
+    if (first != last)
+        detail::reverse(&*first, static_cast<std::size_t>(last - first));
+}
+
+template <typename It>
+void reverse(It first, It last, std::false_type)
+{
+    std::reverse(first, last);
+}
+
+template <typename It, typename Out>
+Out reverse_copy(It first, It last, Out out, std::true_type)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (n > 0)
+        detail::reverse_copy(&*first, n, &*out);
+    return out + n;
+}
+
+template <typename It, typename Out>
+Out reverse_copy(It first, It last, Out out, std::false_type)
+{
+    return std::reverse_copy(first, last, out);
+}
+
+template <typename It1, typename It2>
+It2 swap_ranges(It1 first1, It1 last1, It2 first2, std::true_type)
+{
+    const std::size_t n = static_cast<std::size_t>(last1 - first1);
+    if (n > 0)
+        swap_bytes(reinterpret_cast<unsigned char*>(&*first1), reinterpret_cast<unsigned char*>(&*first2),
+                   n * sizeof(typename value_of<It1>::type));
+    return first2 + n;
+}
+
+template <typename It1, typename It2>
+It2 swap_ranges(It1 first1, It1 last1, It2 first2, std::false_type)
+{
+    return std::swap_ranges(first1, last1, first2);
+}
+
+template <typename It>
+It rotate(It first, It middle, It last, std::true_type)
+{
+    if (first == middle)
+        return last;
+    if (middle == last)
+        return first;
+    const std::size_t size = sizeof(typename value_of<It>::type);
+    unsigned char* base = reinterpret_cast<unsigned char*>(&*first);
+    rotate_bytes(base, base + (middle - first) * size, base + (last - first) * size);
+    return first + (last - middle);
+}
+
+template <typename It>
+It rotate(It first, It middle, It last, std::false_type)
+{
+    return std::rotate(first, middle, last);
+}
+
+template <typename It, typename Out>
+Out rotate_copy(It first, It middle, It last, Out out, std::true_type)
+{
+    const std::size_t size = sizeof(typename value_of<It>::type);
+    const std::size_t a = static_cast<std::size_t>(middle - first), b = static_cast<std::size_t>(last - middle);
+    if (b > 0)
+        std::memcpy(&*out, &*middle, b * size);
+    if (a > 0)
+        std::memcpy(&*(out + b), &*first, a * size);
+    return out + (a + b);
+}
+
+template <typename It, typename Out>
+Out rotate_copy(It first, It middle, It last, Out out, std::false_type)
+{
+    return std::rotate_copy(first, middle, last, out);
+}
+
+} // namespace detail
+
+template <typename It>
+void reverse(It first, It last)
+{
+    typedef typename detail::value_of<It>::type T;
+    detail::reverse(first, last, std::integral_constant<bool, detail::is_bitwise<It>::value && detail::is_lane_size<sizeof(T)>::value>());
+}
+
+template <typename It, typename Out>
+Out reverse_copy(It first, It last, Out out)
+{
+    typedef typename detail::value_of<It>::type T;
+    return detail::reverse_copy(first, last, out,
+                                std::integral_constant<bool, detail::is_bitwise_pair<It, Out>::value &&
+                                                                 detail::is_lane_size<sizeof(T)>::value>());
+}
+
+// the ranges must not overlap
+template <typename It1, typename It2>
+It2 swap_ranges(It1 first1, It1 last1, It2 first2)
+{
+    return detail::swap_ranges(first1, last1, first2, detail::is_bitwise_pair<It1, It2>());
+}
+
+// returns first + (last - middle), the new position of *first, like std::rotate since C++11
+template <typename It>
+It rotate(It first, It middle, It last)
+{
+    return detail::rotate(first, middle, last, detail::is_bitwise<It>());
+}
+
+template <typename It, typename Out>
+Out rotate_copy(It first, It middle, It last, Out out)
+{
+    return detail::rotate_copy(first, middle, last, out, detail::is_bitwise_pair<It, Out>());
+}
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_REORDER_KERNELS_H
@@ -0,0 +1,204 @@
+#include "scan_kernels.h"
+#include "helper.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace algorithms {
+namespace scan_kernels {
+
+// partial_sum_demo() and adjacent_difference_demo() of numerics.cpp
+void same_as_std_demo()
+{
+    list<int> coll;
+    helper::INSERT_ELEMENTS(coll, 1, 6);
+    helper::PRINT_ELEMENT(coll, "coll: ");
+
+    inclusive_scan(coll.begin(), coll.end(), ostream_iterator<int>(cout, " "));
+    cout << endl;
+    inclusive_scan(coll.begin(), coll.end(), ostream_iterator<int>(cout, " "), multiplies<int>());
+    cout << endl;
+    exclusive_scan(coll.begin(), coll.end(), ostream_iterator<int>(cout, " "), 0);
+    cout << endl;
+    // running sum of squares
+    transform_inclusive_scan(coll.begin(), coll.end(), ostream_iterator<int>(cout, " "), plus<int>(),
+                             [] (int x) { return x * x; });
+    cout << endl;
+
+    vector<int> sums(coll.size()), diffs(coll.size());
+    inclusive_scan(coll.begin(), coll.end(), sums.begin());
+    parallel::adjacent_difference(sums.begin(), sums.end(), diffs.begin());
+    helper::PRINT_ELEMENT(diffs, "adjacent_difference of the sums: ");
+
+    // running totals per group: a flag starts a new group
+    vector<int> amounts = {5, 3, 2, 7, 1, 4, 6};
+    vector<bool> starts = {true, false, false, true, false, true, false};
+    vector<int> totals(amounts.size());
+    segmented_inclusive_scan(amounts.begin(), amounts.end(), starts.begin(), totals.begin());
+    helper::PRINT_ELEMENT(totals, "segmented sums: ");
+}
+
+/*
+ * Variable-length records in one flat array: polygons with a different number of vertices each.
+ * The exclusive scan of the vertex counts is the start offset of every polygon; the last offset plus
+ * the last count is the size of the vertex array (the "offsets" column of Arrow-like formats).
+ */
+struct point {
+    float x;
+    float y;
+};
+
+void offsets_demo()
+{
+    vector<uint32_t> counts = {3, 4, 5, 3, 6};
+    vector<uint32_t> offsets(counts.size() + 1);
+    exclusive_scan(counts.begin(), counts.end(), offsets.begin(), 0u);
+    offsets.back() = offsets[counts.size() - 1] + counts.back();
+    helper::PRINT_ELEMENT(offsets, "vertex offsets: ");
+
+    vector<point> vertices(offsets.back());
+    for (size_t p = 0; p < counts.size(); ++p) {
+        for (uint32_t v = 0; v < counts[p]; ++v) {
+            const float angle = 6.2831853f * v / counts[p];
+            point pt = {static_cast<float>(p) + cos(angle), sin(angle)};
+            vertices[offsets[p] + v] = pt;
+        }
+    }
+    // polygon 2 is vertices[offsets[2], offsets[3])
+    cout << "polygon 2 has " << offsets[3] - offsets[2] << " vertices, the first one at (" << vertices[offsets[2]].x
+         << ", " << vertices[offsets[2]].y << ")" << endl;
+}
+
+// with many elements the parallel code paths run (more of them with STL_DEMO_THREADS=8)
+bool cross_check()
+{
+    mt19937 gen(7);
+    uniform_int_distribution<int> val(-1000, 1000);
+    const size_t n = 1000003;
+    vector<int> data(n);
+    vector<int64_t> wide(n);
+    vector<bool> flags(n);
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = val(gen);
+        wide[i] = static_cast<int64_t>(data[i]) * (int64_t(1) << 20); // a left shift of a negative value is undefined
+        flags[i] = val(gen) > 900;
+    }
+
+    vector<int> expected(n), got(n);
+    std::partial_sum(data.begin(), data.end(), expected.begin());
+    inclusive_scan(data.begin(), data.end(), got.begin());
+    bool ok = got == expected;
+    parallel::inclusive_scan(data.begin(), data.end(), got.begin());
+    ok = ok && got == expected;
+
+    // in place, with an initial value
+    vector<int> inplace(data);
+    parallel::inclusive_scan(inplace.begin(), inplace.end(), inplace.begin(), plus<int>(), 100);
+    for (size_t i = 0; i < n && ok; ++i) {
+        ok = inplace[i] == expected[i] + 100;
+    }
+
+    vector<int64_t> wexpected(n), wgot(n);
+    wexpected[0] = 5;
+    for (size_t i = 1; i < n; ++i) {
+        wexpected[i] = wexpected[i - 1] + wide[i - 1];
+    }
+    exclusive_scan(wide.begin(), wide.end(), wgot.begin(), int64_t(5));
+    ok = ok && wgot == wexpected;
+    parallel::exclusive_scan(wide.begin(), wide.end(), wgot.begin(), int64_t(5));
+    ok = ok && wgot == wexpected;
+
+    // associative but not commutative: the chunks have to be combined in order
+    auto last_non_negative = [] (int a, int b) { return b >= 0 ? b : a; };
+    std::partial_sum(data.begin(), data.end(), expected.begin(), last_non_negative);
+    parallel::inclusive_scan(data.begin(), data.end(), got.begin(), last_non_negative);
+    ok = ok && got == expected;
+
+    auto square = [] (int x) { return static_cast<int64_t>(x) * x; };
+    transform(data.begin(), data.end(), wexpected.begin(), square);
+    std::partial_sum(wexpected.begin(), wexpected.end(), wexpected.begin());
+    parallel::transform_inclusive_scan(data.begin(), data.end(), wgot.begin(), plus<int64_t>(), square);
+    ok = ok && wgot == wexpected;
+
+    int acc = 0;
+    for (size_t i = 0; i < n; ++i) {
+        acc = (i == 0 || flags[i]) ? data[i] : acc + data[i];
+        expected[i] = acc;
+    }
+    segmented_inclusive_scan(data.begin(), data.end(), flags.begin(), got.begin());
+    ok = ok && got == expected;
+    fill(got.begin(), got.end(), 0);
+    parallel::segmented_inclusive_scan(data.begin(), data.end(), flags.begin(), got.begin());
+    ok = ok && got == expected;
+
+    std::adjacent_difference(data.begin(), data.end(), expected.begin());
+    parallel::adjacent_difference(data.begin(), data.end(), got.begin());
+    ok = ok && got == expected;
+    fill(got.begin(), got.end(), 0);
+    scan_kernels::adjacent_difference(data.begin(), data.end(), got.begin());
+    ok = ok && got == expected;
+    // the sequential version may write over its input, like std::adjacent_difference
+    inplace = data;
+    scan_kernels::adjacent_difference(inplace.begin(), inplace.end(), inplace.begin());
+    ok = ok && inplace == expected;
+
+    // floats are only close, the order of the additions differs
+    vector<float> fdata(n), fexpected(n), fgot(n);
+    for (size_t i = 0; i < n; ++i) {
+        fdata[i] = data[i] / 1000.0f;
+    }
+    std::partial_sum(fdata.begin(), fdata.end(), fexpected.begin());
+    parallel::inclusive_scan(fdata.begin(), fdata.end(), fgot.begin());
+    for (size_t i = 0; i < n && ok; i += 997) {
+        ok = fabs(fgot[i] - fexpected[i]) <= 1e-3f * (1.0f + fabs(fexpected[i]));
+    }
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+void benchmark()
+{
+    const size_t kValues = 100000000;
+    vector<int32_t> data(kValues), out(kValues);
+    mt19937 gen(42);
+    for (auto& x : data) {
+        x = static_cast<int32_t>(gen() & 0x0f); // the total stays below 2^31
+    }
+
+    long long t = time_ms([&] { std::partial_sum(data.begin(), data.end(), out.begin()); });
+    cout << "std::partial_sum: " << t << " ms, last " << out.back() << endl;
+    t = time_ms([&] { inclusive_scan(data.begin(), data.end(), out.begin()); });
+    cout << "inclusive_scan (SIMD): " << t << " ms, last " << out.back() << endl;
+    t = time_ms([&] { parallel::inclusive_scan(data.begin(), data.end(), out.begin()); });
+    cout << "parallel::inclusive_scan: " << t << " ms, last " << out.back() << " ("
+         << algorithms::parallel::thread_count() << " threads)" << endl;
+    t = time_ms([&] { parallel::inclusive_scan(data.begin(), data.end(), out.begin(), [] (int32_t a, int32_t b) { return a + b; }); });
+    cout << "parallel::inclusive_scan (lambda, scalar): " << t << " ms" << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    offsets_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
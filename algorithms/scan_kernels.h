@@ -0,0 +1,498 @@
+#ifndef STL_DEMO_ALGORITHMS_SCAN_KERNELS_H
+#define STL_DEMO_ALGORITHMS_SCAN_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "simd.h"
+#include "parallel.h"
+
+namespace algorithms {
+namespace scan_kernels {
+
+/*
+ * Prefix scans, the C++17 <numeric> family on top of C++11:
+ *
+ *     inclusive_scan(beg, end, out [, op [, init]])             the same as partial_sum()
+ *     exclusive_scan(beg, end, out, init [, op])                init, init op a1, init op a1 op a2, ...
+ *     transform_inclusive_scan(beg, end, out, op, unary)        scan of unary(a1), unary(a2), ...
+ *     transform_exclusive_scan(beg, end, out, init, op, unary)
+ *     segmented_inclusive_scan(beg, end, flags, out [, op])     restarts wherever *flags is true
+ *     adjacent_difference(beg, end, out [, op])                 the same as std::adjacent_difference()
+ *
+ * op 必须满足结合律 ((a op b) op c == a op (b op c))，但不需要交换律，也不需要单位元。
+ *
+ * The sequential versions scan four (int32/float) or two (int64/double) elements per instruction when
+ * op is std::plus<T> and both ranges are contiguous: a register is scanned in place with two shifted
+ * adds (x + (x << 1 lane) + (x << 2 lanes)) and the carry of the previous register is broadcast and added.
+ *
+ * parallel:: runs the classic two pass "reduce then scan":
+ *     pass 1  every thread reduces its chunk to one value
+ *     serial  the chunk results are scanned (one value per thread)
+ *     pass 2  every thread scans its chunk again, starting with the carry of all chunks before it
+ * The input is read twice, the output written once.
+ *
+ * 浮点数的加法不满足结合律，SIMD 和多线程版本的加法顺序和 std::partial_sum 不同，结果可能有最后几位的误差。
+ */
+
+namespace detail {
+
+struct identity {
+    template <typename T>
+    T&& operator()(T&& x) const { return std::forward<T>(x); }
+};
+
+template <typename In, typename Unary>
+struct scan_value {
+    typedef typename std::decay<decltype(std::declval<Unary>()(*std::declval<In>()))>::type type;
+};
+
+// generic sequential scan of [first, last) continuing from acc
+template <bool Inclusive, typename In, typename Out, typename Op, typename Unary, typename T>
+Out scan_from(In first, In last, Out out, Op op, Unary unary, T acc)
+{
+    for (; first != last; ++first, ++out) {
+        T v = unary(*first); // read before write: out may alias first
+        if (Inclusive) {
+            acc = op(acc, v);
+            *out = acc;
+        } else {
+            *out = acc;
+            acc = op(acc, v);
+        }
+    }
+    return out;
+}
+
+#if defined(STL_DEMO_SIMD)
+
+// in-register prefix sums of a 128 bit vector (SSE2 is there in AVX2 builds as well)
+template <typename T, typename Enable = void>
+struct prefix128;
+
+template <typename T>
+struct prefix128<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) == 4>::type> {
+    typedef __m128i vec;
+    static const std::size_t width = 4;
+    static vec load(const T* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(T* p, vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static vec zero() { return _mm_setzero_si128(); }
+    static vec set1(T v) { return _mm_set1_epi32(static_cast<int>(v)); }
+    static vec add(vec a, vec b) { return _mm_add_epi32(a, b); }
+    static vec shift1(vec v) { return _mm_slli_si128(v, 4); }
+    static vec local(vec x)
+    {
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        return _mm_add_epi32(x, _mm_slli_si128(x, 8));
+    }
+    static vec last(vec v) { return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3)); }
+};
+
+template <typename T>
+struct prefix128<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) == 8>::type> {
+    typedef __m128i vec;
+    static const std::size_t width = 2;
+    static vec load(const T* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(T* p, vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static vec zero() { return _mm_setzero_si128(); }
+    static vec set1(T v) { return _mm_set1_epi64x(static_cast<long long>(v)); }
+    static vec add(vec a, vec b) { return _mm_add_epi64(a, b); }
+    static vec shift1(vec v) { return _mm_slli_si128(v, 8); }
+    static vec local(vec x) { return _mm_add_epi64(x, _mm_slli_si128(x, 8)); }
+    static vec last(vec v) { return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 2, 3, 2)); }
+};
+
+template <>
+struct prefix128<float> {
+    typedef __m128 vec;
+    static const std::size_t width = 4;
+    static vec load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, vec v) { _mm_storeu_ps(p, v); }
+    static vec zero() { return _mm_setzero_ps(); }
+    static vec set1(float v) { return _mm_set1_ps(v); }
+    static vec add(vec a, vec b) { return _mm_add_ps(a, b); }
+    static vec shift1(vec v) { return _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)); }
+    static vec local(vec x)
+    {
+        x = _mm_add_ps(x, shift1(x));
+        return _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+    }
+    static vec last(vec v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+};
+
+template <>
+struct prefix128<double> {
+    typedef __m128d vec;
+    static const std::size_t width = 2;
+    static vec load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, vec v) { _mm_storeu_pd(p, v); }
+    static vec zero() { return _mm_setzero_pd(); }
+    static vec set1(double v) { return _mm_set1_pd(v); }
+    static vec add(vec a, vec b) { return _mm_add_pd(a, b); }
+    static vec shift1(vec v) { return _mm_castsi128_pd(_mm_slli_si128(_mm_castpd_si128(v), 8)); }
+    static vec local(vec x) { return _mm_add_pd(x, shift1(x)); }
+    static vec last(vec v) { return _mm_unpackhi_pd(v, v); }
+};
+
+template <typename T>
+struct has_prefix128
+    : std::integral_constant<bool, (std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                    (sizeof(T) == 4 || sizeof(T) == 8)) ||
+                                       std::is_same<T, float>::value || std::is_same<T, double>::value> {};
+
+template <bool Inclusive, typename T>
+T* plus_scan(const T* in, std::size_t n, T* out, T acc)
+{
+    typedef prefix128<T> P;
+    const std::size_t W = P::width;
+    typename P::vec carry = P::set1(acc);
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const typename P::vec local = P::local(P::load(in + i));
+        const typename P::vec incl = P::add(local, carry);
+        // exclusive: the local prefix moved up one lane (a zero comes in at lane 0) plus the carry
+        P::store(out + i, Inclusive ? incl : P::add(P::shift1(local), carry));
+        carry = P::last(incl);
+    }
+    if (i < n) {
+        T lanes[P::width];
+        P::store(lanes, carry);
+        return scan_from<Inclusive>(in + i, in + n, out + i, std::plus<T>(), identity(), lanes[0]);
+    }
+    return out + n;
+}
+
+#endif // STL_DEMO_SIMD
+
+template <typename In, typename Out, typename Op, typename Unary, typename T>
+struct use_plus_simd
+    : std::integral_constant<bool,
+#if defined(STL_DEMO_SIMD)
+          simd::is_contiguous<In>::value && simd::is_contiguous<Out>::value &&
+          !std::is_const<typename std::remove_reference<decltype(*std::declval<Out>())>::type>::value &&
+          std::is_same<typename simd::value_of<In>::type, T>::value &&
+          std::is_same<typename std::decay<decltype(*std::declval<Out>())>::type, T>::value &&
+          std::is_same<Op, std::plus<T>>::value && std::is_same<Unary, identity>::value && has_prefix128<T>::value
+#else
+          false
+#endif
+          > {};
+
+template <bool Inclusive, typename In, typename Out, typename Op, typename Unary, typename T>
+Out scan_dispatch(In first, In last, Out out, Op op, Unary unary, T acc, std::false_type)
+{
+    return scan_from<Inclusive>(first, last, out, op, unary, acc);
+}
+
+#if defined(STL_DEMO_SIMD)
+template <bool Inclusive, typename In, typename Out, typename Op, typename Unary, typename T>
+Out scan_dispatch(In first, In last, Out out, Op, Unary, T acc, std::true_type)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (n == 0)
+        return out;
+    plus_scan<Inclusive>(simd::to_pointer(first), n, &*out, acc);
+    return out + n;
+}
+#endif
+
+// sequential scan continuing from acc, SIMD whenever possible
+template <bool Inclusive, typename In, typename Out, typename Op, typename Unary, typename T>
+Out scan(In first, In last, Out out, Op op, Unary unary, T acc)
+{
+    return scan_dispatch<Inclusive>(first, last, out, op, unary, acc, use_plus_simd<In, Out, Op, Unary, T>());
+}
+
+// inclusive scan without an initial value: the first element starts the accumulator
+template <typename In, typename Out, typename Op, typename Unary>
+Out scan_first(In first, In last, Out out, Op op, Unary unary)
+{
+    if (first == last)
+        return out;
+    typename scan_value<In, Unary>::type acc = unary(*first);
+    *out = acc;
+    return scan<true>(++first, last, ++out, op, unary, acc);
+}
+
+} // namespace detail
+
+// -- sequential --
+
+template <typename In, typename Out, typename Op, typename T>
+Out inclusive_scan(In first, In last, Out out, Op op, T init)
+{
+    return detail::scan<true>(first, last, out, op, detail::identity(), init);
+}
+
+template <typename In, typename Out, typename Op>
+Out inclusive_scan(In first, In last, Out out, Op op)
+{
+    return detail::scan_first(first, last, out, op, detail::identity());
+}
+
+template <typename In, typename Out>
+Out inclusive_scan(In first, In last, Out out)
+{
+    return scan_kernels::inclusive_scan(first, last, out, std::plus<typename std::iterator_traits<In>::value_type>());
+}
+
+template <typename In, typename Out, typename T, typename Op>
+Out exclusive_scan(In first, In last, Out out, T init, Op op)
+{
+    return detail::scan<false>(first, last, out, op, detail::identity(), init);
+}
+
+template <typename In, typename Out, typename T>
+Out exclusive_scan(In first, In last, Out out, T init)
+{
+    return scan_kernels::exclusive_scan(first, last, out, init, std::plus<T>());
+}
+
+template <typename In, typename Out, typename Op, typename Unary>
+Out transform_inclusive_scan(In first, In last, Out out, Op op, Unary unary)
+{
+    return detail::scan_first(first, last, out, op, unary);
+}
+
+template <typename In, typename Out, typename T, typename Op, typename Unary>
+Out transform_exclusive_scan(In first, In last, Out out, T init, Op op, Unary unary)
+{
+    return detail::scan<false>(first, last, out, op, unary, init);
+}
+
+// a true flag starts a new segment: out[i] = a[i] if flag[i], else out[i - 1] op a[i]
+template <typename In, typename FlagIt, typename Out, typename Op>
+Out segmented_inclusive_scan(In first, In last, FlagIt flags, Out out, Op op)
+{
+    typedef typename std::iterator_traits<In>::value_type T;
+    if (first == last)
+        return out;
+    T acc = *first;
+    *out = acc;
+    for (++first, ++flags, ++out; first != last; ++first, ++flags, ++out) {
+        acc = *flags ? T(*first) : op(acc, *first);
+        *out = acc;
+    }
+    return out;
+}
+
+template <typename In, typename FlagIt, typename Out>
+Out segmented_inclusive_scan(In first, In last, FlagIt flags, Out out)
+{
+    return scan_kernels::segmented_inclusive_scan(first, last, flags, out, std::plus<typename std::iterator_traits<In>::value_type>());
+}
+
+// out[i] = a[i] op a[i - 1]; out may be first, the previous input is kept aside before it is overwritten
+template <typename In, typename Out, typename Op>
+Out adjacent_difference(In first, In last, Out out, Op op)
+{
+    typedef typename std::iterator_traits<In>::value_type T;
+    if (first == last)
+        return out;
+    T prev = *first;
+    *out = prev;
+    for (++first, ++out; first != last; ++first, ++out) {
+        T cur = *first;
+        *out = op(cur, prev);
+        prev = std::move(cur);
+    }
+    return out;
+}
+
+template <typename In, typename Out>
+Out adjacent_difference(In first, In last, Out out)
+{
+    return scan_kernels::adjacent_difference(first, last, out, std::minus<typename std::iterator_traits<In>::value_type>());
+}
+
+namespace parallel {
+
+static const std::size_t kMinPerThread = 1 << 16;
+
+namespace detail {
+
+using scan_kernels::detail::identity;
+using scan_kernels::detail::scan_value;
+
+template <typename In, typename Op, typename Unary>
+typename scan_value<In, Unary>::type reduce(In first, In last, Op op, Unary unary)
+{
+    typename scan_value<In, Unary>::type acc = unary(*first);
+    for (++first; first != last; ++first) {
+        acc = op(acc, unary(*first));
+    }
+    return acc;
+}
+
+/*
+ * Reduce-then-scan over random access ranges. has_init == false means inclusive without an initial
+ * value: chunk 0 then starts with its own first element.
+ */
+template <bool Inclusive, typename In, typename Out, typename Op, typename Unary, typename T>
+Out scan(In first, In last, Out out, Op op, Unary unary, bool has_init, T init)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t chunks = algorithms::parallel::chunk_count(n, kMinPerThread);
+    if (chunks <= 1) {
+        return has_init ? scan_kernels::detail::scan<Inclusive>(first, last, out, op, unary, init)
+                        : scan_kernels::detail::scan_first(first, last, out, op, unary);
+    }
+
+    // pass 1: one value per chunk (the last chunk's value is never needed)
+    std::vector<T> sums(chunks);
+    algorithms::parallel::for_each_chunk(n, chunks, [&] (std::size_t c, std::size_t b, std::size_t e) {
+        if (c + 1 < chunks)
+            sums[c] = reduce(first + b, first + e, op, unary);
+    });
+    // carries, left to right: carry[c] = init op sum[0] op ... op sum[c - 1]
+    std::vector<T> carry(chunks);
+    carry[0] = init;
+    for (std::size_t c = 1; c < chunks; ++c) {
+        carry[c] = (c == 1 && !has_init) ? sums[0] : op(carry[c - 1], sums[c - 1]);
+    }
+    // pass 2
+    algorithms::parallel::for_each_chunk(n, chunks, [&] (std::size_t c, std::size_t b, std::size_t e) {
+        if (c == 0 && !has_init)
+            scan_kernels::detail::scan_first(first + b, first + e, out + b, op, unary);
+        else
+            scan_kernels::detail::scan<Inclusive>(first + b, first + e, out + b, op, unary, carry[c]);
+    });
+    return out + n;
+}
+
+} // namespace detail
+
+template <typename In, typename Out, typename Op, typename T>
+Out inclusive_scan(In first, In last, Out out, Op op, T init)
+{
+    return detail::scan<true>(first, last, out, op, detail::identity(), true, init);
+}
+
+template <typename In, typename Out, typename Op>
+Out inclusive_scan(In first, In last, Out out, Op op)
+{
+    typedef typename std::iterator_traits<In>::value_type T;
+    return detail::scan<true>(first, last, out, op, detail::identity(), false, T());
+}
+
+template <typename In, typename Out>
+Out inclusive_scan(In first, In last, Out out)
+{
+    return parallel::inclusive_scan(first, last, out, std::plus<typename std::iterator_traits<In>::value_type>());
+}
+
+template <typename In, typename Out, typename T, typename Op>
+Out exclusive_scan(In first, In last, Out out, T init, Op op)
+{
+    return detail::scan<false>(first, last, out, op, detail::identity(), true, init);
+}
+
+template <typename In, typename Out, typename T>
+Out exclusive_scan(In first, In last, Out out, T init)
+{
+    return parallel::exclusive_scan(first, last, out, init, std::plus<T>());
+}
+
+template <typename In, typename Out, typename Op, typename Unary>
+Out transform_inclusive_scan(In first, In last, Out out, Op op, Unary unary)
+{
+    typedef typename detail::scan_value<In, Unary>::type T;
+    return detail::scan<true>(first, last, out, op, unary, false, T());
+}
+
+template <typename In, typename Out, typename T, typename Op, typename Unary>
+Out transform_exclusive_scan(In first, In last, Out out, T init, Op op, Unary unary)
+{
+    return detail::scan<false>(first, last, out, op, unary, true, init);
+}
+
+/*
+ * Segmented scan = an ordinary scan over (flag, value) pairs with the associative operator
+ *     (f1, v1) . (f2, v2) = (f1 || f2, f2 ? v2 : v1 op v2)
+ * so it runs through the same reduce-then-scan: pass 1 computes, per chunk, the value after its last
+ * flag and whether it has a flag at all.
+ */
+template <typename In, typename FlagIt, typename Out, typename Op>
+Out segmented_inclusive_scan(In first, In last, FlagIt flags, Out out, Op op)
+{
+    typedef typename std::iterator_traits<In>::value_type T;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t chunks = algorithms::parallel::chunk_count(n, kMinPerThread);
+    if (chunks <= 1)
+        return scan_kernels::segmented_inclusive_scan(first, last, flags, out, op);
+
+    std::vector<T> sums(chunks);
+    std::vector<char> flagged(chunks);
+    algorithms::parallel::for_each_chunk(n, chunks, [&] (std::size_t c, std::size_t b, std::size_t e) {
+        T acc = first[b];
+        bool any = flags[b];
+        for (std::size_t i = b + 1; i < e; ++i) {
+            acc = flags[i] ? T(first[i]) : op(acc, first[i]);
+            any = any || flags[i];
+        }
+        sums[c] = acc;
+        flagged[c] = any;
+    });
+    std::vector<T> carry(chunks);
+    carry[0] = sums[0];
+    for (std::size_t c = 1; c < chunks; ++c) {
+        carry[c] = flagged[c] ? sums[c] : op(carry[c - 1], sums[c]);
+    }
+    algorithms::parallel::for_each_chunk(n, chunks, [&] (std::size_t c, std::size_t b, std::size_t e) {
+        T acc = (c == 0 || flags[b]) ? T(first[b]) : op(carry[c - 1], first[b]);
+        out[b] = acc;
+        for (std::size_t i = b + 1; i < e; ++i) {
+            acc = flags[i] ? T(first[i]) : op(acc, first[i]);
+            out[i] = acc;
+        }
+    });
+    return out + n;
+}
+
+template <typename In, typename FlagIt, typename Out>
+Out segmented_inclusive_scan(In first, In last, FlagIt flags, Out out)
+{
+    return parallel::segmented_inclusive_scan(first, last, flags, out, std::plus<typename std::iterator_traits<In>::value_type>());
+}
+
+// every output only depends on two inputs: no carries at all. out must not alias [first, last)
+template <typename In, typename Out, typename Op>
+Out adjacent_difference(In first, In last, Out out, Op op)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (n == 0)
+        return out;
+    algorithms::parallel::for_each_chunk_min(n, kMinPerThread, [&] (std::size_t, std::size_t b, std::size_t e) {
+        std::size_t i = b;
+        if (i == 0) {
+            out[0] = first[0];
+            ++i;
+        }
+        for (; i < e; ++i) {
+            out[i] = op(first[i], first[i - 1]);
+        }
+    });
+    return out + n;
+}
+
+template <typename In, typename Out>
+Out adjacent_difference(In first, In last, Out out)
+{
+    return parallel::adjacent_difference(first, last, out, std::minus<typename std::iterator_traits<In>::value_type>());
+}
+
+} // namespace parallel
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_SCAN_KERNELS_H
@@ -0,0 +1,202 @@
+#include "search_kernels.h"
+#include "helper.h"
+
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace algorithms {
+namespace search_kernels {
+
+// the examples of non_modifying.cpp, once with std:: and once with the kernels, the positions must agree
+void same_as_std_demo()
+{
+    vector<int> coll;
+    helper::INSERT_ELEMENTS(coll, 1, 7);
+    helper::INSERT_ELEMENTS(coll, 1, 7);
+    helper::PRINT_ELEMENT(coll, "coll: ");
+
+    auto pos = search_kernels::find(coll.begin(), coll.end(), 4);
+    cout << "find(4): " << distance(coll.begin(), pos)
+         << " (std: " << distance(coll.begin(), std::find(coll.begin(), coll.end(), 4)) << ")" << endl;
+    pos = search_kernels::find_if(coll.begin(), coll.end(), simd::greater_than(3));
+    cout << "find_if(> 3): " << distance(coll.begin(), pos) << endl;
+    // an ordinary lambda works too, it just takes the std::find_if path
+    pos = search_kernels::find_if(coll.begin(), coll.end(), [] (int x) { return x % 5 == 0; });
+    cout << "find_if(x % 5 == 0): " << distance(coll.begin(), pos) << endl;
+
+    vector<int> runs = {1, 7, 7, 2, 7, 7, 7, 7, 3, 7, 7, 7};
+    helper::PRINT_ELEMENT(runs, "runs: ");
+    cout << "search_n(3, 7): " << distance(runs.begin(), search_kernels::search_n(runs.begin(), runs.end(), 3, 7))
+         << " (std: " << distance(runs.begin(), std::search_n(runs.begin(), runs.end(), 3, 7)) << ")" << endl;
+    // deque is not contiguous but random access: skip-ahead without SIMD
+    deque<int> druns(runs.begin(), runs.end());
+    cout << "search_n on deque: " << distance(druns.begin(), search_kernels::search_n(druns.begin(), druns.end(), 4, 7)) << endl;
+
+    list<int> subcoll = {3, 4, 5};
+    auto first = search_kernels::search(coll.begin(), coll.end(), subcoll.begin(), subcoll.end());
+    auto last = search_kernels::find_end(coll.begin(), coll.end(), subcoll.begin(), subcoll.end());
+    cout << "search(3 4 5): " << distance(coll.begin(), first)
+         << ", find_end(3 4 5): " << distance(coll.begin(), last) << endl;
+
+    list<int> searchcoll = {6, 5};
+    cout << "find_first_of(6 5): "
+         << distance(coll.begin(), search_kernels::find_first_of(coll.begin(), coll.end(), searchcoll.begin(), searchcoll.end()))
+         << endl;
+
+    vector<int> adj = {1, 3, 2, 4, 5, 5, 0};
+    cout << "adjacent_find: " << distance(adj.begin(), search_kernels::adjacent_find(adj.begin(), adj.end())) << endl;
+
+    // strings are contiguous char ranges
+    string text = "the quick brown fox jumps over the lazy dog";
+    string word = "the";
+    cout << "find_end(\"the\"): " << search_kernels::find_end(text.begin(), text.end(), word.begin(), word.end()) - text.begin()
+         << ", find_first_of(\"he\"): " << search_kernels::find_first_of(text.begin(), text.end(), word.begin() + 1, word.end()) - text.begin()
+         << endl;
+}
+
+// a value of another type: std:: compares after the usual arithmetic conversions
+template <typename T, typename W>
+bool check_value(const vector<T>& v, int count, W value)
+{
+    return search_kernels::find(v.begin(), v.end(), value) == std::find(v.begin(), v.end(), value) &&
+           parallel::find(v.begin(), v.end(), value) == std::find(v.begin(), v.end(), value) &&
+           search_kernels::search_n(v.begin(), v.end(), count, value) == std::search_n(v.begin(), v.end(), count, value);
+}
+
+// randomized comparison against std:: on small inputs, so every tail / border path is exercised
+template <typename T>
+bool cross_check(mt19937& gen, int rounds)
+{
+    uniform_int_distribution<int> len(0, 200);
+    uniform_int_distribution<int> val(0, 3);
+    for (int r = 0; r < rounds; ++r) {
+        vector<T> v(len(gen));
+        for (auto& x : v) {
+            x = static_cast<T>(val(gen));
+        }
+        vector<T> needle(1 + r % 4);
+        for (auto& x : needle) {
+            x = static_cast<T>(val(gen));
+        }
+        const int count = 1 + r % 5;
+        const T value = static_cast<T>(r % 3);
+        if (search_kernels::find(v.begin(), v.end(), value) != std::find(v.begin(), v.end(), value) ||
+            search_kernels::search_n(v.begin(), v.end(), count, value) != std::search_n(v.begin(), v.end(), count, value) ||
+            search_kernels::search(v.begin(), v.end(), needle.begin(), needle.end()) != std::search(v.begin(), v.end(), needle.begin(), needle.end()) ||
+            search_kernels::find_end(v.begin(), v.end(), needle.begin(), needle.end()) != std::find_end(v.begin(), v.end(), needle.begin(), needle.end()) ||
+            search_kernels::find_first_of(v.begin() , v.end(), needle.begin(), needle.end()) != std::find_first_of(v.begin(), v.end(), needle.begin(), needle.end()) ||
+            search_kernels::adjacent_find(v.begin(), v.end()) != std::adjacent_find(v.begin(), v.end()))
+            return false;
+        // values the element type can not hold: 65536 + value must not match value in a range of short
+        if (!check_value(v, count, (1ll << 16) + r % 3) || !check_value(v, count, r % 3 + 0.5) ||
+            !check_value(v, count, -1ll) || !check_value(v, count, r % 3))
+            return false;
+    }
+    return true;
+}
+
+template <typename F>
+long long time_us(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::microseconds>(t1 - t0).count();
+}
+
+void benchmark()
+{
+    // 64M telemetry samples (256 MB), the interesting events sit near the end
+    const size_t kSamples = 64 * 1024 * 1024;
+    vector<float> samples(kSamples);
+    mt19937 gen(42);
+    normal_distribution<float> noise(20.0f, 2.0f);
+    for (auto& s : samples) {
+        s = std::round(noise(gen) * 10.0f) / 10.0f;
+    }
+    const size_t spike = kSamples - kSamples / 10;
+    samples[spike] = 99.5f;
+    for (size_t i = 0; i < 8; ++i) {
+        samples[spike + 1000 + i] = -1.0f; // sensor dropout: 8 identical readings
+    }
+    vector<float> pattern(samples.begin() + spike + 990, samples.begin() + spike + 1002);
+
+    size_t r1 = 0, r2 = 0, r3 = 0;
+    auto report = [&] (const char* name, long long t_std, long long t_simd, long long t_par) {
+        cout << name << ": std " << t_std << " us, simd " << t_simd << " us, parallel " << t_par << " us"
+             << ((r1 == r2 && r2 == r3) ? "" : "  MISMATCH") << endl;
+    };
+
+    long long a = time_us([&] { r1 = std::find(samples.begin(), samples.end(), 99.5f) - samples.begin(); });
+    long long b = time_us([&] { r2 = search_kernels::find(samples.begin(), samples.end(), 99.5f) - samples.begin(); });
+    long long c = time_us([&] { r3 = parallel::find(samples.begin(), samples.end(), 99.5f) - samples.begin(); });
+    report("find", a, b, c);
+
+    a = time_us([&] { r1 = std::find_if(samples.begin(), samples.end(), [] (float x) { return x > 50.0f; }) - samples.begin(); });
+    b = time_us([&] { r2 = search_kernels::find_if(samples.begin(), samples.end(), simd::greater_than(50.0f)) - samples.begin(); });
+    c = time_us([&] { r3 = parallel::find_if(samples.begin(), samples.end(), simd::greater_than(50.0f)) - samples.begin(); });
+    report("find_if", a, b, c);
+
+    a = time_us([&] { r1 = std::search_n(samples.begin(), samples.end(), 8, -1.0f) - samples.begin(); });
+    b = time_us([&] { r2 = search_kernels::search_n(samples.begin(), samples.end(), 8, -1.0f) - samples.begin(); });
+    c = time_us([&] { r3 = parallel::search_n(samples.begin(), samples.end(), 8, -1.0f) - samples.begin(); });
+    report("search_n", a, b, c);
+
+    a = time_us([&] { r1 = std::search(samples.begin(), samples.end(), pattern.begin(), pattern.end()) - samples.begin(); });
+    b = time_us([&] { r2 = search_kernels::search(samples.begin(), samples.end(), pattern.begin(), pattern.end()) - samples.begin(); });
+    c = time_us([&] { r3 = parallel::search(samples.begin(), samples.end(), pattern.begin(), pattern.end()) - samples.begin(); });
+    report("search", a, b, c);
+
+    a = time_us([&] { r1 = std::find_end(samples.begin(), samples.end(), pattern.begin(), pattern.end()) - samples.begin(); });
+    b = time_us([&] { r2 = search_kernels::find_end(samples.begin(), samples.end(), pattern.begin(), pattern.end()) - samples.begin(); });
+    c = time_us([&] { r3 = parallel::find_end(samples.begin(), samples.end(), pattern.begin(), pattern.end()) - samples.begin(); });
+    report("find_end", a, b, c);
+
+    vector<float> alarms = {99.5f, 98.0f, 97.0f, -5.0f};
+    a = time_us([&] { r1 = std::find_first_of(samples.begin(), samples.end(), alarms.begin(), alarms.end()) - samples.begin(); });
+    b = time_us([&] { r2 = search_kernels::find_first_of(samples.begin(), samples.end(), alarms.begin(), alarms.end()) - samples.begin(); });
+    c = time_us([&] { r3 = parallel::find_first_of(samples.begin(), samples.end(), alarms.begin(), alarms.end()) - samples.begin(); });
+    report("find_first_of", a, b, c);
+
+    // adjacent equal readings are frequent in rounded data, use unique integer ids instead
+    vector<int> ids(kSamples);
+    for (size_t i = 0; i < kSamples; ++i) {
+        ids[i] = static_cast<int>(i);
+    }
+    ids[spike + 1] = ids[spike];
+    a = time_us([&] { r1 = std::adjacent_find(ids.begin(), ids.end()) - ids.begin(); });
+    b = time_us([&] { r2 = search_kernels::adjacent_find(ids.begin(), ids.end()) - ids.begin(); });
+    c = time_us([&] { r3 = parallel::adjacent_find(ids.begin(), ids.end()) - ids.begin(); });
+    report("adjacent_find", a, b, c);
+}
+
+void Run()
+{
+#if defined(STL_DEMO_SIMD_AVX2)
+    cout << "search kernels: AVX2" << endl;
+#elif defined(STL_DEMO_SIMD)
+    cout << "search kernels: SSE2" << endl;
+#else
+    cout << "search kernels: scalar" << endl;
+#endif
+    same_as_std_demo();
+
+    mt19937 gen(7);
+    cout << "cross check: " << boolalpha
+         << (cross_check<char>(gen, 2000) && cross_check<unsigned short>(gen, 2000) && cross_check<int>(gen, 2000) &&
+             cross_check<long long>(gen, 2000) && cross_check<float>(gen, 2000) && cross_check<double>(gen, 2000))
+         << endl;
+
+    benchmark();
+}
+
+}
+}
@@ -0,0 +1,550 @@
+#ifndef STL_DEMO_ALGORITHMS_SEARCH_KERNELS_H
+#define STL_DEMO_ALGORITHMS_SEARCH_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "simd.h"
+#include "parallel.h"
+
+namespace algorithms {
+namespace search_kernels {
+
+/*
+ * Drop-in replacements for the search family of non_modifying.cpp:
+ *
+ *     Name                        Kernel for contiguous arithmetic ranges
+ *     find() / find_if()          4x unrolled SIMD compare against a broadcast value / simd:: predicate
+ *     search_n()                  skip-ahead: only every count-th element is inspected until a candidate shows up
+ *     search()                    SIMD filter on the first and the last needle element, then verify
+ *     find_end()                  the same filter, scanning blocks from the back
+ *     find_first_of()             OR of up to 16 broadcast compares, byte table or binary search beyond that
+ *     adjacent_find()             compare the block at i with the block at i + 1
+ *
+ * 接口和 std:: 版本一样 (迭代器进，迭代器出)。只有当迭代器是连续的 (指针, vector / string / array 的迭代器)
+ * 并且元素是算术类型时才走 SIMD 代码，其它情况 (deque, list, 自定义类型, 自定义谓词) 直接转给 std:: 版本，
+ * 所以总是可以无脑替换。
+ *
+ * parallel:: 里是多线程版本，把区间切块交给多个线程，返回的仍然是最早 (find_end: 最晚) 的匹配位置。
+ */
+
+namespace detail {
+
+using simd::value_of;
+using simd::use_simd;
+using simd::to_pointer;
+
+// -- pointer kernels, all return an index, `n` meaning "not found" --
+
+template <typename T, typename Pred>
+std::size_t find_pred(const T* p, std::size_t n, const Pred& pred)
+{
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    typedef simd::lane<T> L;
+    const std::size_t W = L::width;
+    const simd::reg v = L::set1(pred.value);
+    // 4 registers per iteration, only resolve the exact position once something matched
+    for (; i + 4 * W <= n; i += 4 * W) {
+        simd::reg any = simd::or_(simd::or_(pred.mask(L::load(p + i), v), pred.mask(L::load(p + i + W), v)),
+                                  simd::or_(pred.mask(L::load(p + i + 2 * W), v), pred.mask(L::load(p + i + 3 * W), v)));
+        if (simd::bytemask(any))
+            break;
+    }
+    for (; i + W <= n; i += W) {
+        simd::mask_t m = simd::bytemask(pred.mask(L::load(p + i), v));
+        if (m)
+            return i + simd::ctz(m) / sizeof(T);
+    }
+#endif
+    for (; i < n; ++i) {
+        if (pred(p[i]))
+            return i;
+    }
+    return n;
+}
+
+template <typename T>
+std::size_t find(const T* p, std::size_t n, T value)
+{
+    return find_pred(p, n, simd::equal_to(value));
+}
+
+template <typename T>
+bool equal_at(const T* a, const T* b, std::size_t m)
+{
+    for (std::size_t k = 0; k < m; ++k) {
+        if (!(a[k] == b[k]))
+            return false;
+    }
+    return true;
+}
+
+// skip-ahead search_n: a run of `count` values must cover position i + count - 1, so check that
+// element first; on a mismatch the whole window [i, i + count) is skipped at once
+template <typename T>
+std::size_t search_n(const T* p, std::size_t n, std::size_t count, T value)
+{
+    if (count == 0)
+        return 0;
+    if (count == 1)
+        return find(p, n, value);
+    std::size_t i = 0;
+    while (count <= n - i) {
+        const std::size_t last = i + count - 1;
+        if (!(p[last] == value)) {
+            i = last + 1;
+            continue;
+        }
+        // p[last] matches: walk back to find where the run starts inside the window
+        std::size_t start = last;
+        while (start > i && p[start - 1] == value) {
+            --start;
+        }
+        if (count > n - start)
+            return n;
+        // then extend forward (vectorized) from last + 1 up to start + count
+        const std::size_t need = start + count - (last + 1);
+        const std::size_t miss = find_pred(p + last + 1, need, simd::not_equal_to(value));
+        if (miss == need)
+            return start;
+        i = last + 1 + miss + 1;
+    }
+    return n;
+}
+
+// first/last element filter (W. Mula's "SIMD-friendly algorithms for substring searching")
+template <typename T>
+std::size_t search(const T* p, std::size_t n, const T* needle, std::size_t m)
+{
+    if (m == 0)
+        return 0;
+    if (m > n)
+        return n;
+    if (m == 1)
+        return find(p, n, needle[0]);
+    const std::size_t last_start = n - m; // inclusive
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    typedef simd::lane<T> L;
+    const std::size_t W = L::width;
+    const simd::reg first = L::set1(needle[0]);
+    const simd::reg last = L::set1(needle[m - 1]);
+    for (; i + W <= last_start + 1; i += W) {
+        simd::mask_t mask = simd::bytemask(simd::and_(L::eq(L::load(p + i), first), L::eq(L::load(p + i + m - 1), last)));
+        while (mask) {
+            const unsigned bit = simd::ctz(mask);
+            const std::size_t idx = i + bit / sizeof(T);
+            if (equal_at(p + idx + 1, needle + 1, m - 2))
+                return idx;
+            mask = simd::clear_lane<T>(mask, bit);
+        }
+    }
+#endif
+    for (; i <= last_start; ++i) {
+        if (p[i] == needle[0] && p[i + m - 1] == needle[m - 1] && equal_at(p + i + 1, needle + 1, m - 2))
+            return i;
+    }
+    return n;
+}
+
+template <typename T>
+std::size_t find_end(const T* p, std::size_t n, const T* needle, std::size_t m)
+{
+    if (m == 0 || m > n)
+        return n;
+    std::size_t hi = n - m + 1; // candidate starts are [0, hi)
+#if defined(STL_DEMO_SIMD)
+    typedef simd::lane<T> L;
+    const std::size_t W = L::width;
+    const simd::reg first = L::set1(needle[0]);
+    const simd::reg last = L::set1(needle[m - 1]);
+    for (; hi >= W; hi -= W) {
+        const std::size_t base = hi - W;
+        simd::mask_t mask = simd::bytemask(simd::and_(L::eq(L::load(p + base), first), L::eq(L::load(p + base + m - 1), last)));
+        while (mask) {
+            const unsigned bit = 31 - simd::clz(mask);
+            const std::size_t idx = base + bit / sizeof(T);
+            if (equal_at(p + idx, needle, m))
+                return idx;
+            mask = simd::clear_lane<T>(mask, bit);
+        }
+    }
+#endif
+    while (hi > 0) {
+        --hi;
+        if (equal_at(p + hi, needle, m))
+            return hi;
+    }
+    return n;
+}
+
+template <typename T>
+std::size_t find_first_of(const T* p, std::size_t n, const T* set, std::size_t k)
+{
+    if (k == 0)
+        return n;
+    if (k == 1)
+        return find(p, n, set[0]);
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    const std::size_t kMaxBroadcast = 16;
+    if (k <= kMaxBroadcast) {
+        typedef simd::lane<T> L;
+        const std::size_t W = L::width;
+        simd::reg needles[kMaxBroadcast];
+        for (std::size_t j = 0; j < k; ++j) {
+            needles[j] = L::set1(set[j]);
+        }
+        for (; i + W <= n; i += W) {
+            const simd::reg x = L::load(p + i);
+            simd::reg hit = L::eq(x, needles[0]);
+            for (std::size_t j = 1; j < k; ++j) {
+                hit = simd::or_(hit, L::eq(x, needles[j]));
+            }
+            simd::mask_t m = simd::bytemask(hit);
+            if (m)
+                return i + simd::ctz(m) / sizeof(T);
+        }
+        for (; i < n; ++i) {
+            if (std::find(set, set + k, p[i]) != set + k)
+                return i;
+        }
+        return n;
+    }
+#endif
+    if (sizeof(T) == 1) {
+        // byte sized elements: a 256 entry table
+        bool table[256] = {};
+        for (std::size_t j = 0; j < k; ++j) {
+            table[static_cast<unsigned char>(set[j])] = true;
+        }
+        for (; i < n; ++i) {
+            if (table[static_cast<unsigned char>(p[i])])
+                return i;
+        }
+        return n;
+    }
+    // large sets: sorted copy + binary search, NaN never compares equal so leave it out
+    std::vector<T> sorted;
+    sorted.reserve(k);
+    for (std::size_t j = 0; j < k; ++j) {
+        if (set[j] == set[j])
+            sorted.push_back(set[j]);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    for (; i < n; ++i) {
+        if (std::binary_search(sorted.begin(), sorted.end(), p[i]))
+            return i;
+    }
+    return n;
+}
+
+template <typename T>
+std::size_t adjacent_find(const T* p, std::size_t n)
+{
+    if (n < 2)
+        return n;
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    typedef simd::lane<T> L;
+    const std::size_t W = L::width;
+    for (; i + W + 1 <= n; i += W) {
+        simd::mask_t m = simd::bytemask(L::eq(L::load(p + i), L::load(p + i + 1)));
+        if (m)
+            return i + simd::ctz(m) / sizeof(T);
+    }
+#endif
+    for (; i + 1 < n; ++i) {
+        if (p[i] == p[i + 1])
+            return i;
+    }
+    return n;
+}
+
+// -- iterator level dispatch --
+
+template <typename It>
+std::size_t size_of(It first, It last)
+{
+    return static_cast<std::size_t>(std::distance(first, last));
+}
+
+template <typename It, typename Pred>
+It find_if(It first, It last, Pred pred, std::true_type)
+{
+    const std::size_t n = size_of(first, last);
+    return n == 0 ? last : first + find_pred(to_pointer(first), n, pred);
+}
+
+template <typename It, typename Pred>
+It find_if(It first, It last, Pred pred, std::false_type)
+{
+    return std::find_if(first, last, pred);
+}
+
+template <typename It, typename Size, typename T>
+It search_n(It first, It last, Size count, const T& value, std::true_type)
+{
+    const std::size_t n = size_of(first, last);
+    if (count <= 0)
+        return first;
+    return n == 0 ? last
+                  : first + search_n(to_pointer(first), n, static_cast<std::size_t>(count),
+                                     static_cast<typename value_of<It>::type>(value));
+}
+
+// the skip-ahead trick only needs random access, deque gets it too
+template <typename It, typename Size, typename T>
+It search_n_skip(It first, It last, Size count, const T& value, std::random_access_iterator_tag)
+{
+    if (count <= 0)
+        return first;
+    const std::size_t n = size_of(first, last);
+    const std::size_t c = static_cast<std::size_t>(count);
+    std::size_t i = 0;
+    while (c <= n - i) {
+        const std::size_t end = i + c;
+        std::size_t k = end;
+        while (k > i && first[k - 1] == value) {
+            --k;
+        }
+        if (k == i)
+            return first + i;
+        // first[k - 1] breaks the run: no window starting at or before k - 1 can match
+        i = k;
+    }
+    return last;
+}
+
+template <typename It, typename Size, typename T>
+It search_n_skip(It first, It last, Size count, const T& value, std::input_iterator_tag)
+{
+    return std::search_n(first, last, count, value);
+}
+
+template <typename It, typename Size, typename T>
+It search_n(It first, It last, Size count, const T& value, std::false_type)
+{
+    return search_n_skip(first, last, count, value, typename std::iterator_traits<It>::iterator_category());
+}
+
+// the needle side can be any forward range of the same element type, it is copied into a buffer
+template <typename It1, typename It2>
+struct use_simd_pair
+    : std::integral_constant<bool, use_simd<It1>::value &&
+                                       std::is_same<typename value_of<It1>::type, typename value_of<It2>::type>::value> {};
+
+template <typename It1, typename It2>
+It1 search(It1 first, It1 last, It2 s_first, It2 s_last, std::true_type)
+{
+    typedef typename value_of<It1>::type T;
+    const std::vector<T> needle(s_first, s_last);
+    const std::size_t n = size_of(first, last);
+    if (needle.empty())
+        return first;
+    return n == 0 ? last : first + search(to_pointer(first), n, needle.data(), needle.size());
+}
+
+template <typename It1, typename It2>
+It1 search(It1 first, It1 last, It2 s_first, It2 s_last, std::false_type)
+{
+    return std::search(first, last, s_first, s_last);
+}
+
+template <typename It1, typename It2>
+It1 find_end(It1 first, It1 last, It2 s_first, It2 s_last, std::true_type)
+{
+    typedef typename value_of<It1>::type T;
+    const std::vector<T> needle(s_first, s_last);
+    const std::size_t n = size_of(first, last);
+    return n == 0 ? last : first + find_end(to_pointer(first), n, needle.data(), needle.size());
+}
+
+template <typename It1, typename It2>
+It1 find_end(It1 first, It1 last, It2 s_first, It2 s_last, std::false_type)
+{
+    return std::find_end(first, last, s_first, s_last);
+}
+
+template <typename It1, typename It2>
+It1 find_first_of(It1 first, It1 last, It2 s_first, It2 s_last, std::true_type)
+{
+    typedef typename value_of<It1>::type T;
+    const std::vector<T> set(s_first, s_last);
+    const std::size_t n = size_of(first, last);
+    return n == 0 ? last : first + find_first_of(to_pointer(first), n, set.data(), set.size());
+}
+
+template <typename It1, typename It2>
+It1 find_first_of(It1 first, It1 last, It2 s_first, It2 s_last, std::false_type)
+{
+    return std::find_first_of(first, last, s_first, s_last);
+}
+
+template <typename It>
+It adjacent_find(It first, It last, std::true_type)
+{
+    const std::size_t n = size_of(first, last);
+    return n == 0 ? last : first + adjacent_find(to_pointer(first), n);
+}
+
+template <typename It>
+It adjacent_find(It first, It last, std::false_type)
+{
+    return std::adjacent_find(first, last);
+}
+
+} // namespace detail
+
+template <typename It, typename T>
+It find(It first, It last, const T& value)
+{
+    typedef typename detail::value_of<It>::type V;
+    if (!simd::representable<V>(value))
+        return std::find(first, last, value);
+    return detail::find_if(first, last, simd::equal_to(static_cast<V>(value)), detail::use_simd<It>());
+}
+
+// vectorized for the simd::equal_to / less_than / ... predicates, any other predicate goes to std::find_if
+template <typename It, typename Pred>
+It find_if(It first, It last, Pred pred)
+{
+    return detail::find_if(first, last, pred,
+                           std::integral_constant<bool, detail::use_simd<It>::value &&
+                                                            simd::is_simd_predicate_for<Pred, typename detail::value_of<It>::type>::value>());
+}
+
+template <typename It, typename Size, typename T>
+It search_n(It first, It last, Size count, const T& value)
+{
+    // a value the elements can not hold compares in the common type: the skip-ahead loop without the cast
+    if (!simd::representable<typename detail::value_of<It>::type>(value))
+        return detail::search_n(first, last, count, value, std::false_type());
+    return detail::search_n(first, last, count, value, detail::use_simd<It>());
+}
+
+template <typename It1, typename It2>
+It1 search(It1 first, It1 last, It2 s_first, It2 s_last)
+{
+    return detail::search(first, last, s_first, s_last, detail::use_simd_pair<It1, It2>());
+}
+
+template <typename It1, typename It2>
+It1 find_end(It1 first, It1 last, It2 s_first, It2 s_last)
+{
+    return detail::find_end(first, last, s_first, s_last, detail::use_simd_pair<It1, It2>());
+}
+
+template <typename It1, typename It2>
+It1 find_first_of(It1 first, It1 last, It2 s_first, It2 s_last)
+{
+    return detail::find_first_of(first, last, s_first, s_last, detail::use_simd_pair<It1, It2>());
+}
+
+template <typename It>
+It adjacent_find(It first, It last)
+{
+    return detail::adjacent_find(first, last, detail::use_simd<It>());
+}
+
+/*
+ * Multi-threaded versions for random access ranges. Each thread runs the sequential kernel above
+ * on its own blocks; the result is the same position the sequential version returns.
+ */
+namespace parallel {
+
+static const std::size_t kMinPerThread = 1 << 18;
+
+// runs fn(sub_first, sub_last) on each block and maps a miss (sub_last) to n
+template <typename It, typename Fn>
+std::size_t block_hit(It first, std::size_t n, std::size_t b, std::size_t e, Fn fn)
+{
+    const It hit = fn(first + b, first + e);
+    return hit == first + e ? n : static_cast<std::size_t>(hit - first);
+}
+
+template <typename It, typename Pred>
+It find_if(It first, It last, Pred pred)
+{
+    const std::size_t n = detail::size_of(first, last);
+    return first + algorithms::parallel::first_match(n, 0, kMinPerThread, [&] (std::size_t b, std::size_t e) {
+        return block_hit(first, n, b, e, [&] (It f, It l) { return search_kernels::find_if(f, l, pred); });
+    });
+}
+
+template <typename It, typename T>
+It find(It first, It last, const T& value)
+{
+    typedef typename detail::value_of<It>::type V;
+    if (!simd::representable<V>(value))
+        return std::find(first, last, value);
+    return parallel::find_if(first, last, simd::equal_to(static_cast<V>(value)));
+}
+
+template <typename It, typename Size, typename T>
+It search_n(It first, It last, Size count, const T& value)
+{
+    if (count <= 0)
+        return first;
+    const std::size_t n = detail::size_of(first, last);
+    return first + algorithms::parallel::first_match(n, static_cast<std::size_t>(count) - 1, kMinPerThread,
+        [&] (std::size_t b, std::size_t e) {
+            return block_hit(first, n, b, e, [&] (It f, It l) { return search_kernels::search_n(f, l, count, value); });
+        });
+}
+
+template <typename It1, typename It2>
+It1 search(It1 first, It1 last, It2 s_first, It2 s_last)
+{
+    const std::size_t n = detail::size_of(first, last);
+    const std::size_t m = static_cast<std::size_t>(std::distance(s_first, s_last));
+    if (m == 0)
+        return first;
+    return first + algorithms::parallel::first_match(n, m - 1, kMinPerThread, [&] (std::size_t b, std::size_t e) {
+        return block_hit(first, n, b, e, [&] (It1 f, It1 l) { return search_kernels::search(f, l, s_first, s_last); });
+    });
+}
+
+template <typename It1, typename It2>
+It1 find_end(It1 first, It1 last, It2 s_first, It2 s_last)
+{
+    const std::size_t n = detail::size_of(first, last);
+    const std::size_t m = static_cast<std::size_t>(std::distance(s_first, s_last));
+    if (m == 0)
+        return last;
+    return first + algorithms::parallel::last_match(n, m - 1, kMinPerThread, [&] (std::size_t b, std::size_t e) {
+        return block_hit(first, n, b, e, [&] (It1 f, It1 l) { return search_kernels::find_end(f, l, s_first, s_last); });
+    });
+}
+
+template <typename It1, typename It2>
+It1 find_first_of(It1 first, It1 last, It2 s_first, It2 s_last)
+{
+    const std::size_t n = detail::size_of(first, last);
+    return first + algorithms::parallel::first_match(n, 0, kMinPerThread, [&] (std::size_t b, std::size_t e) {
+        return block_hit(first, n, b, e, [&] (It1 f, It1 l) { return search_kernels::find_first_of(f, l, s_first, s_last); });
+    });
+}
+
+template <typename It>
+It adjacent_find(It first, It last)
+{
+    const std::size_t n = detail::size_of(first, last);
+    return first + algorithms::parallel::first_match(n, 1, kMinPerThread, [&] (std::size_t b, std::size_t e) {
+        return block_hit(first, n, b, e, [] (It f, It l) { return search_kernels::adjacent_find(f, l); });
+    });
+}
+
+} // namespace parallel
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ALGORITHMS_SEARCH_KERNELS_H
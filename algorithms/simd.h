@@ -0,0 +1,584 @@
+#ifndef STL_DEMO_ALGORITHMS_SIMD_H
+#define STL_DEMO_ALGORITHMS_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define STL_DEMO_SIMD 1
+#define STL_DEMO_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define STL_DEMO_SIMD 1
+#define STL_DEMO_SIMD_SSE2 1
+#endif
+
+namespace algorithms {
+namespace simd {
+
+/*
+ * A very small SIMD layer shared by the *_kernels.h files.
+ *
+ * 整个工程默认只用 SSE2 编译 (x86-64 的基线)，打开 CMake 选项 STL_DEMO_NATIVE_ARCH (-march=native)
+ * 之后如果 CPU 支持 AVX2，就自动换成 256 位的寄存器；非 x86 平台上 STL_DEMO_SIMD 没有定义，
+ * kernels 只走标量代码。
+ *
+ * 所有的比较都返回 "每个 lane 全 1 或全 0" 的寄存器，bytemask() 把它变成每个字节一位的位掩码。
+ * 对任意元素类型 T 来说:
+ *     第一个匹配的元素下标 = ctz(mask) / sizeof(T)
+ *     匹配的元素个数       = popcount(mask) / sizeof(T)
+ * 这样同一套代码可以处理 1/2/4/8 字节的整数和 float/double。
+ */
+
+// element types the kernels can vectorize: arithmetic, not bool, at most 8 bytes
+template <typename T>
+struct is_simd_type
+    : std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+                                       (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)> {};
+
+template <std::size_t Bytes> struct uint_of;
+template <> struct uint_of<1> { typedef std::uint8_t type; };
+template <> struct uint_of<2> { typedef std::uint16_t type; };
+template <> struct uint_of<4> { typedef std::uint32_t type; };
+template <> struct uint_of<8> { typedef std::uint64_t type; };
+
+template <typename It>
+struct value_of {
+    typedef typename std::iterator_traits<It>::value_type type;
+};
+
+// raw pointers and the iterators of vector / string are contiguous
+// (output iterators like ostream_iterator have the value type void: no vector<void> is formed for them)
+template <typename It, typename V = typename std::conditional<std::is_void<typename value_of<It>::type>::value, char,
+                                                              typename value_of<It>::type>::type>
+struct is_contiguous
+    : std::integral_constant<bool,
+          std::is_pointer<It>::value ||
+          std::is_same<It, typename std::vector<V>::iterator>::value ||
+          std::is_same<It, typename std::vector<V>::const_iterator>::value ||
+          std::is_same<It, std::string::iterator>::value ||
+          std::is_same<It, std::string::const_iterator>::value> {};
+
+template <>
+struct is_contiguous<std::vector<bool>::iterator, bool> : std::false_type {};
+template <>
+struct is_contiguous<std::vector<bool>::const_iterator, bool> : std::false_type {};
+
+// contiguous range of vectorizable elements, the condition for every kernel to take its SIMD path
+template <typename It>
+struct use_simd
+    : std::integral_constant<bool, is_contiguous<It>::value && is_simd_type<typename value_of<It>::type>::value> {};
+
+// contiguous range whose elements may be moved with memcpy (any trivially copyable struct, not only numbers)
+template <typename It>
+struct is_bitwise
+    : std::integral_constant<bool, is_contiguous<It>::value && std::is_trivially_copyable<typename value_of<It>::type>::value> {};
+
+template <typename It1, typename It2>
+struct is_bitwise_pair
+    : std::integral_constant<bool, is_bitwise<It1>::value && is_bitwise<It2>::value &&
+                                       std::is_same<typename value_of<It1>::type, typename value_of<It2>::type>::value> {};
+
+// elements that fit a register lane, reinterpreted as uint_of<Size>
+template <std::size_t Size>
+struct is_lane_size : std::integral_constant<bool, Size == 1 || Size == 2 || Size == 4 || Size == 8> {};
+
+template <typename It>
+const typename value_of<It>::type* to_pointer(It it)
+{
+    return &*it;
+}
+
+typedef std::uint32_t mask_t;
+
+inline unsigned ctz(mask_t m) { return static_cast<unsigned>(__builtin_ctz(m)); }
+inline unsigned clz(mask_t m) { return static_cast<unsigned>(__builtin_clz(m)); }
+inline unsigned popcount(mask_t m) { return static_cast<unsigned>(__builtin_popcount(m)); }
+
+// clear the sizeof(T) mask bits of the lane that owns bit `bit`
+template <typename T>
+inline mask_t clear_lane(mask_t m, unsigned bit)
+{
+    return m & ~(((mask_t(1) << sizeof(T)) - 1) << (bit & ~unsigned(sizeof(T) - 1)));
+}
+
+#if defined(STL_DEMO_SIMD)
+
+#if defined(STL_DEMO_SIMD_AVX2)
+
+typedef __m256i reg;
+static const std::size_t kBytes = 32;
+
+inline reg loadu(const void* p) { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+inline void storeu(void* p, reg v) { _mm256_storeu_si256(static_cast<__m256i*>(p), v); }
+// non-temporal store, p aligned to kBytes; the stores become visible to other threads after sfence()
+inline void stream(void* p, reg v) { _mm256_stream_si256(static_cast<__m256i*>(p), v); }
+inline reg zero() { return _mm256_setzero_si256(); }
+inline reg and_(reg a, reg b) { return _mm256_and_si256(a, b); }
+inline reg or_(reg a, reg b) { return _mm256_or_si256(a, b); }
+inline reg xor_(reg a, reg b) { return _mm256_xor_si256(a, b); }
+inline reg andnot_(reg a, reg b) { return _mm256_andnot_si256(a, b); } // ~a & b
+inline mask_t bytemask(reg v) { return static_cast<mask_t>(_mm256_movemask_epi8(v)); }
+
+namespace detail {
+
+template <std::size_t Bytes>
+struct int_ops;
+
+template <>
+struct int_ops<1> {
+    static reg set1(std::int8_t v) { return _mm256_set1_epi8(v); }
+    static reg eq(reg a, reg b) { return _mm256_cmpeq_epi8(a, b); }
+    static reg gt(reg a, reg b) { return _mm256_cmpgt_epi8(a, b); }
+    static reg add(reg a, reg b) { return _mm256_add_epi8(a, b); }
+};
+
+template <>
+struct int_ops<2> {
+    static reg set1(std::int16_t v) { return _mm256_set1_epi16(v); }
+    static reg eq(reg a, reg b) { return _mm256_cmpeq_epi16(a, b); }
+    static reg gt(reg a, reg b) { return _mm256_cmpgt_epi16(a, b); }
+    static reg add(reg a, reg b) { return _mm256_add_epi16(a, b); }
+};
+
+template <>
+struct int_ops<4> {
+    static reg set1(std::int32_t v) { return _mm256_set1_epi32(v); }
+    static reg eq(reg a, reg b) { return _mm256_cmpeq_epi32(a, b); }
+    static reg gt(reg a, reg b) { return _mm256_cmpgt_epi32(a, b); }
+    static reg add(reg a, reg b) { return _mm256_add_epi32(a, b); }
+};
+
+template <>
+struct int_ops<8> {
+    static reg set1(std::int64_t v) { return _mm256_set1_epi64x(v); }
+    static reg eq(reg a, reg b) { return _mm256_cmpeq_epi64(a, b); }
+    static reg gt(reg a, reg b) { return _mm256_cmpgt_epi64(a, b); }
+    static reg add(reg a, reg b) { return _mm256_add_epi64(a, b); }
+};
+
+struct float_ops {
+    static reg set1(float v) { return _mm256_castps_si256(_mm256_set1_ps(v)); }
+    static reg eq(reg a, reg b) { return cmp<_CMP_EQ_OQ>(a, b); }
+    static reg ne(reg a, reg b) { return cmp<_CMP_NEQ_UQ>(a, b); }
+    static reg lt(reg a, reg b) { return cmp<_CMP_LT_OQ>(a, b); }
+    static reg le(reg a, reg b) { return cmp<_CMP_LE_OQ>(a, b); }
+    static reg gt(reg a, reg b) { return cmp<_CMP_GT_OQ>(a, b); }
+    static reg ge(reg a, reg b) { return cmp<_CMP_GE_OQ>(a, b); }
+    static reg abs(reg a) { return and_(a, _mm256_set1_epi32(0x7fffffff)); }
+    template <int Op>
+    static reg cmp(reg a, reg b) { return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), Op)); }
+};
+
+struct double_ops {
+    static reg set1(double v) { return _mm256_castpd_si256(_mm256_set1_pd(v)); }
+    static reg eq(reg a, reg b) { return cmp<_CMP_EQ_OQ>(a, b); }
+    static reg ne(reg a, reg b) { return cmp<_CMP_NEQ_UQ>(a, b); }
+    static reg lt(reg a, reg b) { return cmp<_CMP_LT_OQ>(a, b); }
+    static reg le(reg a, reg b) { return cmp<_CMP_LE_OQ>(a, b); }
+    static reg gt(reg a, reg b) { return cmp<_CMP_GT_OQ>(a, b); }
+    static reg ge(reg a, reg b) { return cmp<_CMP_GE_OQ>(a, b); }
+    static reg abs(reg a) { return and_(a, _mm256_set1_epi64x(0x7fffffffffffffffLL)); }
+    template <int Op>
+    static reg cmp(reg a, reg b) { return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), Op)); }
+};
+
+} // namespace detail
+
+#else // SSE2
+
+typedef __m128i reg;
+static const std::size_t kBytes = 16;
+
+inline reg loadu(const void* p) { return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+inline void storeu(void* p, reg v) { _mm_storeu_si128(static_cast<__m128i*>(p), v); }
+inline void stream(void* p, reg v) { _mm_stream_si128(static_cast<__m128i*>(p), v); }
+inline reg zero() { return _mm_setzero_si128(); }
+inline reg and_(reg a, reg b) { return _mm_and_si128(a, b); }
+inline reg or_(reg a, reg b) { return _mm_or_si128(a, b); }
+inline reg xor_(reg a, reg b) { return _mm_xor_si128(a, b); }
+inline reg andnot_(reg a, reg b) { return _mm_andnot_si128(a, b); } // ~a & b
+inline mask_t bytemask(reg v) { return static_cast<mask_t>(_mm_movemask_epi8(v)); }
+
+namespace detail {
+
+template <std::size_t Bytes>
+struct int_ops;
+
+template <>
+struct int_ops<1> {
+    static reg set1(std::int8_t v) { return _mm_set1_epi8(v); }
+    static reg eq(reg a, reg b) { return _mm_cmpeq_epi8(a, b); }
+    static reg gt(reg a, reg b) { return _mm_cmpgt_epi8(a, b); }
+    static reg add(reg a, reg b) { return _mm_add_epi8(a, b); }
+};
+
+template <>
+struct int_ops<2> {
+    static reg set1(std::int16_t v) { return _mm_set1_epi16(v); }
+    static reg eq(reg a, reg b) { return _mm_cmpeq_epi16(a, b); }
+    static reg gt(reg a, reg b) { return _mm_cmpgt_epi16(a, b); }
+    static reg add(reg a, reg b) { return _mm_add_epi16(a, b); }
+};
+
+template <>
+struct int_ops<4> {
+    static reg set1(std::int32_t v) { return _mm_set1_epi32(v); }
+    static reg eq(reg a, reg b) { return _mm_cmpeq_epi32(a, b); }
+    static reg gt(reg a, reg b) { return _mm_cmpgt_epi32(a, b); }
+    static reg add(reg a, reg b) { return _mm_add_epi32(a, b); }
+};
+
+// SSE2 has no 64 bit compares (pcmpeqq is SSE4.1, pcmpgtq SSE4.2): build them from 32 bit halves
+template <>
+struct int_ops<8> {
+    static reg set1(std::int64_t v) { return _mm_set1_epi64x(v); }
+    static reg eq(reg a, reg b)
+    {
+        reg e = _mm_cmpeq_epi32(a, b);
+        return _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+    static reg gt(reg a, reg b)
+    {
+        const reg bias = _mm_set_epi32(0, static_cast<int>(0x80000000u), 0, static_cast<int>(0x80000000u));
+        reg hi_gt = _mm_cmpgt_epi32(a, b);
+        reg hi_eq = _mm_cmpeq_epi32(a, b);
+        reg lo_gt = _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias)); // unsigned low halves
+        reg r = _mm_or_si128(hi_gt, _mm_and_si128(hi_eq, _mm_shuffle_epi32(lo_gt, _MM_SHUFFLE(2, 2, 0, 0))));
+        return _mm_shuffle_epi32(r, _MM_SHUFFLE(3, 3, 1, 1));
+    }
+    static reg add(reg a, reg b) { return _mm_add_epi64(a, b); }
+};
+
+struct float_ops {
+    static reg set1(float v) { return _mm_castps_si128(_mm_set1_ps(v)); }
+    static reg eq(reg a, reg b) { return _mm_castps_si128(_mm_cmpeq_ps(ps(a), ps(b))); }
+    static reg ne(reg a, reg b) { return _mm_castps_si128(_mm_cmpneq_ps(ps(a), ps(b))); }
+    static reg lt(reg a, reg b) { return _mm_castps_si128(_mm_cmplt_ps(ps(a), ps(b))); }
+    static reg le(reg a, reg b) { return _mm_castps_si128(_mm_cmple_ps(ps(a), ps(b))); }
+    static reg gt(reg a, reg b) { return _mm_castps_si128(_mm_cmpgt_ps(ps(a), ps(b))); }
+    static reg ge(reg a, reg b) { return _mm_castps_si128(_mm_cmpge_ps(ps(a), ps(b))); }
+    static reg abs(reg a) { return and_(a, _mm_set1_epi32(0x7fffffff)); }
+    static __m128 ps(reg a) { return _mm_castsi128_ps(a); }
+};
+
+struct double_ops {
+    static reg set1(double v) { return _mm_castpd_si128(_mm_set1_pd(v)); }
+    static reg eq(reg a, reg b) { return _mm_castpd_si128(_mm_cmpeq_pd(pd(a), pd(b))); }
+    static reg ne(reg a, reg b) { return _mm_castpd_si128(_mm_cmpneq_pd(pd(a), pd(b))); }
+    static reg lt(reg a, reg b) { return _mm_castpd_si128(_mm_cmplt_pd(pd(a), pd(b))); }
+    static reg le(reg a, reg b) { return _mm_castpd_si128(_mm_cmple_pd(pd(a), pd(b))); }
+    static reg gt(reg a, reg b) { return _mm_castpd_si128(_mm_cmpgt_pd(pd(a), pd(b))); }
+    static reg ge(reg a, reg b) { return _mm_castpd_si128(_mm_cmpge_pd(pd(a), pd(b))); }
+    static reg abs(reg a) { return and_(a, _mm_set1_epi64x(0x7fffffffffffffffLL)); }
+    static __m128d pd(reg a) { return _mm_castsi128_pd(a); }
+};
+
+} // namespace detail
+
+#endif // STL_DEMO_SIMD_AVX2
+
+inline void sfence() { _mm_sfence(); }
+
+inline reg ones() { return detail::int_ops<1>::eq(zero(), zero()); }
+inline reg not_(reg a) { return xor_(a, ones()); }
+// mask ? a : b, mask lanes are all ones or all zeros
+inline reg select(reg mask, reg a, reg b) { return or_(and_(mask, a), andnot_(mask, b)); }
+
+/*
+ * lane<T>: per element type operations, every compare returns a lane mask.
+ * Unsigned integers are compared as signed after flipping the sign bit.
+ */
+template <typename T, typename Enable = void>
+struct lane;
+
+template <typename T>
+struct lane<T, typename std::enable_if<std::is_integral<T>::value && is_simd_type<T>::value>::type> {
+    typedef detail::int_ops<sizeof(T)> ops;
+    typedef typename std::make_signed<T>::type signed_type;
+    static const std::size_t width = kBytes / sizeof(T);
+
+    static reg set1(T v) { return ops::set1(static_cast<signed_type>(v)); }
+    static reg load(const T* p) { return loadu(p); }
+    static reg eq(reg a, reg b) { return ops::eq(a, b); }
+    static reg ne(reg a, reg b) { return not_(ops::eq(a, b)); }
+    static reg gt(reg a, reg b)
+    {
+        return std::is_signed<T>::value ? ops::gt(a, b) : ops::gt(xor_(a, sign()), xor_(b, sign()));
+    }
+    static reg lt(reg a, reg b) { return gt(b, a); }
+    static reg le(reg a, reg b) { return not_(gt(a, b)); }
+    static reg ge(reg a, reg b) { return not_(gt(b, a)); }
+    static reg min(reg a, reg b) { return select(gt(b, a), a, b); }
+    static reg max(reg a, reg b) { return select(gt(a, b), a, b); }
+    static reg add(reg a, reg b) { return ops::add(a, b); }
+    // |x| as an unsigned magnitude (the most negative value maps to itself, like the scalar two's complement)
+    static reg abs(reg a)
+    {
+        if (!std::is_signed<T>::value)
+            return a;
+        reg neg = ops::gt(zero(), a);
+        return ops::add(xor_(a, neg), and_(neg, ops::set1(1)));
+    }
+
+private:
+    static reg sign() { return ops::set1(std::numeric_limits<signed_type>::min()); }
+};
+
+template <>
+struct lane<float> {
+    typedef detail::float_ops ops;
+    static const std::size_t width = kBytes / sizeof(float);
+
+    static reg set1(float v) { return ops::set1(v); }
+    static reg load(const float* p) { return loadu(p); }
+    static reg eq(reg a, reg b) { return ops::eq(a, b); }
+    static reg ne(reg a, reg b) { return ops::ne(a, b); }
+    static reg gt(reg a, reg b) { return ops::gt(a, b); }
+    static reg lt(reg a, reg b) { return ops::lt(a, b); }
+    static reg le(reg a, reg b) { return ops::le(a, b); }
+    static reg ge(reg a, reg b) { return ops::ge(a, b); }
+    static reg min(reg a, reg b) { return select(lt(b, a), b, a); }
+    static reg max(reg a, reg b) { return select(lt(a, b), b, a); }
+    static reg abs(reg a) { return ops::abs(a); }
+};
+
+template <>
+struct lane<double> {
+    typedef detail::double_ops ops;
+    static const std::size_t width = kBytes / sizeof(double);
+
+    static reg set1(double v) { return ops::set1(v); }
+    static reg load(const double* p) { return loadu(p); }
+    static reg eq(reg a, reg b) { return ops::eq(a, b); }
+    static reg ne(reg a, reg b) { return ops::ne(a, b); }
+    static reg gt(reg a, reg b) { return ops::gt(a, b); }
+    static reg lt(reg a, reg b) { return ops::lt(a, b); }
+    static reg le(reg a, reg b) { return ops::le(a, b); }
+    static reg ge(reg a, reg b) { return ops::ge(a, b); }
+    static reg min(reg a, reg b) { return select(lt(b, a), b, a); }
+    static reg max(reg a, reg b) { return select(lt(a, b), b, a); }
+    static reg abs(reg a) { return ops::abs(a); }
+};
+
+/*
+ * One bit per lane instead of one bit per byte: lanemask<T>(m) has bit j set when lane j of m is set.
+ * The compaction kernels index their shuffle tables with it.
+ */
+namespace detail {
+
+#if defined(STL_DEMO_SIMD_AVX2)
+inline mask_t lanemask(reg m, std::integral_constant<std::size_t, 1>) { return bytemask(m); }
+inline mask_t lanemask(reg m, std::integral_constant<std::size_t, 2>)
+{
+    // packs works inside the 128 bit halves: words 0-7 end up in bits 0-7, words 8-15 in bits 16-23
+    const mask_t b = bytemask(_mm256_packs_epi16(m, m));
+    return (b & 0xffu) | ((b >> 8) & 0xff00u);
+}
+inline mask_t lanemask(reg m, std::integral_constant<std::size_t, 4>)
+{
+    return static_cast<mask_t>(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+}
+inline mask_t lanemask(reg m, std::integral_constant<std::size_t, 8>)
+{
+    return static_cast<mask_t>(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+}
+#else
+inline mask_t lanemask(reg m, std::integral_constant<std::size_t, 1>) { return bytemask(m); }
+inline mask_t lanemask(reg m, std::integral_constant<std::size_t, 2>) { return bytemask(_mm_packs_epi16(m, m)) & 0xffu; }
+inline mask_t lanemask(reg m, std::integral_constant<std::size_t, 4>)
+{
+    return static_cast<mask_t>(_mm_movemask_ps(_mm_castsi128_ps(m)));
+}
+inline mask_t lanemask(reg m, std::integral_constant<std::size_t, 8>)
+{
+    return static_cast<mask_t>(_mm_movemask_pd(_mm_castsi128_pd(m)));
+}
+#endif
+
+} // namespace detail
+
+template <typename T>
+inline mask_t lanemask(reg m)
+{
+    return detail::lanemask(m, std::integral_constant<std::size_t, sizeof(T)>());
+}
+
+// lane j of the result is lane (width - 1 - j) of x; works on any element of 1, 2, 4 or 8 bytes
+namespace detail {
+
+#if defined(STL_DEMO_SIMD_AVX2)
+inline reg reverse_lanes(reg x, std::integral_constant<std::size_t, 1>)
+{
+    const reg m = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                   15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(x, m), 0x4e); // then swap the 128 bit halves
+}
+inline reg reverse_lanes(reg x, std::integral_constant<std::size_t, 2>)
+{
+    const reg m = _mm256_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+                                   14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(x, m), 0x4e);
+}
+inline reg reverse_lanes(reg x, std::integral_constant<std::size_t, 4>)
+{
+    return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+inline reg reverse_lanes(reg x, std::integral_constant<std::size_t, 8>) { return _mm256_permute4x64_epi64(x, 0x1b); }
+#else
+inline reg reverse_lanes(reg x, std::integral_constant<std::size_t, 8>) { return _mm_shuffle_epi32(x, 0x4e); }
+inline reg reverse_lanes(reg x, std::integral_constant<std::size_t, 4>) { return _mm_shuffle_epi32(x, 0x1b); }
+inline reg reverse_lanes(reg x, std::integral_constant<std::size_t, 2>)
+{
+    return _mm_shuffle_epi32(_mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0x1b), 0x1b), 0x4e);
+}
+inline reg reverse_lanes(reg x, std::integral_constant<std::size_t, 1>)
+{
+    // no byte shuffle in SSE2: reverse the words, then swap the two bytes of every word
+    x = reverse_lanes(x, std::integral_constant<std::size_t, 2>());
+    return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+#endif
+
+} // namespace detail
+
+template <typename T>
+inline reg reverse(reg x)
+{
+    return detail::reverse_lanes(x, std::integral_constant<std::size_t, sizeof(T)>());
+}
+
+// all lanes of a register of T
+template <typename T>
+inline mask_t all_lanes()
+{
+    return lane<T>::width >= 32 ? ~mask_t(0) : (mask_t(1) << (lane<T>::width % 32)) - 1;
+}
+
+#endif // STL_DEMO_SIMD
+
+/*
+ * Vectorizable predicates: "elem OP value" against a constant.
+ * They work as ordinary unary predicates (so every std algorithm accepts them),
+ * and additionally expose mask() for the kernels.
+ *
+ *     kernels::find_if(v.begin(), v.end(), simd::greater_than(3))
+ */
+enum class cmp_op { eq, ne, lt, le, gt, ge };
+
+template <typename T, cmp_op Op>
+struct compare_to {
+    typedef T value_type;
+    T value;
+
+    explicit compare_to(T v) : value(v) {}
+
+    bool operator()(const T& x) const
+    {
+        return Op == cmp_op::eq ? x == value
+             : Op == cmp_op::ne ? x != value
+             : Op == cmp_op::lt ? x < value
+             : Op == cmp_op::le ? x <= value
+             : Op == cmp_op::gt ? x > value
+                                : x >= value;
+    }
+
+#if defined(STL_DEMO_SIMD)
+    reg mask(reg x) const { return mask(x, lane<T>::set1(value)); }
+
+    static reg mask(reg x, reg v)
+    {
+        return Op == cmp_op::eq ? lane<T>::eq(x, v)
+             : Op == cmp_op::ne ? lane<T>::ne(x, v)
+             : Op == cmp_op::lt ? lane<T>::lt(x, v)
+             : Op == cmp_op::le ? lane<T>::le(x, v)
+             : Op == cmp_op::gt ? lane<T>::gt(x, v)
+                                : lane<T>::ge(x, v);
+    }
+#endif
+};
+
+template <typename T> compare_to<T, cmp_op::eq> equal_to(T v) { return compare_to<T, cmp_op::eq>(v); }
+template <typename T> compare_to<T, cmp_op::ne> not_equal_to(T v) { return compare_to<T, cmp_op::ne>(v); }
+template <typename T> compare_to<T, cmp_op::lt> less_than(T v) { return compare_to<T, cmp_op::lt>(v); }
+template <typename T> compare_to<T, cmp_op::le> less_equal(T v) { return compare_to<T, cmp_op::le>(v); }
+template <typename T> compare_to<T, cmp_op::gt> greater_than(T v) { return compare_to<T, cmp_op::gt>(v); }
+template <typename T> compare_to<T, cmp_op::ge> greater_equal(T v) { return compare_to<T, cmp_op::ge>(v); }
+
+template <typename Pred>
+struct is_simd_predicate : std::false_type {};
+
+template <typename T, cmp_op Op>
+struct is_simd_predicate<compare_to<T, Op>> : is_simd_type<T> {};
+
+// simd:: predicate whose value type matches the range
+template <typename Pred, typename T, bool = is_simd_predicate<Pred>::value>
+struct is_simd_predicate_for : std::false_type {};
+
+template <typename Pred, typename T>
+struct is_simd_predicate_for<Pred, T, true> : std::is_same<typename Pred::value_type, T> {};
+
+/*
+ * std::find(first, last, value) compares *it == value after the usual arithmetic conversions, the kernels
+ * compare in the element type V after static_cast<V>(value). Both agree when value survives the round trip
+ * through V; 300 among int8_t, 1.5 among int or -1 among uint16_t do not, and go to the std algorithm.
+ */
+namespace detail {
+
+// a floating point value converts to an integer type only inside its range
+template <typename I, typename F>
+bool converts(F x, std::true_type)
+{
+    return x >= static_cast<F>(std::numeric_limits<I>::min()) &&
+           x < static_cast<F>(std::numeric_limits<I>::max() / 2 + 1) * 2;
+}
+
+template <typename I, typename F>
+bool converts(F, std::false_type)
+{
+    return true;
+}
+
+template <typename To, typename From>
+bool converts(From x)
+{
+    return converts<To>(x, std::integral_constant<bool, std::is_floating_point<From>::value && std::is_integral<To>::value>());
+}
+
+template <typename V, typename T>
+bool round_trips(const T& value, std::true_type)
+{
+    if (!converts<V>(value))
+        return false;
+    const V v = static_cast<V>(value);
+    return converts<T>(v) && static_cast<T>(v) == value;
+}
+
+// other types compare the way they did
+template <typename V, typename T>
+bool round_trips(const T&, std::false_type)
+{
+    return true;
+}
+
+} // namespace detail
+
+template <typename V, typename T>
+bool representable(const T& value)
+{
+    return std::is_same<V, T>::value ||
+           detail::round_trips<V>(value, std::integral_constant<bool, std::is_arithmetic<V>::value &&
+                                                                       std::is_arithmetic<T>::value>());
+}
+
+} // namespace simd
+} // namespace algorithms
+
+#endif //STL_DEMO_ALGORITHMS_SIMD_H
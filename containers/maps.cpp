@@ -1,5 +1,6 @@
 #include "maps.h"
 #include "helper.h"
+#include "../strings/nocase.h"
 
 #include <iostream>
 #include <map>
@@ -119,9 +120,6 @@ public:
     enum cmp_mode {normal, no_case};
 private:
     const cmp_mode mode;
-    static bool nocase_compare (char c1, char c2) {
-        return toupper(c1) < toupper(c2);
-    }
 public:
     RuntimeStrCmp(cmp_mode m=normal): mode(m) {
 
@@ -132,9 +130,9 @@ public:
             return s1 < s2;
         }
         else {
-            return lexicographical_compare (s1.begin(), s1.end(),
-                                            s2.begin(), s2.end(),
-                                            nocase_compare);
+            // 原来是 lexicographical_compare + toupper 逐个字符比较，
+            // strings/nocase.h 按 ASCII 折叠大小写，一次比较 16/32 个字节，顺序不变
+            return strings::nocase::compare(s1, s2) < 0;
         }
     }
 };
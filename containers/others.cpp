@@ -5,6 +5,8 @@
 #include <deque>
 #include <set>
 #include <memory>
+#include <vector>
+#include <functional>
 
 using namespace std;
 
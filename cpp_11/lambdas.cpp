@@ -1,4 +1,5 @@
 #include "lambdas.h"
+#include "../function_objects/callables.h"
 #include <iostream>
 #include <functional>
 
@@ -18,7 +19,9 @@ or
 
 */
 
-std::function<int(int, int)> returnLambda()
+// std::function<int(int, int)> 也可以，但它在捕获较多时会分配堆内存，并且每次调用都有间接跳转;
+// inplace_function 把lambda直接存放在对象内部的缓冲区里，永远不分配内存
+function_objects::callables::inplace_function<int(int, int)> returnLambda()
 {
     return [] (int x, int y) -> int {
         return x * y;
@@ -80,7 +83,7 @@ void lambdas_demo()
     // Type of lambdas:
     // The type of a lambda is an anonymous function object (or functor) that is unique for each lambda expression
     // 为了声明这种类型的对象，一般像前面用auto，或者decltype(), 或者用标准库中的std::function来声明
-    // 参考前面的 returnLambda() 函数的定义
+    // 参考前面的 returnLambda() 函数的定义 (这里用的是不分配内存的 inplace_function)
 
     auto lf = returnLambda();
     std::cout << lf(6, 10) << std::endl;
@@ -17,6 +17,7 @@ or
 #include "move_semantics.h"
 #include "exceptions.h"
 #include "lambdas.h"
+#include "perfect_hash.h"
 
 #define USE_CPP_11   //if this macro is open, and compile with C++ 98, compile errors happen
 
@@ -132,6 +133,7 @@ constexpr int square(int x)
 {
     return x * x;
 }
+// constexpr 函数同样可以在编译期构造整张查找表，参考 perfect_hash.h (编译期生成的字符串完美哈希表)
 
 // templates new features
 // 1. variadic template: 
@@ -226,6 +228,7 @@ void Run()
     //print(7.5, "hello", std::bitset<16>(377), 42);
 
     //lambdas::lambdas_demo();
+    //perfect_hash::perfect_hash_demo();
     
 }
 
@@ -0,0 +1,77 @@
+#include "perfect_hash.h"
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <chrono>
+
+namespace cpp_11 {
+namespace perfect_hash {
+
+// same enumeration as special_containers::bitsets_::sets_of_flags()
+enum Color { red, yellow, green, blue, white, black, numColors };
+
+constexpr entry<Color> kColorNames[] = {
+    {"red", red}, {"yellow", yellow}, {"green", green},
+    {"blue", blue}, {"white", white}, {"black", black}
+};
+constexpr static_map<Color, 6> kColors = make_static_map(kColorNames);
+
+// the dictionary used by containers::maps fillAndPrint()
+constexpr entry<const char*> kDictEntries[] = {
+    {"Deutschland", "Germany"}, {"deutsch", "German"}, {"Haken", "snag"},
+    {"arbeiten", "work"}, {"Hund", "dog"}, {"gehen", "walk"},
+    {"Unternehmen", "enterprise"}, {"unternehmen", "undertake"}, {"Bestatter", "undertaker"}
+};
+constexpr static_map<const char*, 9> kDict = make_static_map(kDictEntries);
+
+// everything below is evaluated by the compiler, nothing is left for startup
+static_assert(kColors.at("green") == green, "compile time lookup");
+static_assert(kColors.contains("black") && !kColors.contains("purple"), "compile time membership");
+static_assert(kDict.index_of("Hund", 4) == 4, "index into the original entry array");
+// static_assert(kColors.at("purple") == red, "");  // compile error: unknown key inside a constant expression
+
+void perfect_hash_demo()
+{
+    std::cout << "colors: seed = " << kColors.seed() << ", slots = " << kColors.kSlots << std::endl;
+    for (const auto& e : kColors) {
+        std::cout << e.key << " -> " << e.value << std::endl;
+    }
+
+    // run time lookup with strings that only exist at run time
+    std::string names[] = {"blue", "white", "purple", "Red"};
+    for (const auto& name : names) {
+        const Color* c = kColors.find(name);
+        std::cout << name << ": " << (c ? std::to_string(*c) : std::string("not found")) << std::endl;
+    }
+    std::cout << "name of color 2: " << kColors.name_of(green) << std::endl;
+
+    std::cout << "gehen: " << kDict.get("gehen", "?") << std::endl;
+    std::cout << "laufen: " << kDict.get("laufen", "?") << std::endl;
+
+    // compare against a std::map that has to be built at run time
+    const int kRounds = 1000000;
+    std::string keys[] = {"Hund", "gehen", "Haken", "laufen", "Unternehmen", "deutsch"};
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::map<std::string, std::string> dict;
+    for (const auto& e : kDictEntries) {
+        dict[e.key] = e.value;
+    }
+    std::size_t hits = 0;
+    for (int i = 0; i < kRounds; ++i) {
+        hits += dict.count(keys[i % 6]);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; ++i) {
+        hits += kDict.find(keys[i % 6]) != nullptr;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::cout << "hits: " << hits << std::endl;
+    std::cout << "std::map:   " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "static_map: " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+}
+
+}
+}
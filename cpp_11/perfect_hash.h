@@ -0,0 +1,263 @@
+#ifndef CPP_11_PERFECT_HASH_H
+#define CPP_11_PERFECT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "integer_sequence.h"
+
+namespace cpp_11 {
+namespace perfect_hash {
+
+/*
+ * Compile-time perfect hash tables (C++11 constexpr)
+ *
+ * new_features.cpp 里的 constexpr square() 只是最简单的用法，这里用同样的机制在编译期完成:
+ *   1. 对每个字符串字面量计算一次 FNV-1a，再用 seed 参与的 fmix32 得到最终哈希
+ *   2. 从 seed = 0 开始搜索，直到所有 key 落在 table_size(N) 个槽位中互不冲突
+ *   3. 生成槽位数组 slots_[h & (M - 1)] = key 的下标
+ * 运行期查找 = 一次哈希 + 一次查表 + 一次 memcmp，没有任何运行期初始化，
+ * 对象本身可以放在只读数据段里（constexpr 全局变量）。
+ *
+ * C++11 的 constexpr 函数只能有一条 return 语句，所以所有的循环都写成了递归：
+ *   - 哈希递归深度 = key 的长度
+ *   - 冲突检测递归深度 ~ 2N
+ *   - seed 搜索用二分的方式递归，深度只有 log2(kMaxSeed)
+ * 编译器对 constexpr 求值的步数也有上限 (gcc: -fconstexpr-ops-limit)，
+ * 因此适合一百个 key 左右的枚举名 / 关键字表，更大的表请用 std::unordered_map。
+ *
+ * Usage:
+ *     constexpr perfect_hash::entry<Color> kColorNames[] = {{"red", red}, {"green", green}};
+ *     constexpr auto kColors = perfect_hash::make_static_map(kColorNames);
+ *     static_assert(kColors.at("green") == green, "");   // 编译期查找
+ *     const Color* c = kColors.find(name);                // 运行期查找, 找不到返回nullptr
+ */
+
+using helper::index_sequence;
+using helper::make_index_sequence;
+
+namespace detail {
+
+constexpr std::size_t const_strlen(const char* s, std::size_t n = 0)
+{
+    return s[n] == '\0' ? n : const_strlen(s, n + 1);
+}
+
+constexpr bool const_streq(const char* a, const char* b, std::size_t len)
+{
+    return len == 0 ? true : (*a == *b && const_streq(a + 1, b + 1, len - 1));
+}
+
+constexpr std::uint32_t fnv1a(const char* s, std::size_t len, std::uint32_t h)
+{
+    return len == 0 ? h
+                    : fnv1a(s + 1, len - 1,
+                            (h ^ static_cast<std::uint32_t>(static_cast<unsigned char>(*s))) * 16777619u);
+}
+
+// murmur3 finalizer, spreads the entropy into the low bits used for slot selection
+constexpr std::uint32_t fmix_3(std::uint32_t h) { return h ^ (h >> 16); }
+constexpr std::uint32_t fmix_2(std::uint32_t h) { return fmix_3((h ^ (h >> 13)) * 0xc2b2ae35u); }
+constexpr std::uint32_t fmix32(std::uint32_t h) { return fmix_2((h ^ (h >> 16)) * 0x85ebca6bu); }
+
+constexpr std::uint32_t next_pow2(std::uint32_t v, std::uint32_t p = 1)
+{
+    return p >= v ? p : next_pow2(v, p << 1);
+}
+
+} // namespace detail
+
+// seeded string hash, usable both at compile time and at run time.
+// The seed only enters the final mix, so the per-key FNV pass is done once while searching seeds.
+constexpr std::uint32_t remix(std::uint32_t base, std::uint32_t seed)
+{
+    return detail::fmix32(base ^ (seed * 0x9e3779b9u));
+}
+
+constexpr std::uint32_t hash(const char* s, std::size_t len, std::uint32_t seed)
+{
+    return remix(detail::fnv1a(s, len, 2166136261u), seed);
+}
+
+// at least 4 slots per key, and N^2/8 for larger tables, so that the expected
+// number of seed trials (~e^(N^2 / 2M)) stays below ~e^4
+constexpr std::size_t table_size(std::size_t n)
+{
+    return detail::next_pow2(static_cast<std::uint32_t>(n * n / 8 > n * 4 ? n * n / 8 : (n < 1 ? 4 : n * 4)));
+}
+
+template <typename V>
+struct entry {
+    const char* key;
+    V value;
+};
+
+// unseeded FNV-1a of every key, computed once per table
+template <std::size_t N>
+struct key_hashes {
+    std::uint32_t h[N];
+};
+
+template <typename V, std::size_t N, std::size_t... Is>
+constexpr key_hashes<N> make_key_hashes(const entry<V> (&e)[N], index_sequence<Is...>)
+{
+    return key_hashes<N>{{detail::fnv1a(e[Is].key, detail::const_strlen(e[Is].key), 2166136261u)...}};
+}
+
+template <typename V, std::size_t N>
+class static_map {
+public:
+    static const std::size_t kSlots = table_size(N);
+    static const std::size_t npos = N;
+    static const std::uint32_t kMaxSeed = 1u << 16;
+
+    static_assert(N > 0, "static_map needs at least one entry");
+    static_assert(N < 0xffff, "static_map is meant for small tables");
+
+    constexpr explicit static_map(const entry<V> (&e)[N])
+        : static_map(e, make_key_hashes(e, make_index_sequence<N>()))
+    {
+    }
+
+    constexpr std::size_t size() const { return N; }
+    constexpr std::uint32_t seed() const { return seed_; }
+
+    // position of key inside the original entry array, or npos
+    constexpr std::size_t index_of(const char* key, std::size_t len) const
+    {
+        return match(slots_[hash(key, len, seed_) & (kSlots - 1)], key, len);
+    }
+
+    constexpr bool contains(const char* key) const
+    {
+        return index_of(key, detail::const_strlen(key)) != npos;
+    }
+
+    // compile time lookup, an unknown key is a compile error inside a constant expression
+    constexpr const V& at(const char* key) const
+    {
+        return contains(key) ? entries_[index_of(key, detail::const_strlen(key))].value
+                             : throw std::out_of_range("perfect_hash::static_map::at");
+    }
+
+    // run time lookup: one hash, one table load, one memcmp
+    const V* find(const char* key, std::size_t len) const
+    {
+        const std::size_t idx = slots_[hash(key, len, seed_) & (kSlots - 1)];
+        const entry<V>& e = entries_[idx < N ? idx : 0];
+        return (idx < N && lengths_[idx] == len && std::memcmp(e.key, key, len) == 0) ? &e.value : nullptr;
+    }
+
+    const V* find(const std::string& key) const { return find(key.data(), key.size()); }
+
+    V get(const std::string& key, const V& def) const
+    {
+        const V* v = find(key);
+        return v ? *v : def;
+    }
+
+    // reverse lookup (value -> name), linear because the tables are small
+    const char* name_of(const V& value) const
+    {
+        for (std::size_t i = 0; i < N; ++i) {
+            if (entries_[i].value == value)
+                return entries_[i].key;
+        }
+        return nullptr;
+    }
+
+    const entry<V>* begin() const { return entries_; }
+    const entry<V>* end() const { return entries_ + N; }
+
+private:
+    constexpr static_map(const entry<V> (&e)[N], const key_hashes<N>& kh)
+        : static_map(e, kh, find_seed(kh), make_index_sequence<N>(), make_index_sequence<kSlots>())
+    {
+    }
+
+    template <std::size_t... Is, std::size_t... Ss>
+    constexpr static_map(const entry<V> (&e)[N], const key_hashes<N>& kh, std::uint32_t seed,
+                         index_sequence<Is...>, index_sequence<Ss...>)
+        : entries_{e[Is]...},
+          lengths_{detail::const_strlen(e[Is].key)...},
+          slots_{static_cast<std::uint16_t>(slot_of(kh, seed, Ss))...},
+          seed_(seed)
+    {
+    }
+
+    static constexpr std::size_t bucket(const key_hashes<N>& kh, std::uint32_t seed, std::size_t i)
+    {
+        return remix(kh.h[i], seed) & (kSlots - 1);
+    }
+
+    // does key i collide with any key in [j, N) ?
+    static constexpr bool collides(const key_hashes<N>& kh, std::uint32_t seed, std::size_t i, std::size_t j)
+    {
+        return j == N ? false : (bucket(kh, seed, i) == bucket(kh, seed, j) || collides(kh, seed, i, j + 1));
+    }
+
+    static constexpr bool is_perfect(const key_hashes<N>& kh, std::uint32_t seed, std::size_t i = 0)
+    {
+        return i == N ? true : (!collides(kh, seed, i, i + 1) && is_perfect(kh, seed, i + 1));
+    }
+
+    // first perfect seed in [lo, hi), or kMaxSeed; bisection keeps the recursion depth at log2(hi - lo)
+    static constexpr std::uint32_t first_seed(const key_hashes<N>& kh, std::uint32_t lo, std::uint32_t hi)
+    {
+        return hi - lo == 1 ? (is_perfect(kh, lo) ? lo : kMaxSeed)
+                            : first_seed_or(kh, first_seed(kh, lo, lo + (hi - lo) / 2), lo + (hi - lo) / 2, hi);
+    }
+
+    static constexpr std::uint32_t first_seed_or(const key_hashes<N>& kh, std::uint32_t found,
+                                                 std::uint32_t lo, std::uint32_t hi)
+    {
+        return found != kMaxSeed ? found : first_seed(kh, lo, hi);
+    }
+
+    static constexpr std::uint32_t find_seed(const key_hashes<N>& kh)
+    {
+        return checked_seed(first_seed(kh, 0, kMaxSeed));
+    }
+
+    static constexpr std::uint32_t checked_seed(std::uint32_t seed)
+    {
+        return seed != kMaxSeed ? seed
+                                : throw std::logic_error("perfect_hash: duplicate keys or no perfect seed found");
+    }
+
+    static constexpr std::size_t slot_of(const key_hashes<N>& kh, std::uint32_t seed,
+                                         std::size_t slot, std::size_t i = 0)
+    {
+        return i == N ? npos : (bucket(kh, seed, i) == slot ? i : slot_of(kh, seed, slot, i + 1));
+    }
+
+    constexpr std::size_t match(std::size_t idx, const char* key, std::size_t len) const
+    {
+        return idx < N && lengths_[idx] == len && detail::const_streq(entries_[idx].key, key, len) ? idx : npos;
+    }
+
+    entry<V> entries_[N];
+    std::size_t lengths_[N];
+    std::uint16_t slots_[kSlots];
+    std::uint32_t seed_;
+};
+
+template <typename V, std::size_t N> const std::size_t static_map<V, N>::kSlots;
+template <typename V, std::size_t N> const std::size_t static_map<V, N>::npos;
+template <typename V, std::size_t N> const std::uint32_t static_map<V, N>::kMaxSeed;
+
+template <typename V, std::size_t N>
+constexpr static_map<V, N> make_static_map(const entry<V> (&e)[N])
+{
+    return static_map<V, N>(e);
+}
+
+void perfect_hash_demo();
+
+}
+}
+
+#endif // CPP_11_PERFECT_HASH_H
@@ -181,6 +181,9 @@ void Run()
 
     //not1(), not2() 这两个其实并没有什么实用的场景
 
+    // std::bind 嵌套之后不容易被内联，并且会拷贝绑定的参数;
+    // 更轻量的 bind_front() / project() / by() 参考 projections.h
+
     /* deprecated function adapters
      *  Expression              Effect
         bind1st(op,arg)         Calls op(arg,param)
@@ -0,0 +1,141 @@
+#include "callables.h"
+#include "helper.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace function_objects {
+namespace callables {
+
+int plus_10(int val)
+{
+    return val + 10;
+}
+
+void basic_usage()
+{
+    // owning, copyable, never allocates
+    inplace_function<int(int, int)> mul = [] (int x, int y) { return x * y; };
+    cout << "6 * 10 = " << mul(6, 10) << endl;
+
+    // captures up to Capacity bytes are stored inline
+    string prefix = "value: ";
+    inplace_function<string(int), 48> fmt = [prefix] (int v) { return prefix + to_string(v); };
+    inplace_function<string(int), 48> fmt2 = fmt;
+    cout << fmt2(42) << endl;
+
+    // a std::bind result can be stored as well
+    inplace_function<int(int)> plus10 = std::bind(std::plus<int>(), std::placeholders::_1, 10);
+    cout << "+10: " << plus10(7) << endl;
+
+    // empty object behaves like an empty std::function
+    inplace_function<void()> empty;
+    try {
+        empty();
+    } catch (const std::bad_function_call& e) {
+        cout << "empty inplace_function: " << e.what() << endl;
+    }
+
+    // too large a capture is a compile error instead of a hidden heap allocation:
+    // char big[64] = {};
+    // inplace_function<void()> f = [big] {}; // static_assert: callable does not fit into the inline buffer
+
+    // non-owning reference, typical as a callback parameter
+    vector<int> coll = {1, 2, 3, 4};
+    int sum = 0;
+    auto add = [&sum] (int v) { sum += v; };
+    function_ref<void(int)> cb = add;
+    for (int v : coll) {
+        cb(v);
+    }
+    cout << "sum: " << sum << endl;
+
+    function_ref<int(int)> fr = plus_10;
+    cout << "plus_10(5): " << fr(5) << endl;
+
+    cout << "sizeof(std::function<int(int)>): " << sizeof(std::function<int(int)>) << endl;
+    cout << "sizeof(inplace_function<int(int)>): " << sizeof(inplace_function<int(int)>) << endl;
+    cout << "sizeof(function_ref<int(int)>): " << sizeof(function_ref<int(int)>) << endl;
+}
+
+// the callbacks are stored in registries and dispatched many times, so measure the call path
+template <typename Callable>
+long long dispatch(const vector<Callable>& registry, int rounds)
+{
+    long long total = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (const auto& cb : registry) {
+            total += cb(r);
+        }
+    }
+    return total;
+}
+
+template <typename Clock>
+long long elapsed_us(typename Clock::time_point start)
+{
+    return chrono::duration_cast<chrono::microseconds>(Clock::now() - start).count();
+}
+
+void benchmark()
+{
+    typedef chrono::steady_clock clock;
+    const int kCallbacks = 16;
+    const int kRounds = 1000000;
+
+    // 24 bytes of captures: larger than libstdc++'s std::function small buffer
+    struct Offset {
+        long long a, b, c;
+        int operator()(int x) const { return static_cast<int>(x + a - b + c); }
+    };
+
+    auto t0 = clock::now();
+    vector<std::function<int(int)>> std_fns;
+    for (int i = 0; i < kCallbacks; ++i) {
+        std_fns.push_back(Offset{i, 1, 2});
+    }
+    long long r1 = dispatch(std_fns, kRounds);
+    long long t_std = elapsed_us<clock>(t0);
+
+    t0 = clock::now();
+    vector<inplace_function<int(int)>> inplace_fns;
+    for (int i = 0; i < kCallbacks; ++i) {
+        inplace_fns.push_back(Offset{i, 1, 2});
+    }
+    long long r2 = dispatch(inplace_fns, kRounds);
+    long long t_inplace = elapsed_us<clock>(t0);
+
+    t0 = clock::now();
+    vector<Offset> offsets;
+    for (int i = 0; i < kCallbacks; ++i) {
+        offsets.push_back(Offset{i, 1, 2});
+    }
+    vector<function_ref<int(int)>> refs(offsets.begin(), offsets.end());
+    long long r3 = dispatch(refs, kRounds);
+    long long t_ref = elapsed_us<clock>(t0);
+
+    // the raw function objects can be inlined: the lower bound
+    t0 = clock::now();
+    long long r4 = dispatch(offsets, kRounds);
+    long long t_raw = elapsed_us<clock>(t0);
+
+    cout << "results: " << r1 << ' ' << r2 << ' ' << r3 << ' ' << r4 << endl;
+    cout << "std::function:    " << t_std << " us" << endl;
+    cout << "inplace_function: " << t_inplace << " us" << endl;
+    cout << "function_ref:     " << t_ref << " us" << endl;
+    cout << "raw lambda:       " << t_raw << " us" << endl;
+}
+
+void Run()
+{
+    basic_usage();
+    benchmark();
+}
+
+}
+}
@@ -0,0 +1,177 @@
+#ifndef STL_DEMO_FUNCTION_OBJECTS_CALLABLES_H
+#define STL_DEMO_FUNCTION_OBJECTS_CALLABLES_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace function_objects {
+namespace callables {
+
+/*
+ * std::function 的两个开销：
+ *   1. 可调用对象超过实现内部的小缓冲 (libstdc++ 是 16 字节) 时会在堆上分配
+ *   2. 每次调用都要经过一次间接跳转，编译器通常无法内联
+ *
+ * 这里提供两种替代品：
+ *   inplace_function<R(Args...), Capacity>
+ *       拥有所有权的类型擦除，可调用对象直接存放在对象内部 Capacity 字节的缓冲区里，
+ *       永远不会分配堆内存；放不下的可调用对象在编译期报错 (static_assert)。
+ *   function_ref<R(Args...)>
+ *       不拥有所有权，只保存 {对象地址, 调用函数指针} 两个指针，适合作为函数参数传递回调，
+ *       调用者必须保证被引用的可调用对象比 function_ref 活得更久。
+ */
+
+template <typename Signature, std::size_t Capacity = 32,
+          std::size_t Align = std::alignment_of<std::max_align_t>::value>
+class inplace_function;
+
+template <typename R, typename... Args, std::size_t Capacity, std::size_t Align>
+class inplace_function<R(Args...), Capacity, Align> {
+public:
+    typedef R result_type;
+    static const std::size_t capacity = Capacity;
+
+    inplace_function() noexcept : vtable_(&empty_vtable) {}
+    inplace_function(std::nullptr_t) noexcept : vtable_(&empty_vtable) {}
+
+    template <typename F,
+              typename D = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<D, inplace_function>::value>::type>
+    inplace_function(F&& f) : vtable_(&vtable_for<D>::value)
+    {
+        static_assert(sizeof(D) <= Capacity, "inplace_function: callable does not fit into the inline buffer");
+        static_assert(Align % std::alignment_of<D>::value == 0, "inplace_function: callable is over-aligned");
+        ::new (static_cast<void*>(&storage_)) D(std::forward<F>(f));
+    }
+
+    inplace_function(const inplace_function& other) : vtable_(other.vtable_)
+    {
+        vtable_->copy(&storage_, &other.storage_);
+    }
+
+    inplace_function(inplace_function&& other) noexcept : vtable_(other.vtable_)
+    {
+        vtable_->move(&storage_, &other.storage_);
+    }
+
+    inplace_function& operator=(inplace_function other) noexcept
+    {
+        vtable_->destroy(&storage_);
+        vtable_ = other.vtable_;
+        vtable_->move(&storage_, &other.storage_);
+        return *this;
+    }
+
+    ~inplace_function() { vtable_->destroy(&storage_); }
+
+    // no "is empty" branch on the call path: the empty vtable's invoke throws bad_function_call
+    R operator()(Args... args) const
+    {
+        return vtable_->invoke(const_cast<void*>(static_cast<const void*>(&storage_)), std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return vtable_ != &empty_vtable; }
+
+private:
+    struct vtable {
+        R (*invoke)(void*, Args&&...);
+        void (*copy)(void* dst, const void* src);
+        void (*move)(void* dst, void* src);
+        void (*destroy)(void*);
+    };
+
+    static R empty_invoke(void*, Args&&...) { throw std::bad_function_call(); }
+    static void empty_copy(void*, const void*) {}
+    static void empty_move(void*, void*) {}
+    static void empty_destroy(void*) {}
+
+    template <typename F>
+    struct vtable_for {
+        static R invoke(void* obj, Args&&... args)
+        {
+            return static_cast<R>((*static_cast<F*>(obj))(std::forward<Args>(args)...));
+        }
+        static void copy(void* dst, const void* src) { ::new (dst) F(*static_cast<const F*>(src)); }
+        static void move(void* dst, void* src) { ::new (dst) F(std::move(*static_cast<F*>(src))); }
+        static void destroy(void* obj) { static_cast<F*>(obj)->~F(); }
+
+        static const vtable value;
+    };
+
+    static const vtable empty_vtable;
+
+    const vtable* vtable_;
+    typename std::aligned_storage<Capacity, Align>::type storage_;
+};
+
+template <typename R, typename... Args, std::size_t Capacity, std::size_t Align>
+const typename inplace_function<R(Args...), Capacity, Align>::vtable
+inplace_function<R(Args...), Capacity, Align>::empty_vtable = {
+    &inplace_function::empty_invoke, &inplace_function::empty_copy,
+    &inplace_function::empty_move, &inplace_function::empty_destroy
+};
+
+template <typename R, typename... Args, std::size_t Capacity, std::size_t Align>
+template <typename F>
+const typename inplace_function<R(Args...), Capacity, Align>::vtable
+inplace_function<R(Args...), Capacity, Align>::vtable_for<F>::value = {
+    &vtable_for::invoke, &vtable_for::copy, &vtable_for::move, &vtable_for::destroy
+};
+
+template <typename R, typename... Args, std::size_t Capacity, std::size_t Align>
+const std::size_t inplace_function<R(Args...), Capacity, Align>::capacity;
+
+
+template <typename Signature>
+class function_ref;
+
+template <typename R, typename... Args>
+class function_ref<R(Args...)> {
+public:
+    // plain functions are stored as function pointers, anything else by address
+    function_ref(R (*fn)(Args...)) noexcept : callback_(&call_function)
+    {
+        target_.fn = reinterpret_cast<void (*)()>(fn);
+    }
+
+    template <typename F,
+              typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, function_ref>::value &&
+                                                 !std::is_function<typename std::remove_reference<F>::type>::value>::type>
+    function_ref(F&& f) noexcept : callback_(&call_object<typename std::remove_reference<F>::type>)
+    {
+        target_.obj = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+    }
+
+    R operator()(Args... args) const { return callback_(target_, std::forward<Args>(args)...); }
+
+private:
+    union target {
+        void* obj;
+        void (*fn)();
+    };
+
+    static R call_function(target t, Args&&... args)
+    {
+        return reinterpret_cast<R (*)(Args...)>(t.fn)(std::forward<Args>(args)...);
+    }
+
+    template <typename F>
+    static R call_object(target t, Args&&... args)
+    {
+        return static_cast<R>((*static_cast<F*>(t.obj))(std::forward<Args>(args)...));
+    }
+
+    target target_;
+    R (*callback_)(target, Args&&...);
+};
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_FUNCTION_OBJECTS_CALLABLES_H
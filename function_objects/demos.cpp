@@ -2,6 +2,8 @@
 #include "basics.h"
 #include "binders.h"
 #include "lambdas.h"
+#include "callables.h"
+#include "projections.h"
 
 #include <iostream>
 
@@ -14,6 +16,8 @@ void Demos()
     //basics::Run();
     //binders::Run();
     lambdas::Run();
+    //callables::Run();
+    //projections::Run();
 }
 
 }
\ No newline at end of file
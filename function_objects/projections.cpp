@@ -0,0 +1,136 @@
+#include "projections.h"
+#include "helper.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace function_objects {
+namespace projections {
+
+constexpr int add(int x, int y)
+{
+    return x + y;
+}
+
+struct Point {
+    int x;
+    int y;
+};
+
+// everything is constexpr, so the compiler can fold it away completely
+constexpr Point kOrigin{3, 4};
+static_assert(bind_front(add, 10)(7) == 17, "partial application at compile time");
+static_assert(project(&Point::y)(kOrigin) == 4, "member projection at compile time");
+static_assert(compose(bind_front(add, 1), project(&Point::x))(kOrigin) == 4, "composition at compile time");
+static_assert(by(&Point::x)(Point{1, 9}, Point{2, 0}), "projected comparison at compile time");
+
+class Person {
+public:
+    Person(string _name, int _age) : name(_name), age(_age) {}
+
+    const string& get_name() const { return name; }
+    void print2(const string& _prefix) const { cout << _prefix << name << endl; }
+
+    string name;
+    int age;
+};
+
+// the same things binders.cpp does with std::bind / std::mem_fn
+void binders_demo()
+{
+    auto plus10 = bind_front(std::plus<int>(), 10);
+    cout << "+10: " << plus10(7) << endl;
+
+    // (x + 10) * 2
+    auto plus10times2 = compose(bind_front(std::multiplies<int>(), 2), plus10);
+    cout << "+10 * 2: " << plus10times2(7) << endl;
+
+    vector<int> coll = {1, 2, 3, 4, 5, 6, 7};
+    transform(coll.begin(), coll.end(), coll.begin(), bind_front(std::plus<int>(), 10));
+    helper::PRINT_ELEMENT(coll);
+
+    // member functions: objects, pointers and smart pointers all go through invoke()
+    vector<Person> persons = {Person("Tick", 12), Person("Trick", 10), Person("Track", 11)};
+    auto print_with = [] (const string& prefix) {
+        return [prefix] (const Person& p) { projections::invoke(&Person::print2, p, prefix); };
+    };
+    for_each(persons.begin(), persons.end(), print_with("Person: "));
+
+    shared_ptr<Person> sp = make_shared<Person>("Huang", 30);
+    invoke(&Person::print2, sp, "Smart pointer to Person: ");
+    cout << "name through pointer: " << project(&Person::name)(&persons[0]) << endl;
+}
+
+void projections_demo()
+{
+    vector<Person> persons = {Person("Tick", 12), Person("Trick", 10), Person("Track", 11),
+                              Person("Donald", 40), Person("Daisy", 38)};
+
+    // sort by a member, no copies of the strings are made
+    sort(persons.begin(), persons.end(), by(&Person::name));
+    for (const auto& p : persons) cout << p.name << ' ';
+    cout << endl;
+
+    // projections can also be member functions, and any comparator can be used
+    sort(persons.begin(), persons.end(), by(&Person::get_name, greater()));
+    for (const auto& p : persons) cout << p.name << ' ';
+    cout << endl;
+
+    // binary search by key: lower_bound calls cmp(elem, key), upper_bound calls cmp(key, elem)
+    sort(persons.begin(), persons.end(), by(&Person::age));
+    auto range = equal_range(persons.begin(), persons.end(), 11, key_less(&Person::age));
+    cout << "age 11: " << range.first->name << " (" << distance(range.first, range.second) << " found)" << endl;
+    auto pos = lower_bound(persons.begin(), persons.end(), 30, key_less(&Person::age));
+    cout << "first adult: " << pos->name << endl;
+
+    auto donald = find_if(persons.begin(), persons.end(), equals(&Person::name, string("Donald")));
+    cout << "Donald is " << donald->age << endl;
+    cout << "kids: " << count_if(persons.begin(), persons.end(),
+                                 compose(bind_front(greater(), 18), project(&Person::age))) << endl;
+
+    auto youngest = min_element(persons.begin(), persons.end(), by(&Person::age));
+    cout << "youngest: " << youngest->name << endl;
+}
+
+template <typename Cmp>
+long long time_sort(vector<Person> persons, Cmp cmp)
+{
+    auto t0 = chrono::steady_clock::now();
+    sort(persons.begin(), persons.end(), cmp);
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - t0).count();
+}
+
+void benchmark()
+{
+    vector<Person> persons;
+    for (int i = 0; i < 1000000; ++i) {
+        persons.push_back(Person("p" + to_string((i * 7919LL) % 1000003), (i * 31) % 97));
+    }
+
+    using std::placeholders::_1;
+    using std::placeholders::_2;
+    auto by_bind = std::bind(std::less<int>(), std::bind(&Person::age, _1), std::bind(&Person::age, _2));
+
+    cout << "sort 1M persons by age" << endl;
+    cout << "hand-written lambda: "
+         << time_sort(persons, [] (const Person& a, const Person& b) { return a.age < b.age; }) << " us" << endl;
+    cout << "by(&Person::age):    " << time_sort(persons, by(&Person::age)) << " us" << endl;
+    cout << "nested std::bind:    " << time_sort(persons, by_bind) << " us" << endl;
+}
+
+void Run()
+{
+    binders_demo();
+    projections_demo();
+    benchmark();
+}
+
+}
+}
@@ -0,0 +1,307 @@
+#ifndef STL_DEMO_FUNCTION_OBJECTS_PROJECTIONS_H
+#define STL_DEMO_FUNCTION_OBJECTS_PROJECTIONS_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "integer_sequence.h"
+
+namespace function_objects {
+namespace projections {
+
+/*
+ * std::bind() / std::mem_fn() 的替代品
+ *
+ * std::bind 返回的对象内部用 std::tuple 保存绑定的参数，调用时还要逐个判断参数是不是 placeholder，
+ * 嵌套之后编译器往往内联不掉；并且绑定的参数在每次拷贝 binder 时都会被拷贝。
+ * 这里的几个工具都是很薄的 constexpr 函数对象，内联之后和手写的 lambda 没有区别:
+ *
+ *   invoke(f, args...)          统一调用普通函数 / 函数对象 / 成员函数指针 / 成员变量指针 (C++17 std::invoke)
+ *   bind_front(f, args...)      partial application: bind_front(f, a)(b) == f(a, b) (C++20 std::bind_front)
+ *   project(&Person::name)      member projection: project(&Person::name)(p) == p.name, 返回引用不拷贝
+ *   compose(f, g)               compose(f, g)(x) == f(g(x))
+ *   by(proj, cmp)               用于 sort() 等算法的比较器: cmp(proj(a), proj(b))
+ *   key_less(proj, cmp)         用于 lower_bound() / upper_bound() / equal_range(), 一边是元素一边是 key
+ *   equals(proj, value)         用于 find_if() / count_if(): proj(elem) == value
+ */
+
+// -- invoke --
+
+// callable objects and plain functions
+template <typename F, typename... Args>
+constexpr auto invoke(F&& f, Args&&... args)
+    -> decltype(std::forward<F>(f)(std::forward<Args>(args)...))
+{
+    return std::forward<F>(f)(std::forward<Args>(args)...);
+}
+
+// member function, called on an object (or reference)
+template <typename M, typename C, typename Obj, typename... Args>
+constexpr auto invoke(M C::*pm, Obj&& obj, Args&&... args)
+    -> typename std::enable_if<std::is_member_function_pointer<M C::*>::value &&
+                                   std::is_base_of<C, typename std::decay<Obj>::type>::value,
+                               decltype((std::forward<Obj>(obj).*pm)(std::forward<Args>(args)...))>::type
+{
+    return (std::forward<Obj>(obj).*pm)(std::forward<Args>(args)...);
+}
+
+// member function, called through a pointer or a smart pointer
+template <typename M, typename C, typename Ptr, typename... Args>
+constexpr auto invoke(M C::*pm, Ptr&& ptr, Args&&... args)
+    -> typename std::enable_if<std::is_member_function_pointer<M C::*>::value &&
+                                   !std::is_base_of<C, typename std::decay<Ptr>::type>::value,
+                               decltype(((*std::forward<Ptr>(ptr)).*pm)(std::forward<Args>(args)...))>::type
+{
+    return ((*std::forward<Ptr>(ptr)).*pm)(std::forward<Args>(args)...);
+}
+
+// data member of an object
+template <typename M, typename C, typename Obj>
+constexpr auto invoke(M C::*pm, Obj&& obj)
+    -> typename std::enable_if<std::is_member_object_pointer<M C::*>::value &&
+                                   std::is_base_of<C, typename std::decay<Obj>::type>::value,
+                               decltype(std::forward<Obj>(obj).*pm)>::type
+{
+    return std::forward<Obj>(obj).*pm;
+}
+
+// data member through a pointer or a smart pointer
+template <typename M, typename C, typename Ptr>
+constexpr auto invoke(M C::*pm, Ptr&& ptr)
+    -> typename std::enable_if<std::is_member_object_pointer<M C::*>::value &&
+                                   !std::is_base_of<C, typename std::decay<Ptr>::type>::value,
+                               decltype((*std::forward<Ptr>(ptr)).*pm)>::type
+{
+    return (*std::forward<Ptr>(ptr)).*pm;
+}
+
+// -- bind_front --
+
+namespace detail {
+
+// std::tuple has no constexpr constructors in C++11, so keep the bound arguments in plain leaves
+template <std::size_t I, typename T>
+struct leaf {
+    T value;
+    constexpr explicit leaf(const T& v) : value(v) {}
+    constexpr explicit leaf(T&& v) : value(std::move(v)) {}
+};
+
+struct construct_tag {};
+
+template <std::size_t I, typename T>
+constexpr const T& get(const leaf<I, T>& l) { return l.value; }
+
+template <typename Seq, typename... Ts>
+struct bound_args;
+
+template <std::size_t... Is, typename... Ts>
+struct bound_args<helper::index_sequence<Is...>, Ts...> : leaf<Is, Ts>... {
+    template <typename... Us>
+    constexpr explicit bound_args(construct_tag, Us&&... us) : leaf<Is, Ts>(std::forward<Us>(us))... {}
+};
+
+} // namespace detail
+
+template <typename F, typename... Bound>
+class front_binder {
+    typedef helper::index_sequence_for<Bound...> seq;
+
+public:
+    template <typename G, typename... Us>
+    constexpr front_binder(detail::construct_tag, G&& f, Us&&... bound)
+        : f_(std::forward<G>(f)), bound_(detail::construct_tag(), std::forward<Us>(bound)...)
+    {
+    }
+
+    // bound arguments are passed as const lvalues, never copied per call
+    template <typename... Args>
+    constexpr auto operator()(Args&&... args) const
+        -> decltype(projections::invoke(std::declval<const F&>(), std::declval<const Bound&>()...,
+                                        std::forward<Args>(args)...))
+    {
+        return call(seq(), std::forward<Args>(args)...);
+    }
+
+private:
+    template <std::size_t... Is, typename... Args>
+    constexpr auto call(helper::index_sequence<Is...>, Args&&... args) const
+        -> decltype(projections::invoke(std::declval<const F&>(), std::declval<const Bound&>()...,
+                                        std::forward<Args>(args)...))
+    {
+        return projections::invoke(f_, detail::get<Is>(bound_)..., std::forward<Args>(args)...);
+    }
+
+    F f_;
+    detail::bound_args<seq, Bound...> bound_;
+};
+
+template <typename F, typename... Bound>
+constexpr front_binder<typename std::decay<F>::type, typename std::decay<Bound>::type...>
+bind_front(F&& f, Bound&&... bound)
+{
+    return front_binder<typename std::decay<F>::type, typename std::decay<Bound>::type...>(
+        detail::construct_tag(), std::forward<F>(f), std::forward<Bound>(bound)...);
+}
+
+// -- projections --
+
+template <typename P>
+class projection {
+public:
+    constexpr explicit projection(P p) : p_(p) {}
+
+    template <typename T>
+    constexpr auto operator()(T&& obj) const -> decltype(projections::invoke(std::declval<const P&>(), std::forward<T>(obj)))
+    {
+        return projections::invoke(p_, std::forward<T>(obj));
+    }
+
+private:
+    P p_;
+};
+
+// member pointer (data or nullary member function) -> projection
+template <typename M, typename C>
+constexpr projection<M C::*> project(M C::*pm)
+{
+    return projection<M C::*>(pm);
+}
+
+template <typename F, typename G>
+class composed {
+public:
+    constexpr composed(F f, G g) : f_(f), g_(g) {}
+
+    template <typename T>
+    constexpr auto operator()(T&& x) const
+        -> decltype(projections::invoke(std::declval<const F&>(),
+                                        projections::invoke(std::declval<const G&>(), std::forward<T>(x))))
+    {
+        return projections::invoke(f_, projections::invoke(g_, std::forward<T>(x)));
+    }
+
+private:
+    F f_;
+    G g_;
+};
+
+template <typename F, typename G>
+constexpr composed<F, G> compose(F f, G g)
+{
+    return composed<F, G>(f, g);
+}
+
+// -- comparators --
+
+// transparent comparators (std::less<> is C++14)
+struct less {
+    template <typename A, typename B>
+    constexpr bool operator()(const A& a, const B& b) const { return a < b; }
+};
+
+struct greater {
+    template <typename A, typename B>
+    constexpr bool operator()(const A& a, const B& b) const { return b < a; }
+};
+
+struct equal_to {
+    template <typename A, typename B>
+    constexpr bool operator()(const A& a, const B& b) const { return a == b; }
+};
+
+// cmp(proj(a), proj(b)), for sort(), stable_sort(), min_element(), ...
+template <typename P, typename Cmp>
+class projected_compare {
+public:
+    constexpr projected_compare(P p, Cmp cmp) : p_(p), cmp_(cmp) {}
+
+    template <typename A, typename B>
+    constexpr bool operator()(const A& a, const B& b) const
+    {
+        return cmp_(projections::invoke(p_, a), projections::invoke(p_, b));
+    }
+
+private:
+    P p_;
+    Cmp cmp_;
+};
+
+template <typename P, typename Cmp = less>
+constexpr projected_compare<P, Cmp> by(P p, Cmp cmp = Cmp())
+{
+    return projected_compare<P, Cmp>(p, cmp);
+}
+
+template <typename M, typename C, typename Cmp = less>
+constexpr projected_compare<projection<M C::*>, Cmp> by(M C::*pm, Cmp cmp = Cmp())
+{
+    return projected_compare<projection<M C::*>, Cmp>(project(pm), cmp);
+}
+
+namespace detail {
+
+template <typename P, typename T>
+struct is_projectable {
+    template <typename U>
+    static auto test(int) -> decltype(projections::invoke(std::declval<const P&>(), std::declval<const U&>()), std::true_type());
+    template <typename U>
+    static std::false_type test(...);
+
+    static const bool value = decltype(test<T>(0))::value;
+};
+
+} // namespace detail
+
+// heterogeneous comparator: the element side is projected, the key side is used as is.
+// lower_bound() calls cmp(elem, key), upper_bound() calls cmp(key, elem)
+template <typename P, typename Cmp>
+class key_compare {
+public:
+    constexpr key_compare(P p, Cmp cmp) : p_(p), cmp_(cmp) {}
+
+    template <typename A, typename B>
+    constexpr typename std::enable_if<detail::is_projectable<P, A>::value, bool>::type
+    operator()(const A& elem, const B& key) const
+    {
+        return cmp_(projections::invoke(p_, elem), key);
+    }
+
+    template <typename A, typename B>
+    constexpr typename std::enable_if<!detail::is_projectable<P, A>::value, bool>::type
+    operator()(const A& key, const B& elem) const
+    {
+        return cmp_(key, projections::invoke(p_, elem));
+    }
+
+private:
+    P p_;
+    Cmp cmp_;
+};
+
+template <typename M, typename C, typename Cmp = less>
+constexpr key_compare<projection<M C::*>, Cmp> key_less(M C::*pm, Cmp cmp = Cmp())
+{
+    return key_compare<projection<M C::*>, Cmp>(project(pm), cmp);
+}
+
+template <typename P, typename Cmp = less>
+constexpr key_compare<P, Cmp> key_less(P p, Cmp cmp = Cmp())
+{
+    return key_compare<P, Cmp>(p, cmp);
+}
+
+// proj(elem) == value, for find_if(), count_if(), ...
+template <typename M, typename C, typename V>
+constexpr front_binder<key_compare<projection<M C::*>, equal_to>, V> equals(M C::*pm, V value)
+{
+    return bind_front(key_compare<projection<M C::*>, equal_to>(project(pm), equal_to()), value);
+}
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_FUNCTION_OBJECTS_PROJECTIONS_H
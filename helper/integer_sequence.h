@@ -0,0 +1,44 @@
+#ifndef STL_DEMO_HELPER_INTEGER_SEQUENCE_H
+#define STL_DEMO_HELPER_INTEGER_SEQUENCE_H
+
+#include <cstddef>
+
+namespace helper {
+
+// C++11 has no std::index_sequence (since C++14), so provide a minimal one
+template <std::size_t... Is>
+struct index_sequence {};
+
+// built by doubling, so the instantiation depth is log2(N) rather than N
+template <typename S1, typename S2>
+struct concat_index_sequence;
+
+template <std::size_t... I1, std::size_t... I2>
+struct concat_index_sequence<index_sequence<I1...>, index_sequence<I2...>> {
+    typedef index_sequence<I1..., (sizeof...(I1) + I2)...> type;
+};
+
+template <std::size_t N>
+struct make_index_sequence_impl
+    : concat_index_sequence<typename make_index_sequence_impl<N / 2>::type,
+                            typename make_index_sequence_impl<N - N / 2>::type> {};
+
+template <>
+struct make_index_sequence_impl<0> {
+    typedef index_sequence<> type;
+};
+
+template <>
+struct make_index_sequence_impl<1> {
+    typedef index_sequence<0> type;
+};
+
+template <std::size_t N>
+using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
+template <typename... Ts>
+using index_sequence_for = make_index_sequence<sizeof...(Ts)>;
+
+}
+
+#endif //STL_DEMO_HELPER_INTEGER_SEQUENCE_H
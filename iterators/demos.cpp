@@ -2,6 +2,7 @@
 #include "categories.h"
 #include "auxiliary.h"
 #include "adapters.h"
+#include "views.h"
 
 #include <iostream>
 
@@ -13,6 +14,7 @@ void Run()
     //categories::Demo();
     //auxiliary::Demo();
     adapters::Demos();
+    //views::Run();
 }
 
 }
\ No newline at end of file
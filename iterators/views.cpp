@@ -0,0 +1,176 @@
+#include "views.h"
+#include "helper.h"
+
+#include <chrono>
+#include <forward_list>
+#include <iostream>
+#include <list>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace iterators {
+namespace views {
+
+const char* category_name(input_iterator_tag) { return "input"; }
+const char* category_name(forward_iterator_tag) { return "forward"; }
+const char* category_name(bidirectional_iterator_tag) { return "bidirectional"; }
+const char* category_name(random_access_iterator_tag) { return "random access"; }
+
+template <typename R>
+const char* category_of(const R& r)
+{
+    return category_name(typename iterator_traits<decltype(r.begin())>::iterator_category());
+}
+
+void pipeline_demo()
+{
+    // the same data as stl_basics RemovingDemo(): 6 5 4 3 2 1 1 2 3 4 5 6
+    list<int> coll;
+    for (int i = 1; i <= 6; ++i) {
+        coll.push_front(i);
+        coll.push_back(i);
+    }
+    helper::PRINT_ELEMENT(coll, "coll: ");
+
+    // "remove" all 3s without touching coll, no erase(), no temporary container
+    auto not3 = coll | filter([] (int x) { return x != 3; });
+    helper::PRINT_ELEMENT(not3, "without 3: ");
+
+    // filter + transform + take run in one loop, element by element
+    auto first4 = coll | filter([] (int x) { return x % 2 == 0; })
+                       | transform([] (int x) { return x * 10; })
+                       | take(4);
+    helper::PRINT_ELEMENT(first4, "first 4 even * 10: ");
+    helper::PRINT_ELEMENT(coll | drop(9), "drop 9: ");
+
+    cout << "categories (list): filter = " << category_of(not3)
+         << ", transform+take = " << category_of(first4) << endl;
+
+    vector<int> vec(coll.begin(), coll.end());
+    auto squares = vec | transform([] (int x) { return x * x; });
+    cout << "categories (vector): transform = " << category_of(squares)
+         << ", take = " << category_of(vec | take(3))
+         << ", chunk = " << category_of(vec | chunk(5)) << endl;
+    // squares are values: an input iterator that still has operator[]
+    cout << "squares[3] = " << squares.begin()[3] << ", size = " << squares.size() << endl;
+
+    for (auto c : vec | chunk(5)) {
+        helper::PRINT_ELEMENT(c, "chunk: ");
+    }
+
+    vector<string> names = {"zero", "one", "two", "three"};
+    // a function that returns a reference keeps random access
+    auto initials = names | transform([] (const string& s) -> const char& { return s[0]; });
+    cout << "categories (vector): transform returning a reference = " << category_of(initials)
+         << ", initials[2] = " << initials.begin()[2] << endl;
+    for (auto p : zip(names, vec | drop(6))) {
+        cout << p.first << '=' << p.second << ' ';
+    }
+    cout << endl;
+
+    for (auto p : names | enumerate()) {
+        cout << p.first << ':' << p.second << ' ';
+    }
+    cout << endl;
+
+    // views over mutable ranges hand out references: write through them
+    for (auto p : zip(vec, names)) {
+        p.first = static_cast<int>(p.second.size());
+    }
+    helper::PRINT_ELEMENT(vec, "vec after zip write: ");
+}
+
+// take / drop / chunk against the plain loops, the same on every iterator category
+template <typename C>
+bool check_counts(const C& c)
+{
+    const vector<int> all(c.begin(), c.end());
+    const ptrdiff_t n = static_cast<ptrdiff_t>(all.size());
+    bool ok = true;
+    for (ptrdiff_t k = 0; k <= n + 2; ++k) {
+        const ptrdiff_t m = min(k, n);
+        ok = ok && (c | take(k)).to_vector() == vector<int>(all.begin(), all.begin() + m) &&
+             (c | drop(k)).to_vector() == vector<int>(all.begin() + m, all.end());
+        if (k > 0) {
+            size_t seen = 0, chunks = 0;
+            for (auto part : c | chunk(k)) {
+                const vector<int> v = part.to_vector();
+                ok = ok && !v.empty() && v.size() <= static_cast<size_t>(k) &&
+                     equal(v.begin(), v.end(), all.begin() + seen);
+                seen += v.size();
+                ++chunks;
+            }
+            ok = ok && seen == all.size() && chunks == static_cast<size_t>((n + k - 1) / k);
+        }
+    }
+    return ok;
+}
+
+bool cross_check()
+{
+    const vector<int> vec = {1, 2, 3, 4, 5, 6, 7};
+    const list<int> lst(vec.begin(), vec.end());
+    const forward_list<int> fwd(vec.begin(), vec.end());
+    bool ok = check_counts(vec) && check_counts(lst) && check_counts(fwd) && check_counts(vector<int>());
+
+    // a negative count (or a chunk size of 0) is an error on every range, not a read before begin()
+    for (ptrdiff_t n : {-1, -100}) {
+        try {
+            vec | take(n);
+            ok = false;
+        } catch (const invalid_argument&) {
+        }
+        try {
+            lst | drop(n);
+            ok = false;
+        } catch (const invalid_argument&) {
+        }
+        try {
+            vec | chunk(n + 1);
+            ok = false;
+        } catch (const invalid_argument&) {
+        }
+    }
+    return ok;
+}
+
+void benchmark()
+{
+    const int kElems = 10000000;
+    vector<int> data(kElems);
+    for (int i = 0; i < kElems; ++i) {
+        data[i] = (i * 7) % 1000;
+    }
+
+    // materialize every stage: filter -> transform -> drop first 1000
+    auto t0 = chrono::steady_clock::now();
+    vector<int> filtered;
+    copy_if(data.begin(), data.end(), back_inserter(filtered), [] (int x) { return x % 3 == 0; });
+    vector<long long> transformed(filtered.size());
+    std::transform(filtered.begin(), filtered.end(), transformed.begin(), [] (int x) { return x * 3LL; });
+    long long eager = accumulate(transformed.begin() + 1000, transformed.end(), 0LL);
+    auto t1 = chrono::steady_clock::now();
+
+    // same pipeline, fused into one loop
+    auto view = data | filter([] (int x) { return x % 3 == 0; })
+                     | transform([] (int x) { return x * 3LL; })
+                     | drop(1000);
+    long long lazy = accumulate(view.begin(), view.end(), 0LL);
+    auto t2 = chrono::steady_clock::now();
+
+    cout << "eager: " << eager << " in " << chrono::duration_cast<chrono::microseconds>(t1 - t0).count() << " us" << endl;
+    cout << "lazy:  " << lazy << " in " << chrono::duration_cast<chrono::microseconds>(t2 - t1).count() << " us" << endl;
+}
+
+void Run()
+{
+    pipeline_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
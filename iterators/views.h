@@ -0,0 +1,553 @@
+#ifndef STL_DEMO_ITERATORS_VIEWS_H
+#define STL_DEMO_ITERATORS_VIEWS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace iterators {
+namespace views {
+
+/*
+ * Lazy views (C++11 version of C++20 ranges views)
+ *
+ * 像 stl_basics 里的 RemovingDemo() 那样 remove -> transform -> copy 的流水线，每一步都要物化一个中间容器。
+ * view 只是一对迭代器：对 view 的迭代会把 filter / transform / take ... 所有步骤融合进同一个循环里，
+ * 中间不产生任何临时容器，也不分配内存。
+ *
+ *     for (int x : coll | views::filter(is_odd) | views::transform(square) | views::take(3)) ...
+ *
+ * 每个适配器的迭代器类别 (参考 categories.cpp) 取 "底层迭代器的类别" 和 "适配器本身能支持的类别" 中较弱的那个:
+ *     Adapter       Category                                  Element
+ *     filter        min(base, bidirectional)                  base reference
+ *     transform     base (input if f returns by value)        f(*it)
+ *     take / drop   base (random access: plain iterator_range) base reference
+ *     chunk         min(base, forward)                        iterator_range<It>
+ *     zip           min(base1, base2, forward)                std::pair<ref1, ref2>
+ *     enumerate     min(base, forward)                        std::pair<size_t, ref>
+ *
+ * 注意:
+ *   - view 不拥有元素，底层容器必须比 view 活得更久；不要把临时容器直接 | 给适配器
+ *   - 迭代器里保存了谓词 / 函数的拷贝，所以 view 本身是临时对象也没关系
+ */
+
+// -- helpers --
+
+namespace detail {
+
+// the weaker of two iterator categories
+template <typename C1, typename C2>
+struct min_category {
+    typedef typename std::conditional<std::is_base_of<C1, C2>::value, C1, C2>::type type;
+};
+
+template <typename It>
+struct category_of {
+    typedef typename std::iterator_traits<It>::iterator_category type;
+};
+
+template <typename It, typename Cap>
+struct capped_category {
+    typedef typename min_category<typename category_of<It>::type, Cap>::type type;
+};
+
+// a C++11 forward iterator has to return a real reference, one that returns values is only an input iterator
+template <typename It, typename Reference>
+struct reference_category {
+    typedef typename std::conditional<std::is_reference<Reference>::value, typename category_of<It>::type,
+                                      std::input_iterator_tag>::type type;
+};
+
+// lambdas are not copy assignable, but iterators have to be.
+// box re-creates the function object on assignment (like std::optional in C++20 views)
+template <typename F>
+class box {
+public:
+    box() : engaged_(false) {}
+    explicit box(const F& f) : engaged_(true) { ::new (static_cast<void*>(&buf_)) F(f); }
+    box(const box& other) : engaged_(other.engaged_)
+    {
+        if (engaged_)
+            ::new (static_cast<void*>(&buf_)) F(other.get());
+    }
+    box& operator=(const box& other)
+    {
+        if (this != &other) {
+            reset();
+            if (other.engaged_) {
+                ::new (static_cast<void*>(&buf_)) F(other.get());
+                engaged_ = true;
+            }
+        }
+        return *this;
+    }
+    ~box() { reset(); }
+
+    const F& get() const { return *reinterpret_cast<const F*>(&buf_); }
+
+private:
+    void reset()
+    {
+        if (engaged_) {
+            reinterpret_cast<F*>(&buf_)->~F();
+            engaged_ = false;
+        }
+    }
+
+    typename std::aligned_storage<sizeof(F), std::alignment_of<F>::value>::type buf_;
+    bool engaged_;
+};
+
+} // namespace detail
+
+template <typename It>
+class iterator_range {
+public:
+    typedef It iterator;
+    typedef typename std::iterator_traits<It>::value_type value_type;
+
+    iterator_range() {}
+    iterator_range(It first, It last) : first_(first), last_(last) {}
+
+    It begin() const { return first_; }
+    It end() const { return last_; }
+    bool empty() const { return first_ == last_; }
+    typename std::iterator_traits<It>::difference_type size() const { return std::distance(first_, last_); }
+
+    // materialize, only when really needed
+    std::vector<value_type> to_vector() const { return std::vector<value_type>(first_, last_); }
+
+private:
+    It first_;
+    It last_;
+};
+
+template <typename It>
+iterator_range<It> make_range(It first, It last)
+{
+    return iterator_range<It>(first, last);
+}
+
+template <typename R>
+auto all(R& r) -> iterator_range<decltype(std::begin(r))>
+{
+    return make_range(std::begin(r), std::end(r));
+}
+
+// -- operator | --
+
+// every adaptor closure derives from this, so operator| does not catch unrelated types
+struct closure_base {};
+
+template <typename R, typename Closure,
+          typename = typename std::enable_if<std::is_base_of<closure_base, Closure>::value>::type>
+auto operator|(R&& r, const Closure& c) -> decltype(c(std::forward<R>(r)))
+{
+    return c(std::forward<R>(r));
+}
+
+// -- filter --
+
+template <typename It, typename Pred>
+class filter_iterator {
+public:
+    typedef typename detail::capped_category<It, std::bidirectional_iterator_tag>::type iterator_category;
+    typedef typename std::iterator_traits<It>::value_type value_type;
+    typedef typename std::iterator_traits<It>::difference_type difference_type;
+    typedef typename std::iterator_traits<It>::pointer pointer;
+    typedef typename std::iterator_traits<It>::reference reference;
+
+    filter_iterator() {}
+    filter_iterator(It cur, It last, const Pred& pred) : cur_(cur), last_(last), pred_(pred) { satisfy(); }
+
+    reference operator*() const { return *cur_; }
+    pointer operator->() const { return &*cur_; }
+
+    filter_iterator& operator++()
+    {
+        ++cur_;
+        satisfy();
+        return *this;
+    }
+    filter_iterator operator++(int)
+    {
+        filter_iterator tmp(*this);
+        ++*this;
+        return tmp;
+    }
+    filter_iterator& operator--()
+    {
+        do {
+            --cur_;
+        } while (!pred_.get()(*cur_));
+        return *this;
+    }
+    filter_iterator operator--(int)
+    {
+        filter_iterator tmp(*this);
+        --*this;
+        return tmp;
+    }
+
+    It base() const { return cur_; }
+
+    friend bool operator==(const filter_iterator& a, const filter_iterator& b) { return a.cur_ == b.cur_; }
+    friend bool operator!=(const filter_iterator& a, const filter_iterator& b) { return a.cur_ != b.cur_; }
+
+private:
+    void satisfy()
+    {
+        while (cur_ != last_ && !pred_.get()(*cur_)) {
+            ++cur_;
+        }
+    }
+
+    It cur_;
+    It last_;
+    detail::box<Pred> pred_;
+};
+
+template <typename Pred>
+struct filter_closure : closure_base {
+    explicit filter_closure(Pred p) : pred(p) {}
+
+    template <typename R>
+    auto operator()(R&& r) const -> iterator_range<filter_iterator<decltype(std::begin(r)), Pred>>
+    {
+        typedef filter_iterator<decltype(std::begin(r)), Pred> iter;
+        return make_range(iter(std::begin(r), std::end(r), pred), iter(std::end(r), std::end(r), pred));
+    }
+
+    Pred pred;
+};
+
+template <typename Pred>
+filter_closure<Pred> filter(Pred pred)
+{
+    return filter_closure<Pred>(pred);
+}
+
+// -- transform --
+
+// keeps the base category when f returns a reference (a member, an element of a lookup table), so distance(),
+// operator[] and binary search stay O(1) / O(log n); when f returns by value the element cannot be written
+// through and the iterator is an input iterator (operator[], +, - still work, the std algorithms go step by step)
+template <typename It, typename F>
+class transform_iterator {
+public:
+    typedef decltype(std::declval<const F&>()(*std::declval<It>())) reference;
+    typedef typename detail::reference_category<It, reference>::type iterator_category;
+    typedef typename std::decay<reference>::type value_type;
+    typedef typename std::iterator_traits<It>::difference_type difference_type;
+    typedef void pointer;
+
+    transform_iterator() {}
+    transform_iterator(It cur, const F& f) : cur_(cur), f_(f) {}
+
+    reference operator*() const { return f_.get()(*cur_); }
+    reference operator[](difference_type n) const { return f_.get()(cur_[n]); }
+
+    transform_iterator& operator++() { ++cur_; return *this; }
+    transform_iterator operator++(int) { transform_iterator tmp(*this); ++cur_; return tmp; }
+    transform_iterator& operator--() { --cur_; return *this; }
+    transform_iterator operator--(int) { transform_iterator tmp(*this); --cur_; return tmp; }
+    transform_iterator& operator+=(difference_type n) { cur_ += n; return *this; }
+    transform_iterator& operator-=(difference_type n) { cur_ -= n; return *this; }
+
+    friend transform_iterator operator+(transform_iterator it, difference_type n) { return it += n; }
+    friend transform_iterator operator+(difference_type n, transform_iterator it) { return it += n; }
+    friend transform_iterator operator-(transform_iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const transform_iterator& a, const transform_iterator& b) { return a.cur_ - b.cur_; }
+
+    friend bool operator==(const transform_iterator& a, const transform_iterator& b) { return a.cur_ == b.cur_; }
+    friend bool operator!=(const transform_iterator& a, const transform_iterator& b) { return a.cur_ != b.cur_; }
+    friend bool operator<(const transform_iterator& a, const transform_iterator& b) { return a.cur_ < b.cur_; }
+    friend bool operator>(const transform_iterator& a, const transform_iterator& b) { return a.cur_ > b.cur_; }
+    friend bool operator<=(const transform_iterator& a, const transform_iterator& b) { return a.cur_ <= b.cur_; }
+    friend bool operator>=(const transform_iterator& a, const transform_iterator& b) { return a.cur_ >= b.cur_; }
+
+    It base() const { return cur_; }
+
+private:
+    It cur_;
+    detail::box<F> f_;
+};
+
+template <typename F>
+struct transform_closure : closure_base {
+    explicit transform_closure(F fn) : f(fn) {}
+
+    template <typename R>
+    auto operator()(R&& r) const -> iterator_range<transform_iterator<decltype(std::begin(r)), F>>
+    {
+        typedef transform_iterator<decltype(std::begin(r)), F> iter;
+        return make_range(iter(std::begin(r), f), iter(std::end(r), f));
+    }
+
+    F f;
+};
+
+template <typename F>
+transform_closure<F> transform(F f)
+{
+    return transform_closure<F>(f);
+}
+
+// -- take --
+
+// counted iterator for ranges without random access: stops after n elements or at the end, whichever is first
+template <typename It>
+class take_iterator {
+public:
+    typedef typename detail::capped_category<It, std::forward_iterator_tag>::type iterator_category;
+    typedef typename std::iterator_traits<It>::value_type value_type;
+    typedef typename std::iterator_traits<It>::difference_type difference_type;
+    typedef typename std::iterator_traits<It>::pointer pointer;
+    typedef typename std::iterator_traits<It>::reference reference;
+
+    take_iterator() : left_(0) {}
+    take_iterator(It cur, It last, difference_type left) : cur_(cur), last_(last), left_(left) {}
+
+    reference operator*() const { return *cur_; }
+    pointer operator->() const { return &*cur_; }
+
+    take_iterator& operator++() { ++cur_; --left_; return *this; }
+    take_iterator operator++(int) { take_iterator tmp(*this); ++*this; return tmp; }
+
+    friend bool operator==(const take_iterator& a, const take_iterator& b)
+    {
+        return a.done() ? b.done() : (!b.done() && a.cur_ == b.cur_);
+    }
+    friend bool operator!=(const take_iterator& a, const take_iterator& b) { return !(a == b); }
+
+private:
+    bool done() const { return left_ == 0 || cur_ == last_; }
+
+    It cur_;
+    It last_;
+    difference_type left_;
+};
+
+namespace detail {
+
+template <typename It>
+iterator_range<It> take(It first, It last, std::ptrdiff_t n, std::random_access_iterator_tag)
+{
+    return make_range(first, first + std::min<std::ptrdiff_t>(n, last - first));
+}
+
+template <typename It>
+iterator_range<take_iterator<It>> take(It first, It last, std::ptrdiff_t n, std::input_iterator_tag)
+{
+    return make_range(take_iterator<It>(first, last, n), take_iterator<It>(last, last, 0));
+}
+
+template <typename It>
+It advance_at_most(It first, It last, std::ptrdiff_t n, std::random_access_iterator_tag)
+{
+    return first + std::min<std::ptrdiff_t>(n, last - first);
+}
+
+template <typename It>
+It advance_at_most(It first, It last, std::ptrdiff_t n, std::input_iterator_tag)
+{
+    for (; n > 0 && first != last; --n) {
+        ++first;
+    }
+    return first;
+}
+
+} // namespace detail
+
+struct take_closure : closure_base {
+    explicit take_closure(std::ptrdiff_t count) : n(count) {}
+
+    template <typename R>
+    auto operator()(R&& r) const
+        -> decltype(detail::take(std::begin(r), std::end(r), 0, typename detail::category_of<decltype(std::begin(r))>::type()))
+    {
+        return detail::take(std::begin(r), std::end(r), n, typename detail::category_of<decltype(std::begin(r))>::type());
+    }
+
+    std::ptrdiff_t n;
+};
+
+// n == 0 is an empty view; n < 0 would step before begin() on random access ranges
+inline take_closure take(std::ptrdiff_t n)
+{
+    if (n < 0)
+        throw std::invalid_argument("views::take: the count must not be negative");
+    return take_closure(n);
+}
+
+// -- drop --
+
+struct drop_closure : closure_base {
+    explicit drop_closure(std::ptrdiff_t count) : n(count) {}
+
+    template <typename R>
+    auto operator()(R&& r) const -> iterator_range<decltype(std::begin(r))>
+    {
+        return make_range(detail::advance_at_most(std::begin(r), std::end(r), n,
+                                                  typename detail::category_of<decltype(std::begin(r))>::type()),
+                          std::end(r));
+    }
+
+    std::ptrdiff_t n;
+};
+
+inline drop_closure drop(std::ptrdiff_t n)
+{
+    if (n < 0)
+        throw std::invalid_argument("views::drop: the count must not be negative");
+    return drop_closure(n);
+}
+
+// -- chunk --
+
+// yields consecutive sub ranges of n elements, the last one may be shorter
+template <typename It>
+class chunk_iterator {
+public:
+    typedef typename detail::capped_category<It, std::forward_iterator_tag>::type iterator_category;
+    typedef iterator_range<It> value_type;
+    typedef typename std::iterator_traits<It>::difference_type difference_type;
+    typedef void pointer;
+    typedef value_type reference;
+
+    chunk_iterator() : n_(0) {}
+    chunk_iterator(It cur, It last, difference_type n) : cur_(cur), next_(cur), last_(last), n_(n) { locate(); }
+
+    reference operator*() const { return value_type(cur_, next_); }
+
+    chunk_iterator& operator++()
+    {
+        cur_ = next_;
+        locate();
+        return *this;
+    }
+    chunk_iterator operator++(int) { chunk_iterator tmp(*this); ++*this; return tmp; }
+
+    friend bool operator==(const chunk_iterator& a, const chunk_iterator& b) { return a.cur_ == b.cur_; }
+    friend bool operator!=(const chunk_iterator& a, const chunk_iterator& b) { return a.cur_ != b.cur_; }
+
+private:
+    void locate() { next_ = detail::advance_at_most(cur_, last_, n_, typename detail::category_of<It>::type()); }
+
+    It cur_;
+    It next_;
+    It last_;
+    difference_type n_;
+};
+
+struct chunk_closure : closure_base {
+    explicit chunk_closure(std::ptrdiff_t count) : n(count) {}
+
+    template <typename R>
+    auto operator()(R&& r) const -> iterator_range<chunk_iterator<decltype(std::begin(r))>>
+    {
+        typedef chunk_iterator<decltype(std::begin(r))> iter;
+        return make_range(iter(std::begin(r), std::end(r), n), iter(std::end(r), std::end(r), n));
+    }
+
+    std::ptrdiff_t n;
+};
+
+// n <= 0 would never advance: an endless range of empty chunks
+inline chunk_closure chunk(std::ptrdiff_t n)
+{
+    if (n <= 0)
+        throw std::invalid_argument("views::chunk: the chunk size must be positive");
+    return chunk_closure(n);
+}
+
+// -- zip --
+
+// stops at the end of the shorter range
+template <typename It1, typename It2>
+class zip_iterator {
+public:
+    typedef typename detail::min_category<typename detail::capped_category<It1, std::forward_iterator_tag>::type,
+                                          typename detail::category_of<It2>::type>::type iterator_category;
+    typedef std::pair<typename std::iterator_traits<It1>::reference,
+                      typename std::iterator_traits<It2>::reference> reference;
+    typedef reference value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef void pointer;
+
+    zip_iterator() {}
+    zip_iterator(It1 it1, It2 it2) : it1_(it1), it2_(it2) {}
+
+    reference operator*() const { return reference(*it1_, *it2_); }
+
+    zip_iterator& operator++() { ++it1_; ++it2_; return *this; }
+    zip_iterator operator++(int) { zip_iterator tmp(*this); ++*this; return tmp; }
+
+    // "equal" as soon as either side reaches the other's position, so (end1, end2) ends the shorter range
+    friend bool operator==(const zip_iterator& a, const zip_iterator& b) { return a.it1_ == b.it1_ || a.it2_ == b.it2_; }
+    friend bool operator!=(const zip_iterator& a, const zip_iterator& b) { return !(a == b); }
+
+private:
+    It1 it1_;
+    It2 it2_;
+};
+
+template <typename R1, typename R2>
+auto zip(R1&& r1, R2&& r2) -> iterator_range<zip_iterator<decltype(std::begin(r1)), decltype(std::begin(r2))>>
+{
+    typedef zip_iterator<decltype(std::begin(r1)), decltype(std::begin(r2))> iter;
+    return make_range(iter(std::begin(r1), std::begin(r2)), iter(std::end(r1), std::end(r2)));
+}
+
+// -- enumerate --
+
+template <typename It>
+class enumerate_iterator {
+public:
+    typedef typename detail::capped_category<It, std::forward_iterator_tag>::type iterator_category;
+    typedef std::pair<std::size_t, typename std::iterator_traits<It>::reference> reference;
+    typedef reference value_type;
+    typedef typename std::iterator_traits<It>::difference_type difference_type;
+    typedef void pointer;
+
+    enumerate_iterator() : index_(0) {}
+    enumerate_iterator(It cur, std::size_t index) : cur_(cur), index_(index) {}
+
+    reference operator*() const { return reference(index_, *cur_); }
+
+    enumerate_iterator& operator++() { ++cur_; ++index_; return *this; }
+    enumerate_iterator operator++(int) { enumerate_iterator tmp(*this); ++*this; return tmp; }
+
+    friend bool operator==(const enumerate_iterator& a, const enumerate_iterator& b) { return a.cur_ == b.cur_; }
+    friend bool operator!=(const enumerate_iterator& a, const enumerate_iterator& b) { return a.cur_ != b.cur_; }
+
+private:
+    It cur_;
+    std::size_t index_;
+};
+
+struct enumerate_closure : closure_base {
+    template <typename R>
+    auto operator()(R&& r) const -> iterator_range<enumerate_iterator<decltype(std::begin(r))>>
+    {
+        typedef enumerate_iterator<decltype(std::begin(r))> iter;
+        return make_range(iter(std::begin(r), 0), iter(std::end(r), 0));
+    }
+};
+
+inline enumerate_closure enumerate()
+{
+    return enumerate_closure();
+}
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_ITERATORS_VIEWS_H
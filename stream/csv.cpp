@@ -0,0 +1,644 @@
+#include "csv.h"
+#include "../algorithms/parallel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using strings::views::string_view;
+using strings::interning::interner;
+using strings::interning::string_id;
+
+namespace stream {
+namespace csv {
+
+// -- fields --
+
+[[noreturn]] void fail(const string& what, size_t offset)
+{
+    throw runtime_error("csv: " + what + " in the record at offset " + to_string(offset));
+}
+
+// the characters between the quotes with "" turned back into ", or the field as it is when it is not quoted
+string_view unquote(const char* b, const char* e, char quote, string& scratch)
+{
+    if (e - b < 2 || *b != quote || e[-1] != quote)
+        return string_view(b, static_cast<size_t>(e - b));
+    ++b;
+    --e;
+    const void* q = memchr(b, quote, static_cast<size_t>(e - b));
+    if (q == nullptr)
+        return string_view(b, static_cast<size_t>(e - b));
+    scratch.clear();
+    for (const char* p = b; p < e; ++p) {
+        scratch += *p;
+        if (*p == quote && p + 1 < e && p[1] == quote)
+            ++p;
+    }
+    return string_view(scratch);
+}
+
+bool parse_int(string_view s, int64_t& value)
+{
+    if (s.empty()) {
+        value = 0;
+        return true;
+    }
+    const char* p = s.begin();
+    const bool negative = *p == '-';
+    if (*p == '-' || *p == '+')
+        ++p;
+    if (p == s.end())
+        return false;
+    uint64_t v = 0;
+    const uint64_t limit = negative ? uint64_t(1) << 63 : (uint64_t(1) << 63) - 1;
+    for (; p < s.end(); ++p) {
+        const unsigned d = static_cast<unsigned>(*p - '0');
+        if (d > 9 || v > (limit - d) / 10)
+            return false;
+        v = v * 10 + d;
+    }
+    value = negative ? static_cast<int64_t>(0 - v) : static_cast<int64_t>(v);
+    return true;
+}
+
+// decimals of up to 15 significant digits times 10^-22..10^22 are exact in double arithmetic
+// (Clinger's fast path); everything else goes to strtod
+bool parse_double(string_view s, double& value)
+{
+    static const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    if (s.empty()) {
+        value = numeric_limits<double>::quiet_NaN();
+        return true;
+    }
+    const char* p = s.begin();
+    const char* const end = s.end();
+    const bool negative = *p == '-';
+    if (*p == '-' || *p == '+')
+        ++p;
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+    for (; p < end && static_cast<unsigned>(*p - '0') <= 9; ++p, any = true) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+            digits += mantissa != 0;
+        } else {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && static_cast<unsigned>(*p - '0') <= 9; ++p, any = true) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+                digits += mantissa != 0;
+                --exponent;
+            }
+        }
+    }
+    if (any && p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        const bool minus = q < end && *q == '-';
+        if (q < end && (*q == '-' || *q == '+'))
+            ++q;
+        int e = 0;
+        const char* digits_begin = q;
+        for (; q < end && static_cast<unsigned>(*q - '0') <= 9; ++q) {
+            e = e < 10000 ? e * 10 + (*q - '0') : e;
+        }
+        if (q > digits_begin) {
+            exponent += minus ? -e : e;
+            p = q;
+        }
+    }
+    if (any && p == end && digits <= 15 && exponent >= -22 && exponent <= 22) {
+        const double m = static_cast<double>(mantissa);
+        value = exponent < 0 ? m / kPow10[-exponent] : m * kPow10[exponent];
+        value = negative ? -value : value;
+        return true;
+    }
+    // long mantissas, large exponents, inf / nan: strtod on a terminated copy
+    const string copy(s.data(), s.size());
+    char* stop = nullptr;
+    value = strtod(copy.c_str(), &stop);
+    return stop == copy.c_str() + copy.size();
+}
+
+void append(column& c, const char* b, const char* e, char quote, string& scratch, interner& pool, size_t offset)
+{
+    const string_view v = unquote(b, e, quote, scratch);
+    switch (c.type) {
+    case column_type::int64: {
+        int64_t x;
+        if (!parse_int(v, x))
+            fail("'" + v.str() + "' is not an integer (column " + c.name + ")", offset);
+        c.ints.push_back(x);
+        break;
+    }
+    case column_type::float64: {
+        double x;
+        if (!parse_double(v, x))
+            fail("'" + v.str() + "' is not a number (column " + c.name + ")", offset);
+        c.doubles.push_back(x);
+        break;
+    }
+    case column_type::string:
+        c.strings.push_back(pool.intern(v.data(), v.size()));
+        break;
+    }
+}
+
+// the fields of the first record, scalar: it is parsed once
+vector<string> split_record(string_view text, char delimiter, char quote, size_t& used)
+{
+    vector<string> fields(1);
+    bool quoted = false;
+    size_t i = 0;
+    for (; i < text.size(); ++i) {
+        const char c = text[i];
+        if (c == quote) {
+            quoted = !quoted;
+        } else if (!quoted && c == delimiter) {
+            fields.push_back(string());
+            continue;
+        } else if (!quoted && c == '\n') {
+            break;
+        }
+        fields.back() += c;
+    }
+    used = i < text.size() ? i + 1 : i;
+    for (auto& f : fields) {
+        if (!f.empty() && f.back() == '\r')
+            f.pop_back();
+        string scratch;
+        f = unquote(f.data(), f.data() + f.size(), quote, scratch).str();
+    }
+    return fields;
+}
+
+// -- reader --
+
+reader::reader(vector<column_type> types, interner& pool, dialect d)
+    : types_(std::move(types)), pool_(pool), dialect_(d), threads_(algorithms::parallel::thread_count()),
+      min_chunk_bytes_(4 << 20)
+{
+    if (types_.empty() && !d.header)
+        throw invalid_argument("csv::reader: the column types are needed when there is no header");
+    for (size_t i = 0; i < types_.size(); ++i) {
+        names_.push_back("column" + to_string(i));
+    }
+}
+
+size_t reader::read_header(string_view text, bool last)
+{
+    size_t used = 0;
+    vector<string> names = split_record(text, dialect_.delimiter, dialect_.quote, used);
+    if (used == text.size() && !last && (text.empty() || text.back() != '\n'))
+        return 0;
+    if (types_.empty())
+        types_.assign(names.size(), column_type::string);
+    if (names.size() != types_.size())
+        fail("the header has " + to_string(names.size()) + " fields, expected " + to_string(types_.size()), 0);
+    names_ = std::move(names);
+    return used;
+}
+
+batch reader::empty_batch() const
+{
+    batch b;
+    for (size_t i = 0; i < types_.size(); ++i) {
+        column c;
+        c.name = names_[i];
+        c.type = types_[i];
+        b.columns.push_back(std::move(c));
+    }
+    return b;
+}
+
+size_t reader::parse_range(const char* text, size_t b, size_t e, size_t offset, bool last, batch& out) const
+{
+    const size_t columns = types_.size();
+    const char quote = dialect_.quote, delimiter = dialect_.delimiter;
+    string scratch;
+    size_t field = 0, field_begin = b, record_begin = b;
+
+    // one field of the record that starts at record_begin
+    auto on_field = [&] (size_t fb, size_t fe, bool end_of_record) {
+        if (end_of_record && fe > fb && text[fe - 1] == '\r')
+            --fe;
+        if (end_of_record && field == 0 && fe == fb)
+            return; // an empty line
+        if (field == columns)
+            fail("more than " + to_string(columns) + " fields", offset + record_begin);
+        append(out.columns[field], text + fb, text + fe, quote, scratch, pool_, offset + record_begin);
+        ++field;
+        if (end_of_record) {
+            if (field != columns)
+                fail(to_string(field) + " fields instead of " + to_string(columns), offset + record_begin);
+            field = 0;
+            ++out.rows;
+        }
+    };
+
+    // structural scan, 64 bytes at a time; inside is all ones while the previous block ended inside quotes
+    uint64_t inside_carry = 0;
+    for (size_t i = b; i < e; i += 64) {
+        detail::masks m;
+        if (i + 64 <= e) {
+            m = detail::classify(text + i, quote, delimiter);
+        } else {
+            char tail[64] = {};
+            memcpy(tail, text + i, e - i);
+            m = detail::classify(tail, quote, delimiter);
+            const uint64_t valid = (uint64_t(1) << (e - i)) - 1;
+            m.quote &= valid;
+            m.delimiter &= valid;
+            m.newline &= valid;
+        }
+        const uint64_t inside = detail::prefix_xor(m.quote) ^ inside_carry;
+        inside_carry = static_cast<uint64_t>(static_cast<int64_t>(inside) >> 63);
+        uint64_t structural = (m.delimiter | m.newline) & ~inside;
+        while (structural) {
+            const unsigned bit = static_cast<unsigned>(__builtin_ctzll(structural));
+            const size_t pos = i + bit;
+            const bool end_of_record = (m.newline >> bit) & 1;
+            on_field(field_begin, pos, end_of_record);
+            field_begin = pos + 1;
+            if (end_of_record)
+                record_begin = pos + 1;
+            structural &= structural - 1;
+        }
+    }
+    if (last) {
+        // the last record without a line break
+        if (field_begin < e || field > 0)
+            on_field(field_begin, e, true);
+        return e;
+    }
+    // an incomplete record at the end waits for the next block
+    if (field > 0) {
+        for (column& c : out.columns) {
+            c.ints.resize(min(c.ints.size(), out.rows));
+            c.doubles.resize(min(c.doubles.size(), out.rows));
+            c.strings.resize(min(c.strings.size(), out.rows));
+        }
+    }
+    return record_begin;
+}
+
+size_t reader::parse_block(string_view text, size_t offset, bool last, batch& out) const
+{
+    const char* p = text.data();
+    const size_t n = text.size();
+    const size_t chunks = max<size_t>(1, min(threads_, n / min_chunk_bytes_));
+    if (chunks == 1) {
+        out = empty_batch();
+        return parse_range(p, 0, n, offset, last, out);
+    }
+
+    // the quotes before a byte tell whether it is inside a quoted field
+    vector<size_t> quotes(chunks);
+    algorithms::parallel::for_each_chunk(n, chunks, [&] (size_t c, size_t b, size_t e) {
+        quotes[c] = detail::count_char(p + b, e - b, dialect_.quote);
+    });
+    // every chunk starts after the first line break outside quotes at or after its byte range
+    vector<size_t> starts(chunks + 1, 0);
+    starts[chunks] = n;
+    const size_t step = n / chunks;
+    size_t before = 0;
+    for (size_t c = 1; c < chunks; ++c) {
+        before += quotes[c - 1];
+        bool quoted = before % 2 == 1;
+        size_t i = c * step;
+        if (starts[c - 1] > i) {
+            // the record before ran past this range: its end is outside quotes
+            i = starts[c - 1];
+            quoted = false;
+        }
+        for (; i < n; ++i) {
+            if (p[i] == dialect_.quote)
+                quoted = !quoted;
+            else if (p[i] == '\n' && !quoted)
+                break;
+        }
+        starts[c] = min(n, i + 1);
+    }
+
+    vector<batch> parts(chunks);
+    vector<size_t> ends(chunks);
+    vector<exception_ptr> errors(chunks);
+    algorithms::parallel::for_each_chunk(chunks, chunks, [&] (size_t c, size_t, size_t) {
+        try {
+            parts[c] = empty_batch();
+            // only the chunk that reaches the end of the block may hold an incomplete record
+            ends[c] = parse_range(p, starts[c], starts[c + 1], offset, starts[c + 1] == n ? last : true, parts[c]);
+        } catch (...) {
+            errors[c] = current_exception();
+        }
+    });
+    for (const auto& e : errors) {
+        if (e)
+            rethrow_exception(e);
+    }
+
+    out = empty_batch();
+    for (size_t i = 0; i < out.columns.size(); ++i) {
+        column& dst = out.columns[i];
+        for (const batch& part : parts) {
+            const column& src = part.columns[i];
+            dst.ints.insert(dst.ints.end(), src.ints.begin(), src.ints.end());
+            dst.doubles.insert(dst.doubles.end(), src.doubles.begin(), src.doubles.end());
+            dst.strings.insert(dst.strings.end(), src.strings.begin(), src.strings.end());
+        }
+    }
+    for (const batch& part : parts) {
+        out.rows += part.rows;
+    }
+    // a long record at the end can leave the chunks after it empty
+    size_t c = 0;
+    while (starts[c + 1] < n)
+        ++c;
+    return ends[c];
+}
+
+batch reader::parse(string_view text)
+{
+    size_t used = 0;
+    if (dialect_.header)
+        used = read_header(text, true);
+    batch out;
+    parse_block(text.substr(used), used, true, out);
+    return out;
+}
+
+// -- demo, cross check, benchmark --
+
+// getline + istringstream, the way adapters.cpp reads tokens from a stream
+void same_as_std_demo()
+{
+    const string text = "name,price,volume\n"
+                        "BASF,369.50,1200\n"
+                        "\"Daimler, AG\",819.00,300\r\n"
+                        "\"Siemens \"\"Healthineers\"\"\",842.20,75\n";
+    cout << "getline:" << endl;
+    istringstream in(text);
+    string line;
+    while (getline(in, line)) {
+        istringstream fields(line);
+        string field;
+        cout << " ";
+        while (getline(fields, field, ',')) {
+            cout << " [" << field << "]";
+        }
+        cout << endl;
+    }
+
+    interner pool;
+    reader r({column_type::string, column_type::float64, column_type::int64}, pool);
+    const batch b = r.parse(text);
+    cout << "csv::reader, " << b.rows << " rows:" << endl;
+    const column& names = *b.find("name");
+    const column& prices = *b.find("price");
+    const column& volumes = *b.find("volume");
+    for (size_t i = 0; i < b.rows; ++i) {
+        cout << "  [" << pool.str(names.strings[i]) << "] [" << prices.doubles[i] << "] [" << volumes.ints[i] << "]" << endl;
+    }
+}
+
+// a character at a time: the reference for the structural scan
+vector<vector<string>> reference_parse(const string& s, char delimiter, char quote)
+{
+    vector<vector<string>> records;
+    vector<string> record;
+    string field;
+    bool quoted = false, any = false;
+    for (size_t i = 0; i < s.size(); ++i) {
+        const char c = s[i];
+        any = true;
+        if (quoted) {
+            if (c == quote && i + 1 < s.size() && s[i + 1] == quote) {
+                field += quote;
+                ++i;
+            } else if (c == quote) {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == quote) {
+            quoted = true;
+        } else if (c == delimiter) {
+            record.push_back(field);
+            field.clear();
+        } else if (c == '\n') {
+            if (!field.empty() && field.back() == '\r')
+                field.pop_back();
+            record.push_back(field);
+            if (!(record.size() == 1 && record[0].empty()))
+                records.push_back(record);
+            record.clear();
+            field.clear();
+            any = false;
+        } else {
+            field += c;
+        }
+    }
+    if (any) {
+        record.push_back(field);
+        records.push_back(record);
+    }
+    return records;
+}
+
+string quoted_field(mt19937& gen, const string& value, char delimiter)
+{
+    const bool must = value.find_first_of(string(1, delimiter) + "\"\n\r") != string::npos || value.empty();
+    if (!must && gen() % 3)
+        return value;
+    string out = "\"";
+    for (char c : value) {
+        out += c;
+        if (c == '"')
+            out += '"';
+    }
+    return out + "\"";
+}
+
+bool cross_check()
+{
+    mt19937 gen(59);
+    bool ok = true;
+    for (int round = 0; round < 300 && ok; ++round) {
+        const dialect d = round % 2 ? dialect::csv() : dialect::tsv();
+        const size_t rows = gen() % (round % 10 == 0 ? 3000 : 40);
+        string text = string("id") + d.delimiter + "value" + d.delimiter + "text\n";
+        vector<int64_t> ids;
+        vector<double> values;
+        vector<string> texts;
+        for (size_t r = 0; r < rows; ++r) {
+            const int64_t id = static_cast<int64_t>(gen()) - (1ll << 31);
+            const double value = gen() % 4 == 0 ? static_cast<double>(gen()) / 7 : (gen() % 200000) / 100.0;
+            string t;
+            static const char kChars[] = "ab ,\t\"\n\r;x";
+            for (size_t k = gen() % 12; k > 0; --k) {
+                t += kChars[gen() % (sizeof(kChars) - 1)];
+            }
+            if (!t.empty() && t.back() == '\r')
+                t.pop_back(); // a bare \r before the line break is part of the line ending
+            ids.push_back(id);
+            values.push_back(value);
+            texts.push_back(t);
+            ostringstream value_text;
+            value_text << setprecision(17) << value;
+            text += quoted_field(gen, to_string(id), d.delimiter) + d.delimiter + value_text.str() + d.delimiter +
+                    quoted_field(gen, t, d.delimiter) + (gen() % 4 ? "\n" : "\r\n");
+            if (gen() % 20 == 0)
+                text += "\n";
+        }
+        if (gen() % 2 && !text.empty() && text.back() == '\n')
+            text.pop_back();
+
+        ok = ok && reference_parse(text, d.delimiter, d.quote).size() == rows + 1;
+        interner pool;
+        reader r({column_type::int64, column_type::float64, column_type::string}, pool, d);
+        r.set_parallelism(1 + gen() % 6, 1 + gen() % 512);
+        const batch b = r.parse(text);
+        ok = ok && b.rows == rows && r.names()[2] == "text";
+        for (size_t i = 0; i < rows && ok; ++i) {
+            ok = ok && b.columns[0].ints[i] == ids[i] && b.columns[1].doubles[i] == values[i] &&
+                 pool.str(b.columns[2].strings[i]) == texts[i];
+        }
+
+        // the same text through read() in small blocks
+        istringstream in(text);
+        size_t seen = 0;
+        reader s({column_type::int64, column_type::float64, column_type::string}, pool, d);
+        s.set_parallelism(1 + gen() % 3, 64);
+        const size_t total = s.read(in, [&] (const batch& part) {
+            for (size_t i = 0; i < part.rows; ++i, ++seen) {
+                ok = ok && part.columns[0].ints[i] == ids[seen] && pool.str(part.columns[2].strings[i]) == texts[seen];
+            }
+        }, 1 + gen() % 300);
+        ok = ok && total == rows && seen == rows;
+    }
+
+    // a record at the end of a block longer than a chunk: the chunks after it are empty
+    {
+        string text = "id,text\n";
+        for (int r = 0; r < 41; ++r) {
+            text += to_string(r) + ",x\n";
+        }
+        text += "41," + string(200, 'y') + "\n";
+        interner pool;
+        reader r({column_type::int64, column_type::string}, pool);
+        r.set_parallelism(4, 1);
+        istringstream in(text);
+        size_t seen = 0;
+        const size_t total = r.read(in, [&] (const batch& part) {
+            for (size_t i = 0; i < part.rows; ++i, ++seen) {
+                ok = ok && part.columns[0].ints[i] == static_cast<int64_t>(seen) &&
+                     pool.str(part.columns[1].strings[i]).size() == (seen == 41 ? 200u : 1u);
+            }
+        }, 300);
+        ok = ok && total == 42 && seen == 42;
+    }
+
+    // the number parsers against strtod / strtoll
+    for (const char* x : {"0", "-0", "1.5", "-2.25e3", "1e22", "1e23", "123456789012345678", "0.1", "3.14159265358979",
+                          "1e-300", "inf", ".5", "5.", "+7"}) {
+        double v;
+        ok = ok && parse_double(string_view(x), v) && v == strtod(x, nullptr);
+    }
+    int64_t i;
+    ok = ok && parse_int("-9223372036854775808", i) && i == numeric_limits<int64_t>::min() &&
+         !parse_int("9223372036854775808", i) && !parse_int("12a", i) && !parse_int("-", i);
+    interner pool;
+    reader bad({column_type::int64, column_type::int64}, pool);
+    try {
+        bad.parse("a,b\n1,2\n3,x\n");
+        ok = false;
+    } catch (const runtime_error& e) {
+        ok = ok && string(e.what()).find("offset 8") != string::npos;
+    }
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+// 1M trade records, about 50 MB: id, symbol, price, quantity, a quoted note now and then
+void benchmark()
+{
+    mt19937 gen(61);
+    string text = "id,symbol,price,quantity,note\n";
+    for (size_t r = 0; r < 1000000; ++r) {
+        text += to_string(r) + ",SYM" + to_string(gen() % 500) + "," + to_string(gen() % 100000 / 100) + "." +
+                to_string(10 + gen() % 90) + "," + to_string(gen() % 1000) + "," +
+                (gen() % 4 == 0 ? "\"late, partial fill\"" : "ok") + "\n";
+    }
+
+    double sum = 0;
+    long long t = time_ms([&] {
+        istringstream in(text);
+        string line, field;
+        getline(in, line);
+        while (getline(in, line)) {
+            istringstream fields(line);
+            for (int f = 0; f < 4 && getline(fields, field, ','); ++f) {
+                if (f == 2)
+                    sum += stod(field);
+            }
+        }
+    });
+    cout << "getline + istringstream + stod (no quotes): " << t << " ms, sum " << fixed << setprecision(2) << sum << endl;
+
+    const vector<column_type> types = {column_type::int64, column_type::string, column_type::float64, column_type::int64,
+                                       column_type::string};
+    interner pool;
+    reader r(types, pool);
+    r.set_parallelism(1);
+    batch b;
+    t = time_ms([&] { b = r.parse(text); });
+    sum = 0;
+    for (double x : b.find("price")->doubles) {
+        sum += x;
+    }
+    cout << "csv::reader, 1 thread: " << t << " ms (" << text.size() / 1000 / max<long long>(t, 1) << " MB/s), sum "
+         << sum << ", " << pool.size() << " distinct strings" << endl;
+
+    const size_t threads = algorithms::parallel::thread_count();
+    reader parallel(types, pool);
+    t = time_ms([&] { b = parallel.parse(text); });
+    cout << "csv::reader, " << threads << " threads: " << t << " ms, " << b.rows << " rows" << endl;
+
+    istringstream in(text);
+    reader streaming(types, pool);
+    size_t rows = 0;
+    t = time_ms([&] { rows = streaming.read(in, [] (const batch&) {}, 4 << 20); });
+    cout << "csv::reader::read, 4 MB blocks: " << t << " ms, " << rows << " rows" << endl << defaultfloat;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
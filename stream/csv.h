@@ -0,0 +1,226 @@
+#ifndef STL_DEMO_STREAM_CSV_H
+#define STL_DEMO_STREAM_CSV_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../algorithms/simd.h"
+#include "../strings/interner.h"
+#include "../strings/string_view.h"
+
+namespace stream {
+namespace csv {
+
+/*
+ * CSV / TSV reader: delimited text in, struct-of-arrays batches out
+ *
+ *     strings::interning::interner pool;
+ *     reader r({column_type::int64, column_type::string, column_type::float64}, pool);
+ *     batch b = r.parse(text);                  // 整个文件已经在内存里
+ *     r.read(in, [] (const batch& b) { ... });  // 或者按块读一个很大的流，每块回调一次
+ *
+ * 每一列是一个连续的数组 (batch::columns[i].ints / doubles / strings)，字符串列存的是 interner 的 string_id，
+ * 重复出现的值 (代码、名字、枚举) 只存一份，比较和分组都是整数操作。
+ *
+ * 解析分两步 (simdjson / simdcsv 的做法):
+ *   1. structural scan: 每 64 个字节用 SIMD 比较出引号、分隔符、换行符的三个 64 位掩码。
+ *      引号掩码做一次 prefix XOR 就得到 "哪些字节在引号里面"，分隔符和换行符去掉引号里的部分就是字段边界，
+ *      然后用 ctz 逐个取出来。引号里的 "" (转义的引号) 自然地出现两次，不影响内外的判断
+ *   2. 每个字段交给对应列的 builder: int64 / float64 直接从字符解析 (常见的小数走精确的快速路径，
+ *      其它情况交给 strtod)，string 去掉引号、还原 "" 以后 intern
+ *
+ * 并行: 文本按字节切成若干块，先并行数出每块的引号个数，前缀和的奇偶性告诉每一块的起点是否在引号里，
+ * 于是每块都能找到自己的第一个记录边界 (不在引号里的换行)；各块独立解析，最后按顺序拼起来。
+ *
+ * 规则: RFC 4180 (引号里可以有分隔符、换行和 ""), 行尾可以是 \n 或 \r\n，空行被跳过。
+ * 空的 int64 字段是 0，空的 float64 字段是 NaN。字段个数不对或者数字不合法时抛 std::runtime_error，
+ * 消息里是出错记录在输入里的字节偏移。
+ */
+
+enum class column_type { int64, float64, string };
+
+struct dialect {
+    char delimiter;
+    char quote;
+    bool header; // the first record holds the column names
+
+    static dialect csv() { return dialect{',', '"', true}; }
+    static dialect tsv() { return dialect{'\t', '"', true}; }
+};
+
+struct column {
+    std::string name;
+    column_type type;
+    std::vector<std::int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<strings::interning::string_id> strings;
+
+    std::size_t size() const
+    {
+        return type == column_type::int64 ? ints.size() : type == column_type::float64 ? doubles.size() : strings.size();
+    }
+};
+
+struct batch {
+    std::vector<column> columns;
+    std::size_t rows;
+
+    batch() : rows(0) {}
+
+    // the column of that name, nullptr if there is none
+    const column* find(const std::string& name) const
+    {
+        for (const column& c : columns) {
+            if (c.name == name)
+                return &c;
+        }
+        return nullptr;
+    }
+};
+
+namespace detail {
+
+// bit i: the parity of the set bits at positions <= i
+inline std::uint64_t prefix_xor(std::uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// one bit per byte of p[0, 64) for each of the three characters
+struct masks {
+    std::uint64_t quote;
+    std::uint64_t delimiter;
+    std::uint64_t newline;
+};
+
+inline masks classify(const char* p, char quote, char delimiter)
+{
+    masks m = {0, 0, 0};
+#if defined(STL_DEMO_SIMD)
+    namespace simd = algorithms::simd;
+    typedef simd::lane<char> L;
+    const simd::reg q = L::set1(quote), d = L::set1(delimiter), nl = L::set1('\n');
+    for (std::size_t i = 0; i < 64; i += simd::kBytes) {
+        const simd::reg x = simd::loadu(p + i);
+        m.quote |= static_cast<std::uint64_t>(simd::bytemask(L::eq(x, q))) << i;
+        m.delimiter |= static_cast<std::uint64_t>(simd::bytemask(L::eq(x, d))) << i;
+        m.newline |= static_cast<std::uint64_t>(simd::bytemask(L::eq(x, nl))) << i;
+    }
+#else
+    for (std::size_t i = 0; i < 64; ++i) {
+        m.quote |= static_cast<std::uint64_t>(p[i] == quote) << i;
+        m.delimiter |= static_cast<std::uint64_t>(p[i] == delimiter) << i;
+        m.newline |= static_cast<std::uint64_t>(p[i] == '\n') << i;
+    }
+#endif
+    return m;
+}
+
+inline std::size_t count_char(const char* p, std::size_t n, char c)
+{
+    std::size_t count = 0, i = 0;
+#if defined(STL_DEMO_SIMD)
+    namespace simd = algorithms::simd;
+    typedef simd::lane<char> L;
+    const simd::reg v = L::set1(c);
+    for (; i + simd::kBytes <= n; i += simd::kBytes) {
+        count += simd::popcount(simd::bytemask(L::eq(simd::loadu(p + i), v)));
+    }
+#endif
+    for (; i < n; ++i) {
+        count += p[i] == c;
+    }
+    return count;
+}
+
+}
+
+class reader {
+public:
+    // one type per column; the names come from the header record (column0, column1, ... without one).
+    // With a header and no types every column is a string column
+    reader(std::vector<column_type> types, strings::interning::interner& pool, dialect d = dialect::csv());
+
+    // a whole document in memory
+    batch parse(strings::views::string_view text);
+
+    // a stream of any size, block_bytes at a time: on_batch(const batch&) once per block, returns the rows read
+    template <typename F>
+    std::size_t read(std::istream& in, F on_batch, std::size_t block_bytes = 64 << 20)
+    {
+        std::vector<char> buffer(block_bytes);
+        std::size_t have = 0, rows = 0, offset = 0;
+        bool first = true;
+        for (;;) {
+            if (have == buffer.size())
+                buffer.resize(buffer.size() * 2); // one record longer than a block
+            in.read(buffer.data() + have, static_cast<std::streamsize>(buffer.size() - have));
+            have += static_cast<std::size_t>(in.gcount());
+            const bool last = !in;
+            strings::views::string_view text(buffer.data(), have);
+            std::size_t used = 0;
+            if (first && dialect_.header) {
+                used = read_header(text, last);
+                if (used == 0 && !last)
+                    continue;
+            }
+            first = false;
+            batch b;
+            used += parse_block(text.substr(used), offset + used, last, b);
+            if (b.rows > 0) {
+                rows += b.rows;
+                on_batch(static_cast<const batch&>(b));
+            }
+            // the incomplete record at the end moves to the front
+            std::memmove(buffer.data(), buffer.data() + used, have - used);
+            have -= used;
+            offset += used;
+            if (last)
+                return rows;
+        }
+    }
+
+    const std::vector<std::string>& names() const { return names_; }
+
+    // up to `threads` chunks of at least min_chunk_bytes each (default: thread_count() and 4 MB)
+    void set_parallelism(std::size_t threads, std::size_t min_chunk_bytes = 4 << 20)
+    {
+        threads_ = threads == 0 ? 1 : threads;
+        min_chunk_bytes_ = min_chunk_bytes == 0 ? 1 : min_chunk_bytes;
+    }
+
+private:
+    // the header record: the bytes it takes, 0 if it is not complete yet (unless it is the last of the input)
+    std::size_t read_header(strings::views::string_view text, bool last);
+    // the complete records of text in parallel chunks; the bytes consumed
+    std::size_t parse_block(strings::views::string_view text, std::size_t offset, bool last, batch& out) const;
+    // the records of [b, e), which starts at a record boundary; the end of the last record parsed
+    std::size_t parse_range(const char* text, std::size_t b, std::size_t e, std::size_t offset, bool last,
+                            batch& out) const;
+    batch empty_batch() const;
+
+    std::vector<column_type> types_;
+    std::vector<std::string> names_;
+    strings::interning::interner& pool_;
+    dialect dialect_;
+    std::size_t threads_;
+    std::size_t min_chunk_bytes_;
+};
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_STREAM_CSV_H
@@ -1,4 +1,7 @@
 #include "demos.h"
+#include "records.h"
+#include "csv.h"
+#include "snapshot.h"
 
 #include <iostream>
 
@@ -9,6 +12,10 @@ using namespace std;
 void Demos()
 {
     std::cout << "Stream demos running.." << std::endl;
+
+    //records::Run();
+    //csv::Run();
+    //snapshot::Run();
 }
 
 }
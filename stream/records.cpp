@@ -0,0 +1,56 @@
+#include "records.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+namespace stream {
+namespace records {
+
+struct trade {
+    uint64_t id;
+    double price;
+    uint32_t quantity;
+};
+
+void Run()
+{
+    // binary records through a file with a 256 KB buffer
+    const string path = "records_demo.bin";
+    {
+        buffered_ofstream out(path, 256 * 1024);
+        binary_codec<trade> codec;
+        for (uint32_t i = 0; i < 5; ++i) {
+            trade t = {1000 + i, 10.5 * i, i * 100};
+            codec.write(out.get(), t);
+        }
+        out.close();
+    }
+    {
+        buffered_ifstream in(path, 256 * 1024);
+        binary_codec<trade> codec;
+        trade t;
+        while (codec.read(in.get(), t)) {
+            cout << "trade " << t.id << ": " << t.quantity << " @ " << t.price << endl;
+        }
+    }
+    std::remove(path.c_str());
+
+    // text records: one per line
+    istringstream text("delta\nalpha\ncharlie\nbravo\n");
+    line_codec lines;
+    string rec;
+    size_t bytes = 0;
+    while (lines.read(text, rec)) {
+        bytes += lines.footprint(rec);
+        lines.write(cout, rec);
+    }
+    cout << "in memory footprint: " << bytes << " bytes" << endl;
+}
+
+}
+}
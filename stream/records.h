@@ -0,0 +1,118 @@
+#ifndef STL_DEMO_STREAM_RECORDS_H
+#define STL_DEMO_STREAM_RECORDS_H
+
+#include <cstddef>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace stream {
+namespace records {
+
+/*
+ * Record codecs: how one record is read from / written to a stream.
+ * Everything that streams records through files (e.g. algorithms/external_sort.h) is written against
+ * this small interface instead of a concrete format:
+ *
+ *     bool        read(std::istream&, T&)         false at the end of the input
+ *     void        write(std::ostream&, const T&)
+ *     std::size_t footprint(const T&)             bytes the record occupies in memory, for memory budgets
+ *
+ * binary_codec<T>  定长的二进制记录 (trivially copyable 的 struct 或者整数)，直接按字节读写
+ * line_codec       文本文件，一行一条记录，不包括换行符
+ */
+
+template <typename T>
+struct binary_codec {
+    static_assert(std::is_trivially_copyable<T>::value, "binary_codec needs a trivially copyable record type");
+    typedef T value_type;
+
+    bool read(std::istream& in, T& rec) const
+    {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&rec), sizeof(T)));
+    }
+
+    void write(std::ostream& out, const T& rec) const
+    {
+        out.write(reinterpret_cast<const char*>(&rec), sizeof(T));
+    }
+
+    std::size_t footprint(const T&) const { return sizeof(T); }
+};
+
+struct line_codec {
+    typedef std::string value_type;
+
+    bool read(std::istream& in, std::string& rec) const
+    {
+        return static_cast<bool>(std::getline(in, rec));
+    }
+
+    void write(std::ostream& out, const std::string& rec) const
+    {
+        out.write(rec.data(), static_cast<std::streamsize>(rec.size()));
+        out.put('\n');
+    }
+
+    // heap allocation (if any) plus the string object itself
+    std::size_t footprint(const std::string& rec) const { return sizeof(std::string) + rec.capacity(); }
+};
+
+/*
+ * File streams with a caller sized buffer. The default filebuf buffer is a few KB, which means a
+ * system call every few KB; sequential record files want buffers of hundreds of KB.
+ * pubsetbuf() has to be called before open(), hence the helpers.
+ */
+class buffered_ifstream {
+public:
+    buffered_ifstream(const std::string& path, std::size_t buffer_size)
+        : buffer_(new char[buffer_size])
+    {
+        stream_.rdbuf()->pubsetbuf(buffer_.get(), static_cast<std::streamsize>(buffer_size));
+        stream_.open(path.c_str(), std::ios::in | std::ios::binary);
+        if (!stream_)
+            throw std::runtime_error("cannot open " + path + " for reading");
+    }
+
+    std::ifstream& get() { return stream_; }
+
+private:
+    std::unique_ptr<char[]> buffer_; // declared first: must outlive the stream
+    std::ifstream stream_;
+};
+
+class buffered_ofstream {
+public:
+    buffered_ofstream(const std::string& path, std::size_t buffer_size)
+        : buffer_(new char[buffer_size])
+    {
+        stream_.rdbuf()->pubsetbuf(buffer_.get(), static_cast<std::streamsize>(buffer_size));
+        stream_.open(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream_)
+            throw std::runtime_error("cannot open " + path + " for writing");
+    }
+
+    std::ofstream& get() { return stream_; }
+
+    void close()
+    {
+        stream_.close();
+        if (!stream_)
+            throw std::runtime_error("write error");
+    }
+
+private:
+    std::unique_ptr<char[]> buffer_;
+    std::ofstream stream_;
+};
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_STREAM_RECORDS_H
@@ -0,0 +1,675 @@
+#include "snapshot.h"
+#include "records.h"
+#include "../strings/tokenizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using strings::views::string_view;
+
+namespace stream {
+namespace snapshot {
+
+namespace detail {
+
+namespace {
+
+// slicing-by-8 tables of the reflected Castagnoli polynomial
+struct crc_tables {
+    uint32_t t[8][256];
+
+    crc_tables()
+    {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = c & 1 ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+            }
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int k = 1; k < 8; ++k) {
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+}
+
+uint32_t crc32c(const void* data, size_t n, uint32_t crc)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+#if defined(__SSE4_2__)
+    uint64_t c = crc;
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        c = _mm_crc32_u64(c, word);
+    }
+    crc = static_cast<uint32_t>(c);
+    for (; n > 0; --n, ++p) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+#else
+    static const crc_tables tables;
+    const uint32_t (*t)[256] = tables.t;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; n >= 8; n -= 8, p += 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+#endif
+    for (; n > 0; --n, ++p) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xFF];
+    }
+#endif
+    return ~crc;
+}
+
+size_t element_size(uint32_t type)
+{
+    switch (static_cast<element_type>(type)) {
+    case element_type::i8: return 1;
+    case element_type::i32:
+    case element_type::u32:
+    case element_type::f32: return 4;
+    case element_type::i64:
+    case element_type::u64:
+    case element_type::f64: return 8;
+    }
+    return 0;
+}
+
+}
+
+// -- writer --
+
+void writer::push(const string& name, element_type type, column_kind kind, size_t rows, const void* values,
+                  size_t value_bytes, const uint64_t* offsets)
+{
+    if (name.empty() || name.size() >= sizeof(detail::column_entry::name) || name.find('\0') != string::npos)
+        throw invalid_argument("snapshot::writer: a column name has 1 to 47 characters: " + name);
+    for (const pending& c : columns_) {
+        if (c.name == name)
+            throw invalid_argument("snapshot::writer: two columns named " + name);
+    }
+    pending c = {name, type, kind, rows, values, value_bytes, offsets};
+    columns_.push_back(c);
+}
+
+void writer::add_strings(const string& name, const vector<string>& values)
+{
+    vector<char> chars;
+    vector<uint64_t> offsets(1, 0);
+    offsets.reserve(values.size() + 1);
+    for (const string& s : values) {
+        chars.insert(chars.end(), s.begin(), s.end());
+        offsets.push_back(chars.size());
+    }
+    // the buffers move into the vectors of vectors, their data() stays where it is
+    chars_.push_back(std::move(chars));
+    owned_offsets_.push_back(std::move(offsets));
+    push(name, element_type::i8, column_kind::strings, values.size(), chars_.back().data(), chars_.back().size(),
+         owned_offsets_.back().data());
+}
+
+void writer::save(const string& path) const
+{
+    const string tmp = path + ".tmp";
+    vector<detail::column_entry> directory(columns_.size());
+    uint64_t position = 0;
+    {
+        records::buffered_ofstream file(tmp, 1 << 20);
+        ostream& out = file.get();
+        static const char kZeros[detail::kAlign] = {};
+        // up to the next block boundary
+        auto pad = [&] {
+            const uint64_t next = detail::align_up(position);
+            out.write(kZeros, static_cast<streamsize>(next - position));
+            position = next;
+        };
+        auto block = [&] (const void* data, size_t bytes, uint64_t& offset, uint32_t& crc) {
+            pad();
+            offset = position;
+            crc = detail::crc32c(data, bytes);
+            out.write(static_cast<const char*>(data), static_cast<streamsize>(bytes));
+            position += bytes;
+        };
+
+        // the header goes in last, when the directory is known
+        out.write(kZeros, sizeof(detail::file_header));
+        position = sizeof(detail::file_header);
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            const pending& c = columns_[i];
+            detail::column_entry& e = directory[i];
+            memset(&e, 0, sizeof(e));
+            memcpy(e.name, c.name.data(), c.name.size());
+            e.type = static_cast<uint32_t>(c.type);
+            e.kind = static_cast<uint32_t>(c.kind);
+            e.rows = c.rows;
+            e.values_count = c.value_bytes / detail::element_size(e.type);
+            block(c.values, c.value_bytes, e.values_offset, e.values_crc);
+            if (c.offsets != nullptr)
+                block(c.offsets, (c.rows + 1) * sizeof(uint64_t), e.offsets_offset, e.offsets_crc);
+        }
+        pad();
+
+        detail::file_header h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, "STLSNAP", 8);
+        h.version = detail::kVersion;
+        h.byte_order = detail::kByteOrder;
+        h.directory_offset = position;
+        h.column_count = static_cast<uint32_t>(directory.size());
+        h.file_size = position + directory.size() * sizeof(detail::column_entry);
+        h.directory_crc = detail::crc32c(directory.data(), directory.size() * sizeof(detail::column_entry));
+        h.header_crc = detail::crc32c(&h, offsetof(detail::file_header, header_crc));
+        out.write(reinterpret_cast<const char*>(directory.data()),
+                  static_cast<streamsize>(directory.size() * sizeof(detail::column_entry)));
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        file.close();
+    }
+    // readers see the old file or the new one, never half of the new one
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw runtime_error("snapshot: cannot rename " + tmp + " to " + path);
+    }
+}
+
+// -- mapped_file --
+
+mapped_file::mapped_file(const string& path) : data_(nullptr), size_(0), mapped_(false)
+{
+#if defined(__unix__)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw runtime_error("snapshot: cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw runtime_error("snapshot: cannot stat " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw runtime_error("snapshot: cannot map " + path);
+        }
+        data_ = static_cast<const char*>(p);
+        mapped_ = true;
+    }
+    ::close(fd); // the mapping keeps the file
+#else
+    ifstream in(path.c_str(), ios::binary | ios::ate);
+    if (!in)
+        throw runtime_error("snapshot: cannot open " + path);
+    size_ = static_cast<size_t>(in.tellg());
+    // 8 byte aligned, like the blocks of a mapping
+    uint64_t* buffer = new uint64_t[(size_ + 7) / 8 + 1];
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(buffer), static_cast<streamsize>(size_));
+    data_ = reinterpret_cast<const char*>(buffer);
+    if (!in) {
+        delete[] buffer;
+        throw runtime_error("snapshot: cannot read " + path);
+    }
+#endif
+}
+
+mapped_file::~mapped_file()
+{
+#if defined(__unix__)
+    if (mapped_)
+        ::munmap(const_cast<char*>(data_), size_);
+#else
+    delete[] reinterpret_cast<const uint64_t*>(data_);
+#endif
+}
+
+// -- file --
+
+file::file(const string& path, verify level) : path_(path), map_(path), header_(nullptr), directory_(nullptr)
+{
+    const size_t size = map_.size();
+    if (size < sizeof(detail::file_header))
+        fail("too small to be a snapshot");
+    header_ = reinterpret_cast<const detail::file_header*>(map_.data());
+    if (memcmp(header_->magic, "STLSNAP", 8) != 0)
+        fail("not a snapshot");
+    if (header_->byte_order != detail::kByteOrder)
+        fail("written with the other byte order");
+    if (header_->version != detail::kVersion)
+        fail("version " + to_string(header_->version) + ", this build reads version " + to_string(detail::kVersion));
+    if (detail::crc32c(header_, offsetof(detail::file_header, header_crc)) != header_->header_crc)
+        fail("the header is damaged");
+    if (header_->file_size != size)
+        fail(to_string(size) + " bytes, the header says " + to_string(header_->file_size) + " (truncated?)");
+
+    const uint64_t dir = header_->directory_offset;
+    if (dir % 8 != 0 || dir > size || header_->column_count > (size - dir) / sizeof(detail::column_entry))
+        fail("the directory is out of the file");
+    directory_ = reinterpret_cast<const detail::column_entry*>(map_.data() + dir);
+    if (detail::crc32c(directory_, header_->column_count * sizeof(detail::column_entry)) != header_->directory_crc)
+        fail("the directory is damaged");
+
+    // every block inside the file, so that no span can point out of the mapping
+    for (uint32_t i = 0; i < header_->column_count; ++i) {
+        const detail::column_entry& e = directory_[i];
+        const void* nul = memchr(e.name, 0, sizeof(e.name));
+        const string name(e.name, nul ? static_cast<const char*>(nul) - e.name : sizeof(e.name));
+        const size_t element = detail::element_size(e.type);
+        const bool listed = e.kind == static_cast<uint32_t>(column_kind::lists) ||
+                            e.kind == static_cast<uint32_t>(column_kind::strings);
+        if (name.size() == sizeof(e.name) || element == 0 || (!listed && e.kind != static_cast<uint32_t>(column_kind::values)))
+            fail("column " + to_string(i) + " is not valid");
+        if (e.values_offset % detail::kAlign != 0 || e.values_offset > size ||
+            e.values_count > (size - e.values_offset) / element || (!listed && e.values_count != e.rows))
+            fail("the values of " + name + " are out of the file");
+        if (listed && (e.offsets_offset % detail::kAlign != 0 || e.offsets_offset > size ||
+                       e.rows >= (size - e.offsets_offset) / sizeof(uint64_t)))
+            fail("the offsets of " + name + " are out of the file");
+    }
+    if (level == verify::all)
+        verify_blocks();
+}
+
+void file::verify_blocks() const
+{
+    for (uint32_t i = 0; i < header_->column_count; ++i) {
+        const detail::column_entry& e = directory_[i];
+        const char* values = map_.data() + e.values_offset;
+        if (detail::crc32c(values, e.values_count * detail::element_size(e.type)) != e.values_crc)
+            fail("the values of " + string(e.name) + " are damaged");
+        if (e.kind == static_cast<uint32_t>(column_kind::values))
+            continue;
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(map_.data() + e.offsets_offset);
+        if (detail::crc32c(offsets, (e.rows + 1) * sizeof(uint64_t)) != e.offsets_crc)
+            fail("the offsets of " + string(e.name) + " are damaged");
+        bool ordered = offsets[0] == 0 && offsets[e.rows] == e.values_count;
+        for (uint64_t r = 0; r < e.rows && ordered; ++r) {
+            ordered = offsets[r] <= offsets[r + 1];
+        }
+        if (!ordered)
+            fail("the offsets of " + string(e.name) + " are not in order");
+    }
+}
+
+vector<string> file::names() const
+{
+    vector<string> out;
+    for (uint32_t i = 0; i < header_->column_count; ++i) {
+        out.push_back(directory_[i].name);
+    }
+    return out;
+}
+
+string_column file::strings(const string& name) const
+{
+    const detail::column_entry& e = entry(name, element_type::i8, column_kind::strings);
+    return string_column(list_column<char>(reinterpret_cast<const uint64_t*>(map_.data() + e.offsets_offset),
+                                           static_cast<size_t>(e.rows), map_.data() + e.values_offset));
+}
+
+const detail::column_entry* file::find(const string& name) const
+{
+    for (uint32_t i = 0; i < header_->column_count; ++i) {
+        if (name == directory_[i].name)
+            return directory_ + i;
+    }
+    return nullptr;
+}
+
+const detail::column_entry& file::entry(const string& name) const
+{
+    const detail::column_entry* e = find(name);
+    if (e == nullptr)
+        fail("no column " + name);
+    return *e;
+}
+
+const detail::column_entry& file::entry(const string& name, element_type type, column_kind kind) const
+{
+    const detail::column_entry& e = entry(name);
+    if (e.type != static_cast<uint32_t>(type))
+        fail("column " + name + " holds another element type");
+    if (e.kind != static_cast<uint32_t>(kind))
+        fail("column " + name + " is not a " +
+             (kind == column_kind::values ? "values" : kind == column_kind::lists ? "lists" : "strings") + " column");
+    return e;
+}
+
+void file::fail(const string& what) const
+{
+    throw runtime_error("snapshot " + path_ + ": " + what);
+}
+
+// -- demo, cross check, benchmark --
+
+string temp_path(const string& name)
+{
+    const char* dir = getenv("TMPDIR");
+    return string(dir && *dir ? dir : "/tmp") + "/stl_demo_" + name;
+}
+
+// the Link_details_shp.txt records of HPP_MAP.md as columns
+struct links {
+    vector<int64_t> id, from, to;
+    vector<int32_t> width;
+    vector<uint64_t> offsets; // into points, three doubles (x, y, z) per point
+    vector<double> points;
+
+    links() : offsets(1, 0) {}
+
+    // "id|fjcid|tjcid|width|LINESTRING(x|y|z,...)"; strtod stops at the next '|', ',' or ')'
+    void parse(const string& line)
+    {
+        using strings::tokenizing::split;
+        size_t f = 0;
+        for (string_view field : split(line, '|').limit(5)) {
+            switch (f++) {
+            case 0: id.push_back(strtoll(field.data(), nullptr, 10)); break;
+            case 1: from.push_back(strtoll(field.data(), nullptr, 10)); break;
+            case 2: to.push_back(strtoll(field.data(), nullptr, 10)); break;
+            case 3: width.push_back(static_cast<int32_t>(strtol(field.data(), nullptr, 10))); break;
+            default:
+                field.remove_prefix(field.find('(') + 1);
+                for (string_view point : split(field, ',')) {
+                    for (string_view coordinate : split(point, '|')) {
+                        points.push_back(strtod(coordinate.data(), nullptr));
+                    }
+                }
+                offsets.push_back(points.size());
+            }
+        }
+    }
+
+    void save(const string& path) const
+    {
+        writer w;
+        w.add("link_id", id);
+        w.add("fjcid", from);
+        w.add("tjcid", to);
+        w.add("width", width);
+        w.add_lists("geometry", offsets, points);
+        w.save(path);
+    }
+};
+
+// ofstream << and ifstream >>, the std way to keep numbers between runs: text, parsed again every time
+void same_as_std_demo()
+{
+    const string lines[] = {"9000|9001|9002|166|LINESTRING(9.3102112|21.3413677|0,7.4145136|22.8352985|0)",
+                            "9001|9002|9003|120|LINESTRING(7.4145136|22.8352985|0,5.5|24.25|0,3.75|25.5|0)",
+                            "9002|9003|9000|166|LINESTRING(3.75|25.5|0,9.3102112|21.3413677|0)"};
+    const string text_path = temp_path("links.txt");
+    {
+        ofstream out(text_path.c_str());
+        for (const string& line : lines) {
+            out << line << '\n';
+        }
+    }
+    links parsed;
+    {
+        ifstream in(text_path.c_str());
+        string line;
+        while (getline(in, line)) {
+            parsed.parse(line);
+        }
+    }
+    std::remove(text_path.c_str());
+    cout << "ifstream + getline + split: " << parsed.id.size() << " links" << endl;
+
+    const string path = temp_path("links.snap");
+    parsed.save(path);
+    {
+        file f(path);
+        cout << "snapshot: " << f.size_bytes() << " bytes, columns:";
+        for (const string& name : f.names()) {
+            cout << " " << name << "(" << f.rows(name) << ")";
+        }
+        cout << endl;
+        const span<int64_t> ids = f.values<int64_t>("link_id");
+        const span<int32_t> widths = f.values<int32_t>("width");
+        const list_column<double> geometry = f.lists<double>("geometry");
+        for (size_t i = 0; i < ids.size(); ++i) {
+            cout << "  link " << ids[i] << ", width " << widths[i] << ", points:";
+            const span<double> g = geometry[i];
+            for (size_t k = 0; k < g.size(); k += 3) {
+                cout << " (" << g[k] << ", " << g[k + 1] << ")";
+            }
+            cout << endl;
+        }
+        try {
+            f.values<double>("width");
+        } catch (const runtime_error& e) {
+            cout << e.what() << endl;
+        }
+    }
+    std::remove(path.c_str());
+}
+
+void overwrite(const string& path, size_t at, const void* bytes, size_t n)
+{
+    fstream f(path.c_str(), ios::in | ios::out | ios::binary);
+    f.seekp(static_cast<streamoff>(at));
+    f.write(static_cast<const char*>(bytes), static_cast<streamsize>(n));
+}
+
+bool opens(const string& path, verify level)
+{
+    try {
+        file f(path, level);
+        return true;
+    } catch (const runtime_error&) {
+        return false;
+    }
+}
+
+bool cross_check()
+{
+    bool ok = detail::crc32c("123456789", 9) == 0xE3069283u && detail::crc32c("", 0) == 0;
+    // in two parts is the same as at once
+    const string text = "the quick brown fox jumps over the lazy dog";
+    ok = ok && detail::crc32c(text.data() + 13, text.size() - 13, detail::crc32c(text.data(), 13)) ==
+                   detail::crc32c(text.data(), text.size());
+
+    mt19937_64 gen(67);
+    const string path = temp_path("cross_check.snap");
+    for (int round = 0; round < 50 && ok; ++round) {
+        const size_t rows = gen() % (round % 5 == 0 ? 100000 : 50);
+        vector<int8_t> small(rows);
+        vector<uint32_t> ids(rows);
+        vector<double> values(rows);
+        vector<uint64_t> offsets(1, 0);
+        vector<float> items;
+        vector<string> names(rows);
+        for (size_t i = 0; i < rows; ++i) {
+            small[i] = static_cast<int8_t>(gen());
+            ids[i] = static_cast<uint32_t>(gen());
+            values[i] = static_cast<double>(gen()) / 3;
+            for (size_t k = gen() % 5; k > 0; --k) {
+                items.push_back(static_cast<float>(gen() % 1000) / 8);
+            }
+            offsets.push_back(items.size());
+            names[i] = string(gen() % 6, static_cast<char>(gen() % 256)); // empty, NUL and high bytes too
+        }
+        {
+            writer w;
+            w.add("small", small);
+            w.add("id", ids);
+            w.add("value", values);
+            w.add_lists("items", offsets, items);
+            vector<string> copy = names;
+            w.add_strings("name", copy);
+            copy.clear(); // add_strings() keeps its own characters
+            w.save(path);
+        }
+        file f(path, verify::all);
+        const span<int8_t> s = f.values<int8_t>("small");
+        const span<uint32_t> i32 = f.values<uint32_t>("id");
+        const span<double> d = f.values<double>("value");
+        const list_column<float> l = f.lists<float>("items");
+        const string_column n = f.strings("name");
+        ok = ok && f.column_count() == 5 && s.size() == rows && i32.size() == rows && d.size() == rows &&
+             l.size() == rows && n.size() == rows && l.values().size() == items.size();
+        ok = ok && reinterpret_cast<uintptr_t>(d.data()) % detail::kAlign == 0 &&
+             reinterpret_cast<uintptr_t>(l.values().data()) % detail::kAlign == 0;
+        for (size_t r = 0; r < rows && ok; ++r) {
+            const span<float> row = l[r];
+            ok = s[r] == small[r] && i32[r] == ids[r] && d[r] == values[r] && n[r] == string_view(names[r]) &&
+                 row.size() == offsets[r + 1] - offsets[r] && equal(row.begin(), row.end(), items.begin() + offsets[r]);
+        }
+        ok = ok && !f.has("missing") && f.has("items");
+    }
+
+    // an empty snapshot
+    writer().save(path);
+    ok = ok && file(path, verify::all).column_count() == 0;
+
+    // damage: a data byte (found only by verify::all), the directory, the version, a truncated file
+    vector<int64_t> big(10000, 7);
+    writer w;
+    w.add("big", big);
+    w.save(path);
+    const char x = 1;
+    overwrite(path, sizeof(detail::file_header) + 100, &x, 1);
+    ok = ok && opens(path, verify::header) && !opens(path, verify::all);
+    w.save(path);
+    const size_t size = file(path).size_bytes();
+    overwrite(path, size - sizeof(detail::column_entry) + 60, &x, 1); // rows of the column
+    ok = ok && !opens(path, verify::header);
+    w.save(path);
+    const uint32_t version = 2;
+    overwrite(path, offsetof(detail::file_header, version), &version, 4);
+    try {
+        file f(path);
+        ok = false;
+    } catch (const runtime_error& e) {
+        ok = ok && string(e.what()).find("version 2") != string::npos;
+    }
+    w.save(path);
+    {
+        vector<char> bytes(size - 8);
+        ifstream in(path.c_str(), ios::binary);
+        in.read(bytes.data(), static_cast<streamsize>(bytes.size()));
+        in.close();
+        ofstream out(path.c_str(), ios::binary | ios::trunc);
+        out.write(bytes.data(), static_cast<streamsize>(bytes.size()));
+    }
+    ok = ok && !opens(path, verify::header) && !opens(temp_path("does_not_exist.snap"), verify::header);
+    std::remove(path.c_str());
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+// 1M links in the text format of HPP_MAP.md against the same columns as a snapshot
+void benchmark()
+{
+    mt19937 gen(71);
+    const string text_path = temp_path("links_bench.txt");
+    const string path = temp_path("links_bench.snap");
+    {
+        records::buffered_ofstream out(text_path, 1 << 20);
+        char buf[64];
+        for (size_t i = 0; i < 1000000; ++i) {
+            out.get() << 9000 + i << '|' << 9000 + gen() % 1000000 << '|' << 9000 + gen() % 1000000 << '|'
+                      << gen() % 300 << "|LINESTRING(";
+            const size_t points = 2 + gen() % 7;
+            for (size_t p = 0; p < points; ++p) {
+                snprintf(buf, sizeof(buf), "%s%.7f|%.7f|0", p ? "," : "", (gen() % 100000000) / 1e6,
+                         (gen() % 100000000) / 1e6);
+                out.get() << buf;
+            }
+            out.get() << ")\n";
+        }
+        out.close();
+    }
+
+    links parsed;
+    long long t = time_ms([&] {
+        records::buffered_ifstream in(text_path, 1 << 20);
+        string line;
+        while (getline(in.get(), line)) {
+            parsed.parse(line);
+        }
+    });
+    cout << "text, getline + split + strtod: " << t << " ms, " << parsed.id.size() << " links, "
+         << parsed.points.size() / 3 << " points" << endl;
+    t = time_ms([&] { parsed.save(path); });
+    cout << "writer::save: " << t << " ms" << endl;
+
+    double sum = 0;
+    size_t bytes = 0;
+    t = time_ms([&] {
+        file f(path);
+        bytes = f.size_bytes();
+        const list_column<double> g = f.lists<double>("geometry");
+        sum = g[g.size() / 2][0]; // one link: one page of the file
+    });
+    cout << "open + one link: " << t << " ms (" << bytes / (1 << 20) << " MB file), x " << sum << endl;
+    int64_t total = 0;
+    t = time_ms([&] {
+        file f(path);
+        for (int32_t w : f.values<int32_t>("width")) {
+            total += w;
+        }
+        sum = 0;
+        for (double v : f.lists<double>("geometry").values()) {
+            sum += v;
+        }
+    });
+    cout << "open + scan width and geometry: " << t << " ms, widths " << total << ", coordinates "
+         << static_cast<long long>(sum) << endl;
+    t = time_ms([&] { file f(path, verify::all); });
+    cout << "open with verify::all (CRC32C of every block): " << t << " ms" << endl;
+
+    std::remove(text_path.c_str());
+    std::remove(path.c_str());
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
@@ -0,0 +1,274 @@
+#ifndef STL_DEMO_STREAM_SNAPSHOT_H
+#define STL_DEMO_STREAM_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../strings/string_view.h"
+
+namespace stream {
+namespace snapshot {
+
+/*
+ * Binary columnar snapshots: parse the text once, save the columns, map them back in at the next start
+ *
+ *     writer w;
+ *     w.add("link_id", ids);                           // std::vector<T> 或 (const T*, n), T 是整数或浮点数
+ *     w.add_lists("geometry", offsets, coordinates);   // 变长的行: 第 i 行是 values[offsets[i], offsets[i + 1])
+ *     w.add_strings("name", names);
+ *     w.save("links.snap");                            // 先写 links.snap.tmp 再 rename, 读的一方不会看到写了一半的文件
+ *
+ *     file f("links.snap");                            // mmap, 只检查文件头和列目录
+ *     span<const std::int64_t> ids = f.values<std::int64_t>("link_id");
+ *     span<const double> points = f.lists<double>("geometry")[i];
+ *
+ * 打开文件不做任何反序列化: values / lists / strings 返回的就是指向映射内存的 span，
+ * 页面在第一次访问时才由操作系统读进来，所以启动时间和文件大小基本无关，没用到的列一个字节也不读。
+ *
+ * 文件格式 (version 1, 本机字节序，文件头里有字节序标记，不一致时拒绝打开):
+ *
+ *     file_header   64 字节: magic "STLSNAP\0", version, 字节序标记, 文件大小, 列目录的位置和个数, 校验和
+ *     blocks        每列一个 values 块，变长列和字符串列再加一个 rows + 1 个 std::uint64_t 的 offsets 块；
+ *                   每个块都从 64 字节对齐的位置开始 (mmap 的起点按页对齐，所以块在内存里也是对齐的)
+ *     directory     每列一个 column_entry: 名字、元素类型、种类、行数、两个块的位置和 CRC32C
+ *
+ * 校验: 打开时总是检查文件头和列目录的 CRC32C 以及每个块是否在文件范围内，所以截断、版本不对、
+ * 不是快照的文件都会被拒绝 (std::runtime_error)。数据块的 CRC 要读完整个文件，
+ * 只在 verify::all 或者调用 verify_blocks() 时检查。
+ */
+
+template <typename T>
+class span {
+public:
+    typedef T value_type;
+    typedef const T* iterator;
+
+    span() : data_(nullptr), size_(0) {}
+    span(const T* data, std::size_t size) : data_(data), size_(size) {}
+
+    const T* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const T& operator[](std::size_t i) const { return data_[i]; }
+    iterator begin() const { return data_; }
+    iterator end() const { return data_ + size_; }
+
+private:
+    const T* data_;
+    std::size_t size_;
+};
+
+// variable length rows: row i is values[offsets[i], offsets[i + 1])
+template <typename T>
+class list_column {
+public:
+    list_column() : offsets_(nullptr), rows_(0), values_(nullptr) {}
+    list_column(const std::uint64_t* offsets, std::size_t rows, const T* values)
+        : offsets_(offsets), rows_(rows), values_(values)
+    {
+    }
+
+    std::size_t size() const { return rows_; }
+    span<T> operator[](std::size_t i) const
+    {
+        return span<T>(values_ + offsets_[i], static_cast<std::size_t>(offsets_[i + 1] - offsets_[i]));
+    }
+    // the rows one after the other
+    span<T> values() const { return span<T>(values_, rows_ == 0 ? 0 : static_cast<std::size_t>(offsets_[rows_])); }
+    span<std::uint64_t> offsets() const { return span<std::uint64_t>(offsets_, rows_ + 1); }
+
+private:
+    const std::uint64_t* offsets_;
+    std::size_t rows_;
+    const T* values_;
+};
+
+class string_column {
+public:
+    string_column() {}
+    explicit string_column(list_column<char> chars) : chars_(chars) {}
+
+    std::size_t size() const { return chars_.size(); }
+    strings::views::string_view operator[](std::size_t i) const
+    {
+        const span<char> s = chars_[i];
+        return strings::views::string_view(s.data(), s.size());
+    }
+
+private:
+    list_column<char> chars_;
+};
+
+enum class element_type : std::uint32_t { i8 = 1, i32, u32, i64, u64, f32, f64 };
+enum class column_kind : std::uint32_t { values = 1, lists, strings };
+enum class verify { header, all };
+
+namespace detail {
+
+const std::uint32_t kVersion = 1;
+const std::uint32_t kByteOrder = 0x01020304;
+const std::size_t kAlign = 64;
+
+struct file_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t file_size;
+    std::uint64_t directory_offset;
+    std::uint32_t column_count;
+    std::uint32_t directory_crc;
+    std::uint32_t header_crc; // of the bytes before it
+    char reserved[20];
+};
+static_assert(sizeof(file_header) == 64, "file_header is one cache line");
+
+struct column_entry {
+    char name[48];            // NUL terminated
+    std::uint32_t type;       // element_type
+    std::uint32_t kind;       // column_kind
+    std::uint64_t rows;
+    std::uint64_t values_offset;
+    std::uint64_t values_count;
+    std::uint64_t offsets_offset; // lists and strings: rows + 1 offsets into the values
+    std::uint32_t values_crc;
+    std::uint32_t offsets_crc;
+};
+static_assert(sizeof(column_entry) == 96, "column_entry has no padding");
+
+template <typename T> struct element_of;
+template <> struct element_of<char> { static const element_type value = element_type::i8; };
+template <> struct element_of<std::int8_t> { static const element_type value = element_type::i8; };
+template <> struct element_of<std::int32_t> { static const element_type value = element_type::i32; };
+template <> struct element_of<std::uint32_t> { static const element_type value = element_type::u32; };
+template <> struct element_of<std::int64_t> { static const element_type value = element_type::i64; };
+template <> struct element_of<std::uint64_t> { static const element_type value = element_type::u64; };
+template <> struct element_of<float> { static const element_type value = element_type::f32; };
+template <> struct element_of<double> { static const element_type value = element_type::f64; };
+
+// CRC32C (Castagnoli): the SSE4.2 crc32 instruction when the compiler targets it, slicing-by-8 otherwise
+std::uint32_t crc32c(const void* data, std::size_t n, std::uint32_t crc = 0);
+
+inline std::uint64_t align_up(std::uint64_t x) { return (x + kAlign - 1) & ~std::uint64_t(kAlign - 1); }
+
+}
+
+class writer {
+public:
+    // the data is not copied: it has to stay alive until save()
+    template <typename T>
+    void add(const std::string& name, const T* values, std::size_t n)
+    {
+        push(name, detail::element_of<T>::value, column_kind::values, n, values, n * sizeof(T), nullptr);
+    }
+
+    template <typename T>
+    void add(const std::string& name, const std::vector<T>& values)
+    {
+        add(name, values.data(), values.size());
+    }
+
+    // offsets.size() - 1 rows; offsets.back() == values.size()
+    template <typename T>
+    void add_lists(const std::string& name, const std::vector<std::uint64_t>& offsets, const std::vector<T>& values)
+    {
+        if (offsets.empty() || offsets.back() != values.size())
+            throw std::invalid_argument("snapshot::writer: the offsets of " + name + " do not end at the values");
+        push(name, detail::element_of<T>::value, column_kind::lists, offsets.size() - 1, values.data(),
+             values.size() * sizeof(T), offsets.data());
+    }
+
+    // the characters are packed here, the strings themselves may go away
+    void add_strings(const std::string& name, const std::vector<std::string>& values);
+
+    void save(const std::string& path) const;
+
+private:
+    struct pending {
+        std::string name;
+        element_type type;
+        column_kind kind;
+        std::size_t rows;
+        const void* values;
+        std::size_t value_bytes;
+        const std::uint64_t* offsets;
+    };
+
+    void push(const std::string& name, element_type type, column_kind kind, std::size_t rows, const void* values,
+              std::size_t value_bytes, const std::uint64_t* offsets);
+
+    std::vector<pending> columns_;
+    std::vector<std::vector<char>> chars_;          // of add_strings()
+    std::vector<std::vector<std::uint64_t>> owned_offsets_;
+};
+
+// a read only mapping of a whole file (a heap copy where there is no mmap)
+class mapped_file {
+public:
+    explicit mapped_file(const std::string& path);
+    ~mapped_file();
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    mapped_file(const mapped_file&);
+    mapped_file& operator=(const mapped_file&);
+
+    const char* data_;
+    std::size_t size_;
+    bool mapped_;
+};
+
+class file {
+public:
+    explicit file(const std::string& path, verify level = verify::header);
+
+    std::size_t column_count() const { return header_->column_count; }
+    std::vector<std::string> names() const;
+    bool has(const std::string& name) const { return find(name) != nullptr; }
+    std::size_t rows(const std::string& name) const { return static_cast<std::size_t>(entry(name).rows); }
+    std::size_t size_bytes() const { return map_.size(); }
+
+    template <typename T>
+    span<T> values(const std::string& name) const
+    {
+        const detail::column_entry& e = entry(name, detail::element_of<T>::value, column_kind::values);
+        return span<T>(reinterpret_cast<const T*>(map_.data() + e.values_offset), static_cast<std::size_t>(e.rows));
+    }
+
+    template <typename T>
+    list_column<T> lists(const std::string& name) const
+    {
+        const detail::column_entry& e = entry(name, detail::element_of<T>::value, column_kind::lists);
+        return list_column<T>(reinterpret_cast<const std::uint64_t*>(map_.data() + e.offsets_offset),
+                              static_cast<std::size_t>(e.rows), reinterpret_cast<const T*>(map_.data() + e.values_offset));
+    }
+
+    string_column strings(const std::string& name) const;
+
+    // the CRC of every block and the offsets of every list column; throws std::runtime_error
+    void verify_blocks() const;
+
+private:
+    const detail::column_entry* find(const std::string& name) const;
+    const detail::column_entry& entry(const std::string& name) const;
+    const detail::column_entry& entry(const std::string& name, element_type type, column_kind kind) const;
+    [[noreturn]] void fail(const std::string& what) const;
+
+    std::string path_;
+    mapped_file map_;
+    const detail::file_header* header_;
+    const detail::column_entry* directory_;
+};
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_STREAM_SNAPSHOT_H
@@ -1,5 +1,11 @@
 #include "demos.h"
 #include "details.h"
+#include "rope.h"
+#include "interner.h"
+#include "nocase.h"
+#include "small_string.h"
+#include "tokenizer.h"
+#include "utf8.h"
 
 #include <iostream>
 
@@ -29,6 +35,12 @@ void Demos()
     cout << "demos of string" << endl;
 
     details::Run();
+    //ropes::Run();
+    //interning::Run();
+    //nocase::Run();
+    //small_strings::Run();
+    //tokenizing::Run();
+    //utf8::Run();
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef STL_DEMO_STRINGS_HASHING_H
+#define STL_DEMO_STRINGS_HASHING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace strings {
+namespace hashing {
+
+/*
+ * The byte hash shared by the string types of this directory (interner, nocase, small_string).
+ * 每次读 8 个字节做一次乘法，最后用 murmur3 的 fmix64 把熵扩散到所有位上:
+ * 高位和低位都可以直接拿来分片 / 选槽位。
+ * Fold 在混合之前变换每个 8 字节的字 (例如 nocase 的大小写折叠)，结尾不足 8 字节的部分用 0 补齐。
+ */
+
+struct identity {
+    std::uint64_t operator()(std::uint64_t w) const { return w; }
+};
+
+template <typename Fold>
+inline std::uint64_t hash_words(const char* s, std::size_t n, Fold fold)
+{
+    std::uint64_t h = 0x9e3779b97f4a7c15ull ^ (n * 0xff51afd7ed558ccdull);
+    for (; n >= 8; s += 8, n -= 8) {
+        std::uint64_t w;
+        std::memcpy(&w, s, 8);
+        h = (h ^ (fold(w) * 0xc4ceb9fe1a85ec53ull)) * 0x9e3779b97f4a7c15ull;
+        h ^= h >> 29;
+    }
+    if (n > 0) {
+        std::uint64_t w = 0;
+        std::memcpy(&w, s, n);
+        h = (h ^ (fold(w) * 0xc4ceb9fe1a85ec53ull)) * 0x9e3779b97f4a7c15ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+inline std::uint64_t hash_bytes(const char* s, std::size_t n)
+{
+    return hash_words(s, n, identity());
+}
+
+}
+}
+
+#endif //STL_DEMO_STRINGS_HASHING_H
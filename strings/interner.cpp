@@ -0,0 +1,191 @@
+#include "interner.h"
+#include "../algorithms/parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace strings {
+namespace interning {
+
+// the stocks of maps.cpp and the VAT map of stl_basics containers.cc, keyed by string_id
+void same_as_std_demo()
+{
+    interner pool;
+    map<string_id, float, interner::lexicographic_less> stocks{interner::lexicographic_less(pool)};
+    stocks[pool.intern("BASF")] = 369.50;
+    stocks[pool.intern("VW")] = 413.50;
+    stocks[pool.intern("Daimler")] = 819.00;
+    stocks[pool.intern("BMW")] = 834.00;
+    stocks[pool.intern("Siemens")] = 842.20;
+    cout << left;
+    for (const auto& s : stocks) {
+        cout << "stock: " << setw(12) << pool.str(s.first) << "id: " << setw(4) << s.first.value()
+             << "price: " << s.second << endl;
+    }
+    cout << right;
+
+    unordered_map<string_id, float> coll;
+    coll[pool.intern("VAT1")] = 0.16;
+    coll[pool.intern("VAT2")] = 0.07;
+    coll[pool.intern("VAT1")] += 0.03;
+    cout << "VAT difference: " << coll[pool.intern("VAT1")] - coll[pool.intern("VAT2")] << endl;
+
+    cout << "find(\"BMW\"): " << pool.find("BMW").value() << ", find(\"Audi\") found: " << boolalpha
+         << static_cast<bool>(pool.find("Audi")) << endl;
+    const interner::snapshot frozen = pool.freeze();
+    cout << "snapshot of " << frozen.size() << " strings, find(\"VW\"): " << frozen.find("VW").value() << endl;
+}
+
+string symbol(size_t i)
+{
+    // 5 to 16 characters
+    string s = "S" + to_string(i * 2654435761u % 1000003);
+    s.append(i % 12, static_cast<char>('A' + i % 26));
+    return s;
+}
+
+bool cross_check()
+{
+    bool ok = true;
+    interner pool;
+    ok = ok && pool.intern("") && pool.intern("") == pool.intern(string()) && pool.size(pool.intern("")) == 0;
+
+    // every thread interns the same strings in a different order: one id per string
+    const size_t kStrings = 200000;
+    const size_t threads = std::max<size_t>(algorithms::parallel::thread_count(), 4);
+    vector<vector<string_id>> ids(threads, vector<string_id>(kStrings));
+    algorithms::parallel::for_each_chunk(threads, threads, [&] (size_t c, size_t, size_t) {
+        for (size_t k = 0; k < kStrings; ++k) {
+            const size_t i = ((c % 2 ? kStrings - 1 - k : k) + c * 7919) % kStrings;
+            ids[c][i] = pool.intern(symbol(i));
+        }
+    });
+    ok = ok && pool.size() == kStrings + 1;
+    for (size_t c = 1; c < threads; ++c) {
+        ok = ok && ids[c] == ids[0];
+    }
+    vector<string_id> sorted(ids[0]);
+    sort(sorted.begin(), sorted.end());
+    ok = ok && adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+
+    const interner::snapshot frozen = pool.freeze();
+    for (size_t i = 0; i < kStrings; ++i) {
+        const string s = symbol(i);
+        const string_id id = ids[0][i];
+        ok = ok && pool.str(id) == s && pool.find(s) == id && frozen.find(s) == id &&
+             pool.hash(id) == static_cast<uint32_t>(hashing::hash_bytes(s.data(), s.size()));
+    }
+    ok = ok && !pool.find("not interned") && !frozen.find("not interned") && frozen.size() == kStrings + 1;
+
+    // a string interned after freeze() is not in the snapshot
+    const string_id late = pool.intern("late");
+    ok = ok && pool.find("late") == late && !frozen.find("late");
+
+    // lexicographic_less == std::string::operator<
+    vector<string_id> by_text(ids[0].begin(), ids[0].begin() + 1000);
+    sort(by_text.begin(), by_text.end(), interner::lexicographic_less(pool));
+    for (size_t i = 1; i < by_text.size(); ++i) {
+        ok = ok && pool.str(by_text[i - 1]) < pool.str(by_text[i]);
+    }
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+// 4M records over 500K distinct symbols
+void benchmark()
+{
+    const size_t kSymbols = 500000, kRecords = 4000000;
+    mt19937 gen(19);
+    vector<string> records(kRecords);
+    for (auto& r : records) {
+        r = symbol(gen() % kSymbols);
+    }
+
+    unordered_map<string, double> by_string;
+    long long t = time_ms([&] {
+        for (const string& r : records) {
+            by_string[r] += 1;
+        }
+    });
+    cout << "unordered_map<string, double> totals: " << t << " ms" << endl;
+
+    interner pool;
+    vector<string_id> ids(kRecords);
+    t = time_ms([&] {
+        for (size_t i = 0; i < kRecords; ++i) {
+            ids[i] = pool.intern(records[i]);
+        }
+    });
+    cout << "intern " << kRecords << " records: " << t << " ms, " << pool.size() << " distinct, "
+         << pool.arena_bytes() / 1024 << " KB of characters" << endl;
+
+    unordered_map<string_id, double> by_id;
+    t = time_ms([&] {
+        for (string_id id : ids) {
+            by_id[id] += 1;
+        }
+    });
+    cout << "unordered_map<string_id, double> totals: " << t << " ms" << endl;
+    // ids are dense: a plain vector is enough
+    vector<double> dense(pool.size() + 1);
+    t = time_ms([&] {
+        for (string_id id : ids) {
+            dense[id.value()] += 1;
+        }
+    });
+    cout << "vector<double> indexed by id: " << t << " ms, same: " << boolalpha
+         << (by_string[records[7]] == dense[ids[7].value()]) << endl;
+
+    size_t found = 0;
+    t = time_ms([&] {
+        for (const string& r : records) {
+            found += pool.find(r).value() != 0;
+        }
+    });
+    cout << "find() with shard locks: " << t << " ms" << endl;
+    const interner::snapshot frozen = pool.freeze();
+    t = time_ms([&] {
+        for (const string& r : records) {
+            found += frozen.find(r).value() != 0;
+        }
+    });
+    cout << "snapshot::find() without locks: " << t << " ms (" << found << ")" << endl;
+
+    interner shared;
+    const size_t threads = algorithms::parallel::thread_count();
+    t = time_ms([&] {
+        algorithms::parallel::for_each_chunk(kRecords, threads, [&] (size_t, size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) {
+                shared.intern(records[i]);
+            }
+        });
+    });
+    cout << "intern from " << threads << " threads: " << t << " ms" << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
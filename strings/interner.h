@@ -0,0 +1,358 @@
+#ifndef STL_DEMO_STRINGS_INTERNER_H
+#define STL_DEMO_STRINGS_INTERNER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "hashing.h"
+
+namespace strings {
+namespace interning {
+
+/*
+ * String interning: every distinct string is stored once and gets a 32 bit id
+ *
+ * containers/maps.cpp 的 stocks["BASF"] 和 containers.cc 的 coll["VAT1"] 每次查找都要对 key 重新
+ * 计算哈希、逐字节比较。如果同一批 symbol 在几十亿条记录里反复出现，先把字符串换成 string_id:
+ *   - 比较 / 哈希 string_id 都是 O(1)，map<string_id, T> / unordered_map<string_id, T> 的 key 只有 4 个字节
+ *   - 字符本身存放在 interner 的 arena 里 (大块连续内存，从不移动)，每个字符串的哈希值只算一次
+ *
+ *     interner pool;
+ *     string_id basf = pool.intern("BASF");        // 第一次: 存起来，分配新的 id
+ *     assert(pool.intern("BASF") == basf);         // 之后: 同一个 id
+ *     pool.str(basf) == "BASF"
+ *
+ * 线程安全:
+ *   - intern() / find() 按哈希值分到 kShards 个分片上，每个分片一把锁，不同分片上的调用互不等待
+ *   - id -> 字符串 (str / data / size / hash) 不加锁: 条目放在分段数组里，写好以后再也不会移动
+ *   - freeze() 得到一个只读的 snapshot: 所有分片合并成一张扁平的哈希表，find() 完全无锁，
+ *     适合 "先加载全部 symbol，再由很多线程只读查询" 的场景。snapshot 之后新 intern 的字符串它看不到
+ *
+ * string_id() 表示 "没有字符串"，可以当作 find() 失败的返回值；空字符串 "" 也有自己的 id。
+ * string_id 的 < 是按 intern 的先后顺序，不是字典序；需要字典序的时候用 interner::lexicographic_less。
+ * 所有字符串都活到 interner 析构为止，snapshot 不能比它的 interner 活得更久。
+ */
+
+class string_id {
+public:
+    string_id() : value_(0) {}
+    explicit string_id(std::uint32_t value) : value_(value) {}
+
+    std::uint32_t value() const { return value_; }
+    explicit operator bool() const { return value_ != 0; }
+
+    friend bool operator==(string_id a, string_id b) { return a.value_ == b.value_; }
+    friend bool operator!=(string_id a, string_id b) { return a.value_ != b.value_; }
+    friend bool operator<(string_id a, string_id b) { return a.value_ < b.value_; }
+
+private:
+    std::uint32_t value_;
+};
+
+namespace detail {
+
+// what an id stands for
+struct entry {
+    const char* data;
+    std::uint32_t size;
+    std::uint32_t hash;
+};
+
+// open addressing, linear probing. Hash and size are kept in the slot: growing never touches the strings,
+// and a lookup reads the slot and then the characters, nothing in between
+struct slot {
+    std::uint32_t hash;
+    std::uint32_t size;
+    const char* data;  // nullptr: empty
+
+    // the arena stores the id right in front of the characters
+    std::uint32_t id() const
+    {
+        std::uint32_t id;
+        std::memcpy(&id, data - sizeof(id), sizeof(id));
+        return id;
+    }
+};
+
+// the slot that holds s, or the empty slot where s belongs; the table is never full
+inline std::size_t probe(const std::vector<slot>& table, std::uint32_t hash, const char* s, std::size_t n)
+{
+    const std::size_t mask = table.size() - 1;
+    for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+        const slot& sl = table[i];
+        if (!sl.data || (sl.hash == hash && sl.size == n && std::memcmp(sl.data, s, n) == 0))
+            return i;
+    }
+}
+
+inline void insert_slot(std::vector<slot>& table, const slot& sl)
+{
+    const std::size_t mask = table.size() - 1;
+    std::size_t i = sl.hash & mask;
+    while (table[i].data) {
+        i = (i + 1) & mask;
+    }
+    table[i] = sl;
+}
+
+// bump allocator for the characters, each string is stored as [id][chars]; blocks never move
+class arena {
+public:
+    arena() : cursor_(nullptr), left_(0), bytes_(0) {}
+
+    const char* store(std::uint32_t id, const char* s, std::size_t n)
+    {
+        const std::size_t need = sizeof(id) + n;
+        char* p;
+        if (need > left_ && need > kBlock / 4) {
+            // big strings get a block of their own, the current block stays usable
+            blocks_.push_back(std::unique_ptr<char[]>(new char[need]));
+            bytes_ += need;
+            p = blocks_.back().get();
+        } else {
+            if (need > left_) {
+                blocks_.push_back(std::unique_ptr<char[]>(new char[kBlock]));
+                cursor_ = blocks_.back().get();
+                left_ = kBlock;
+                bytes_ += kBlock;
+            }
+            p = cursor_;
+            cursor_ += need;
+            left_ -= need;
+        }
+        std::memcpy(p, &id, sizeof(id));
+        std::memcpy(p + sizeof(id), s, n);
+        return p + sizeof(id);
+    }
+
+    std::size_t bytes() const { return bytes_; }
+
+private:
+    static const std::size_t kBlock = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* cursor_;
+    std::size_t left_;
+    std::size_t bytes_;
+};
+
+}
+
+class interner {
+public:
+    // ids are handed out in segments of 64K entries, there is room for 2^32 - 1 of them
+    static const unsigned kSegmentBits = 16;
+    static const std::size_t kSegmentSize = std::size_t(1) << kSegmentBits;
+    static const std::size_t kSegments = std::size_t(1) << (32 - kSegmentBits);
+    static const std::size_t kShards = 64;
+
+    interner() : next_id_(1), segments_(new std::atomic<detail::entry*>[kSegments])
+    {
+        for (std::size_t i = 0; i < kSegments; ++i) {
+            segments_[i].store(nullptr, std::memory_order_relaxed);
+        }
+        for (std::size_t i = 0; i < kShards; ++i) {
+            shards_[i].table.assign(16, detail::slot());
+        }
+    }
+    ~interner()
+    {
+        for (std::size_t i = 0; i < kSegments; ++i) {
+            delete[] segments_[i].load(std::memory_order_relaxed);
+        }
+    }
+    interner(const interner&) = delete;
+    interner& operator=(const interner&) = delete;
+
+    string_id intern(const char* s, std::size_t n)
+    {
+        const std::uint64_t h = hashing::hash_bytes(s, n);
+        const std::uint32_t h32 = static_cast<std::uint32_t>(h);
+        shard& sh = shards_[(h >> 58) & (kShards - 1)];
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        detail::slot& sl = sh.table[detail::probe(sh.table, h32, s, n)];
+        if (sl.data)
+            return string_id(sl.id());
+
+        const std::uint32_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
+        detail::entry& e = entry_for_writing(id);
+        e.data = sh.bytes.store(id, s, n);
+        e.size = static_cast<std::uint32_t>(n);
+        e.hash = h32;
+        sl.hash = h32;
+        sl.size = e.size;
+        sl.data = e.data;
+        if (++sh.count * 4 > sh.table.size() * 3)
+            grow(sh);
+        return string_id(id);
+    }
+    string_id intern(const std::string& s) { return intern(s.data(), s.size()); }
+    string_id intern(const char* s) { return intern(s, std::strlen(s)); }
+
+    // string_id() if s was never interned
+    string_id find(const char* s, std::size_t n) const
+    {
+        const std::uint64_t h = hashing::hash_bytes(s, n);
+        const shard& sh = shards_[(h >> 58) & (kShards - 1)];
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        const detail::slot& sl = sh.table[detail::probe(sh.table, static_cast<std::uint32_t>(h), s, n)];
+        return sl.data ? string_id(sl.id()) : string_id();
+    }
+    string_id find(const std::string& s) const { return find(s.data(), s.size()); }
+
+    // lock free; id has to come from this interner
+    const char* data(string_id id) const { return entry_of(id.value()).data; }
+    std::size_t size(string_id id) const { return entry_of(id.value()).size; }
+    std::string str(string_id id) const { return std::string(data(id), size(id)); }
+    // the hash of the characters, computed once by intern()
+    std::uint32_t hash(string_id id) const { return entry_of(id.value()).hash; }
+
+    // number of distinct strings
+    std::size_t size() const { return next_id_.load(std::memory_order_acquire) - 1; }
+
+    // memory of the character arenas
+    std::size_t arena_bytes() const
+    {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < kShards; ++i) {
+            std::lock_guard<std::mutex> lock(shards_[i].mutex);
+            total += shards_[i].bytes.bytes();
+        }
+        return total;
+    }
+
+    // read only view of everything interned so far: find() without locks
+    class snapshot {
+    public:
+        string_id find(const char* s, std::size_t n) const
+        {
+            const std::uint32_t h = static_cast<std::uint32_t>(hashing::hash_bytes(s, n));
+            const detail::slot& sl = table_[detail::probe(table_, h, s, n)];
+            return sl.data ? string_id(sl.id()) : string_id();
+        }
+        string_id find(const std::string& s) const { return find(s.data(), s.size()); }
+
+        const char* data(string_id id) const { return owner_->data(id); }
+        std::size_t size(string_id id) const { return owner_->size(id); }
+        std::string str(string_id id) const { return owner_->str(id); }
+        std::size_t size() const { return count_; }
+
+    private:
+        friend class interner;
+        snapshot(const interner* owner, std::size_t count) : owner_(owner), count_(count)
+        {
+            std::size_t cap = 16;
+            while (cap < count * 2) {
+                cap *= 2;
+            }
+            table_.assign(cap, detail::slot());
+        }
+
+        const interner* owner_;
+        std::size_t count_;
+        std::vector<detail::slot> table_;
+    };
+
+    // the shards are locked one after the other; strings interned meanwhile may or may not make it
+    snapshot freeze() const
+    {
+        std::vector<detail::slot> all;
+        for (std::size_t i = 0; i < kShards; ++i) {
+            std::lock_guard<std::mutex> lock(shards_[i].mutex);
+            for (const detail::slot& sl : shards_[i].table) {
+                if (sl.data)
+                    all.push_back(sl);
+            }
+        }
+        snapshot result(this, all.size());
+        for (const detail::slot& sl : all) {
+            detail::insert_slot(result.table_, sl);
+        }
+        return result;
+    }
+
+    // dictionary order of the characters, for std::map<string_id, T, lexicographic_less>
+    class lexicographic_less {
+    public:
+        explicit lexicographic_less(const interner& pool) : pool_(&pool) {}
+        bool operator()(string_id a, string_id b) const
+        {
+            const detail::entry& x = pool_->entry_of(a.value());
+            const detail::entry& y = pool_->entry_of(b.value());
+            const int c = std::memcmp(x.data, y.data, std::min(x.size, y.size));
+            return c < 0 || (c == 0 && x.size < y.size);
+        }
+
+    private:
+        const interner* pool_;
+    };
+
+private:
+    struct shard {
+        mutable std::mutex mutex;
+        std::vector<detail::slot> table;
+        std::size_t count = 0;
+        detail::arena bytes;
+    };
+
+    const detail::entry& entry_of(std::uint32_t id) const
+    {
+        const detail::entry* segment = segments_[id >> kSegmentBits].load(std::memory_order_acquire);
+        return segment[id & (kSegmentSize - 1)];
+    }
+
+    // the first id of a segment allocates it; ids of other shards may race for the same segment
+    detail::entry& entry_for_writing(std::uint32_t id)
+    {
+        std::atomic<detail::entry*>& seg = segments_[id >> kSegmentBits];
+        detail::entry* segment = seg.load(std::memory_order_acquire);
+        if (!segment) {
+            std::lock_guard<std::mutex> lock(segments_mutex_);
+            segment = seg.load(std::memory_order_relaxed);
+            if (!segment) {
+                segment = new detail::entry[kSegmentSize];
+                seg.store(segment, std::memory_order_release);
+            }
+        }
+        return segment[id & (kSegmentSize - 1)];
+    }
+
+    void grow(shard& sh)
+    {
+        std::vector<detail::slot> bigger(sh.table.size() * 2);
+        for (const detail::slot& sl : sh.table) {
+            if (sl.data)
+                detail::insert_slot(bigger, sl);
+        }
+        sh.table.swap(bigger);
+    }
+
+    std::atomic<std::uint32_t> next_id_;
+    std::unique_ptr<std::atomic<detail::entry*>[]> segments_;
+    std::mutex segments_mutex_;
+    shard shards_[kShards];
+};
+
+void Run();
+
+}
+}
+
+namespace std {
+
+template <>
+struct hash<strings::interning::string_id> {
+    std::size_t operator()(strings::interning::string_id id) const { return id.value(); }
+};
+
+}
+
+#endif //STL_DEMO_STRINGS_INTERNER_H
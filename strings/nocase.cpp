@@ -0,0 +1,253 @@
+#include "nocase.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace strings {
+namespace nocase {
+
+// the no_case branch of RuntimeStrCmp in maps.cpp before it used nocase::compare
+bool toupper_less(const string& s1, const string& s2)
+{
+    return lexicographical_compare(s1.begin(), s1.end(), s2.begin(), s2.end(),
+                                   [] (char c1, char c2) { return toupper(c1) < toupper(c2); });
+}
+
+template <typename Map>
+void fill_and_print(Map& coll)
+{
+    coll["Deutschland"] = "Germany";
+    coll["deutsch"] = "German";
+    coll["Haken"] = "snag";
+    coll["arbeiten"] = "work";
+    coll["Hund"] = "dog";
+    coll["gehen"] = "go";
+    coll["Unternehmen"] = "enterprise";
+    coll["unternehmen"] = "undertake";
+    coll["gehen"] = "walk";
+    coll["Bestatter"] = "undertaker";
+    cout << left;
+    for (const auto& elem : coll) {
+        cout << setw(15) << elem.first << " " << elem.second << endl;
+    }
+    cout << right << endl;
+}
+
+ostream& operator<<(ostream& out, const key& k)
+{
+    return out << k.str();
+}
+
+// RunEx() of maps.cpp
+void same_as_std_demo()
+{
+    map<string, string, nocase::less> coll1;
+    fill_and_print(coll1);
+    // the same order, with most comparisons decided by the 8 byte prefix
+    map<key, string> coll2;
+    fill_and_print(coll2);
+
+    unordered_map<string, string, nocase::hash, nocase::equal_to> coll3;
+    coll3["Content-Type"] = "text/html";
+    coll3["content-type"] = "text/plain";
+    cout << "unordered, " << coll3.size() << " element: " << coll3["CONTENT-TYPE"] << endl;
+    cout << "to_upper: " << to_upper("select * from Stocks where name_1 = 'BASF'") << endl;
+}
+
+// ASCII letters, the characters right next to them, and bytes above 0x7f
+string random_text(mt19937& gen, size_t n)
+{
+    static const char kChars[] = "aAzZbYmM@[`{_09\x7f\x80\xe4\xc4\xff";
+    string s(n, ' ');
+    for (auto& c : s) {
+        c = kChars[gen() % (sizeof(kChars) - 1)];
+    }
+    return s;
+}
+
+int sign(int x)
+{
+    return (x > 0) - (x < 0);
+}
+
+// the folded bytes as unsigned char, the same order as std::string
+int reference_compare(const string& a, const string& b)
+{
+    auto up = [] (char c) { return static_cast<unsigned char>(toupper(static_cast<unsigned char>(c))); };
+    for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+        if (up(a[i]) != up(b[i]))
+            return up(a[i]) < up(b[i]) ? -1 : 1;
+    }
+    return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+}
+
+bool cross_check()
+{
+    mt19937 gen(23);
+    bool ok = true;
+    for (int round = 0; round < 20000; ++round) {
+        const string a = random_text(gen, gen() % 80);
+        string b = a;
+        // mostly the same text in another case, with an occasional change somewhere
+        for (auto& c : b) {
+            if (gen() % 2 && isalpha(static_cast<unsigned char>(c)))
+                c = static_cast<char>(c ^ 0x20);
+        }
+        if (gen() % 2 && !b.empty())
+            b[gen() % b.size()] = random_text(gen, 1)[0];
+        if (gen() % 4 == 0)
+            b.resize(gen() % (b.size() + 1));
+
+        const int expected = reference_compare(a, b);
+        ok = ok && sign(compare(a, b)) == expected && sign(compare(b, a)) == -expected;
+        ok = ok && equal(a, b) == (expected == 0) && (expected != 0 || hash()(a) == hash()(b));
+        ok = ok && (key(a) < key(b)) == (expected < 0) && (key(b) < key(a)) == (expected > 0);
+        ok = ok && (key(a) == key(b)) == (expected == 0);
+
+        string upper = a;
+        transform(upper.begin(), upper.end(), upper.begin(), [] (char c) { return static_cast<char>(toupper(static_cast<unsigned char>(c))); });
+        ok = ok && to_upper(a) == upper;
+        // ASCII text orders exactly like the old comparator
+        const string x = random_text(gen, gen() % 20), y = random_text(gen, gen() % 20);
+        if (all_of(x.begin(), x.end(), [] (char c) { return c > 0; }) && all_of(y.begin(), y.end(), [] (char c) { return c > 0; }))
+            ok = ok && toupper_less(x, y) == (compare(x, y) < 0);
+    }
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+// identifiers like "Order_Line_Id" in random case, 200K distinct, 1M lookups
+void benchmark()
+{
+    static const char* kWords[] = {"order", "line", "customer", "id", "name", "date", "total", "price", "item",
+                                   "account", "status", "created", "updated", "key", "value", "type"};
+    mt19937 gen(29);
+    auto identifier = [&] {
+        string s;
+        const size_t words = 2 + gen() % 3;
+        for (size_t w = 0; w < words; ++w) {
+            s += kWords[gen() % 16];
+            s += '_';
+        }
+        s += to_string(gen() % 100000);
+        for (auto& c : s) {
+            if (gen() % 2)
+                c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+        }
+        return s;
+    };
+    vector<string> names(200000), queries(1000000);
+    for (auto& s : names) {
+        s = identifier();
+    }
+    for (auto& q : queries) {
+        q = names[gen() % names.size()];
+        // another case than the one that was inserted
+        char& c = q[gen() % q.size()];
+        if (isalpha(static_cast<unsigned char>(c)))
+            c = static_cast<char>(c ^ 0x20);
+    }
+
+    size_t found = 0;
+    {
+        typedef bool (*cmp)(const string&, const string&);
+        map<string, int, cmp> m(toupper_less);
+        long long t = time_ms([&] {
+            for (size_t i = 0; i < names.size(); ++i) {
+                m[names[i]] = static_cast<int>(i);
+            }
+            for (const string& q : queries) {
+                found += m.count(q);
+            }
+        });
+        cout << "map, toupper comparator: " << t << " ms" << endl;
+    }
+    {
+        map<string, int, nocase::less> m;
+        long long t = time_ms([&] {
+            for (size_t i = 0; i < names.size(); ++i) {
+                m[names[i]] = static_cast<int>(i);
+            }
+            for (const string& q : queries) {
+                found += m.count(q);
+            }
+        });
+        cout << "map, nocase::less: " << t << " ms" << endl;
+    }
+    {
+        map<key, int> m;
+        long long t = time_ms([&] {
+            for (size_t i = 0; i < names.size(); ++i) {
+                m[key(names[i])] = static_cast<int>(i);
+            }
+            for (const string& q : queries) {
+                found += m.count(key(q));
+            }
+        });
+        cout << "map<nocase::key> (prefix): " << t << " ms" << endl;
+    }
+    {
+        unordered_map<string, int> m;
+        long long t = time_ms([&] {
+            for (size_t i = 0; i < names.size(); ++i) {
+                m[to_upper(names[i])] = static_cast<int>(i);
+            }
+            for (const string& q : queries) {
+                found += m.count(to_upper(q));
+            }
+        });
+        cout << "unordered_map of upper case copies: " << t << " ms" << endl;
+    }
+    {
+        unordered_map<string, int, nocase::hash, nocase::equal_to> m;
+        long long t = time_ms([&] {
+            for (size_t i = 0; i < names.size(); ++i) {
+                m[names[i]] = static_cast<int>(i);
+            }
+            for (const string& q : queries) {
+                found += m.count(q);
+            }
+        });
+        cout << "unordered_map, nocase::hash + equal_to: " << t << " ms (" << found << " found)" << endl;
+    }
+
+    vector<string> a(names), b(names);
+    vector<key> k(names.begin(), names.end());
+    long long t = time_ms([&] { sort(a.begin(), a.end(), toupper_less); });
+    cout << "sort, toupper comparator: " << t << " ms" << endl;
+    t = time_ms([&] { sort(b.begin(), b.end(), nocase::less()); });
+    cout << "sort, nocase::less: " << t << " ms" << endl;
+    t = time_ms([&] { sort(k.begin(), k.end()); });
+    cout << "sort of nocase::key: " << t << " ms, same: " << boolalpha
+         << (equal(a.begin(), a.end(), b.begin(), nocase::equal_to()) &&
+             equal(b.begin(), b.end(), k.begin(), [] (const string& x, const key& y) { return nocase::equal(x, y.str()); }))
+         << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
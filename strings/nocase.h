@@ -0,0 +1,206 @@
+#ifndef STL_DEMO_STRINGS_NOCASE_H
+#define STL_DEMO_STRINGS_NOCASE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "../algorithms/simd.h"
+#include "hashing.h"
+
+namespace strings {
+namespace nocase {
+
+/*
+ * ASCII case-insensitive compare / equal / hash
+ *
+ * containers/maps.cpp 的 RuntimeStrCmp::no_case 用 lexicographical_compare + toupper 逐个字符比较:
+ * toupper 要查 locale 的表，每个字符一次函数调用和一个分支。标识符、HTTP 头、SQL 关键字这类 key
+ * 只有 ASCII 的大小写需要忽略，所以这里直接按字节折叠: 'a'..'z' 变成 'A'..'Z'，其它字节原样比较。
+ *   - 16 / 32 字节一组用 SIMD 折叠再比较 (algorithms/simd.h)，剩下的 8 字节一组用 SWAR，最后逐字节
+ *   - 顺序和 toupper 版本一样 (都折叠成大写，所以 '_' < 'a' 和原来一致)；
+ *     0x80 以上的字节按 unsigned char 比较，和 std::string::compare 一致
+ *   - hash() 先折叠再哈希，和 equal() 配套: unordered_map<std::string, T, nocase::hash, nocase::equal_to>
+ *   - key: 一个 std::string 加上预先算好的 8 字节折叠前缀 (big-endian，所以整数比较 = 字典序)。
+ *     map<nocase::key, T> 的大部分比较只比较两个 uint64_t，前缀相同的时候才去比较字符
+ */
+
+namespace detail {
+
+inline unsigned char upper(unsigned char c)
+{
+    return static_cast<unsigned char>(c - ((static_cast<unsigned>(c - 'a') < 26u) << 5));
+}
+
+// eight bytes at once: 'a'..'z' lose 0x20, bytes >= 0x80 are left alone
+inline std::uint64_t upper_word(std::uint64_t x)
+{
+    const std::uint64_t ones = 0x0101010101010101ull;
+    const std::uint64_t high = ones * 0x80;
+    const std::uint64_t low7 = x & ~high;
+    const std::uint64_t ge_a = low7 + ones * (0x80 - 'a');      // high bit: >= 'a'
+    const std::uint64_t gt_z = low7 + ones * (0x80 - 'z' - 1);  // high bit: > 'z'
+    const std::uint64_t lower = (ge_a ^ gt_z) & ~x & high;
+    return x ^ (lower >> 2);
+}
+
+struct fold_upper {
+    std::uint64_t operator()(std::uint64_t w) const { return upper_word(w); }
+};
+
+inline std::uint64_t load_word(const char* p)
+{
+    std::uint64_t w;
+    std::memcpy(&w, p, 8);
+    return w;
+}
+
+#if defined(STL_DEMO_SIMD)
+inline algorithms::simd::reg upper(algorithms::simd::reg x)
+{
+    typedef algorithms::simd::lane<std::int8_t> bytes;
+    using algorithms::simd::and_;
+    // signed compares: bytes >= 0x80 are negative and never in 'a'..'z'
+    const algorithms::simd::reg lower = and_(bytes::gt(x, bytes::set1('a' - 1)), bytes::gt(bytes::set1('z' + 1), x));
+    return algorithms::simd::xor_(x, and_(lower, bytes::set1(0x20)));
+}
+#endif
+
+// first i < n where the folded bytes of a and b differ, n if there is none
+inline std::size_t mismatch(const char* a, const char* b, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    namespace simd = algorithms::simd;
+    for (; i + simd::kBytes <= n; i += simd::kBytes) {
+        const simd::reg x = upper(simd::loadu(a + i)), y = upper(simd::loadu(b + i));
+        const simd::mask_t eq = simd::bytemask(simd::lane<std::int8_t>::eq(x, y));
+        if (eq != simd::all_lanes<std::int8_t>())
+            return i + simd::ctz(~eq);
+    }
+#endif
+    for (; i + 8 <= n; i += 8) {
+        if (upper_word(load_word(a + i)) != upper_word(load_word(b + i)))
+            break;
+    }
+    for (; i < n; ++i) {
+        if (upper(static_cast<unsigned char>(a[i])) != upper(static_cast<unsigned char>(b[i])))
+            return i;
+    }
+    return n;
+}
+
+// the first 8 folded bytes, zero padded, big-endian: a < b as integers means a < b as strings
+inline std::uint64_t prefix_of(const char* s, std::size_t n)
+{
+    std::uint64_t w = 0;
+    std::memcpy(&w, s, std::min<std::size_t>(n, 8));
+    w = upper_word(w);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    w = __builtin_bswap64(w);
+#endif
+    return w;
+}
+
+}
+
+// <0, 0, >0 like std::string::compare, ignoring ASCII case
+inline int compare(const char* a, std::size_t na, const char* b, std::size_t nb)
+{
+    const std::size_t n = std::min(na, nb);
+    const std::size_t i = detail::mismatch(a, b, n);
+    if (i < n)
+        return detail::upper(static_cast<unsigned char>(a[i])) < detail::upper(static_cast<unsigned char>(b[i])) ? -1 : 1;
+    return na < nb ? -1 : (na > nb ? 1 : 0);
+}
+
+inline int compare(const std::string& a, const std::string& b)
+{
+    return compare(a.data(), a.size(), b.data(), b.size());
+}
+
+inline bool equal(const char* a, std::size_t na, const char* b, std::size_t nb)
+{
+    return na == nb && detail::mismatch(a, b, na) == na;
+}
+
+inline bool equal(const std::string& a, const std::string& b)
+{
+    return equal(a.data(), a.size(), b.data(), b.size());
+}
+
+// the hash of the folded bytes: equal() strings hash alike
+inline std::uint64_t hash_bytes(const char* s, std::size_t n)
+{
+    return hashing::hash_words(s, n, detail::fold_upper());
+}
+
+// 'a'..'z' -> 'A'..'Z' in place
+inline void to_upper(char* s, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    namespace simd = algorithms::simd;
+    for (; i + simd::kBytes <= n; i += simd::kBytes) {
+        simd::storeu(s + i, detail::upper(simd::loadu(s + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        s[i] = static_cast<char>(detail::upper(static_cast<unsigned char>(s[i])));
+    }
+}
+
+inline std::string to_upper(std::string s)
+{
+    to_upper(&s[0], s.size());
+    return s;
+}
+
+// function objects for the containers
+struct less {
+    bool operator()(const std::string& a, const std::string& b) const { return compare(a, b) < 0; }
+};
+
+struct equal_to {
+    bool operator()(const std::string& a, const std::string& b) const { return equal(a, b); }
+};
+
+struct hash {
+    std::size_t operator()(const std::string& s) const { return static_cast<std::size_t>(hash_bytes(s.data(), s.size())); }
+};
+
+// a string with its folded prefix, as the key of ordered containers
+class key {
+public:
+    key() : prefix_(0) {}
+    key(const char* s) : text_(s), prefix_(detail::prefix_of(text_.data(), text_.size())) {}
+    key(std::string s) : text_(std::move(s)), prefix_(detail::prefix_of(text_.data(), text_.size())) {}
+
+    const std::string& str() const { return text_; }
+    std::uint64_t prefix() const { return prefix_; }
+
+    friend bool operator<(const key& a, const key& b)
+    {
+        if (a.prefix_ != b.prefix_)
+            return a.prefix_ < b.prefix_;
+        // the first folded bytes are equal, the characters decide from there on
+        const std::size_t skip = std::min<std::size_t>(8, std::min(a.text_.size(), b.text_.size()));
+        return compare(a.text_.data() + skip, a.text_.size() - skip, b.text_.data() + skip, b.text_.size() - skip) < 0;
+    }
+    friend bool operator==(const key& a, const key& b) { return a.prefix_ == b.prefix_ && equal(a.text_, b.text_); }
+    friend bool operator!=(const key& a, const key& b) { return !(a == b); }
+
+private:
+    std::string text_;
+    std::uint64_t prefix_;
+};
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_STRINGS_NOCASE_H
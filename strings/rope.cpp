@@ -0,0 +1,206 @@
+#include "rope.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace strings {
+namespace ropes {
+
+// modify_operations() of details.cpp
+void same_as_std_demo()
+{
+    rope s = "Huang Fan";
+    rope s2 = s;  // a snapshot: only the root is copied
+
+    rope s4 = s.substr(2, 3);
+    cout << "s4: " << s4 << endl;
+
+    rope s5(s2.cbegin(), s2.cbegin() + 5);
+    cout << "s5: " << s5 << endl;
+
+    s.append(" is ").append(string("writing")).push_back('.');
+    cout << "appended: " << s << endl;
+    s.insert(6, "Xiao ");
+    cout << "insert(6, \"Xiao \"): " << s << endl;
+    s.erase(0, 6);
+    cout << "erase(0, 6): " << s << endl;
+    s.replace(s.size() - 8, 7, "reading");
+    cout << "replace: " << s << endl;
+    cout << "s2 is still: " << s2 << endl;
+
+    // 随机访问迭代器，标准算法都能用
+    cout << "count of 'a': " << count(s.begin(), s.end(), 'a') << ", s[3]: " << s[3] << endl;
+
+    try {
+        s.insert(100, "x");
+    } catch (const out_of_range& e) {
+        cout << "out_of_range: " << e.what() << endl;
+    }
+}
+
+bool cross_check()
+{
+    mt19937 gen(17);
+    bool ok = true;
+    for (size_t initial : {0, 10, 1000, 100000}) {
+        string expected(initial, 'a');
+        for (auto& c : expected) {
+            c = static_cast<char>('a' + gen() % 26);
+        }
+        rope r(expected);
+        rope snapshot = r;
+        const string snapshot_text = expected;
+
+        for (int step = 0; step < 3000; ++step) {
+            const size_t pos = expected.empty() ? 0 : gen() % (expected.size() + 1);
+            const size_t op = gen() % 5;
+            if (op <= 1) {
+                // short and long insertions (long ones do not fit into a leaf)
+                string text(op == 0 ? gen() % 20 : 400 + gen() % 2000, 'A' + static_cast<char>(gen() % 26));
+                expected.insert(pos, text);
+                r.insert(pos, text);
+            } else if (op == 2) {
+                const size_t n = gen() % 300;
+                expected.erase(pos, n);
+                r.erase(pos, n);
+            } else if (op == 3) {
+                const size_t n = gen() % 50;
+                expected.replace(pos, n, "<replaced>");
+                r.replace(pos, n, "<replaced>");
+            } else {
+                // a piece of the rope itself, shared
+                const size_t n = gen() % 500;
+                const rope piece = r.substr(pos, n);
+                ok = ok && piece == expected.substr(pos, n);
+                const size_t to = gen() % (expected.size() + 1);
+                expected.insert(to, expected.substr(pos, n));
+                r.insert(to, piece);
+            }
+            if (step % 97 == 0 && !expected.empty()) {
+                const size_t i = gen() % expected.size();
+                ok = ok && r[i] == expected[i] && r.at(i) == expected[i];
+            }
+        }
+        ok = ok && r == expected && r.str() == expected && string(r.begin(), r.end()) == expected;
+        ok = ok && snapshot == snapshot_text;
+
+        // AVL: height <= 1.44 log2(chunks + 2), and there are at most size() chunks
+        ok = ok && r.height() <= 1.45 * log2(r.size() + 2.0) + 1;
+
+        // iterators going backwards and jumping
+        string reversed(r.size(), ' ');
+        reverse_copy(r.begin(), r.end(), reversed.begin());
+        ok = ok && equal(expected.rbegin(), expected.rend(), reversed.begin());
+        if (expected.size() >= 2) {
+            const size_t mid = expected.size() / 2;
+            auto it = r.begin() + mid;
+            ok = ok && *it == expected[mid] && it[-1] == expected[mid - 1] && r.end() - it == static_cast<ptrdiff_t>(expected.size() - mid);
+        }
+    }
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+void benchmark()
+{
+    // a 2 MB template with a ${name} placeholder every 200 characters
+    const size_t kPlaceholders = 10000;
+    const string placeholder = "${name}";
+    string doc;
+    vector<size_t> at;
+    for (size_t i = 0; i < kPlaceholders; ++i) {
+        doc.append(193, static_cast<char>('a' + i % 26));
+        at.push_back(doc.size());
+        doc += placeholder;
+    }
+    const string value = "Huang Fan";
+    cout << "template: " << doc.size() / 1024 << " KB, " << kPlaceholders << " placeholders" << endl;
+
+    string expanded;
+    long long t = time_ms([&] {
+        expanded = doc;
+        size_t shift = 0;
+        for (size_t p : at) {
+            expanded.replace(p + shift, placeholder.size(), value);
+            shift += value.size() - placeholder.size();
+        }
+    });
+    cout << "std::string::replace in place: " << t << " ms" << endl;
+
+    rope r;
+    t = time_ms([&] {
+        r = rope(string(doc));
+        size_t shift = 0;
+        for (size_t p : at) {
+            r.replace(p + shift, placeholder.size(), value);
+            shift += value.size() - placeholder.size();
+        }
+    });
+    cout << "rope::replace: " << t << " ms, height " << r.height() << ", same: " << boolalpha << (r == expanded) << endl;
+
+    // edits in order can simply be appended to a new string, which is O(n) and the fastest of all
+    string rebuilt;
+    t = time_ms([&] {
+        rebuilt.reserve(doc.size() + kPlaceholders * value.size());
+        size_t from = 0;
+        for (size_t p : at) {
+            rebuilt.append(doc, from, p - from).append(value);
+            from = p + placeholder.size();
+        }
+        rebuilt.append(doc, from, string::npos);
+    });
+    cout << "append into a new string (edits in order): " << t << " ms" << endl;
+
+    // random positions: no single pass can do this
+    mt19937 gen(5);
+    vector<size_t> positions(20000);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        positions[i] = gen() % (doc.size() + i * 8);
+    }
+    string s = doc;
+    t = time_ms([&] {
+        for (size_t p : positions) {
+            s.insert(p, "inserted");
+        }
+    });
+    cout << "std::string::insert x 20000 at random: " << t << " ms" << endl;
+    r = rope(string(doc));
+    t = time_ms([&] {
+        for (size_t p : positions) {
+            r.insert(p, "inserted");
+        }
+    });
+    cout << "rope::insert x 20000 at random: " << t << " ms, same: " << (r == s) << endl;
+
+    string flat;
+    t = time_ms([&] { flat = r.str(); });
+    cout << "rope::str() of " << flat.size() / 1024 << " KB: " << t << " ms" << endl;
+    size_t hits = 0;
+    t = time_ms([&] { hits = count(r.begin(), r.end(), 'i'); });
+    cout << "count through the rope iterator: " << t << " ms (" << hits << ")" << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
@@ -0,0 +1,472 @@
+#ifndef STL_DEMO_STRINGS_ROPE_H
+#define STL_DEMO_STRINGS_ROPE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace strings {
+namespace ropes {
+
+/*
+ * rope: a string as a balanced tree of chunks
+ *
+ * details.cpp 里 modify_operations() 演示的 insert / erase / replace 在 std::string 中间做的时候都是 O(n):
+ * 后面所有字符都要挪一遍。一个几 MB 的文档做成千上万次中间编辑 (例如模板展开)，就是 O(n^2)。
+ *
+ * rope 把字符串存成一棵 AVL 树，叶子是一段连续的字符，内部节点只记录子树的长度:
+ *
+ *     Operation                         std::string      rope
+ *     operator[] / at                   O(1)             O(log n)
+ *     insert / erase / replace (中间)    O(n)             O(log n)
+ *     append / push_back                O(1) amortized   O(log n)
+ *     substr                            O(len)           O(log n), 不复制字符
+ *     copy (snapshot)                   O(n)             O(1)
+ *     iterator ++ / --                  O(1)             O(1), 跨叶子时 O(log n)
+ *
+ *   - 节点一旦建好就不再修改，编辑只复制从根到改动处的一条路径 (path copying)，
+ *     所以拷贝一个 rope 只是拷贝根指针，两个副本之后各自编辑互不影响。
+ *     节点不可变，快照可以交给别的线程去读，同时原来的 rope 继续编辑
+ *   - 叶子是某个共享 buffer 里的一段 [offset, offset + size)，所以 split / substr 不复制字符，
+ *     rope(std::string&&) 直接接管字符串的 buffer。代价是一小段叶子会让整个 buffer 一直活着
+ *   - 短的叶子 (合起来不超过 kLeafBytes) 在编辑时会被合并成一个新的叶子，避免树里全是几个字节的碎片
+ *   - const_iterator 是随机访问迭代器，缓存了当前叶子，所以顺序遍历和 std::string 差不多快。
+ *     和 std::string 一样，任何编辑都会让迭代器失效
+ *   - 下标越界的时候和 std::string 一样抛出 std::out_of_range
+ */
+
+namespace detail {
+
+// edits of leaves up to this size copy the leaf instead of splitting it
+static const std::size_t kLeafBytes = 512;
+
+struct node;
+typedef std::shared_ptr<const node> node_ptr;
+
+// leaf (height 0): (*text)[offset, offset + size)
+// inner: left + right, both never null
+struct node {
+    std::size_t size;
+    int height;
+    node_ptr left, right;
+    std::shared_ptr<const std::string> text;
+    std::size_t offset;
+
+    bool is_leaf() const { return height == 0; }
+    const char* chars() const { return text->data() + offset; }
+};
+
+inline node_ptr make_leaf(std::shared_ptr<const std::string> text, std::size_t offset, std::size_t size)
+{
+    if (size == 0)
+        return node_ptr();
+    std::shared_ptr<node> n = std::make_shared<node>();
+    n->size = size;
+    n->height = 0;
+    n->text = std::move(text);
+    n->offset = offset;
+    return n;
+}
+
+inline node_ptr make_leaf(std::string&& text)
+{
+    const std::size_t size = text.size();
+    return make_leaf(std::make_shared<std::string>(std::move(text)), 0, size);
+}
+
+inline node_ptr make_inner(node_ptr l, node_ptr r)
+{
+    std::shared_ptr<node> n = std::make_shared<node>();
+    n->size = l->size + r->size;
+    n->height = 1 + std::max(l->height, r->height);
+    n->left = std::move(l);
+    n->right = std::move(r);
+    n->offset = 0;
+    return n;
+}
+
+// l + r where the heights differ by 2 at most: one single or double rotation restores the AVL balance
+inline node_ptr balance(const node_ptr& l, const node_ptr& r)
+{
+    if (l->height > r->height + 1) {
+        if (l->left->height >= l->right->height)
+            return make_inner(l->left, make_inner(l->right, r));
+        return make_inner(make_inner(l->left, l->right->left), make_inner(l->right->right, r));
+    }
+    if (r->height > l->height + 1) {
+        if (r->right->height >= r->left->height)
+            return make_inner(make_inner(l, r->left), r->right);
+        return make_inner(make_inner(l, r->left->left), make_inner(r->left->right, r->right));
+    }
+    return make_inner(l, r);
+}
+
+// concatenation: walks down the spine of the taller tree until the heights match, O(|h(l) - h(r)|)
+inline node_ptr join(const node_ptr& l, const node_ptr& r)
+{
+    if (!l)
+        return r;
+    if (!r)
+        return l;
+    if (l->is_leaf() && r->is_leaf() && l->size + r->size <= kLeafBytes) {
+        std::string text;
+        text.reserve(l->size + r->size);
+        text.append(l->chars(), l->size).append(r->chars(), r->size);
+        return make_leaf(std::move(text));
+    }
+    if (l->height > r->height + 1)
+        return balance(l->left, join(l->right, r));
+    if (r->height > l->height + 1)
+        return balance(join(l, r->left), r->right);
+    return make_inner(l, r);
+}
+
+// [0, pos) and [pos, size); leaves are cut without copying
+inline std::pair<node_ptr, node_ptr> split(const node_ptr& n, std::size_t pos)
+{
+    if (!n || pos == 0)
+        return std::make_pair(node_ptr(), n);
+    if (pos >= n->size)
+        return std::make_pair(n, node_ptr());
+    if (n->is_leaf())
+        return std::make_pair(make_leaf(n->text, n->offset, pos), make_leaf(n->text, n->offset + pos, n->size - pos));
+    if (pos < n->left->size) {
+        std::pair<node_ptr, node_ptr> p = split(n->left, pos);
+        return std::make_pair(p.first, join(p.second, n->right));
+    }
+    std::pair<node_ptr, node_ptr> p = split(n->right, pos - n->left->size);
+    return std::make_pair(join(n->left, p.first), p.second);
+}
+
+// inserts into the leaf that holds pos when the result still fits into kLeafBytes (null otherwise).
+// heights do not change, so only the path to the leaf is copied
+inline node_ptr insert_in_leaf(const node_ptr& n, std::size_t pos, const char* s, std::size_t len)
+{
+    if (n->is_leaf()) {
+        if (n->size + len > kLeafBytes)
+            return node_ptr();
+        std::string text;
+        text.reserve(n->size + len);
+        text.append(n->chars(), pos).append(s, len).append(n->chars() + pos, n->size - pos);
+        return make_leaf(std::move(text));
+    }
+    // at the boundary the left leaf grows: appends extend the last leaf
+    if (pos <= n->left->size) {
+        node_ptr child = insert_in_leaf(n->left, pos, s, len);
+        return child ? make_inner(child, n->right) : child;
+    }
+    node_ptr child = insert_in_leaf(n->right, pos - n->left->size, s, len);
+    return child ? make_inner(n->left, child) : child;
+}
+
+// the leaf that holds pos < n->size; start is the position of its first character
+inline const node* find_leaf(const node* n, std::size_t pos, std::size_t& start)
+{
+    start = 0;
+    while (!n->is_leaf()) {
+        if (pos < n->left->size) {
+            n = n->left.get();
+        } else {
+            pos -= n->left->size;
+            start += n->left->size;
+            n = n->right.get();
+        }
+    }
+    return n;
+}
+
+template <typename F>
+void for_each_leaf(const node* n, F& f)
+{
+    if (!n)
+        return;
+    if (n->is_leaf()) {
+        f(n->chars(), n->size);
+        return;
+    }
+    for_each_leaf(n->left.get(), f);
+    for_each_leaf(n->right.get(), f);
+}
+
+}
+
+// random access, read only; remembers the leaf under the current position.
+// the leaf is looked up when the iterator moves, not on *it: the algorithms copy iterators all the time
+class rope_iterator {
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef char value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const char* pointer;
+    typedef const char& reference;
+
+    rope_iterator() : root_(nullptr), pos_(0), chunk_(nullptr), chunk_begin_(0), chunk_end_(0) {}
+    rope_iterator(const detail::node* root, std::size_t pos)
+        : root_(root), pos_(pos), chunk_(nullptr), chunk_begin_(0), chunk_end_(0)
+    {
+        settle();
+    }
+
+    reference operator*() const { return chunk_[pos_ - chunk_begin_]; }
+    pointer operator->() const { return &**this; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    rope_iterator& operator++()
+    {
+        ++pos_;
+        settle();
+        return *this;
+    }
+    rope_iterator operator++(int) { rope_iterator tmp(*this); ++*this; return tmp; }
+    rope_iterator& operator--()
+    {
+        --pos_;
+        settle();
+        return *this;
+    }
+    rope_iterator operator--(int) { rope_iterator tmp(*this); --*this; return tmp; }
+    rope_iterator& operator+=(difference_type n)
+    {
+        pos_ += n;
+        settle();
+        return *this;
+    }
+    rope_iterator& operator-=(difference_type n) { return *this += -n; }
+    rope_iterator operator+(difference_type n) const { rope_iterator tmp(*this); return tmp += n; }
+    rope_iterator operator-(difference_type n) const { rope_iterator tmp(*this); return tmp -= n; }
+    friend rope_iterator operator+(difference_type n, const rope_iterator& it) { return it + n; }
+    difference_type operator-(const rope_iterator& other) const
+    {
+        return static_cast<difference_type>(pos_) - static_cast<difference_type>(other.pos_);
+    }
+
+    bool operator==(const rope_iterator& other) const { return pos_ == other.pos_; }
+    bool operator!=(const rope_iterator& other) const { return pos_ != other.pos_; }
+    bool operator<(const rope_iterator& other) const { return pos_ < other.pos_; }
+    bool operator>(const rope_iterator& other) const { return pos_ > other.pos_; }
+    bool operator<=(const rope_iterator& other) const { return pos_ <= other.pos_; }
+    bool operator>=(const rope_iterator& other) const { return pos_ >= other.pos_; }
+
+    std::size_t index() const { return pos_; }
+
+private:
+    // end() and positions before begin() keep the old leaf, they cannot be dereferenced anyway
+    void settle()
+    {
+        if ((pos_ < chunk_begin_ || pos_ >= chunk_end_) && root_ && pos_ < root_->size) {
+            const detail::node* leaf = detail::find_leaf(root_, pos_, chunk_begin_);
+            chunk_ = leaf->chars();
+            chunk_end_ = chunk_begin_ + leaf->size;
+        }
+    }
+
+    const detail::node* root_;
+    std::size_t pos_;
+    const char* chunk_;
+    std::size_t chunk_begin_, chunk_end_;
+};
+
+class rope {
+public:
+    typedef char value_type;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef rope_iterator const_iterator;
+    typedef rope_iterator iterator;
+    static const size_type npos = static_cast<size_type>(-1);
+
+    rope() {}
+    rope(const char* s) : root_(detail::make_leaf(std::string(s))) {}
+    rope(const char* s, size_type n) : root_(detail::make_leaf(std::string(s, n))) {}
+    rope(const std::string& s) : root_(detail::make_leaf(std::string(s))) {}
+    // takes over the buffer of s, no copy
+    rope(std::string&& s) : root_(detail::make_leaf(std::move(s))) {}
+    // shares an existing buffer, e.g. a file that was read once
+    explicit rope(std::shared_ptr<const std::string> text)
+        : root_(text ? detail::make_leaf(text, 0, text->size()) : detail::node_ptr()) {}
+    template <typename InputIterator>
+    rope(InputIterator beg, InputIterator end) : root_(detail::make_leaf(std::string(beg, end))) {}
+
+    size_type size() const { return root_ ? root_->size : 0; }
+    size_type length() const { return size(); }
+    bool empty() const { return !root_; }
+    // 0 for a single chunk; the tree stays AVL balanced, so at most ~1.44 log2(chunks)
+    int height() const { return root_ ? root_->height : -1; }
+
+    char operator[](size_type i) const
+    {
+        size_type start;
+        return detail::find_leaf(root_.get(), i, start)->chars()[i - start];
+    }
+    char at(size_type i) const
+    {
+        if (i >= size())
+            throw std::out_of_range("rope::at");
+        return (*this)[i];
+    }
+    char front() const { return (*this)[0]; }
+    char back() const { return (*this)[size() - 1]; }
+
+    const_iterator begin() const { return const_iterator(root_.get(), 0); }
+    const_iterator end() const { return const_iterator(root_.get(), size()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    rope& insert(size_type pos, const char* s, size_type n)
+    {
+        check(pos, "rope::insert");
+        if (n == 0)
+            return *this;
+        if (root_ && n <= detail::kLeafBytes) {
+            detail::node_ptr edited = detail::insert_in_leaf(root_, pos, s, n);
+            if (edited) {
+                root_ = std::move(edited);
+                return *this;
+            }
+        }
+        return insert_node(pos, detail::make_leaf(std::string(s, n)));
+    }
+    rope& insert(size_type pos, const char* s) { return insert(pos, s, std::strlen(s)); }
+    rope& insert(size_type pos, const std::string& s) { return insert(pos, s.data(), s.size()); }
+    rope& insert(size_type pos, std::string&& s)
+    {
+        check(pos, "rope::insert");
+        if (s.size() <= detail::kLeafBytes)
+            return insert(pos, s.data(), s.size());
+        return insert_node(pos, detail::make_leaf(std::move(s)));
+    }
+    // shares the chunks of r
+    rope& insert(size_type pos, const rope& r)
+    {
+        check(pos, "rope::insert");
+        return insert_node(pos, r.root_);
+    }
+
+    rope& erase(size_type pos = 0, size_type n = npos)
+    {
+        check(pos, "rope::erase");
+        n = std::min(n, size() - pos);
+        std::pair<detail::node_ptr, detail::node_ptr> head = detail::split(root_, pos);
+        root_ = detail::join(head.first, detail::split(head.second, n).second);
+        return *this;
+    }
+
+    rope& replace(size_type pos, size_type n, const char* s, size_type len)
+    {
+        erase(pos, n);
+        return insert(pos, s, len);
+    }
+    rope& replace(size_type pos, size_type n, const char* s) { return replace(pos, n, s, std::strlen(s)); }
+    rope& replace(size_type pos, size_type n, const std::string& s) { return replace(pos, n, s.data(), s.size()); }
+    rope& replace(size_type pos, size_type n, const rope& r)
+    {
+        erase(pos, n);
+        return insert(pos, r);
+    }
+
+    rope& append(const char* s, size_type n) { return insert(size(), s, n); }
+    rope& append(const char* s) { return insert(size(), s); }
+    rope& append(const std::string& s) { return insert(size(), s); }
+    rope& append(std::string&& s) { return insert(size(), std::move(s)); }
+    rope& append(const rope& r) { return insert(size(), r); }
+    rope& operator+=(const char* s) { return append(s); }
+    rope& operator+=(const std::string& s) { return append(s); }
+    rope& operator+=(const rope& r) { return append(r); }
+    rope& operator+=(char c) { return append(&c, 1); }
+    void push_back(char c) { append(&c, 1); }
+
+    // shares the chunks, no characters are copied
+    rope substr(size_type pos = 0, size_type n = npos) const
+    {
+        check(pos, "rope::substr");
+        rope result;
+        result.root_ = detail::split(detail::split(root_, pos).second, n).first;
+        return result;
+    }
+
+    void clear() { root_.reset(); }
+    void swap(rope& other) { root_.swap(other.root_); }
+
+    // f(const char* chars, size_t n) for every chunk, in order
+    template <typename F>
+    void for_each_chunk(F f) const
+    {
+        detail::for_each_leaf(root_.get(), f);
+    }
+
+    std::string str() const
+    {
+        std::string result;
+        result.reserve(size());
+        for_each_chunk([&result] (const char* s, std::size_t n) { result.append(s, n); });
+        return result;
+    }
+
+    int compare(const std::string& s) const
+    {
+        std::size_t pos = 0;
+        int result = 0;
+        for_each_chunk([&] (const char* chars, std::size_t n) {
+            if (result != 0)
+                return;
+            const std::size_t common = std::min(n, s.size() - pos);
+            result = std::memcmp(chars, s.data() + pos, common);
+            if (result == 0 && common < n)
+                result = 1;
+            pos += common;
+        });
+        return result == 0 && pos < s.size() ? -1 : result;
+    }
+
+    friend bool operator==(const rope& a, const rope& b)
+    {
+        return a.size() == b.size() && (a.root_ == b.root_ || std::equal(a.begin(), a.end(), b.begin()));
+    }
+    friend bool operator!=(const rope& a, const rope& b) { return !(a == b); }
+    friend bool operator==(const rope& a, const std::string& b) { return a.size() == b.size() && a.compare(b) == 0; }
+    friend bool operator!=(const rope& a, const std::string& b) { return !(a == b); }
+    friend bool operator==(const std::string& a, const rope& b) { return b == a; }
+    friend bool operator!=(const std::string& a, const rope& b) { return !(b == a); }
+    friend bool operator==(const rope& a, const char* b) { return a == std::string(b); }
+    friend bool operator!=(const rope& a, const char* b) { return !(a == b); }
+
+    friend std::ostream& operator<<(std::ostream& out, const rope& r)
+    {
+        r.for_each_chunk([&out] (const char* s, std::size_t n) { out.write(s, static_cast<std::streamsize>(n)); });
+        return out;
+    }
+
+private:
+    void check(size_type pos, const char* what) const
+    {
+        if (pos > size())
+            throw std::out_of_range(what);
+    }
+
+    rope& insert_node(size_type pos, const detail::node_ptr& n)
+    {
+        std::pair<detail::node_ptr, detail::node_ptr> parts = detail::split(root_, pos);
+        root_ = detail::join(detail::join(parts.first, n), parts.second);
+        return *this;
+    }
+
+    detail::node_ptr root_;
+};
+
+inline void swap(rope& a, rope& b)
+{
+    a.swap(b);
+}
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_STRINGS_ROPE_H
@@ -0,0 +1,238 @@
+#include "small_string.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace strings {
+namespace small_strings {
+
+static_assert(sizeof(small_string24) == 24 && sizeof(small_string32) == 32 && sizeof(small_string64) == 64,
+              "the allocator takes no space");
+
+// size_and_capacity(), searching_and_finding() and comparisons() of details.cpp
+void same_as_std_demo()
+{
+    small_string32 s("Huang Fan");
+    cout << "size: " << s.size() << ", capacity: " << s.capacity() << ", inline: " << boolalpha << s.is_inline() << endl;
+    s.reserve(80);
+    cout << "after reserve(80), capacity: " << s.capacity() << ", inline: " << s.is_inline() << endl;
+    s.shrink_to_fit();
+    cout << "after shrink_to_fit, capacity: " << s.capacity() << ", inline: " << s.is_inline() << endl;
+
+    cout << "find('n'): " << s.find('n') << endl;
+    cout << "rfind('n'): " << s.rfind('n') << endl;
+    cout << "find('n', 5): " << s.find('n', 5) << endl;
+    cout << "find(\"an\"): " << s.find("an") << endl;
+    cout << "find_first_of(\"uvw\"): " << s.find_first_of("uvw") << endl;
+    cout << "substr(5): " << s.substr(5) << ", substr(0, 5): " << s.substr(0, 5) << endl;
+
+    small_string32 a("aabb");
+    const string b = "aabbb";
+    cout << "compare(b): " << a.compare(b) << endl;
+    cout << "compare(3, 2, b): " << a.compare(3, 2, b) << endl;
+    cout << "compare(0, 2, b, 0, 1): " << a.compare(0, 2, b, 0, 1) << endl;
+
+    arena pool;
+    arena_string32 key("/usr/local/share/stl_demo/strings/small_string", arena_allocator<char>(pool));
+    cout << key << " (" << key.size() << " characters in an arena of " << pool.bytes_used() << " bytes)" << endl;
+}
+
+int sign(int x)
+{
+    return (x > 0) - (x < 0);
+}
+
+template <typename S>
+bool same(const S& s, const string& t)
+{
+    return s.size() == t.size() && s.str() == t && s.c_str()[s.size()] == '\0' && s.capacity() >= s.size();
+}
+
+// random edits of a small string and a std::string side by side
+template <typename S>
+bool cross_check_with(mt19937& gen, const typename S::allocator_type& a)
+{
+    static const char kChars[] = "abcab";
+    auto random_text = [&] (size_t n) {
+        string t(n, ' ');
+        for (auto& c : t) {
+            c = kChars[gen() % 5];
+        }
+        return t;
+    };
+    bool ok = true;
+    for (int round = 0; round < 300 && ok; ++round) {
+        S s(a);
+        string t;
+        for (int step = 0; step < 100; ++step) {
+            const size_t pos = gen() % (t.size() + 2);
+            const size_t len = gen() % 12;
+            const string arg = random_text(gen() % (gen() % 4 == 0 ? 100 : 12));
+            try {
+                switch (gen() % 12) {
+                case 0: s.append(arg); t.append(arg); break;
+                case 1: s.insert(pos, arg); t.insert(pos, arg); break;
+                case 2: s.erase(pos, len); t.erase(pos, len); break;
+                case 3: s.replace(pos, len, arg); t.replace(pos, len, arg); break;
+                case 4: s.push_back(arg.empty() ? 'x' : arg[0]); t.push_back(arg.empty() ? 'x' : arg[0]); break;
+                case 5: s.resize(len * 4, 'z'); t.resize(len * 4, 'z'); break;
+                case 6: s.assign(arg); t.assign(arg); break;
+                case 7: s.shrink_to_fit(); t.shrink_to_fit(); break;
+                case 8:
+                    // the argument is a piece of the string itself
+                    if (pos <= t.size()) {
+                        const size_t n = min(len, t.size() - pos);
+                        s.append(s.data() + pos, n);
+                        t.append(t.substr(pos, n));
+                    }
+                    break;
+                case 9: s.reserve(len * 10); break;
+                case 10: { S moved(std::move(s)); ok = ok && s.empty(); s = moved; break; }
+                default: { S copy(s); s = std::move(copy); break; }
+                }
+            } catch (const out_of_range&) {
+                ok = ok && pos > t.size();
+            }
+            ok = ok && same(s, t);
+
+            const string needle = random_text(gen() % 3);
+            const size_t from = gen() % (t.size() + 2);
+            ok = ok && s.find(needle, from) == t.find(needle, from) && s.rfind(needle, from) == t.rfind(needle, from) &&
+                 s.find(kChars[from % 3], from) == t.find(kChars[from % 3], from) &&
+                 s.rfind('c', from) == t.rfind('c', from) &&
+                 s.find_first_of(needle, from) == t.find_first_of(needle, from) &&
+                 s.find_last_of(needle, from) == t.find_last_of(needle, from) &&
+                 s.find_first_not_of(needle, from) == t.find_first_not_of(needle, from) &&
+                 s.find_last_not_of(needle, from) == t.find_last_not_of(needle, from);
+            const string other = random_text(gen() % 20);
+            ok = ok && sign(s.compare(other)) == sign(t.compare(other)) && (s < other) == (t < other) &&
+                 (s == other) == (t == other) && (other <= s) == (other <= t);
+            if (from <= t.size()) {
+                ok = ok && s.substr(from, len) == t.substr(from, len) &&
+                     sign(s.compare(from, len, other)) == sign(t.compare(from, len, other));
+            }
+            ok = ok && hash<S>()(s) == hash<small_string64>()(small_string64(t));
+        }
+    }
+    return ok;
+}
+
+bool cross_check()
+{
+    mt19937 gen(31);
+    arena pool;
+    bool ok = cross_check_with<small_string24>(gen, allocator<char>()) &&
+              cross_check_with<small_string32>(gen, allocator<char>()) &&
+              cross_check_with<small_string64>(gen, allocator<char>()) &&
+              cross_check_with<arena_string32>(gen, arena_allocator<char>(pool));
+
+    // different N compare and hash alike
+    small_string24 x("the same 28 characters, yes!");
+    small_string64 y(x.str());
+    ok = ok && x == y && !(x < y) && x.compare(y) == 0 && !x.is_inline() && y.is_inline() &&
+         hash<small_string24>()(x) == hash<small_string64>()(y);
+
+    // at() of the last position, one past it and npos (i + 1 would wrap around to 0)
+    ok = ok && x.at(x.size() - 1) == '!';
+    for (size_t i : {x.size(), y.size() + 1, small_string24::npos}) {
+        try {
+            x.at(i);
+            ok = false;
+        } catch (const out_of_range&) {
+        }
+    }
+
+    // an odd block size: after 1020 bytes the 8 byte alignment needs more padding than the block has left
+    arena odd(1021);
+    for (size_t n : {200, 200, 200, 200, 200, 20, 8}) {
+        const size_t align = n == 8 ? 8 : 1;
+        char* p = static_cast<char*>(odd.allocate(n, align));
+        ok = ok && reinterpret_cast<uintptr_t>(p) % align == 0;
+        memset(p, 1, n); // outside the block: ASan reports it
+    }
+    arena small_blocks(97);
+    for (int round = 0; round < 1000; ++round) {
+        const size_t n = 1 + gen() % 40, align = size_t(1) << (gen() % 4);
+        char* p = static_cast<char*>(small_blocks.allocate(n, align));
+        ok = ok && reinterpret_cast<uintptr_t>(p) % align == 0;
+        memset(p, 1, n);
+    }
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+// 1M keys of 16 to 40 characters: build, sort, copy, hash lookups
+template <typename S>
+void bench(const char* name, const vector<string>& keys, const typename S::allocator_type& a)
+{
+    size_t found = 0;
+    vector<S> v;
+    v.reserve(keys.size());
+    long long build = time_ms([&] {
+        for (const string& k : keys) {
+            v.push_back(S(k, a));
+        }
+    });
+    long long sorted = time_ms([&] { sort(v.begin(), v.end()); });
+    long long copied = time_ms([&] {
+        vector<S> copy(v);
+        found += copy.size();
+    });
+    unordered_map<S, int> m;
+    long long lookups = time_ms([&] {
+        for (size_t i = 0; i < v.size(); ++i) {
+            m.emplace(v[i], static_cast<int>(i));
+        }
+        for (const S& s : v) {
+            found += m.count(s);
+        }
+    });
+    cout << name << ": build " << build << " ms, sort " << sorted << " ms, copy " << copied
+         << " ms, unordered_map " << lookups << " ms (" << found << ")" << endl;
+}
+
+void benchmark()
+{
+    mt19937 gen(37);
+    vector<string> keys(1000000);
+    for (auto& k : keys) {
+        k.resize(16 + gen() % 25);
+        for (auto& c : k) {
+            c = static_cast<char>('a' + gen() % 26);
+        }
+    }
+
+    bench<string>("std::string", keys, allocator<char>());
+    bench<small_string32>("small_string32", keys, allocator<char>());
+    bench<small_string64>("small_string64", keys, allocator<char>());
+    arena pool;
+    bench<arena_string32>("arena_string32", keys, arena_allocator<char>(pool));
+    cout << "arena: " << pool.bytes_used() / 1024 << " KB used" << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
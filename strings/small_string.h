@@ -0,0 +1,694 @@
+#ifndef STL_DEMO_STRINGS_SMALL_STRING_H
+#define STL_DEMO_STRINGS_SMALL_STRING_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "hashing.h"
+
+namespace strings {
+namespace small_strings {
+
+/*
+ * Small string optimization with a configurable inline capacity
+ *
+ * libstdc++ 的 std::string 只能内联 15 个字符 (sizeof 32)，16 个字符以上的 key 每个都要一次 malloc，
+ * 拷贝 / 析构也都要经过分配器。symbol、路径片段、标识符这类 key 常常是 16~40 个字节，正好落在这个坑里。
+ * basic_small_string<N> 把最多 N 个字符直接放在对象里:
+ *   - small_string24 / small_string32 / small_string64: N = 23 / 31 / 63，sizeof 分别是 24 / 32 / 64
+ *   - 最后一个字节是标志位: 内联的时候存 N - size()，满 N 个字符时它正好是 0，兼作结尾的 '\0'；
+ *     放在堆上的时候是 0xFF，前面的字节存 指针 / size / log2(容量 + 1)
+ *   - 堆上的容量总是 2^k - 1，append / push_back 按两倍增长，shrink_to_fit 放得下的时候会回到内联
+ *   - move 只拷贝 sizeof 个字节 (堆上的缓冲区直接转移)，被 move 的对象变成空串
+ *   - 接口是 std::string 的一个子集: size / capacity / reserve / shrink_to_fit，find / rfind / find_*_of，
+ *     substr，compare (包括 compare(pos, len, str))，append / insert / erase / replace ...
+ *     参数可以是 const char*、std::string 或者任意 N 的 basic_small_string
+ *
+ * 第二个模板参数是分配器。arena_allocator 从一个 arena 里切内存，deallocate 什么也不做，
+ * 所以 arena 上的长字符串适合 "构建一次，之后只读" 的场景 (加载字典、解析一次的配置)，
+ * 反复修改的字符串每次增长都会在 arena 里留下旧的缓冲区。arena 要比它上面的字符串活得更久。
+ *
+ *     arena pool;
+ *     arena_string32 s("a rather long key that does not fit inline", arena_allocator<char>(pool));
+ */
+
+// monotonic memory: 64 KB blocks, released all at once in the destructor
+class arena {
+public:
+    explicit arena(std::size_t block_bytes = 64 * 1024)
+        : block_bytes_(block_bytes), cur_(nullptr), end_(nullptr), used_(0), reserved_(0)
+    {
+    }
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    void* allocate(std::size_t n, std::size_t align = 1)
+    {
+        if (cur_ == nullptr)
+            return refill(n, align);
+        // the padding alone can use up the rest of the block: compare sizes, never form a pointer past end_
+        const std::size_t room = static_cast<std::size_t>(end_ - cur_);
+        const std::size_t pad = padding(cur_, align);
+        if (pad > room || n > room - pad)
+            return refill(n, align);
+        char* p = cur_ + pad;
+        cur_ = p + n;
+        used_ += n;
+        return p;
+    }
+
+    std::size_t bytes_used() const { return used_; }
+    std::size_t bytes_reserved() const { return reserved_; }
+
+private:
+    static std::size_t padding(const char* p, std::size_t align)
+    {
+        const std::uintptr_t x = reinterpret_cast<std::uintptr_t>(p);
+        return static_cast<std::size_t>((align - x % align) % align);
+    }
+
+    static char* align_up(char* p, std::size_t align) { return p + padding(p, align); }
+
+    void* refill(std::size_t n, std::size_t align)
+    {
+        // a big request gets a block of its own and the current block stays in use
+        const bool own = n + align > block_bytes_ / 4;
+        const std::size_t bytes = own ? n + align : block_bytes_;
+        blocks_.emplace_back(new char[bytes]);
+        reserved_ += bytes;
+        char* p = align_up(blocks_.back().get(), align);
+        if (!own) {
+            cur_ = p + n;
+            end_ = blocks_.back().get() + bytes;
+        }
+        used_ += n;
+        return p;
+    }
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    std::size_t block_bytes_;
+    char* cur_;
+    char* end_;
+    std::size_t used_;
+    std::size_t reserved_;
+};
+
+template <typename T>
+class arena_allocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    explicit arena_allocator(arena& a) : arena_(&a) {}
+    template <typename U>
+    arena_allocator(const arena_allocator<U>& other) : arena_(other.get_arena()) {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, std::size_t) {}
+
+    arena* get_arena() const { return arena_; }
+
+    template <typename U>
+    friend bool operator==(const arena_allocator& a, const arena_allocator<U>& b) { return a.arena_ == b.get_arena(); }
+    template <typename U>
+    friend bool operator!=(const arena_allocator& a, const arena_allocator<U>& b) { return a.arena_ != b.get_arena(); }
+
+private:
+    arena* arena_;
+};
+
+template <std::size_t N, typename Alloc>
+class basic_small_string;
+
+namespace detail {
+
+// the characters of any argument: const char*, std::string, basic_small_string<M>
+struct chars {
+    chars(const char* s) : data(s), size(std::strlen(s)) {}
+    chars(const char* s, std::size_t n) : data(s), size(n) {}
+    chars(const std::string& s) : data(s.data()), size(s.size()) {}
+    template <std::size_t M, typename A>
+    chars(const basic_small_string<M, A>& s) : data(s.data()), size(s.size()) {}
+
+    const char* data;
+    std::size_t size;
+};
+
+inline int compare(const char* a, std::size_t na, const char* b, std::size_t nb)
+{
+    const int r = std::memcmp(a, b, std::min(na, nb));
+    if (r != 0)
+        return r;
+    return na < nb ? -1 : (na > nb ? 1 : 0);
+}
+
+inline bool contains(chars set, char c)
+{
+    return set.size != 0 && std::memchr(set.data, c, set.size) != nullptr;
+}
+
+}
+
+template <std::size_t N, typename Alloc = std::allocator<char>>
+class basic_small_string {
+    // pointer + size + log2(capacity + 1) in front of the flag byte
+    static_assert(N >= sizeof(char*) + sizeof(std::size_t) + 1, "the inline buffer must hold the heap fields");
+    static_assert(N < 0xFF, "the flag byte holds N - size()");
+    static_assert(std::is_same<typename Alloc::value_type, char>::value, "Alloc must allocate char");
+
+    typedef std::allocator_traits<Alloc> traits;
+    typedef detail::chars chars;
+
+public:
+    typedef char value_type;
+    typedef std::size_t size_type;
+    typedef char* iterator;
+    typedef const char* const_iterator;
+    typedef Alloc allocator_type;
+
+    static const size_type npos = static_cast<size_type>(-1);
+    static const size_type inline_capacity = N;
+
+    basic_small_string() : s_(Alloc()) { set_inline_size(0); }
+    explicit basic_small_string(const Alloc& a) : s_(a) { set_inline_size(0); }
+    basic_small_string(const char* s, const Alloc& a = Alloc()) : s_(a) { init(s, std::strlen(s)); }
+    basic_small_string(const char* s, size_type n, const Alloc& a = Alloc()) : s_(a) { init(s, n); }
+    basic_small_string(const std::string& s, const Alloc& a = Alloc()) : s_(a) { init(s.data(), s.size()); }
+    basic_small_string(size_type n, char c, const Alloc& a = Alloc()) : s_(a)
+    {
+        set_inline_size(0);
+        append(n, c);
+    }
+    basic_small_string(const basic_small_string& other)
+        : s_(traits::select_on_container_copy_construction(other.alloc()))
+    {
+        init(other.data(), other.size());
+    }
+    basic_small_string(const basic_small_string& other, const Alloc& a) : s_(a) { init(other.data(), other.size()); }
+    // sizeof bytes, whether inline or a heap pointer
+    basic_small_string(basic_small_string&& other) noexcept : s_(other.alloc())
+    {
+        std::memcpy(s_.buf, other.s_.buf, N + 1);
+        other.set_inline_size(0);
+    }
+
+    ~basic_small_string() { release(); }
+
+    basic_small_string& operator=(const basic_small_string& other)
+    {
+        if (this != &other) {
+            if (traits::propagate_on_container_copy_assignment::value) {
+                if (alloc() != other.alloc())
+                    release();
+                alloc() = other.alloc();
+            }
+            assign(other.data(), other.size());
+        }
+        return *this;
+    }
+
+    basic_small_string& operator=(basic_small_string&& other)
+    {
+        if (this != &other) {
+            if (traits::propagate_on_container_move_assignment::value) {
+                if (alloc() != other.alloc())
+                    release();
+                alloc() = other.alloc();
+            }
+            if (other.is_heap() && alloc() == other.alloc()) {
+                release();
+                std::memcpy(s_.buf, other.s_.buf, N + 1);
+                other.set_inline_size(0);
+            } else {
+                assign(other.data(), other.size());
+            }
+        }
+        return *this;
+    }
+
+    basic_small_string& operator=(chars s) { return assign(s); }
+
+    allocator_type get_allocator() const { return alloc(); }
+
+    // -- size and capacity --
+    size_type size() const { return is_heap() ? heap_size() : N - flag(); }
+    size_type length() const { return size(); }
+    bool empty() const { return size() == 0; }
+    size_type max_size() const { return (std::min<size_type>(traits::max_size(alloc()), npos / 2)) - 1; }
+    size_type capacity() const { return is_heap() ? (size_type(1) << heap_log2()) - 1 : N; }
+    bool is_inline() const { return !is_heap(); }
+
+    void reserve(size_type n)
+    {
+        if (n > capacity())
+            move_to(log2_for(n + 1));
+    }
+
+    // back to the inline buffer when the characters fit, otherwise the smallest 2^k - 1
+    void shrink_to_fit()
+    {
+        if (!is_heap())
+            return;
+        const size_type n = size();
+        if (n <= N) {
+            char* p = heap_ptr();
+            const unsigned k = heap_log2();
+            std::memcpy(s_.buf, p, n);
+            set_inline_size(n);
+            traits::deallocate(alloc(), p, size_type(1) << k);
+        } else if (log2_for(n + 1) < heap_log2()) {
+            const unsigned k = log2_for(n + 1);
+            char* p = traits::allocate(alloc(), size_type(1) << k);
+            std::memcpy(p, heap_ptr(), n + 1);
+            release();
+            set_heap(p, n, k);
+        }
+    }
+
+    // -- element access --
+    const char* data() const { return is_heap() ? heap_ptr() : s_.buf; }
+    char* data() { return is_heap() ? heap_ptr() : s_.buf; }
+    const char* c_str() const { return data(); }
+    char& operator[](size_type i) { return data()[i]; }
+    const char& operator[](size_type i) const { return data()[i]; }
+    char& at(size_type i)
+    {
+        if (i >= size())
+            throw std::out_of_range("small_string::at");
+        return data()[i];
+    }
+    const char& at(size_type i) const
+    {
+        if (i >= size())
+            throw std::out_of_range("small_string::at");
+        return data()[i];
+    }
+    char& front() { return data()[0]; }
+    const char& front() const { return data()[0]; }
+    char& back() { return data()[size() - 1]; }
+    const char& back() const { return data()[size() - 1]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + size(); }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size(); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    std::string str() const { return std::string(data(), size()); }
+
+    // -- modifiers, all of them end in replace_impl() --
+    void clear() { set_size(0); }
+
+    basic_small_string& assign(chars s) { return replace_impl(0, size(), s.data, s.size); }
+    basic_small_string& assign(const char* s, size_type n) { return replace_impl(0, size(), s, n); }
+    basic_small_string& append(chars s) { return replace_impl(size(), 0, s.data, s.size); }
+    basic_small_string& append(const char* s, size_type n) { return replace_impl(size(), 0, s, n); }
+    basic_small_string& append(size_type n, char c)
+    {
+        const size_type old = size();
+        reserve_for_append(old + n);
+        std::memset(data() + old, c, n);
+        set_size(old + n);
+        return *this;
+    }
+    basic_small_string& operator+=(chars s) { return append(s); }
+    basic_small_string& operator+=(char c)
+    {
+        push_back(c);
+        return *this;
+    }
+
+    void push_back(char c)
+    {
+        const unsigned char f = flag();
+        if (f != kHeap && f != 0) {
+            // inline with room: the flag byte alone tells the size
+            s_.buf[N - f] = c;
+            set_inline_size(N - f + 1);
+            return;
+        }
+        const size_type n = size();
+        reserve_for_append(n + 1);
+        data()[n] = c;
+        set_size(n + 1);
+    }
+    void pop_back() { set_size(size() - 1); }
+
+    basic_small_string& insert(size_type pos, chars s)
+    {
+        return replace_impl(check(pos, "small_string::insert"), 0, s.data, s.size);
+    }
+    basic_small_string& erase(size_type pos = 0, size_type len = npos)
+    {
+        check(pos, "small_string::erase");
+        return replace_impl(pos, std::min(len, size() - pos), "", 0);
+    }
+    basic_small_string& replace(size_type pos, size_type len, chars s)
+    {
+        check(pos, "small_string::replace");
+        return replace_impl(pos, std::min(len, size() - pos), s.data, s.size);
+    }
+
+    void resize(size_type n, char c = '\0')
+    {
+        if (n <= size())
+            set_size(n);
+        else
+            append(n - size(), c);
+    }
+
+    void swap(basic_small_string& other)
+    {
+        if (traits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc(), other.alloc());
+        }
+        char tmp[N + 1];
+        std::memcpy(tmp, s_.buf, N + 1);
+        std::memcpy(s_.buf, other.s_.buf, N + 1);
+        std::memcpy(other.s_.buf, tmp, N + 1);
+    }
+    friend void swap(basic_small_string& a, basic_small_string& b) { a.swap(b); }
+
+    // -- searching, the same results as std::string --
+    size_type find(char c, size_type pos = 0) const
+    {
+        const size_type n = size();
+        if (pos >= n)
+            return npos;
+        const void* p = std::memchr(data() + pos, c, n - pos);
+        return p ? static_cast<const char*>(p) - data() : npos;
+    }
+    size_type find(chars s, size_type pos = 0) const
+    {
+        const size_type n = size();
+        if (s.size == 0)
+            return pos <= n ? pos : npos;
+        if (pos >= n || s.size > n - pos)
+            return npos;
+        const char* d = data();
+        const char* const last = d + n - s.size;
+        for (const char* p = d + pos; p <= last; ++p) {
+            p = static_cast<const char*>(std::memchr(p, s.data[0], last - p + 1));
+            if (!p)
+                break;
+            if (std::memcmp(p + 1, s.data + 1, s.size - 1) == 0)
+                return p - d;
+        }
+        return npos;
+    }
+    size_type rfind(char c, size_type pos = npos) const
+    {
+        const char* d = data();
+        for (size_type i = std::min(pos, size() - 1) + 1; size() != 0 && i-- > 0;) {
+            if (d[i] == c)
+                return i;
+        }
+        return npos;
+    }
+    size_type rfind(chars s, size_type pos = npos) const
+    {
+        const size_type n = size();
+        if (s.size > n)
+            return npos;
+        const char* d = data();
+        for (size_type i = std::min(pos, n - s.size) + 1; i-- > 0;) {
+            if (std::memcmp(d + i, s.data, s.size) == 0)
+                return i;
+        }
+        return npos;
+    }
+    size_type find_first_of(chars set, size_type pos = 0) const { return scan_forward(set, pos, true); }
+    size_type find_first_not_of(chars set, size_type pos = 0) const { return scan_forward(set, pos, false); }
+    size_type find_last_of(chars set, size_type pos = npos) const { return scan_backward(set, pos, true); }
+    size_type find_last_not_of(chars set, size_type pos = npos) const { return scan_backward(set, pos, false); }
+
+    basic_small_string substr(size_type pos = 0, size_type len = npos) const
+    {
+        check(pos, "small_string::substr");
+        return basic_small_string(data() + pos, std::min(len, size() - pos), alloc());
+    }
+
+    // -- comparisons --
+    int compare(chars s) const { return detail::compare(data(), size(), s.data, s.size); }
+    int compare(size_type pos, size_type len, chars s) const
+    {
+        check(pos, "small_string::compare");
+        return detail::compare(data() + pos, std::min(len, size() - pos), s.data, s.size);
+    }
+    int compare(size_type pos, size_type len, chars s, size_type pos2, size_type len2) const
+    {
+        check(pos, "small_string::compare");
+        if (pos2 > s.size)
+            throw std::out_of_range("small_string::compare");
+        return detail::compare(data() + pos, std::min(len, size() - pos), s.data + pos2, std::min(len2, s.size - pos2));
+    }
+
+    friend bool operator==(const basic_small_string& a, chars b) { return a.size() == b.size && std::memcmp(a.data(), b.data, b.size) == 0; }
+    friend bool operator==(chars a, const basic_small_string& b) { return b == a; }
+    friend bool operator!=(const basic_small_string& a, chars b) { return !(a == b); }
+    friend bool operator!=(chars a, const basic_small_string& b) { return !(b == a); }
+    friend bool operator<(const basic_small_string& a, chars b) { return a.compare(b) < 0; }
+    friend bool operator<(chars a, const basic_small_string& b) { return b.compare(a) > 0; }
+    friend bool operator>(const basic_small_string& a, chars b) { return a.compare(b) > 0; }
+    friend bool operator>(chars a, const basic_small_string& b) { return b.compare(a) < 0; }
+    friend bool operator<=(const basic_small_string& a, chars b) { return a.compare(b) <= 0; }
+    friend bool operator<=(chars a, const basic_small_string& b) { return b.compare(a) >= 0; }
+    friend bool operator>=(const basic_small_string& a, chars b) { return a.compare(b) >= 0; }
+    friend bool operator>=(chars a, const basic_small_string& b) { return b.compare(a) <= 0; }
+
+    friend basic_small_string operator+(const basic_small_string& a, chars b)
+    {
+        basic_small_string r(a);
+        r.append(b);
+        return r;
+    }
+    friend basic_small_string operator+(basic_small_string&& a, chars b)
+    {
+        a.append(b);
+        return std::move(a);
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const basic_small_string& s)
+    {
+        return out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+
+private:
+    static const unsigned char kHeap = 0xFF;
+
+    // the allocator as an empty base: sizeof(small_string32) == 32 with std::allocator
+    struct storage : Alloc {
+        explicit storage(const Alloc& a) : Alloc(a) {}
+        alignas(std::size_t) char buf[N + 1];
+    };
+
+    Alloc& alloc() { return s_; }
+    const Alloc& alloc() const { return s_; }
+
+    unsigned char flag() const { return static_cast<unsigned char>(s_.buf[N]); }
+    bool is_heap() const { return flag() == kHeap; }
+
+    char* heap_ptr() const
+    {
+        char* p;
+        std::memcpy(&p, s_.buf, sizeof(p));
+        return p;
+    }
+    size_type heap_size() const
+    {
+        size_type n;
+        std::memcpy(&n, s_.buf + sizeof(char*), sizeof(n));
+        return n;
+    }
+    unsigned heap_log2() const { return static_cast<unsigned char>(s_.buf[sizeof(char*) + sizeof(size_type)]); }
+
+    void set_heap(char* p, size_type n, unsigned k)
+    {
+        std::memcpy(s_.buf, &p, sizeof(p));
+        std::memcpy(s_.buf + sizeof(char*), &n, sizeof(n));
+        s_.buf[sizeof(char*) + sizeof(size_type)] = static_cast<char>(k);
+        s_.buf[N] = static_cast<char>(kHeap);
+    }
+    // with n == N the flag byte is 0 and terminates the characters
+    void set_inline_size(size_type n)
+    {
+        s_.buf[n] = '\0';
+        s_.buf[N] = static_cast<char>(N - n);
+    }
+    void set_size(size_type n)
+    {
+        if (is_heap()) {
+            std::memcpy(s_.buf + sizeof(char*), &n, sizeof(n));
+            heap_ptr()[n] = '\0';
+        } else {
+            set_inline_size(n);
+        }
+    }
+
+    void init(const char* s, size_type n)
+    {
+        if (n <= N) {
+            std::memcpy(s_.buf, s, n);
+            set_inline_size(n);
+        } else {
+            const unsigned k = log2_for(n + 1);
+            char* p = traits::allocate(alloc(), size_type(1) << k);
+            std::memcpy(p, s, n);
+            p[n] = '\0';
+            set_heap(p, n, k);
+        }
+    }
+
+    void release()
+    {
+        if (is_heap()) {
+            traits::deallocate(alloc(), heap_ptr(), size_type(1) << heap_log2());
+            set_inline_size(0);
+        }
+    }
+
+    static unsigned log2_for(size_type bytes)
+    {
+        unsigned k = 0;
+        while ((size_type(1) << k) < bytes) {
+            ++k;
+        }
+        return k;
+    }
+
+    // the same characters in a new buffer of 2^k bytes
+    void move_to(unsigned k)
+    {
+        const size_type n = size();
+        char* p = traits::allocate(alloc(), size_type(1) << k);
+        std::memcpy(p, data(), n + 1);
+        release();
+        set_heap(p, n, k);
+    }
+
+    void reserve_for_append(size_type n)
+    {
+        if (n > max_size())
+            throw std::length_error("small_string");
+        if (n > capacity())
+            move_to(log2_for(std::max(n + 1, 2 * (capacity() + 1))));
+    }
+
+    size_type check(size_type pos, const char* where) const
+    {
+        if (pos > size())
+            throw std::out_of_range(where);
+        return pos;
+    }
+
+    basic_small_string& replace_impl(size_type pos, size_type len, const char* s, size_type n)
+    {
+        const size_type old = size();
+        if (old - len > max_size() - n)
+            throw std::length_error("small_string");
+        const size_type total = old - len + n;
+        char* d = data();
+        if (total <= capacity()) {
+            // s may point into our own characters, which the memmove below shifts
+            std::less<const char*> before;
+            if (n != 0 && !before(s, d) && before(s, d + old)) {
+                const std::string copy(s, n);
+                return replace_impl(pos, len, copy.data(), n);
+            }
+            std::memmove(d + pos + n, d + pos + len, old - pos - len);
+            std::memcpy(d + pos, s, n);
+            set_size(total);
+            return *this;
+        }
+        // the new buffer is filled before the old one is released, so s may alias it
+        const unsigned k = log2_for(std::max(total + 1, 2 * (capacity() + 1)));
+        char* p = traits::allocate(alloc(), size_type(1) << k);
+        std::memcpy(p, d, pos);
+        std::memcpy(p + pos, s, n);
+        std::memcpy(p + pos + n, d + pos + len, old - pos - len);
+        p[total] = '\0';
+        release();
+        set_heap(p, total, k);
+        return *this;
+    }
+
+    size_type scan_forward(chars set, size_type pos, bool in) const
+    {
+        const char* d = data();
+        for (size_type i = pos, n = size(); i < n; ++i) {
+            if (detail::contains(set, d[i]) == in)
+                return i;
+        }
+        return npos;
+    }
+    size_type scan_backward(chars set, size_type pos, bool in) const
+    {
+        const char* d = data();
+        if (size() == 0)
+            return npos;
+        for (size_type i = std::min(pos, size() - 1) + 1; i-- > 0;) {
+            if (detail::contains(set, d[i]) == in)
+                return i;
+        }
+        return npos;
+    }
+
+    storage s_;
+};
+
+template <std::size_t N, typename Alloc>
+const typename basic_small_string<N, Alloc>::size_type basic_small_string<N, Alloc>::npos;
+template <std::size_t N, typename Alloc>
+const typename basic_small_string<N, Alloc>::size_type basic_small_string<N, Alloc>::inline_capacity;
+
+// two small strings, same or different N: an exact match beats the conversions to chars above
+template <std::size_t N, typename A, std::size_t M, typename B>
+bool operator==(const basic_small_string<N, A>& a, const basic_small_string<M, B>& b) { return a == detail::chars(b); }
+template <std::size_t N, typename A, std::size_t M, typename B>
+bool operator!=(const basic_small_string<N, A>& a, const basic_small_string<M, B>& b) { return a != detail::chars(b); }
+template <std::size_t N, typename A, std::size_t M, typename B>
+bool operator<(const basic_small_string<N, A>& a, const basic_small_string<M, B>& b) { return a.compare(b) < 0; }
+template <std::size_t N, typename A, std::size_t M, typename B>
+bool operator>(const basic_small_string<N, A>& a, const basic_small_string<M, B>& b) { return a.compare(b) > 0; }
+template <std::size_t N, typename A, std::size_t M, typename B>
+bool operator<=(const basic_small_string<N, A>& a, const basic_small_string<M, B>& b) { return a.compare(b) <= 0; }
+template <std::size_t N, typename A, std::size_t M, typename B>
+bool operator>=(const basic_small_string<N, A>& a, const basic_small_string<M, B>& b) { return a.compare(b) >= 0; }
+
+typedef basic_small_string<23> small_string24;
+typedef basic_small_string<31> small_string32;
+typedef basic_small_string<63> small_string64;
+typedef basic_small_string<31, arena_allocator<char>> arena_string32;
+
+void Run();
+
+}
+}
+
+namespace std {
+
+// the same hash for every N and allocator
+template <std::size_t N, typename Alloc>
+struct hash<strings::small_strings::basic_small_string<N, Alloc>> {
+    std::size_t operator()(const strings::small_strings::basic_small_string<N, Alloc>& s) const
+    {
+        return static_cast<std::size_t>(strings::hashing::hash_bytes(s.data(), s.size()));
+    }
+};
+
+}
+
+#endif //STL_DEMO_STRINGS_SMALL_STRING_H
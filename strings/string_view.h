@@ -0,0 +1,194 @@
+#ifndef STL_DEMO_STRINGS_STRING_VIEW_H
+#define STL_DEMO_STRINGS_STRING_VIEW_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#include "hashing.h"
+
+namespace strings {
+namespace views {
+
+/*
+ * A C++11 stand-in for std::string_view (C++17): a pointer and a length, never owning the characters
+ *
+ * details.cpp 里的 substr() 每次都要拷贝出一个新的 std::string。string_view 只记录 "从哪里开始、有多长"，
+ * substr / remove_prefix / remove_suffix 都是 O(1)，不分配内存。tokenizer 切出来的每一个字段都是 string_view。
+ *   - 接口和 std::string 的只读部分一样: find / rfind / find_first_of / find_first_not_of / substr / compare
+ *   - 不保证以 '\0' 结尾，需要 C 字符串或者 std::string 的时候用 str() 拷贝一份
+ *   - 被引用的字符串必须比 string_view 活得更久
+ */
+
+class string_view {
+public:
+    typedef char value_type;
+    typedef std::size_t size_type;
+    typedef const char* iterator;
+    typedef const char* const_iterator;
+
+    static const size_type npos = static_cast<size_type>(-1);
+
+    string_view() : data_(""), size_(0) {}
+    string_view(const char* s) : data_(s), size_(std::strlen(s)) {}
+    string_view(const char* s, size_type n) : data_(s), size_(n) {}
+    string_view(const std::string& s) : data_(s.data()), size_(s.size()) {}
+
+    const char* data() const { return data_; }
+    size_type size() const { return size_; }
+    size_type length() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const char* begin() const { return data_; }
+    const char* end() const { return data_ + size_; }
+    const char& operator[](size_type i) const { return data_[i]; }
+    const char& front() const { return data_[0]; }
+    const char& back() const { return data_[size_ - 1]; }
+
+    std::string str() const { return std::string(data_, size_); }
+    explicit operator std::string() const { return str(); }
+
+    void remove_prefix(size_type n)
+    {
+        data_ += n;
+        size_ -= n;
+    }
+    void remove_suffix(size_type n) { size_ -= n; }
+
+    string_view substr(size_type pos = 0, size_type n = npos) const
+    {
+        if (pos > size_)
+            throw std::out_of_range("string_view::substr");
+        return string_view(data_ + pos, std::min(n, size_ - pos));
+    }
+
+    bool starts_with(string_view s) const { return size_ >= s.size_ && std::memcmp(data_, s.data_, s.size_) == 0; }
+    bool ends_with(string_view s) const
+    {
+        return size_ >= s.size_ && std::memcmp(data_ + size_ - s.size_, s.data_, s.size_) == 0;
+    }
+
+    // without the given characters at both ends ("  a b " -> "a b" for " ")
+    string_view trim(string_view set = " \t\r\n") const
+    {
+        const size_type b = find_first_not_of(set);
+        if (b == npos)
+            return string_view(data_ + size_, 0);
+        return string_view(data_ + b, find_last_not_of(set) + 1 - b);
+    }
+
+    size_type find(char c, size_type pos = 0) const
+    {
+        if (pos >= size_)
+            return npos;
+        const void* p = std::memchr(data_ + pos, c, size_ - pos);
+        return p ? static_cast<const char*>(p) - data_ : npos;
+    }
+    size_type find(string_view s, size_type pos = 0) const
+    {
+        if (s.size_ == 0)
+            return pos <= size_ ? pos : npos;
+        for (size_type i = find(s.data_[0], pos); i != npos && s.size_ <= size_ - i; i = find(s.data_[0], i + 1)) {
+            if (std::memcmp(data_ + i + 1, s.data_ + 1, s.size_ - 1) == 0)
+                return i;
+        }
+        return npos;
+    }
+    size_type rfind(char c, size_type pos = npos) const
+    {
+        for (size_type i = size_ == 0 ? 0 : std::min(pos, size_ - 1) + 1; i-- > 0;) {
+            if (data_[i] == c)
+                return i;
+        }
+        return npos;
+    }
+    size_type rfind(string_view s, size_type pos = npos) const
+    {
+        if (s.size_ > size_)
+            return npos;
+        for (size_type i = std::min(pos, size_ - s.size_) + 1; i-- > 0;) {
+            if (std::memcmp(data_ + i, s.data_, s.size_) == 0)
+                return i;
+        }
+        return npos;
+    }
+    size_type find_first_of(string_view set, size_type pos = 0) const
+    {
+        for (size_type i = pos; i < size_; ++i) {
+            if (set.find(data_[i]) != npos)
+                return i;
+        }
+        return npos;
+    }
+    size_type find_first_not_of(string_view set, size_type pos = 0) const
+    {
+        for (size_type i = pos; i < size_; ++i) {
+            if (set.find(data_[i]) == npos)
+                return i;
+        }
+        return npos;
+    }
+    size_type find_last_of(string_view set, size_type pos = npos) const
+    {
+        for (size_type i = size_ == 0 ? 0 : std::min(pos, size_ - 1) + 1; i-- > 0;) {
+            if (set.find(data_[i]) != npos)
+                return i;
+        }
+        return npos;
+    }
+    size_type find_last_not_of(string_view set, size_type pos = npos) const
+    {
+        for (size_type i = size_ == 0 ? 0 : std::min(pos, size_ - 1) + 1; i-- > 0;) {
+            if (set.find(data_[i]) == npos)
+                return i;
+        }
+        return npos;
+    }
+
+    int compare(string_view s) const
+    {
+        const int r = std::memcmp(data_, s.data_, std::min(size_, s.size_));
+        if (r != 0)
+            return r;
+        return size_ < s.size_ ? -1 : (size_ > s.size_ ? 1 : 0);
+    }
+
+    friend bool operator==(string_view a, string_view b)
+    {
+        return a.size_ == b.size_ && std::memcmp(a.data_, b.data_, a.size_) == 0;
+    }
+    friend bool operator!=(string_view a, string_view b) { return !(a == b); }
+    friend bool operator<(string_view a, string_view b) { return a.compare(b) < 0; }
+    friend bool operator>(string_view a, string_view b) { return a.compare(b) > 0; }
+    friend bool operator<=(string_view a, string_view b) { return a.compare(b) <= 0; }
+    friend bool operator>=(string_view a, string_view b) { return a.compare(b) >= 0; }
+
+    friend std::ostream& operator<<(std::ostream& out, string_view s)
+    {
+        return out.write(s.data_, static_cast<std::streamsize>(s.size_));
+    }
+
+private:
+    const char* data_;
+    size_type size_;
+};
+
+}
+}
+
+namespace std {
+
+template <>
+struct hash<strings::views::string_view> {
+    std::size_t operator()(strings::views::string_view s) const
+    {
+        return static_cast<std::size_t>(strings::hashing::hash_bytes(s.data(), s.size()));
+    }
+};
+
+}
+
+#endif //STL_DEMO_STRINGS_STRING_VIEW_H
@@ -0,0 +1,262 @@
+#include "tokenizer.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace strings {
+
+namespace views {
+const string_view::size_type string_view::npos;
+}
+
+namespace tokenizing {
+
+// the records of HPP_MAP.md: the slot, junction and link formats
+void same_as_std_demo()
+{
+    const string slot = "9000|9002|1|POLYGON((-4.96760919|-4.88976726|0,-6.14617265|-10.01724132|0,"
+                        "-8.5914249|-9.6041403|0,-7.204628|-4.4503746|0,-4.96760919|-4.88976726|0))";
+    const vector<string_view> fields = split(slot, '|').limit(4).to_vector();
+    cout << "slot " << fields[0] << ", link " << fields[1] << ", entryLine " << fields[2] << endl;
+    string_view polygon = fields[3];
+    polygon.remove_prefix(polygon.find("((") + 2);
+    polygon.remove_suffix(2);
+    for (string_view point : split(polygon, ',')) {
+        cout << "  (";
+        for (string_view coordinate : split(point, '|')) {
+            cout << " " << strtod(coordinate.str().c_str(), nullptr);
+        }
+        cout << " )" << endl;
+    }
+
+    const string junction = "9000|9002;9003|7.9767389|0.210041";
+    const vector<string_view> j = split(junction, '|').to_vector();
+    cout << "junction " << j[0] << ", links:";
+    for (string_view link : split(j[1], ';')) {
+        cout << " " << link;
+    }
+    cout << ", x " << j[2] << ", y " << j[3] << endl;
+
+    // the istream_iterator way of adapters.cpp reads words, split() of a character set does the same without copies
+    const string text = "  once \tupon a\ttime  ";
+    istringstream in(text);
+    cout << "istream_iterator:";
+    for (istream_iterator<string> it(in), eof; it != eof; ++it) {
+        cout << " [" << *it << "]";
+    }
+    cout << endl << "any_of(\" \\t\"):  ";
+    for (string_view word : split(text, any_of(" \t")).skip_empty()) {
+        cout << " [" << word << "]";
+    }
+    cout << endl << "split(\"std::chrono::steady_clock\", \"::\"):";
+    for (string_view part : split("std::chrono::steady_clock", "::")) {
+        cout << " [" << part << "]";
+    }
+    cout << endl;
+}
+
+// std::string::find / substr, the copying way
+vector<string> reference_split(const string& s, const string& delimiters, bool any, size_t limit, bool skip_empty)
+{
+    vector<string> out;
+    size_t start = 0;
+    for (;;) {
+        size_t i = string::npos;
+        if (limit == 0 || out.size() + 1 < limit)
+            i = any ? s.find_first_of(delimiters, start) : (delimiters.empty() ? string::npos : s.find(delimiters, start));
+        const string piece = s.substr(start, i == string::npos ? string::npos : i - start);
+        if (!skip_empty || !piece.empty())
+            out.push_back(piece);
+        if (i == string::npos)
+            break;
+        start = i + (any ? 1 : delimiters.size());
+    }
+    return out;
+}
+
+template <typename Range>
+bool same(const Range& r, const vector<string>& expected)
+{
+    vector<string> pieces;
+    for (string_view v : r) {
+        pieces.push_back(v.str());
+    }
+    return pieces == expected;
+}
+
+bool cross_check()
+{
+    mt19937 gen(41);
+    bool ok = true;
+    // long texts too, so that the SIMD blocks and the scalar tails both find delimiters
+    static const char kChars[] = "ab|,;:: \t";
+    for (int round = 0; round < 20000; ++round) {
+        string s(gen() % (round % 10 == 0 ? 300 : 40), ' ');
+        for (auto& c : s) {
+            c = kChars[gen() % (sizeof(kChars) - 1)];
+        }
+        const size_t limit = gen() % 4 == 0 ? gen() % 5 : 0;
+        const bool skip = gen() % 3 == 0;
+        const char c = "|,;: "[gen() % 5];
+
+        split_range<by_char> r1 = split(s, c);
+        r1 = limit ? r1.limit(limit) : r1;
+        ok = ok && same(skip ? r1.skip_empty() : r1, reference_split(s, string(1, c), true, limit, skip));
+
+        const string set = string("|,;: \tab").substr(gen() % 4, 1 + gen() % 4);
+        split_range<any_of> r2 = split(s, any_of(set));
+        r2 = limit ? r2.limit(limit) : r2;
+        ok = ok && same(skip ? r2.skip_empty() : r2, reference_split(s, set, true, limit, skip));
+        // more than 8 characters: the table only
+        ok = ok && same(split(s, any_of("abcdefgh|,")), reference_split(s, "abcdefgh|,", true, 0, false));
+
+        const string delimiter = string("::|a,b").substr(gen() % 3, gen() % 4);
+        split_range<by_string> r3 = split(s, by_string(delimiter));
+        r3 = limit ? r3.limit(limit) : r3;
+        ok = ok && same(skip ? r3.skip_empty() : r3, reference_split(s, delimiter, false, limit, skip));
+    }
+
+    // the string_view members against std::string
+    for (int round = 0; round < 5000; ++round) {
+        string s(gen() % 30, ' ');
+        for (auto& ch : s) {
+            ch = "abc"[gen() % 3];
+        }
+        const string_view v(s);
+        const string needle = string("abcab").substr(gen() % 3, gen() % 3);
+        const size_t pos = gen() % (s.size() + 2);
+        ok = ok && v.find(needle, pos) == s.find(needle, pos) && v.rfind(needle, pos) == s.rfind(needle, pos) &&
+             v.find('b', pos) == s.find('b', pos) && v.rfind('c', pos) == s.rfind('c', pos) &&
+             v.find_first_of(needle, pos) == s.find_first_of(needle, pos) &&
+             v.find_first_not_of(needle, pos) == s.find_first_not_of(needle, pos) &&
+             v.find_last_of(needle, pos) == s.find_last_of(needle, pos) &&
+             v.find_last_not_of(needle, pos) == s.find_last_not_of(needle, pos) &&
+             (v.compare(needle) < 0) == (s.compare(needle) < 0) && (v == string_view(needle)) == (s == needle);
+        if (pos <= s.size())
+            ok = ok && v.substr(pos, 3).str() == s.substr(pos, 3);
+    }
+    ok = ok && string_view(" \t a b \n").trim() == "a b" && string_view("   ").trim().empty();
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+// 500K link records "id|fjcid|tjcid|width|LINESTRING(x|y|z,...)", every field down to the coordinates
+void benchmark()
+{
+    mt19937 gen(43);
+    vector<string> lines(500000);
+    for (auto& line : lines) {
+        ostringstream out;
+        out << 9000 + gen() % 1000 << '|' << 9000 + gen() % 1000 << '|' << 9000 + gen() % 1000 << '|' << gen() % 300
+            << "|LINESTRING(";
+        const size_t points = 2 + gen() % 6;
+        for (size_t p = 0; p < points; ++p) {
+            out << (p ? "," : "") << (gen() % 100000) / 1000.0 << '|' << (gen() % 100000) / 1000.0 << "|0";
+        }
+        out << ')';
+        line = out.str();
+    }
+
+    size_t total = 0;
+    long long t = time_ms([&] {
+        for (const string& line : lines) {
+            istringstream in(line);
+            string field;
+            for (int f = 0; f < 4 && getline(in, field, '|'); ++f) {
+                total += field.size();
+            }
+            getline(in, field);
+            istringstream points(field);
+            string point;
+            while (getline(points, point, ',')) {
+                istringstream coordinates(point);
+                string coordinate;
+                while (getline(coordinates, coordinate, '|')) {
+                    total += coordinate.size();
+                }
+            }
+        }
+    });
+    cout << "getline on istringstream: " << t << " ms (" << total << ")" << endl;
+
+    total = 0;
+    t = time_ms([&] {
+        for (const string& line : lines) {
+            const vector<string> fields = reference_split(line, "|", true, 5, false);
+            for (size_t f = 0; f < 4; ++f) {
+                total += fields[f].size();
+            }
+            for (const string& point : reference_split(fields[4], ",", true, 0, false)) {
+                for (const string& coordinate : reference_split(point, "|", true, 0, false)) {
+                    total += coordinate.size();
+                }
+            }
+        }
+    });
+    cout << "std::string find + substr: " << t << " ms (" << total << ")" << endl;
+
+    total = 0;
+    t = time_ms([&] {
+        for (const string& line : lines) {
+            size_t f = 0;
+            for (string_view field : split(line, '|').limit(5)) {
+                if (++f < 5) {
+                    total += field.size();
+                    continue;
+                }
+                for (string_view point : split(field, ',')) {
+                    for (string_view coordinate : split(point, '|')) {
+                        total += coordinate.size();
+                    }
+                }
+            }
+        }
+    });
+    cout << "split() of string_views: " << t << " ms (" << total << ")" << endl;
+
+    // a long text, words separated by blanks and tabs
+    string text;
+    for (size_t i = 0; i < 4000000; ++i) {
+        text.append(1 + gen() % 12, 'a' + gen() % 26);
+        text += gen() % 8 ? ' ' : '\t';
+    }
+    size_t words = 0;
+    t = time_ms([&] {
+        istringstream in(text);
+        words += distance(istream_iterator<string>(in), istream_iterator<string>());
+    });
+    cout << "istream_iterator<string> words: " << t << " ms (" << words << ")" << endl;
+    words = 0;
+    t = time_ms([&] {
+        for (string_view w : split(text, any_of(" \t")).skip_empty()) {
+            words += !w.empty();
+        }
+    });
+    cout << "split(any_of(\" \\t\")) words: " << t << " ms (" << words << ")" << endl;
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
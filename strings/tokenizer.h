@@ -0,0 +1,272 @@
+#ifndef STL_DEMO_STRINGS_TOKENIZER_H
+#define STL_DEMO_STRINGS_TOKENIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../algorithms/simd.h"
+#include "../algorithms/search_kernels.h"
+#include "string_view.h"
+
+namespace strings {
+namespace tokenizing {
+
+/*
+ * Zero-copy splitting: the fields of a line as string_views into the line itself
+ *
+ *     for (string_view field : split(line, '|'))                  // 单个字符
+ *     for (string_view word : split(text, any_of(" \t")).skip_empty())  // 字符集合，跳过空字段
+ *     for (string_view part : split(path, "::"))                  // 多个字符组成的分隔符
+ *
+ * split() 返回的是一个 "惰性" 的 range: 不分配内存，也不预先切好所有字段，迭代器每前进一步才去找下一个分隔符。
+ *   - 找分隔符用 SIMD: by_char 每次比较 16 / 32 个字节 (algorithms/simd.h)，any_of 对每个字符广播比较再 OR，
+ *     字符多于 8 个的时候用 256 项的表；by_string 用 search_kernels 的首尾字符过滤 (SIMD) 再逐字节确认
+ *   - 和 Python 的 str.split(sep) 一样: "a,,b" -> "a", "", "b"；"" -> 一个空字段；"a," -> "a", ""
+ *   - skip_empty(): 丢掉空字段 (按空白切单词)
+ *   - limit(n): 最多切出 n 个字段，最后一个字段是剩下的全部内容。HPP_MAP.md 的 Slot / Link 记录里
+ *     几何字段 POLYGON((x|y|z,...)) 内部也用 '|'，它总是最后一个字段，所以 split(line, '|').limit(4)
+ *     就能拿到完整的几何字段，再对它 split(',') 得到点、split('|') 得到坐标
+ *
+ * 切出来的 string_view 指向原来的字符串，原字符串必须活得比它们久；range 要比它的迭代器活得久
+ * (range-for 里的临时 range 没有问题)。
+ */
+
+using views::string_view;
+
+namespace detail {
+
+// first i < n with p[i] == c, n if there is none. One register per step: fields are short,
+// so there is no unrolling to amortize and nothing is read past p + n
+inline std::size_t find_char(const char* p, std::size_t n, char c)
+{
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    namespace simd = algorithms::simd;
+    typedef simd::lane<char> L;
+    const simd::reg v = L::set1(c);
+    for (; i + simd::kBytes <= n; i += simd::kBytes) {
+        const simd::mask_t m = simd::bytemask(L::eq(simd::loadu(p + i), v));
+        if (m)
+            return i + simd::ctz(m);
+    }
+#endif
+    for (; i < n; ++i) {
+        if (p[i] == c)
+            return i;
+    }
+    return n;
+}
+
+}
+
+// -- delimiters: find(p, n) is the index of the next delimiter (n if none), length() its size --
+
+class by_char {
+public:
+    by_char(char c) : c_(c) {}
+    std::size_t find(const char* p, std::size_t n) const { return detail::find_char(p, n, c_); }
+    std::size_t length() const { return 1; }
+
+private:
+    char c_;
+};
+
+// any one character of a set
+class any_of {
+public:
+    explicit any_of(string_view set) : size_(set.size() < kBroadcast ? set.size() : kBroadcast), table_()
+    {
+        std::memcpy(set_, set.data(), size_);
+        for (char c : set) {
+            table_[static_cast<unsigned char>(c)] = true;
+        }
+        if (set.size() > kBroadcast)
+            size_ = 0;
+    }
+
+    std::size_t find(const char* p, std::size_t n) const
+    {
+        std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+        namespace simd = algorithms::simd;
+        typedef simd::lane<char> L;
+        if (size_ != 0 && n >= simd::kBytes) {
+            simd::reg needles[kBroadcast];
+            for (std::size_t j = 0; j < size_; ++j) {
+                needles[j] = L::set1(set_[j]);
+            }
+            for (; i + simd::kBytes <= n; i += simd::kBytes) {
+                const simd::reg x = simd::loadu(p + i);
+                simd::reg hit = L::eq(x, needles[0]);
+                for (std::size_t j = 1; j < size_; ++j) {
+                    hit = simd::or_(hit, L::eq(x, needles[j]));
+                }
+                const simd::mask_t m = simd::bytemask(hit);
+                if (m)
+                    return i + simd::ctz(m);
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            if (table_[static_cast<unsigned char>(p[i])])
+                return i;
+        }
+        return n;
+    }
+    std::size_t length() const { return 1; }
+
+private:
+    // up to 8 characters are compared one register each, larger sets only use the table
+    static const std::size_t kBroadcast = 8;
+
+    char set_[kBroadcast];
+    std::size_t size_;
+    bool table_[256];
+};
+
+// a delimiter of one or more characters: "::", "\r\n", " -> ". An empty one never matches
+class by_string {
+public:
+    by_string(const char* s) : s_(s) {}
+    by_string(string_view s) : s_(s) {}
+
+    std::size_t find(const char* p, std::size_t n) const
+    {
+        if (s_.empty())
+            return n;
+        if (s_.size() == 1)
+            return detail::find_char(p, n, s_[0]);
+        return algorithms::search_kernels::detail::search(p, n, s_.data(), s_.size());
+    }
+    std::size_t length() const { return s_.size(); }
+
+private:
+    string_view s_;
+};
+
+template <typename Delimiter>
+class split_range {
+public:
+    class iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef string_view value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const string_view* pointer;
+        typedef const string_view& reference;
+
+        iterator() : range_(nullptr), next_(nullptr), left_(0) {}
+
+        reference operator*() const { return piece_; }
+        pointer operator->() const { return &piece_; }
+
+        iterator& operator++()
+        {
+            advance();
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator old(*this);
+            advance();
+            return old;
+        }
+
+        // pieces start at strictly increasing positions, the end iterator has no range
+        friend bool operator==(const iterator& a, const iterator& b)
+        {
+            return a.range_ == b.range_ && (a.range_ == nullptr || a.piece_.data() == b.piece_.data());
+        }
+        friend bool operator!=(const iterator& a, const iterator& b) { return !(a == b); }
+
+    private:
+        friend class split_range;
+
+        explicit iterator(const split_range* range)
+            : range_(range), next_(range->text_.data()), left_(range->limit_)
+        {
+            advance();
+        }
+
+        void advance()
+        {
+            const char* const end = range_->text_.end();
+            do {
+                if (next_ == nullptr) {
+                    range_ = nullptr;
+                    return;
+                }
+                const std::size_t rest = static_cast<std::size_t>(end - next_);
+                const std::size_t i = left_ == 1 ? rest : range_->delimiter_.find(next_, rest);
+                piece_ = string_view(next_, i);
+                // after the last piece next_ is null: "a," still has the empty piece after ','
+                next_ = i == rest ? nullptr : next_ + i + range_->delimiter_.length();
+            } while (range_->skip_empty_ && piece_.empty());
+            if (left_ > 1)
+                --left_;
+        }
+
+        const split_range* range_;
+        const char* next_;
+        std::size_t left_;
+        string_view piece_;
+    };
+    typedef iterator const_iterator;
+
+    split_range(string_view text, const Delimiter& delimiter)
+        : text_(text), delimiter_(delimiter), limit_(0), skip_empty_(false)
+    {
+    }
+
+    // at most n pieces, the last one runs to the end of the text
+    split_range limit(std::size_t n) const
+    {
+        split_range r(*this);
+        r.limit_ = n;
+        return r;
+    }
+    split_range skip_empty() const
+    {
+        split_range r(*this);
+        r.skip_empty_ = true;
+        return r;
+    }
+
+    iterator begin() const { return iterator(this); }
+    iterator end() const { return iterator(); }
+
+    std::vector<string_view> to_vector() const { return std::vector<string_view>(begin(), end()); }
+
+private:
+    string_view text_;
+    Delimiter delimiter_;
+    std::size_t limit_; // 0: no limit
+    bool skip_empty_;
+};
+
+inline split_range<by_char> split(string_view text, char delimiter)
+{
+    return split_range<by_char>(text, by_char(delimiter));
+}
+
+inline split_range<by_string> split(string_view text, const char* delimiter)
+{
+    return split_range<by_string>(text, by_string(delimiter));
+}
+
+template <typename Delimiter>
+split_range<Delimiter> split(string_view text, const Delimiter& delimiter)
+{
+    return split_range<Delimiter>(text, delimiter);
+}
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_STRINGS_TOKENIZER_H
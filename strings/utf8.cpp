@@ -0,0 +1,257 @@
+#include "utf8.h"
+
+#include <chrono>
+#include <codecvt>
+#include <iomanip>
+#include <iostream>
+#include <locale>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace strings {
+namespace utf8 {
+
+const size_t validator::npos;
+
+// wstring_convert with the codecvt facets of <codecvt>, the only conversion C++11 has
+void same_as_std_demo()
+{
+    const string text = "Huang Fan \xe9\xbb\x84\xe5\xb8\x86, 10 \xe2\x82\xac, \xf0\x9d\x84\x9e";
+    wstring_convert<codecvt_utf8_utf16<char16_t>, char16_t> to16;
+    wstring_convert<codecvt_utf8<char32_t>, char32_t> to32;
+    cout << text << endl;
+    cout << "bytes: " << text.size() << ", code points: " << count_code_points(text) << " / "
+         << to32.from_bytes(text).size() << ", UTF-16 units: " << utf16_length(text) << " / "
+         << to16.from_bytes(text).size() << endl;
+    cout << "to_utf16 == wstring_convert: " << boolalpha << (to_utf16(text) == to16.from_bytes(text))
+         << ", to_utf32 == wstring_convert: " << (to_utf32(text) == to32.from_bytes(text))
+         << ", back: " << (to_utf8(to_utf16(text)) == text && to_utf8(to_wstring(text)) == text) << endl;
+
+    // "caf\xe9" is Latin-1, not UTF-8
+    const string latin1 = "caf\xe9 au lait";
+    cout << "valid: " << is_valid(latin1) << ", first invalid byte at " << find_invalid(latin1) << endl;
+    try {
+        to_utf16(latin1);
+    } catch (const range_error& e) {
+        cout << "strict: " << e.what() << endl;
+    }
+    try {
+        to16.from_bytes(latin1);
+    } catch (const range_error& e) {
+        cout << "wstring_convert: " << e.what() << endl;
+    }
+    cout << "replace: " << to_utf8(to_utf16(latin1, errors::replace)) << endl;
+}
+
+// the rules of Table 3-7 one by one: the length from the lead byte, then overlong / surrogate / range checks
+size_t reference_find_invalid(const string& s)
+{
+    size_t i = 0;
+    while (i < s.size()) {
+        const unsigned char b = s[i];
+        const size_t len = b < 0x80 ? 1 : (b >> 5) == 6 ? 2 : (b >> 4) == 14 ? 3 : (b >> 3) == 30 ? 4 : 0;
+        if (len == 0 || i + len > s.size())
+            return i;
+        char32_t cp = len == 1 ? b : b & (0x7F >> len);
+        for (size_t k = 1; k < len; ++k) {
+            const unsigned char c = s[i + k];
+            if ((c & 0xC0) != 0x80)
+                return i;
+            cp = (cp << 6) | (c & 0x3F);
+        }
+        static const char32_t kMin[] = {0, 0, 0x80, 0x800, 0x10000};
+        if (cp < kMin[len] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+            return i;
+        i += len;
+    }
+    return s.size();
+}
+
+string encode(char32_t cp)
+{
+    return to_utf8(u32string(1, cp));
+}
+
+// mostly valid text of every length class, now and then a corrupted, truncated or stray byte
+string random_text(mt19937& gen, size_t n)
+{
+    static const char32_t kRanges[][2] = {{0x20, 0x7E}, {0x80, 0x7FF}, {0x800, 0xD7FF}, {0xE000, 0xFFFF}, {0x10000, 0x10FFFF}};
+    string s;
+    while (s.size() < n) {
+        const unsigned r = gen() % 8;
+        if (r < 3) {
+            s.append(1 + gen() % 40, static_cast<char>('a' + gen() % 26));
+        } else {
+            const char32_t* range = kRanges[gen() % 5];
+            s += encode(range[0] + gen() % (range[1] - range[0] + 1));
+        }
+    }
+    const unsigned damage = gen() % 4;
+    for (unsigned d = 0; d < damage && !s.empty(); ++d) {
+        switch (gen() % 4) {
+        case 0: s[gen() % s.size()] = static_cast<char>(0x80 + gen() % 0x80); break;
+        case 1: s.resize(s.size() - 1); break;
+        case 2: s.insert(gen() % s.size(), 1, "\xc0\xc1\xf5\xff\xed\xe0\xf0\xf4"[gen() % 8]); break;
+        default: s[gen() % s.size()] = static_cast<char>(gen()); break;
+        }
+    }
+    return s;
+}
+
+bool cross_check()
+{
+    bool ok = true;
+    // Table 3-8 of the Unicode standard: one U+FFFD per maximal subpart
+    const string table38 = "\x61\xF1\x80\x80\xE1\x80\xC2\x62\x80\x63\x80\xBF\x64";
+    ok = ok && to_utf32(table38, errors::replace) == U"a���b�c��d";
+    // the boundaries of every rule
+    ok = ok && is_valid("\x7f\xc2\x80\xdf\xbf\xe0\xa0\x80\xed\x9f\xbf\xee\x80\x80\xf0\x90\x80\x80\xf4\x8f\xbf\xbf");
+    for (const char* bad : {"\xc1\xbf", "\xe0\x9f\xbf", "\xed\xa0\x80", "\xf0\x8f\xbf\xbf", "\xf4\x90\x80\x80", "\xf5", "\x80"}) {
+        ok = ok && !is_valid(bad) && find_invalid(bad) == 0;
+    }
+
+    mt19937 gen(47);
+    wstring_convert<codecvt_utf8_utf16<char16_t>, char16_t> to16;
+    for (int round = 0; round < 20000; ++round) {
+        const string s = random_text(gen, gen() % (round % 10 == 0 ? 2000 : 60));
+        const size_t bad = reference_find_invalid(s);
+        ok = ok && find_invalid(s) == bad && is_valid(s) == (bad == s.size());
+
+        if (bad == s.size()) {
+            const u16string u16 = to_utf16(s);
+            const u32string u32 = to_utf32(s);
+            ok = ok && u16 == to16.from_bytes(s) && u32.size() == count_code_points(s) && u16.size() == utf16_length(s) &&
+                 to_utf8(u16) == s && to_utf8(u32) == s && to_utf8(to_wstring(s)) == s &&
+                 to_utf16(s, errors::replace) == u16;
+        } else {
+            try {
+                to_utf16(s);
+                ok = false;
+            } catch (const range_error& e) {
+                ok = ok && string(e.what()).find("offset " + to_string(bad)) != string::npos;
+            }
+            // the replaced text is valid and keeps every valid sequence before the first error
+            const string fixed = to_utf8(to_utf32(s, errors::replace));
+            ok = ok && is_valid(fixed) && fixed.compare(0, bad, s, 0, bad) == 0 && fixed.find("\xef\xbf\xbd") != string::npos;
+        }
+
+        // the same input in random chunks
+        validator v;
+        decoder d(errors::replace);
+        u32string streamed;
+        for (size_t pos = 0; pos < s.size();) {
+            const size_t len = min<size_t>(s.size() - pos, gen() % 7);
+            v.feed(string_view(s.data() + pos, len));
+            d.decode(string_view(s.data() + pos, len), streamed);
+            pos += len;
+        }
+        d.finish(streamed);
+        ok = ok && v.finish() == (bad == s.size()) && (bad == s.size() || v.error_offset() == bad) &&
+             streamed == to_utf32(s, errors::replace);
+
+        decoder strict;
+        u16string out;
+        size_t pos = 0;
+        try {
+            for (; pos < s.size(); pos += 3) {
+                strict.decode(string_view(s.data() + pos, min<size_t>(3, s.size() - pos)), out);
+            }
+            strict.finish(out);
+            ok = ok && bad == s.size() && out == to_utf16(s);
+        } catch (const range_error& e) {
+            ok = ok && bad < s.size() && string(e.what()).find("offset " + to_string(bad)) != string::npos;
+        }
+    }
+
+    // unpaired surrogates and values past U+10FFFF on the way back
+    ok = ok && to_utf8(u16string(1, 0xD800) + u"x", errors::replace) == "\xef\xbf\xbdx" &&
+         to_utf8(u32string(1, 0x110000), errors::replace) == "\xef\xbf\xbd";
+    try {
+        to_utf8(u"a" + u16string(1, 0xDC00));
+        ok = false;
+    } catch (const range_error&) {
+    }
+    return ok;
+}
+
+template <typename F>
+long long time_ms(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
+void benchmark()
+{
+    mt19937 gen(53);
+    const size_t kBytes = 32 << 20;
+    // ASCII with a few accented letters, Chinese with ASCII punctuation, and emoji heavy text
+    string latin, cjk, mixed;
+    while (latin.size() < kBytes) {
+        latin.append(1 + gen() % 80, static_cast<char>('a' + gen() % 26));
+        latin += encode(0xE0 + gen() % 32);
+    }
+    while (cjk.size() < kBytes) {
+        cjk += encode(0x4E00 + gen() % 0x5000);
+        if (gen() % 10 == 0)
+            cjk += ", ";
+    }
+    while (mixed.size() < kBytes) {
+        const unsigned r = gen() % 4;
+        mixed += r == 0 ? encode(0x1F600 + gen() % 80) : r == 1 ? encode(0x400 + gen() % 0x100) : string(1 + gen() % 8, 'x');
+    }
+
+    const struct {
+        const char* name;
+        const string* text;
+    } inputs[] = {{"mostly ASCII", &latin}, {"Chinese", &cjk}, {"emoji / Cyrillic / ASCII", &mixed}};
+    for (const auto& in : inputs) {
+        const string& s = *in.text;
+        cout << in.name << ", " << s.size() / (1 << 20) << " MB:" << endl;
+        size_t r1 = 0, r2 = 0, n16 = 0, n32 = 0;
+        long long t = time_ms([&] { r1 = reference_find_invalid(s); });
+        cout << "  validate, one sequence at a time: " << t << " ms" << endl;
+        t = time_ms([&] { r2 = find_invalid(s); });
+        cout << "  validate, SIMD ASCII + DFA: " << t << " ms, same: " << boolalpha << (r1 == r2) << endl;
+        t = time_ms([&] { n32 = count_code_points(s); });
+        cout << "  count_code_points: " << t << " ms (" << n32 << ")" << endl;
+
+        wstring_convert<codecvt_utf8_utf16<char16_t>, char16_t> to16;
+        u16string a, b;
+        t = time_ms([&] { a = to16.from_bytes(s); });
+        cout << "  wstring_convert<codecvt_utf8_utf16> from_bytes: " << t << " ms" << endl;
+        t = time_ms([&] { b = to_utf16(s); });
+        n16 = b.size();
+        cout << "  to_utf16: " << t << " ms, same: " << (a == b) << " (" << n16 << " units)" << endl;
+        string back1, back2;
+        t = time_ms([&] { back1 = to16.to_bytes(b); });
+        cout << "  wstring_convert to_bytes: " << t << " ms" << endl;
+        t = time_ms([&] { back2 = to_utf8(b); });
+        cout << "  to_utf8(u16string): " << t << " ms, same: " << (back1 == back2 && back2 == s) << endl;
+
+        decoder d;
+        u32string streamed;
+        t = time_ms([&] {
+            for (size_t pos = 0; pos < s.size(); pos += 65536) {
+                d.decode(string_view(s.data() + pos, min<size_t>(65536, s.size() - pos)), streamed);
+            }
+            d.finish(streamed);
+        });
+        cout << "  decoder, 64 KB chunks to u32string: " << t << " ms, same: " << (streamed.size() == n32) << endl;
+    }
+}
+
+void Run()
+{
+    same_as_std_demo();
+    cout << "cross check: " << boolalpha << cross_check() << endl;
+    benchmark();
+}
+
+}
+}
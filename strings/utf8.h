@@ -0,0 +1,563 @@
+#ifndef STL_DEMO_STRINGS_UTF8_H
+#define STL_DEMO_STRINGS_UTF8_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "../algorithms/simd.h"
+#include "string_view.h"
+
+namespace strings {
+namespace utf8 {
+
+/*
+ * UTF-8 validation, counting and transcoding to / from UTF-16 and UTF-32
+ *
+ * demos.cpp 列出了 wstring / u16string / u32string，可是 C++11 里它们和 UTF-8 之间的转换只有
+ * wstring_convert + codecvt_utf8 / codecvt_utf8_utf16 (C++17 里已经 deprecated)，而且每个字符都要走一遍虚函数。
+ *   - find_invalid / is_valid: 纯 ASCII 的部分用 SIMD 每次检查 16 / 32 个字节 (最高位都是 0 就跳过)，
+ *     其它部分用一个 "shift DFA": 每个字节查一次表，状态就是 64 位表项里的位移，没有分支。
+ *     Unicode 的全部规则都在状态机里: 不允许 overlong、代理区 (U+D800..U+DFFF) 和 U+10FFFF 以上的码点
+ *   - count_code_points / utf16_length: 数不是续字节 (0x80..0xBF) 的字节，SIMD 比较 + popcount
+ *   - to_utf16 / to_utf32 / to_wstring 和反方向的 to_utf8: ASCII 一整块直接展开，其它逐个序列解码
+ *   - errors::strict 遇到非法序列抛 std::range_error (和 wstring_convert 一样)，位置写在 what() 里；
+ *     errors::replace 把每个 "maximal subpart" 换成一个 U+FFFD (Unicode 推荐的做法，和浏览器一致)
+ *   - decoder / validator: 分块输入 (网络、文件按块读)，被块边界切断的序列留到下一块再拼起来
+ *
+ * wstring 在 Linux 上是 UTF-32 (wchar_t 4 个字节)，在 Windows 上是 UTF-16，to_wstring 按 sizeof(wchar_t) 选择。
+ */
+
+using views::string_view;
+
+enum class errors { strict, replace };
+
+namespace detail {
+
+// -- the validating DFA: a state is the bit offset of its 6 bit field in the table entries --
+const unsigned kAccept = 0;
+const unsigned kError = 6;
+const unsigned kTail1 = 12;  // one continuation byte to go
+const unsigned kTail2 = 18;  // two to go
+const unsigned kE0 = 24;     // after E0: A0..BF (no overlong)
+const unsigned kED = 30;     // after ED: 80..9F (no surrogates)
+const unsigned kF0 = 36;     // after F0: 90..BF (no overlong)
+const unsigned kTail3 = 42;  // after F1..F3
+const unsigned kF4 = 48;     // after F4: 80..8F (nothing above U+10FFFF)
+
+struct dfa {
+    dfa()
+    {
+        for (unsigned b = 0; b < 256; ++b) {
+            std::uint64_t row = 0;
+            set(row, kAccept, b < 0x80 ? kAccept : b < 0xC2 ? kError : b < 0xE0 ? kTail1 : b == 0xE0 ? kE0
+                              : b == 0xED ? kED : b < 0xF0 ? kTail2 : b == 0xF0 ? kF0 : b < 0xF4 ? kTail3
+                              : b == 0xF4 ? kF4 : kError);
+            set(row, kError, kError);
+            const bool cont = b >= 0x80 && b <= 0xBF;
+            set(row, kTail1, cont ? kAccept : kError);
+            set(row, kTail2, cont ? kTail1 : kError);
+            set(row, kE0, b >= 0xA0 && b <= 0xBF ? kTail1 : kError);
+            set(row, kED, b >= 0x80 && b <= 0x9F ? kTail1 : kError);
+            set(row, kF0, b >= 0x90 && b <= 0xBF ? kTail2 : kError);
+            set(row, kTail3, cont ? kTail2 : kError);
+            set(row, kF4, b >= 0x80 && b <= 0x8F ? kTail2 : kError);
+            table[b] = row;
+        }
+    }
+    static void set(std::uint64_t& row, unsigned state, unsigned next) { row |= static_cast<std::uint64_t>(next) << state; }
+
+    std::uint64_t table[256];
+};
+
+inline const std::uint64_t* dfa_table()
+{
+    static const dfa d;
+    return d.table;
+}
+
+inline unsigned step(const std::uint64_t* table, unsigned state, unsigned char b)
+{
+    return static_cast<unsigned>(table[b] >> state) & 63;
+}
+
+// the number of leading ASCII bytes of s[0, n)
+inline std::size_t ascii_prefix(const unsigned char* s, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(STL_DEMO_SIMD)
+    namespace simd = algorithms::simd;
+    for (; i + simd::kBytes <= n; i += simd::kBytes) {
+        // movemask collects the high bit of every byte
+        const simd::mask_t m = simd::bytemask(simd::loadu(s + i));
+        if (m)
+            return i + simd::ctz(m);
+    }
+#endif
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t w;
+        std::memcpy(&w, s + i, 8);
+        if (w & 0x8080808080808080ull)
+            break;
+    }
+    for (; i < n; ++i) {
+        if (s[i] >= 0x80)
+            return i;
+    }
+    return n;
+}
+
+const std::size_t kCarried = static_cast<std::size_t>(-1); // "the sequence began in an earlier chunk"
+
+// the DFA over s[0, n) from `state`, ASCII runs skipped whenever a sequence is complete. Stops early
+// in kError; `safe` is the last offset seen in kAccept (kCarried if there was none)
+inline unsigned run(const unsigned char* s, std::size_t n, unsigned state, std::size_t& safe)
+{
+    const std::uint64_t* table = dfa_table();
+    const std::size_t kBlock = 16;
+    safe = state == kAccept ? 0 : kCarried;
+    std::size_t i = 0;
+    while (i < n) {
+        if (state == kAccept) {
+            safe = i;
+            i += ascii_prefix(s + i, n - i);
+            if (i == n)
+                break;
+            safe = i;
+        }
+        // a block without checks: kError is absorbing
+        const std::size_t end = i + std::min(n - i, kBlock);
+        for (; i < end; ++i) {
+            state = step(table, state, s[i]);
+        }
+        if (state == kError)
+            break;
+    }
+    return state;
+}
+
+// byte by byte from s[from] in `state`: where the failing sequence starts (seq_start while inside the open one),
+// n if nothing fails and the last sequence is complete
+inline std::size_t locate(const unsigned char* s, std::size_t n, std::size_t from, unsigned state, std::size_t seq_start)
+{
+    const std::uint64_t* table = dfa_table();
+    for (std::size_t i = from; i < n; ++i) {
+        if (state == kAccept)
+            seq_start = i;
+        state = step(table, state, s[i]);
+        if (state == kError)
+            return seq_start;
+    }
+    return state == kAccept ? n : seq_start;
+}
+
+// -- decoding one sequence: the same rules, written out for the code point --
+
+// > 0: the length of a valid sequence, its code point in cp. 0: valid so far, cut off by the end of s.
+// < 0: minus the length of the maximal invalid subpart, to be replaced by one U+FFFD
+inline int decode_one(const unsigned char* s, std::size_t n, char32_t& cp)
+{
+    const unsigned char b = s[0];
+    unsigned char lo = 0x80, hi = 0xBF;
+    int len;
+    char32_t c;
+    if (b < 0x80) {
+        cp = b;
+        return 1;
+    } else if (b < 0xC2) {
+        return -1;
+    } else if (b < 0xE0) {
+        len = 2;
+        c = b & 0x1F;
+    } else if (b < 0xF0) {
+        len = 3;
+        c = b & 0x0F;
+        lo = b == 0xE0 ? 0xA0 : 0x80;
+        hi = b == 0xED ? 0x9F : 0xBF;
+    } else if (b < 0xF5) {
+        len = 4;
+        c = b & 0x07;
+        lo = b == 0xF0 ? 0x90 : 0x80;
+        hi = b == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        return -1;
+    }
+    for (int i = 1; i < len; ++i) {
+        if (static_cast<std::size_t>(i) >= n)
+            return 0;
+        const unsigned char x = s[i];
+        if (x < lo || x > hi)
+            return -i;
+        lo = 0x80;
+        hi = 0xBF;
+        c = (c << 6) | (x & 0x3F);
+    }
+    cp = c;
+    return len;
+}
+
+// one code point as UTF-16 or UTF-32, by the size of the unit (char16_t, char32_t, wchar_t)
+template <typename Unit>
+inline Unit* put(char32_t cp, Unit* out)
+{
+    if (sizeof(Unit) == 2 && cp >= 0x10000) {
+        cp -= 0x10000;
+        *out++ = static_cast<Unit>(0xD800 + (cp >> 10));
+        *out++ = static_cast<Unit>(0xDC00 + (cp & 0x3FF));
+        return out;
+    }
+    *out++ = static_cast<Unit>(cp);
+    return out;
+}
+
+struct result {
+    std::size_t read;    // input consumed
+    std::size_t written; // output units produced
+    bool error;          // strict: stopped at an invalid sequence, which starts at `read`
+};
+
+// s[0, n) -> out, which has room for n units (a UTF-8 byte never becomes more than one unit).
+// Without `last` a sequence cut off at the end is left unread for the next chunk
+template <typename Unit>
+result decode(const unsigned char* s, std::size_t n, Unit* out, errors mode, bool last)
+{
+    Unit* o = out;
+    std::size_t i = 0;
+    result r = {0, 0, false};
+    while (i < n) {
+        if (s[i] < 0x80) {
+            // widen the whole ASCII run at once
+            const std::size_t k = ascii_prefix(s + i, n - i);
+            for (std::size_t j = 0; j < k; ++j) {
+                o[j] = static_cast<Unit>(s[i + j]);
+            }
+            o += k;
+            i += k;
+            continue;
+        }
+        char32_t cp;
+        const int len = decode_one(s + i, n - i, cp);
+        if (len > 0) {
+            o = put(cp, o);
+            i += len;
+        } else if (len == 0 && !last) {
+            break;
+        } else if (mode == errors::strict) {
+            r.error = true;
+            break;
+        } else {
+            *o++ = static_cast<Unit>(0xFFFD);
+            i += len == 0 ? n - i : static_cast<std::size_t>(-len);
+        }
+    }
+    r.read = i;
+    r.written = static_cast<std::size_t>(o - out);
+    return r;
+}
+
+// UTF-16 / UTF-32 s[0, n) -> UTF-8 out, which has room for 3 bytes per unit (4 for UTF-32)
+template <typename Unit>
+result encode(const Unit* s, std::size_t n, char* out, errors mode)
+{
+    char* o = out;
+    std::size_t i = 0;
+    result r = {0, 0, false};
+    while (i < n) {
+        // eight ASCII units at once (unsigned: wchar_t is signed on Linux)
+        if (i + 8 <= n) {
+            std::uint32_t any = 0;
+            for (std::size_t j = 0; j < 8; ++j) {
+                any |= static_cast<std::uint32_t>(s[i + j]);
+            }
+            if (any < 0x80) {
+                for (std::size_t j = 0; j < 8; ++j) {
+                    o[j] = static_cast<char>(s[i + j]);
+                }
+                o += 8;
+                i += 8;
+                continue;
+            }
+        }
+        char32_t cp = static_cast<char32_t>(s[i]);
+        std::size_t used = 1;
+        bool bad = false;
+        if (sizeof(Unit) == 2 && cp >= 0xD800 && cp <= 0xDFFF) {
+            // a high surrogate followed by a low one, nothing else
+            const char32_t next = i + 1 < n ? static_cast<char32_t>(s[i + 1]) : 0;
+            if (cp <= 0xDBFF && next >= 0xDC00 && next <= 0xDFFF) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (next - 0xDC00);
+                used = 2;
+            } else {
+                bad = true;
+            }
+        } else if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            bad = true;
+        }
+        if (bad) {
+            if (mode == errors::strict) {
+                r.error = true;
+                break;
+            }
+            cp = 0xFFFD;
+        }
+        if (cp < 0x80) {
+            *o++ = static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            *o++ = static_cast<char>(0xC0 | (cp >> 6));
+            *o++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            *o++ = static_cast<char>(0xE0 | (cp >> 12));
+            *o++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *o++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            *o++ = static_cast<char>(0xF0 | (cp >> 18));
+            *o++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            *o++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *o++ = static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        i += used;
+    }
+    r.read = i;
+    r.written = static_cast<std::size_t>(o - out);
+    return r;
+}
+
+inline void throw_invalid(const char* what, std::size_t offset)
+{
+    throw std::range_error(std::string(what) + ": invalid sequence at offset " + std::to_string(offset));
+}
+
+template <typename String>
+String to_units(string_view s, errors mode)
+{
+    String out(s.size(), typename String::value_type());
+    const result r = decode(reinterpret_cast<const unsigned char*>(s.data()), s.size(), &out[0], mode, true);
+    if (r.error)
+        throw_invalid("utf8", r.read);
+    out.resize(r.written);
+    return out;
+}
+
+template <typename Unit>
+std::string from_units(const Unit* s, std::size_t n, errors mode)
+{
+    std::string out(n * (sizeof(Unit) == 2 ? 3 : 4), '\0');
+    const result r = encode(s, n, &out[0], mode);
+    if (r.error)
+        throw_invalid(sizeof(Unit) == 2 ? "utf16" : "utf32", r.read);
+    out.resize(r.written);
+    return out;
+}
+
+}
+
+// -- validation --
+
+// the offset where the first invalid (or cut off) sequence starts, s.size() for valid UTF-8
+inline std::size_t find_invalid(string_view s)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(s.data());
+    std::size_t safe;
+    const unsigned state = detail::run(p, s.size(), detail::kAccept, safe);
+    if (state == detail::kAccept)
+        return s.size();
+    return detail::locate(p, s.size(), safe, detail::kAccept, safe);
+}
+
+inline bool is_valid(string_view s)
+{
+    std::size_t safe;
+    return detail::run(reinterpret_cast<const unsigned char*>(s.data()), s.size(), detail::kAccept, safe) == detail::kAccept;
+}
+
+// -- counting, for valid input --
+
+inline std::size_t count_code_points(string_view s)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(s.data());
+    const std::size_t n = s.size();
+    std::size_t continuation = 0, i = 0;
+#if defined(STL_DEMO_SIMD)
+    namespace simd = algorithms::simd;
+    typedef simd::lane<std::int8_t> bytes;
+    // 0x80..0xBF are the signed bytes -128..-65
+    const simd::reg bound = bytes::set1(-64);
+    for (; i + simd::kBytes <= n; i += simd::kBytes) {
+        continuation += simd::popcount(simd::bytemask(bytes::gt(bound, simd::loadu(p + i))));
+    }
+#endif
+    for (; i < n; ++i) {
+        continuation += (p[i] & 0xC0) == 0x80;
+    }
+    return n - continuation;
+}
+
+// the number of UTF-16 units: code points, plus one more for each 4 byte sequence
+inline std::size_t utf16_length(string_view s)
+{
+    std::size_t four = 0;
+    for (unsigned char c : s) {
+        four += c >= 0xF0;
+    }
+    return count_code_points(s) + four;
+}
+
+// -- transcoding: errors::strict throws std::range_error --
+
+inline std::u16string to_utf16(string_view s, errors mode = errors::strict)
+{
+    return detail::to_units<std::u16string>(s, mode);
+}
+
+inline std::u32string to_utf32(string_view s, errors mode = errors::strict)
+{
+    return detail::to_units<std::u32string>(s, mode);
+}
+
+inline std::wstring to_wstring(string_view s, errors mode = errors::strict)
+{
+    return detail::to_units<std::wstring>(s, mode);
+}
+
+inline std::string to_utf8(const std::u16string& s, errors mode = errors::strict)
+{
+    return detail::from_units(s.data(), s.size(), mode);
+}
+
+inline std::string to_utf8(const std::u32string& s, errors mode = errors::strict)
+{
+    return detail::from_units(s.data(), s.size(), mode);
+}
+
+inline std::string to_utf8(const std::wstring& s, errors mode = errors::strict)
+{
+    return detail::from_units(s.data(), s.size(), mode);
+}
+
+// -- chunked input --
+
+// validates a stream chunk by chunk; sequences may be split anywhere
+class validator {
+public:
+    validator() : state_(detail::kAccept), offset_(0), seq_start_(0), error_(npos) {}
+
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    // false once the input is known to be invalid
+    bool feed(string_view chunk)
+    {
+        if (error_ != npos)
+            return false;
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(chunk.data());
+        const std::size_t n = chunk.size();
+        std::size_t safe;
+        const unsigned state = detail::run(p, n, state_, safe);
+        if (state == detail::kError) {
+            const std::size_t at = safe == detail::kCarried ? detail::locate(p, n, 0, state_, detail::kCarried)
+                                                            : detail::locate(p, n, safe, detail::kAccept, safe);
+            error_ = at == detail::kCarried ? seq_start_ : offset_ + at;
+            return false;
+        }
+        if (state != detail::kAccept) {
+            // the open sequence: its lead byte is the last one that is not a continuation byte
+            std::size_t lead = n;
+            while (lead > 0 && (p[lead - 1] & 0xC0) == 0x80) {
+                --lead;
+            }
+            if (lead > 0)
+                seq_start_ = offset_ + lead - 1;
+        }
+        state_ = state;
+        offset_ += n;
+        return true;
+    }
+
+    // false if the input was invalid or ended inside a sequence
+    bool finish()
+    {
+        if (error_ == npos && state_ != detail::kAccept)
+            error_ = seq_start_;
+        return error_ == npos;
+    }
+
+    // the offset where the first invalid sequence starts, npos while there is none
+    std::size_t error_offset() const { return error_; }
+
+private:
+    unsigned state_;
+    std::size_t offset_;    // bytes fed so far
+    std::size_t seq_start_; // where the open sequence began
+    std::size_t error_;
+};
+
+// decodes a stream chunk by chunk into a u16string / u32string / wstring
+class decoder {
+public:
+    explicit decoder(errors mode = errors::strict) : mode_(mode), pending_(0), offset_(0) {}
+
+    template <typename String>
+    void decode(string_view chunk, String& out)
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(chunk.data());
+        std::size_t n = chunk.size();
+        if (pending_ > 0) {
+            // complete the sequence cut off by the previous chunk
+            const std::size_t take = std::min<std::size_t>(4 - pending_, n);
+            std::memcpy(carry_ + pending_, p, take);
+            const std::size_t have = pending_ + take;
+            typename String::value_type units[4];
+            const detail::result r = detail::decode(carry_, have, units, mode_, false);
+            out.append(units, r.written);
+            if (r.error)
+                detail::throw_invalid("utf8", offset_ - pending_ + r.read);
+            if (r.read == 0) {
+                // still not complete: the chunk was shorter than the rest of the sequence
+                pending_ = have;
+                offset_ += n;
+                return;
+            }
+            const std::size_t used = r.read - pending_;
+            pending_ = 0;
+            p += used;
+            n -= used;
+            offset_ += used;
+        }
+        const std::size_t old = out.size();
+        out.resize(old + n);
+        const detail::result r = detail::decode(p, n, &out[old], mode_, false);
+        out.resize(old + r.written);
+        if (r.error)
+            detail::throw_invalid("utf8", offset_ + r.read);
+        pending_ = n - r.read;
+        std::memcpy(carry_, p + r.read, pending_);
+        offset_ += n;
+    }
+
+    // the end of the input: a sequence still open is an error (strict) or one U+FFFD (replace)
+    template <typename String>
+    void finish(String& out)
+    {
+        if (pending_ > 0) {
+            if (mode_ == errors::strict)
+                detail::throw_invalid("utf8", offset_ - pending_);
+            out.push_back(static_cast<typename String::value_type>(0xFFFD));
+            pending_ = 0;
+        }
+    }
+
+private:
+    errors mode_;
+    unsigned char carry_[4];
+    std::size_t pending_; // bytes of an incomplete sequence in carry_
+    std::size_t offset_;  // input consumed so far, carry_ included
+};
+
+void Run();
+
+}
+}
+
+#endif //STL_DEMO_STRINGS_UTF8_H